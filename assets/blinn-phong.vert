@@ -9,18 +9,37 @@ layout(location = 2) in vec3 iNormal;
 layout(location = 0) uniform mat4 uProjCameraWorld;
 layout(location = 1) uniform mat3 uNormalMatrix;
 
+// Vertex format, see setVertexFormatUniforms(). The defaults are for float
+// attributes.
+uniform vec3 uPositionOffset = vec3(0.0);
+uniform vec3 uPositionScale = vec3(1.0);
+uniform bool uOctahedralNormals = false;
+
 // Stuff to pass to fragment shader
 out vec3 outColor;
 out vec3 outPos;
 out vec3 v3fNormal;
 
+// Inverse of encode_octahedral() in vmlib/quantize.hpp
+vec3 decodeOctahedral(vec2 e)
+{
+	vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+	if (n.z < 0.0)
+		n.xy = (1.0 - abs(e.yx)) * vec2(e.x >= 0.0 ? 1.0 : -1.0, e.y >= 0.0 ? 1.0 : -1.0);
+	return normalize(n);
+}
+
 void main()
 {
+	// Decode quantized attributes
+	vec3 position = uPositionOffset + uPositionScale * iPosition;
+	vec3 normal = uOctahedralNormals ? decodeOctahedral(iNormal.xy) : iNormal;
+
 	// Setting fragment shader variables
 	outColor = iColor;
-	outPos = iPosition;
-	v3fNormal = normalize(uNormalMatrix * iNormal);
+	outPos = position;
+	v3fNormal = normalize(uNormalMatrix * normal);
 	
 	// Set vertex position
-	gl_Position = uProjCameraWorld * vec4(iPosition, 1.0);
+	gl_Position = uProjCameraWorld * vec4(position, 1.0);
 }
\ No newline at end of file
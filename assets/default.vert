@@ -9,6 +9,11 @@ layout(location = 3) in vec2 iTexCoords;
 // Uniforms
 layout(location = 0) uniform mat4 uProjCameraWorld;
 
+// Vertex format, see setVertexFormatUniforms(). The defaults are for float
+// attributes.
+uniform vec3 uPositionOffset = vec3(0.0);
+uniform vec3 uPositionScale = vec3(1.0);
+
 // Stuff to pass to fragment shader
 out vec3 outColor;
 out vec2 v2fTexCoord;
@@ -20,5 +25,6 @@ void main()
 	v2fTexCoord = iTexCoords;
 
 	// Set vertex position
-	gl_Position = uProjCameraWorld * vec4(iPosition, 1.0);
+	vec3 position = uPositionOffset + uPositionScale * iPosition;
+	gl_Position = uProjCameraWorld * vec4(position, 1.0);
 }
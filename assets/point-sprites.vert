@@ -1,7 +1,9 @@
 #version 430
 
-// VAO attributes
+// VAO attributes. The lifetime is negative for dead particles, which are
+// not drawn (only the GPU simulation keeps dead particles in its buffers).
 layout(location = 0) in vec3 iPosition;
+layout(location = 1) in float iLifeTime;
 
 // Uniforms
 layout(location = 0) uniform mat4 modelMatrix;
@@ -11,6 +13,15 @@ layout(location = 3) uniform vec3 uCameraPos;
 
 void main()
 {
+	// Dead particles are moved outside of the clip volume, so that they
+	// are culled
+	if (iLifeTime < 0.0)
+	{
+		gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+		gl_PointSize = 1.0;
+		return;
+	}
+
 	// Change position based on the transformed model matrix from the application
 	vec4 newPos = modelMatrix * vec4(iPosition, 1.0);
 
@@ -24,4 +35,4 @@ void main()
 	// Do usual vertex position transformation
 	mat4 mvpMatrix = projectionMatrix * viewMatrix * modelMatrix;
 	gl_Position = mvpMatrix * vec4(iPosition, 1.0);
-}
\ No newline at end of file
+}
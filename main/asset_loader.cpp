@@ -0,0 +1,328 @@
+#include "asset_loader.hpp"
+
+#include <algorithm>
+
+#include "../support/error.hpp"
+
+namespace
+{
+	std::size_t vertexBytes_(PreparedMesh const& aMesh)
+	{
+		return aMesh.vertexCount * sizeof(QuantizedVertex);
+	}
+	std::size_t indexBytes_(PreparedMesh const& aMesh)
+	{
+		return aMesh.indexCount * (GL_UNSIGNED_SHORT == aMesh.indexType ? sizeof(std::uint16_t) : sizeof(std::uint32_t));
+	}
+	std::size_t imageBytes_(Image const& aImage, MipChain const& aMips)
+	{
+		return std::size_t(aImage.width) * std::size_t(aImage.height) * 4 + aMips.pixels.size();
+	}
+
+	// Buffer of the given size without contents. Filling it with
+	// glCopyBufferSubData() from the staging buffer needs no flags;
+	// glBufferSubData() needs GL_DYNAMIC_STORAGE_BIT.
+	GLuint createBuffer_(std::size_t aSize, GLbitfield aStorageFlags)
+	{
+		GLuint buffer = 0;
+		glGenBuffers(1, &buffer);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+
+		if (GLAD_GL_VERSION_4_4 && aSize > 0)
+		{
+			glBufferStorage(GL_COPY_WRITE_BUFFER, GLsizeiptr(aSize), nullptr, aStorageFlags);
+		}
+		else
+		{
+			glBufferData(GL_COPY_WRITE_BUFFER, GLsizeiptr(aSize), nullptr, GL_STATIC_DRAW);
+		}
+
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		return buffer;
+	}
+}
+
+AssetLoader::AssetLoader(std::size_t uploadBytesPerFrame, std::size_t workerCount)
+	: staging(uploadBytesPerFrame)
+	, uploadBytesPerFrame(uploadBytesPerFrame)
+{
+	for (std::size_t i = 0; i < workerCount; ++i)
+	{
+		workers.emplace_back([this] { worker(); });
+	}
+}
+
+AssetLoader::~AssetLoader()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stop = true;
+	}
+	wake.notify_all();
+
+	for (auto& thread : workers)
+	{
+		thread.join();
+	}
+
+	for (auto& upload : uploads)
+	{
+		discard(*upload);
+	}
+}
+
+void AssetLoader::requestMesh(char const* path, MeshLoadOptions const& options, MeshReady onReady)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		jobs.push_back(Job{ true, path, options, std::move(onReady), nullptr });
+	}
+	wake.notify_one();
+	++pending;
+}
+
+void AssetLoader::requestTexture(char const* path, TextureReady onReady)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		jobs.push_back(Job{ false, path, MeshLoadOptions{}, nullptr, std::move(onReady) });
+	}
+	wake.notify_one();
+	++pending;
+}
+
+void AssetLoader::update()
+{
+	// Take over the assets that the workers have finished
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		while (!done.empty())
+		{
+			if (done.front()->error)
+			{
+				std::rethrow_exception(done.front()->error);
+			}
+
+			Upload& upload = *done.front();
+			ready += upload.job.isMesh ? vertexBytes_(upload.mesh) + indexBytes_(upload.mesh) : imageBytes_(upload.image, upload.mips);
+
+			uploads.push_back(std::move(done.front()));
+			done.pop_front();
+		}
+	}
+
+	if (uploads.empty())
+	{
+		return;
+	}
+
+	// Upload in the order the assets became ready, until the budget for
+	// this frame is used up
+	budget = uploadBytesPerFrame;
+
+	std::size_t finished = 0;
+	for (auto& upload : uploads)
+	{
+		if (!upload->started)
+		{
+			start(*upload);
+		}
+
+		if (!step(*upload))
+		{
+			break;
+		}
+		++finished;
+	}
+
+	staging.flush();
+
+	for (std::size_t i = 0; i < finished; ++i)
+	{
+		finish(*uploads.front());
+		uploads.pop_front();
+		--pending;
+	}
+}
+
+void AssetLoader::worker()
+{
+	for (;;)
+	{
+		Job job;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [this] { return stop || !jobs.empty(); });
+			if (stop)
+			{
+				return;
+			}
+
+			job = std::move(jobs.front());
+			jobs.pop_front();
+		}
+
+		auto upload = std::make_unique<Upload>();
+		upload->job = std::move(job);
+		try
+		{
+			if (upload->job.isMesh)
+			{
+				upload->mesh = prepareCachedWavefrontOBJ(upload->job.path.c_str(), upload->job.options);
+			}
+			else
+			{
+				upload->image = loadImage(upload->job.path.c_str());
+				upload->mips = generateMipChain(upload->image);
+			}
+		}
+		catch (...)
+		{
+			upload->error = std::current_exception();
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+		done.push_back(std::move(upload));
+	}
+}
+
+std::size_t AssetLoader::stagingAvailable() const
+{
+	return std::min(budget, staging.available());
+}
+
+void AssetLoader::start(Upload& upload)
+{
+	if (upload.job.isMesh)
+	{
+		// A mesh from the cache points into the mapped file (see
+		// prepareCachedWavefrontOBJ()); the mapping stays valid until the
+		// upload is finished, so it needs no staging copy
+		upload.direct = nullptr != upload.mesh.cache.data();
+
+		GLbitfield const flags = upload.direct ? GL_DYNAMIC_STORAGE_BIT : 0;
+		upload.vertexBuffer = createBuffer_(vertexBytes_(upload.mesh), flags);
+		upload.indexBuffer = createBuffer_(indexBytes_(upload.mesh), flags);
+	}
+	else
+	{
+		if (std::size_t(upload.image.width) * 4 > staging.capacity())
+		{
+			throw Error("Image '%s' is too wide to be uploaded through the staging buffer", upload.job.path.c_str());
+		}
+
+		glGenTextures(1, &upload.texture);
+		glBindTexture(GL_TEXTURE_2D, upload.texture);
+		glTexStorage2D(GL_TEXTURE_2D, mipLevelCount(upload.image.width, upload.image.height), GL_SRGB8_ALPHA8, upload.image.width, upload.image.height);
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
+
+	upload.started = true;
+}
+
+bool AssetLoader::step(Upload& upload)
+{
+	if (upload.job.isMesh)
+	{
+		// Vertices, then indices, in pieces that fit in this frame's budget
+		auto const copy = [&] (GLuint aBuffer, void const* aData, std::size_t aSize, std::size_t& aDone) {
+			std::size_t const size = std::min(aSize - aDone, upload.direct ? budget : stagingAvailable());
+			if (size > 0)
+			{
+				unsigned char const* data = static_cast<unsigned char const*>(aData) + aDone;
+				if (upload.direct)
+				{
+					glBindBuffer(GL_COPY_WRITE_BUFFER, aBuffer);
+					glBufferSubData(GL_COPY_WRITE_BUFFER, GLintptr(aDone), GLsizeiptr(size), data);
+					glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+				}
+				else
+				{
+					staging.copyToBuffer(aBuffer, aDone, data, size);
+				}
+
+				aDone += size;
+				uploaded += size;
+				budget -= size;
+			}
+			return aDone == aSize;
+		};
+
+		PreparedMesh const& mesh = upload.mesh;
+		return copy(upload.vertexBuffer, mesh.vertices, vertexBytes_(mesh), upload.vertexBytesDone)
+			&& copy(upload.indexBuffer, mesh.indices, indexBytes_(mesh), upload.indexBytesDone);
+	}
+
+	// Whole rows of the image, and then of each mipmap level
+	GLint const levelCount = GLint(upload.mips.levels.size()) + 1;
+	while (upload.level < levelCount)
+	{
+		int width = upload.image.width, height = upload.image.height;
+		unsigned char const* pixels = upload.image.pixels.get();
+		if (upload.level > 0)
+		{
+			MipChain::Level const& level = upload.mips.levels[upload.level - 1];
+			width = level.width;
+			height = level.height;
+			pixels = upload.mips.pixels.data() + level.offset;
+		}
+
+		std::size_t const rowBytes = std::size_t(width) * 4;
+		GLint const rows = GLint(std::min(std::size_t(height - upload.rowsDone), stagingAvailable() / rowBytes));
+		if (0 == rows)
+		{
+			return false;
+		}
+
+		staging.copyToTexture(upload.texture, upload.level, width, upload.rowsDone, rows, pixels + upload.rowsDone * rowBytes);
+		upload.rowsDone += rows;
+		uploaded += rows * rowBytes;
+		budget -= rows * rowBytes;
+
+		if (upload.rowsDone == height)
+		{
+			++upload.level;
+			upload.rowsDone = 0;
+		}
+	}
+
+	return true;
+}
+
+void AssetLoader::finish(Upload& upload)
+{
+	if (upload.job.isMesh)
+	{
+		PreparedMesh& mesh = upload.mesh;
+
+		LoadedMesh loaded;
+		loaded.vao = createVAO(upload.vertexBuffer, upload.indexBuffer, mesh.indexCount, mesh.indexType, mesh.format, std::move(mesh.lods), std::move(mesh.tiles));
+		loaded.bounds = mesh.bounds;
+
+		// The VAO keeps the buffers alive
+		discard(upload);
+
+		upload.job.onMeshReady(loaded);
+		return;
+	}
+
+	glBindTexture(GL_TEXTURE_2D, upload.texture);
+	setTextureParameters2D();
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	GLuint const texture = upload.texture;
+	upload.texture = 0;
+
+	upload.job.onTextureReady(texture);
+}
+
+void AssetLoader::discard(Upload& upload)
+{
+	glDeleteBuffers(1, &upload.vertexBuffer);
+	glDeleteBuffers(1, &upload.indexBuffer);
+	glDeleteTextures(1, &upload.texture);
+
+	upload.vertexBuffer = 0;
+	upload.indexBuffer = 0;
+	upload.texture = 0;
+}
@@ -0,0 +1,125 @@
+// Background loading of meshes and textures
+//
+// requestMesh() and requestTexture() queue an asset; worker threads do all
+// the CPU work (parsing the OBJ file or mapping its cache, see
+// prepareCachedWavefrontOBJ(), and decoding images with stb_image and
+// computing their mipmaps, see generateMipChain()). The
+// main thread calls update() once per frame, which moves the data of the
+// assets that are ready into GL buffers and textures, at most
+// uploadBytesPerFrame bytes per frame. Meshes loaded from their cache are
+// uploaded with glBufferSubData() straight from the mapped cache file;
+// everything else goes through a StagingBuffer. Once all of an asset is
+// uploaded, its callback is called (on the main thread, from update())
+// with the finished VAO or texture.
+//
+// Until then, the application keeps drawing without the asset, or with a
+// placeholder (e.g., createSolidTexture2D()).
+//
+// Errors on the worker threads are rethrown by update().
+#pragma once
+
+#include <glad.h>
+
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <functional>
+#include <exception>
+#include <condition_variable>
+
+#include "texture.hpp"
+#include "mesh_cache.hpp"
+#include "staging_buffer.hpp"
+
+class AssetLoader
+{
+public:
+	using MeshReady = std::function<void(LoadedMesh const&)>;
+	using TextureReady = std::function<void(GLuint)>;
+
+	AssetLoader(std::size_t uploadBytesPerFrame, std::size_t workerCount = 2);
+
+	// Waits for the worker threads to finish the asset they are working on.
+	// Assets that were not handed over yet are deleted. Needs the GL
+	// context.
+	~AssetLoader();
+
+	AssetLoader(AssetLoader const&) = delete;
+	AssetLoader& operator=(AssetLoader const&) = delete;
+
+	void requestMesh(char const* path, MeshLoadOptions const&, MeshReady onReady);
+	void requestTexture(char const* path, TextureReady onReady);
+
+	// Main thread, once per frame
+	void update();
+
+	// Assets requested but not handed over yet
+	std::size_t pendingCount() const { return pending; }
+
+	// Bytes uploaded so far, and in total for the assets that are ready
+	// (for progress displays)
+	std::size_t uploadedBytes() const { return uploaded; }
+	std::size_t readyBytes() const { return ready; }
+
+private:
+	struct Job
+	{
+		bool isMesh;
+		std::string path;
+		MeshLoadOptions options;
+		MeshReady onMeshReady;
+		TextureReady onTextureReady;
+	};
+
+	// Asset that is ready on the CPU side, and its upload state
+	struct Upload
+	{
+		Job job;
+		PreparedMesh mesh;
+		Image image;
+		MipChain mips;
+		std::exception_ptr error;
+
+		bool started = false;
+		bool direct = false; // mesh uploaded from the mapped cache
+		GLuint vertexBuffer = 0;
+		GLuint indexBuffer = 0;
+		GLuint texture = 0;
+		std::size_t vertexBytesDone = 0;
+		std::size_t indexBytesDone = 0;
+		GLint level = 0;
+		GLint rowsDone = 0; // of level
+	};
+
+	void worker();
+	void start(Upload&);
+	bool step(Upload&); // true when done
+	void finish(Upload&);
+	void discard(Upload&);
+
+	// Bytes that can still be uploaded in this frame through the staging
+	// buffer
+	std::size_t stagingAvailable() const;
+
+	StagingBuffer staging;
+	std::size_t uploadBytesPerFrame;
+	std::size_t budget = 0; // bytes left in this frame (main thread)
+
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::deque<Job> jobs;
+	std::deque<std::unique_ptr<Upload>> done; // from the workers
+	bool stop = false;
+
+	std::vector<std::thread> workers;
+
+	// Main thread only
+	std::deque<std::unique_ptr<Upload>> uploads;
+	std::size_t pending = 0;
+	std::size_t uploaded = 0;
+	std::size_t ready = 0;
+};
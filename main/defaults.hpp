@@ -20,4 +20,13 @@ using Clock = std::chrono::steady_clock;
  */
 using Secondsf = std::chrono::duration<float, std::ratio<1>>;
 
+/* Use the approximations from vmlib/fastmath.hpp
+ *
+ * The particle emitter and the shape generators spend most of their time in
+ * sin/cos/sqrt. With this enabled, they use the polynomial approximations
+ * instead (max. error of a few 1e-7, see fastmath.hpp), which is not visible
+ * in the rendered result. Disable to get the C library functions.
+ */
+constexpr bool kUseFastMath = true;
+
 #endif // DEFAULTS_HPP_B71D6BE9_ED49_4477_8DCA_76670C2F0398
@@ -0,0 +1,238 @@
+#include "gpu_particle_check.hpp"
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+#include <cmath>
+#include <cstdio>
+
+#include "../vmlib/mat44.hpp"
+
+#include "particles.hpp"
+#include "gpu_particles.hpp"
+
+namespace
+{
+	constexpr int kParticles_ = 5000;
+	constexpr float kSpawnRate_ = 4500.f;
+	constexpr float kDeltaTime_ = 0.016f;
+	constexpr int kUpdates_ = 300; // particles live up to 2 s
+	constexpr int kDrawUpdates_ = 10;
+	constexpr std::uint64_t kSeed_ = 7;
+
+	// Must match particles.comp and ParticleGenerator
+	constexpr float kSpeed_ = 5.f;
+	constexpr float kMaxLifeTime_ = 2.f;
+	constexpr float kConeAngle_ = 0.8f;
+
+	constexpr GLsizei kTargetSize_ = 64;
+
+	struct Readback_
+	{
+		std::vector<float> positions;
+		std::vector<float> velocities;
+		std::vector<float> lifeTimes;
+	};
+
+	std::vector<float> readBuffer_(GLuint aBuffer, std::size_t aCount)
+	{
+		std::vector<float> ret(aCount);
+		glBindBuffer(GL_COPY_READ_BUFFER, aBuffer);
+		glGetBufferSubData(GL_COPY_READ_BUFFER, 0, GLsizeiptr(aCount * sizeof(float)), ret.data());
+		glBindBuffer(GL_COPY_READ_BUFFER, 0);
+		return ret;
+	}
+
+	Readback_ read_(GpuParticleGenerator const& aGenerator)
+	{
+		std::size_t const n = std::size_t(aGenerator.maxParticles);
+		return Readback_{
+			readBuffer_(aGenerator.positionBuffer, 3 * n),
+			readBuffer_(aGenerator.velocityBuffer, 3 * n),
+			readBuffer_(aGenerator.lifeTimeBuffer, n)
+		};
+	}
+
+	struct UpdateResult_
+	{
+		int errors;
+		std::size_t freeSlots; // dead before the update, or died during it
+		std::size_t respawned;
+		std::size_t alive;
+	};
+
+	// Checks one update against the state before it
+	UpdateResult_ checkUpdate_(Readback_ const& aPrev, Readback_ const& aCur, Vec3f aEmitter, Vec3f aConeDirection)
+	{
+		UpdateResult_ ret{};
+
+		for (std::size_t i = 0; i < aCur.lifeTimes.size(); ++i)
+		{
+			bool const freeSlot = aPrev.lifeTimes[i] < 0.f || aPrev.lifeTimes[i] - kDeltaTime_ < 0.f;
+			ret.freeSlots += freeSlot ? 1 : 0;
+
+			if (aCur.lifeTimes[i] < 0.f)
+			{
+				ret.errors += freeSlot ? 0 : 1;
+				continue;
+			}
+
+			ret.alive++;
+
+			Vec3f const p{ aCur.positions[3*i], aCur.positions[3*i + 1], aCur.positions[3*i + 2] };
+			Vec3f const v{ aCur.velocities[3*i], aCur.velocities[3*i + 1], aCur.velocities[3*i + 2] };
+
+			if (freeSlot)
+			{
+				ret.respawned++;
+
+				bool const atEmitter = p.x == aEmitter.x && p.y == aEmitter.y && p.z == aEmitter.z;
+				bool const speed = std::abs(length(v) - kSpeed_) < 1e-3f;
+				bool const inCone = dot(v, aConeDirection) / kSpeed_ >= std::cos(kConeAngle_) - 1e-4f;
+				bool const lifeTime = aCur.lifeTimes[i] <= kMaxLifeTime_;
+				ret.errors += (atEmitter && speed && inCone && lifeTime) ? 0 : 1;
+			}
+			else
+			{
+				Vec3f const p0{ aPrev.positions[3*i], aPrev.positions[3*i + 1], aPrev.positions[3*i + 2] };
+				Vec3f const v0{ aPrev.velocities[3*i], aPrev.velocities[3*i + 1], aPrev.velocities[3*i + 2] };
+
+				bool const moved = length(p - (p0 + kDeltaTime_ * v0)) < 1e-4f;
+				bool const kept = v.x == v0.x && v.y == v0.y && v.z == v0.z;
+				bool const aged = std::abs(aCur.lifeTimes[i] - (aPrev.lifeTimes[i] - kDeltaTime_)) < 1e-6f;
+				ret.errors += (moved && kept && aged) ? 0 : 1;
+			}
+		}
+
+		return ret;
+	}
+
+	// Number of pixels that are not black
+	std::size_t litPixels_()
+	{
+		std::vector<unsigned char> pixels(std::size_t(kTargetSize_) * kTargetSize_ * 4);
+		glReadPixels(0, 0, kTargetSize_, kTargetSize_, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+		std::size_t ret = 0;
+		for (std::size_t i = 0; i < pixels.size(); i += 4)
+		{
+			ret += (pixels[i] | pixels[i + 1] | pixels[i + 2]) ? 1 : 0;
+		}
+		return ret;
+	}
+
+	template <typename Generator>
+	std::size_t drawnPixels_(Generator& aGenerator, GLuint aProgram, Vec3f aCenter, GLuint aTexture)
+	{
+		glClear(GL_COLOR_BUFFER_BIT);
+
+		// aCenter ends up in the middle of the target
+		Mat44f const model = make_translation(-aCenter);
+		Vec3f const camera{ 0.f, 0.f, 0.f };
+
+		glUseProgram(aProgram);
+		glUniformMatrix4fv(0, 1, GL_TRUE, model.v);
+		glUniformMatrix4fv(1, 1, GL_TRUE, kIdentity44f.v);
+		glUniformMatrix4fv(2, 1, GL_TRUE, kIdentity44f.v);
+		glUniform3fv(3, 1, &camera.x);
+
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, aTexture);
+
+		aGenerator.draw();
+
+		glBindTexture(GL_TEXTURE_2D, 0);
+		glUseProgram(0);
+
+		return litPixels_();
+	}
+}
+
+bool runGpuParticleCheck(ShaderProgram const& aComputeProgram, GLuint aPointSpriteProgram)
+{
+	Vec3f const emitter{ 1.f, 2.f, 3.f };
+	int errors = 0;
+
+	GpuParticleGenerator gpu(kParticles_, kSpawnRate_, Vec3f{ 0.f, 0.f, 0.f }, kSeed_);
+	gpu.createBuffers(aComputeProgram);
+
+	// Simulation: the due count is accumulated as in the generator
+	std::printf("%d slots, %.0f spawned per second\n", kParticles_, kSpawnRate_);
+
+	float remainder = 0.f;
+	Readback_ prev = read_(gpu);
+	for (int update = 0; update < kUpdates_; ++update)
+	{
+		remainder += kSpawnRate_ * kDeltaTime_;
+		std::size_t const due = std::size_t(remainder);
+		remainder -= float(due);
+
+		gpu.update(kDeltaTime_, emitter);
+		Readback_ cur = read_(gpu);
+
+		UpdateResult_ const res = checkUpdate_(prev, cur, emitter, gpu.coneDirection);
+		bool const ok = 0 == res.errors && res.respawned == std::min(due, res.freeSlots);
+
+		errors += ok ? 0 : std::max(res.errors, 1);
+		if (0 == update % 60 || !ok)
+		{
+			std::printf("  update %3d  respawned %4zu of %4zu due, %4zu alive   %s\n", update, res.respawned, due, res.alive, ok ? "ok" : "FAILED");
+		}
+
+		prev = std::move(cur);
+	}
+
+	// Drawing, into a small offscreen target with a white particle texture
+	GLuint texture = 0;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	unsigned char const white[4] = { 255, 255, 255, 255 };
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	GLuint colorBuffer = 0;
+	glGenRenderbuffers(1, &colorBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, kTargetSize_, kTargetSize_);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	GLuint fbo = 0;
+	glGenFramebuffers(1, &fbo);
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+
+	glViewport(0, 0, kTargetSize_, kTargetSize_);
+	glClearColor(0.f, 0.f, 0.f, 0.f);
+	glEnable(GL_PROGRAM_POINT_SIZE);
+
+	std::size_t const gpuPixels = drawnPixels_(gpu, aPointSpriteProgram, emitter, texture);
+	// The dead slots are all at the origin, and must be culled
+	gpu.resetParticles();
+	std::size_t const resetPixels = drawnPixels_(gpu, aPointSpriteProgram, Vec3f{ 0.f, 0.f, 0.f }, texture);
+
+	ParticleGenerator cpu(kParticles_, kSpawnRate_, Vec3f{ 0.f, 0.f, 0.f }, kSeed_);
+	cpu.createVAO();
+	for (int update = 0; update < kDrawUpdates_; ++update)
+	{
+		cpu.update(kDeltaTime_, emitter);
+	}
+	std::size_t const cpuPixels = drawnPixels_(cpu, aPointSpriteProgram, emitter, texture);
+
+	bool const drawn = gpuPixels > 0 && 0 == resetPixels && cpuPixels > 0;
+	errors += drawn ? 0 : 1;
+	std::printf("  drawn pixels: GPU %zu, after reset %zu, CPU %zu   %s\n", gpuPixels, resetPixels, cpuPixels, drawn ? "ok" : "FAILED");
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glDeleteFramebuffers(1, &fbo);
+	glDeleteRenderbuffers(1, &colorBuffer);
+	glDeleteTextures(1, &texture);
+
+	GLenum const glError = glGetError();
+	errors += GL_NO_ERROR == glError ? 0 : 1;
+
+	std::printf("%s (%d errors, GL error 0x%x)\n", 0 == errors ? "PASSED" : "FAILED", errors, glError);
+	return 0 == errors;
+}
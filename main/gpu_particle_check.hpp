@@ -0,0 +1,26 @@
+// Check of the GPU particle simulation (GpuParticleGenerator)
+//
+// Started with
+//
+//	main --check-gpu-particles
+//
+// Runs a number of updates and reads the buffers back after each one, then
+// checks that
+//  - live particles move by deltaTime * velocity and age by deltaTime,
+//  - each update respawns exactly the particles that are due (fewer only if
+//    there are not enough dead slots),
+//  - respawned particles start at the emitter with speed 5, inside the cone
+//    and with a lifetime of at most 2 s.
+// It then draws the particles of both generators into an offscreen
+// framebuffer and checks that points show up, and that none do after a
+// reset. Only needs a GL 4.3 context (e.g., Mesa's llvmpipe); the window
+// stays hidden. Results are printed to stdout.
+#pragma once
+
+#include <glad.h>
+
+#include "../support/program.hpp"
+
+// aComputeProgram is built from particles.comp, aPointSpriteProgram from
+// point-sprites.vert/.frag. Returns true if all checks pass.
+bool runGpuParticleCheck(ShaderProgram const& aComputeProgram, GLuint aPointSpriteProgram);
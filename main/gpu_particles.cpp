@@ -0,0 +1,147 @@
+#include "gpu_particles.hpp"
+
+#include <chrono>
+#include <cmath>
+
+#include "../vmlib/quat.hpp"
+
+namespace
+{
+	// SplitMix64 step, to derive the seed of each update
+	std::uint64_t mix_(std::uint64_t x)
+	{
+		x += 0x9e3779b97f4a7c15ull;
+		x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+		x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+		return x ^ (x >> 31);
+	}
+
+	// Must match local_size_x in particles.comp
+	constexpr GLuint kWorkGroupSize_ = 256;
+
+	// Half angle of the exhaust cone, as in ParticleGenerator
+	constexpr float kConeAngle_ = 0.8f;
+
+	GLuint createStorage_(GLsizeiptr size)
+	{
+		GLuint buffer = 0;
+		glGenBuffers(1, &buffer);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+
+		// Only the GPU reads and writes the particles, so immutable storage
+		// without any access flags is enough
+		if (GLAD_GL_VERSION_4_4)
+		{
+			glBufferStorage(GL_SHADER_STORAGE_BUFFER, size, nullptr, 0);
+		}
+		else
+		{
+			glBufferData(GL_SHADER_STORAGE_BUFFER, size, nullptr, GL_DYNAMIC_COPY);
+		}
+
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		return buffer;
+	}
+
+	void clearStorage_(GLuint buffer, float value)
+	{
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+		glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32F, GL_RED, GL_FLOAT, &value);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	}
+}
+
+GpuParticleGenerator::GpuParticleGenerator(int maxParticles, float spawnRate, Vec3f initialPosition)
+	: GpuParticleGenerator(maxParticles, spawnRate, initialPosition, std::uint64_t(std::chrono::system_clock::now().time_since_epoch().count()))
+{}
+
+GpuParticleGenerator::GpuParticleGenerator(int maxParticles, float spawnRate, Vec3f initialPosition, std::uint64_t seed) : maxParticles(maxParticles), spawnRate(spawnRate), conePosition(initialPosition), coneDirection(Vec3f{0.f, -1.f, 0.f}), seed(seed)
+{}
+
+void GpuParticleGenerator::createBuffers(ShaderProgram const& computeProgram)
+{
+	this->computeProgram = &computeProgram;
+
+	GLsizeiptr const count = GLsizeiptr(this->maxParticles);
+	this->positionBuffer = createStorage_(count * 3 * sizeof(float));
+	this->velocityBuffer = createStorage_(count * 3 * sizeof(float));
+	this->lifeTimeBuffer = createStorage_(count * sizeof(float));
+	this->counterBuffer = createStorage_(sizeof(GLuint));
+
+	this->resetParticles();
+
+	// The storage buffers double as vertex buffers for point-sprites.vert:
+	// positions at attribute 0, lifetimes at attribute 1
+	glGenVertexArrays(1, &this->vao);
+	glBindVertexArray(this->vao);
+
+	glBindVertexBuffer(0, this->positionBuffer, 0, 3 * sizeof(float));
+	glVertexAttribFormat(0, 3, GL_FLOAT, GL_FALSE, 0);
+	glVertexAttribBinding(0, 0);
+	glEnableVertexAttribArray(0);
+
+	glBindVertexBuffer(1, this->lifeTimeBuffer, 0, sizeof(float));
+	glVertexAttribFormat(1, 1, GL_FLOAT, GL_FALSE, 0);
+	glVertexAttribBinding(1, 1);
+	glEnableVertexAttribArray(1);
+
+	glBindVertexArray(0);
+}
+
+void GpuParticleGenerator::resetParticles()
+{
+	// All slots dead
+	clearStorage_(this->positionBuffer, 0.f);
+	clearStorage_(this->velocityBuffer, 0.f);
+	clearStorage_(this->lifeTimeBuffer, -1.f);
+
+	this->spawnRemainder = 0.f;
+}
+
+void GpuParticleGenerator::update(float deltaTime, Vec3f updatedShipPos)
+{
+	// Particles that are due, as in ParticleGenerator. Those that find no
+	// dead slot are dropped.
+	this->spawnRemainder += this->spawnRate * deltaTime;
+	GLuint const due = GLuint(this->spawnRemainder);
+	this->spawnRemainder -= float(due);
+
+	GLuint const zero = 0;
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->counterBuffer);
+	glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	Quatf const rotation = make_quat_rotation_between(Vec3f{ 0.f, 0.f, 1.f }, this->coneDirection);
+	std::uint64_t const updateSeed = mix_(this->seed ^ mix_(this->updateCount));
+
+	glUseProgram(this->computeProgram->programId());
+	glUniform1f(0, deltaTime);
+	glUniform1ui(1, GLuint(this->maxParticles));
+	glUniform1ui(2, due);
+	glUniform3f(3, updatedShipPos.x, updatedShipPos.y, updatedShipPos.z);
+	glUniform4f(4, rotation.x, rotation.y, rotation.z, rotation.w);
+	glUniform1f(5, std::cos(kConeAngle_));
+	glUniform1ui(6, GLuint(updateSeed ^ (updateSeed >> 32)));
+
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, this->positionBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, this->lifeTimeBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, this->velocityBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, this->counterBuffer);
+
+	glDispatchCompute((GLuint(this->maxParticles) + kWorkGroupSize_ - 1) / kWorkGroupSize_, 1, 1);
+	glUseProgram(0);
+
+	// The next dispatch reads what this one wrote, and the draws fetch it
+	// as vertex attributes
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+
+	this->updateCount++;
+}
+
+void GpuParticleGenerator::draw()
+{
+	// Dead slots stay in place, so the vertex shader has to cull them
+	glBindVertexArray(this->vao);
+	glDrawArrays(GL_POINTS, 0, GLsizei(this->maxParticles));
+	glBindVertexArray(0);
+}
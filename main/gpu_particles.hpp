@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+
+#include "glad.h"
+#include "../vmlib/vec3.hpp"
+#include "../support/program.hpp"
+
+// Particle system that runs entirely on the GPU, as an alternative to
+// ParticleGenerator. Positions, velocities and lifetimes live in shader
+// storage buffers, with the same layout as ParticleGenerator's VBO (three
+// floats per position). A compute shader (assets/particles.comp) moves,
+// ages and respawns the particles, and the same buffers are the vertex
+// buffers for point-sprites.vert, so no particle data is copied to the GPU
+// per frame.
+//
+// There is no compaction: the pool has maxParticles slots, dead slots have
+// a negative lifetime and are skipped when drawing. Each update respawns
+// the particles that are due (at spawnRate per second) in dead slots. The
+// random numbers of a respawned particle are hashed from the seed, the
+// update and the slot. Which dead slots get respawned depends on the order
+// in which the GPU runs the invocations.
+class GpuParticleGenerator
+{
+public:
+	// As ParticleGenerator. The first constructor seeds the random numbers
+	// from the clock.
+	GpuParticleGenerator(int maxParticles, float spawnRate, Vec3f initialPosition);
+	GpuParticleGenerator(int maxParticles, float spawnRate, Vec3f initialPosition, std::uint64_t seed);
+
+	// Creates the buffers (requires an OpenGL context). computeProgram is
+	// the program built from particles.comp; it must outlive the generator.
+	void createBuffers(ShaderProgram const& computeProgram);
+	void resetParticles();
+
+	// Runs the compute shader. Leaves no program bound.
+	void update(float deltaTime, Vec3f updatedShipPos);
+
+	// Draws all slots as GL_POINTS (dead ones are culled by the vertex
+	// shader). The caller sets up the program (point-sprites.vert) and
+	// textures.
+	void draw();
+
+	int maxParticles{};
+	float spawnRate{};
+	Vec3f conePosition;
+	Vec3f coneDirection;
+	GLuint vao = 0;
+
+	GLuint positionBuffer = 0;
+	GLuint velocityBuffer = 0;
+	GLuint lifeTimeBuffer = 0;
+
+private:
+	ShaderProgram const* computeProgram = nullptr;
+	GLuint counterBuffer = 0;
+
+	std::uint64_t seed;
+	std::uint64_t updateCount = 0;
+
+	// Fraction of a particle that was due but not yet spawned
+	float spawnRemainder = 0.f;
+};
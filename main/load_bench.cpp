@@ -0,0 +1,60 @@
+#include "load_bench.hpp"
+
+#include <limits>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+#include <cstdio>
+
+#include "defaults.hpp"
+#include "loadobj.hpp"
+
+#include "../support/thread_pool.hpp"
+
+namespace
+{
+	constexpr int kRepeats_ = 5;
+
+	double measure_(char const* aObjPath, ThreadPool& aPool)
+	{
+		double ret = std::numeric_limits<double>::infinity();
+		for (int i = 0; i < kRepeats_; ++i)
+		{
+			auto const start = Clock::now();
+			SimpleMeshData const mesh = loadWavefrontOBJ(aObjPath, aPool);
+			auto const ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+			ret = std::min(ret, ms);
+		}
+		return ret;
+	}
+}
+
+void runLoadBenchmark(char const* aObjPath)
+{
+	std::size_t const triangles = loadWavefrontOBJ(aObjPath).positions.size() / 3;
+	std::printf("%s: %zu triangles\n", aObjPath, triangles);
+
+	std::size_t const hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+
+	std::vector<std::size_t> threadCounts;
+	for (std::size_t n = 1; n < hardwareThreads; n *= 2)
+	{
+		threadCounts.emplace_back(n);
+	}
+	threadCounts.emplace_back(hardwareThreads);
+
+	double single = 0.0;
+	for (std::size_t const threads : threadCounts)
+	{
+		ThreadPool pool(threads);
+		double const ms = measure_(aObjPath, pool);
+		if (1 == threads)
+		{
+			single = ms;
+		}
+
+		std::printf("  %3zu threads  %9.3f ms   speedup %5.2fx\n", threads, ms, single / ms);
+	}
+}
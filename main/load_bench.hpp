@@ -0,0 +1,14 @@
+// Benchmark for loadWavefrontOBJ()
+//
+// Started with
+//
+//	main --bench-load [path/to/mesh.obj]
+//
+// Loads the mesh (by default the terrain) with thread pools of 1, 2, 4, ...
+// threads, up to the number of hardware threads, and prints the load time
+// (best of several repetitions) and the speedup over a single thread to
+// stdout. The time includes parsing, which rapidobj spreads over its own
+// threads independently of the pool.
+#pragma once
+
+void runLoadBenchmark(char const* aObjPath);
@@ -1,11 +1,22 @@
 #include "loadobj.hpp"
 
+#include <algorithm>
+
 #include <rapidobj/rapidobj.hpp>
 
 #include "../support/error.hpp"
 
+namespace
+{
+	// Corners converted per parallel_for() chunk
+	constexpr std::size_t kCornersPerChunk_ = 3 * 4096;
+
+	// Color of faces without a material
+	constexpr Vec3f kDefaultColor_{ 1.f, 1.f, 1.f };
+}
+
 // Method for loading .obj files
-SimpleMeshData loadWavefrontOBJ(char const* path)
+SimpleMeshData loadWavefrontOBJ(char const* path, ThreadPool& aPool)
 {
 	// Parse obj file
 	auto result = rapidobj::ParseFile(path);
@@ -17,40 +28,80 @@ SimpleMeshData loadWavefrontOBJ(char const* path)
 	// Triangulate vertices
 	rapidobj::Triangulate(result);
 
-	SimpleMeshData mesh;
+	// First pass: where each shape's corners start in the output (prefix sum
+	// of the corner counts)
+	std::vector<std::size_t> shapeOffsets(result.shapes.size() + 1, 0);
+	for (std::size_t s = 0; s < result.shapes.size(); ++s)
+	{
+		shapeOffsets[s + 1] = shapeOffsets[s] + result.shapes[s].mesh.indices.size();
+	}
+
+	std::size_t const cornerCount = shapeOffsets.back();
 
-	for (auto const& shape : result.shapes)
+	// Colors per material, looked up once per face below
+	std::vector<Vec3f> materialColors;
+	materialColors.reserve(result.materials.size());
+	for (auto const& mat : result.materials)
 	{
-		for (std::size_t i = 0; i < shape.mesh.indices.size(); ++i)
+		materialColors.emplace_back(Vec3f{ mat.ambient[0], mat.ambient[1], mat.ambient[2] });
+	}
+
+	SimpleMeshData mesh;
+	mesh.positions.resize(cornerCount);
+	mesh.colors.resize(cornerCount);
+	mesh.normals.resize(cornerCount);
+	mesh.texcoords.resize(cornerCount);
+
+	// Second pass: fill the arrays. The chunks are whole triangles, and may
+	// span several shapes.
+	auto const& attribs = result.attributes;
+	aPool.parallel_for(cornerCount, kCornersPerChunk_, [&] (std::size_t aBegin, std::size_t aEnd) {
+		std::size_t s = std::upper_bound(shapeOffsets.begin(), shapeOffsets.end(), aBegin) - shapeOffsets.begin() - 1;
+
+		for (std::size_t out = aBegin; out < aEnd; ++s)
 		{
-			auto const& idx = shape.mesh.indices[i];
-
-			// Put all positions from obj file into our mesh
-			mesh.positions.emplace_back(Vec3f{
-				result.attributes.positions[idx.position_index * 3 + 0],
-				result.attributes.positions[idx.position_index * 3 + 1],
-				result.attributes.positions[idx.position_index * 3 + 2]
-			});
-
-			// Put colors from obj file into our mesh
-			auto const& mat = result.materials[shape.mesh.material_ids[i / 3]];
-
-			mesh.colors.emplace_back(Vec3f{ mat.ambient[0], mat.ambient[1], mat.ambient[2] });
-
-			// Put all normals from obj file into our mesh
-			mesh.normals.emplace_back(Vec3f{
-				result.attributes.normals[idx.normal_index * 3 + 0],
-				result.attributes.normals[idx.normal_index * 3 + 1],
-				result.attributes.normals[idx.normal_index * 3 + 2]
-			});
-
-			// Put all texture coordinates from obj file into mesh
-			mesh.texcoords.emplace_back(Vec2f{
-				result.attributes.texcoords[idx.texcoord_index * 2 + 0],
-				result.attributes.texcoords[idx.texcoord_index * 2 + 1]
-			});
+			auto const& shapeMesh = result.shapes[s].mesh;
+			std::size_t const base = shapeOffsets[s];
+			std::size_t const end = std::min(aEnd, shapeOffsets[s + 1]);
+
+			for (; out < end; out += 3)
+			{
+				std::size_t const i = out - base;
+
+				int const materialId = shapeMesh.material_ids[i / 3];
+				Vec3f const color = materialId >= 0 ? materialColors[materialId] : kDefaultColor_;
+
+				for (std::size_t c = 0; c < 3; ++c)
+				{
+					auto const& idx = shapeMesh.indices[i + c];
+
+					mesh.positions[out + c] = Vec3f{
+						attribs.positions[idx.position_index * 3 + 0],
+						attribs.positions[idx.position_index * 3 + 1],
+						attribs.positions[idx.position_index * 3 + 2]
+					};
+
+					mesh.colors[out + c] = color;
+
+					// Missing normals and texture coordinates become zero
+					mesh.normals[out + c] = idx.normal_index >= 0
+						? Vec3f{
+							attribs.normals[idx.normal_index * 3 + 0],
+							attribs.normals[idx.normal_index * 3 + 1],
+							attribs.normals[idx.normal_index * 3 + 2]
+						}
+						: Vec3f{ 0.f, 0.f, 0.f };
+
+					mesh.texcoords[out + c] = idx.texcoord_index >= 0
+						? Vec2f{
+							attribs.texcoords[idx.texcoord_index * 2 + 0],
+							attribs.texcoords[idx.texcoord_index * 2 + 1]
+						}
+						: Vec2f{ 0.f, 0.f };
+				}
+			}
 		}
-	}
+	});
 
 	return mesh;
 }
@@ -1,3 +1,9 @@
+#pragma once
+
 #include "simple_mesh.hpp"
 
-SimpleMeshData loadWavefrontOBJ(char const* path);
\ No newline at end of file
+#include "../support/thread_pool.hpp"
+
+// Loads and triangulates an .obj file. The conversion into SimpleMeshData
+// runs on aPool.
+SimpleMeshData loadWavefrontOBJ(char const* path, ThreadPool& aPool = default_thread_pool());
@@ -5,8 +5,13 @@
 #include <stdexcept>
 
 #include <cstdio>
+#include <cstdint>
 #include <cstdlib>
+#include <cmath>
+#include <cstring>
 #include <map>
+#include <vector>
+#include <algorithm>
 
 #include "../support/error.hpp"
 #include "../support/program.hpp"
@@ -17,6 +22,8 @@
 #include "../vmlib/vec4.hpp"
 #include "../vmlib/mat44.hpp"
 #include "../vmlib/mat33.hpp"
+#include "../vmlib/transform.hpp"
+#include "../vmlib/bounds.hpp"
 
 #ifdef _WIN32
 #	define WIN32_LEAN_AND_MEAN 1
@@ -38,6 +45,11 @@
 #include "texture.hpp"
 #include "vaos.hpp"
 #include "particles.hpp"
+#include "gpu_particles.hpp"
+#include "vertex_layout_bench.hpp"
+#include "load_bench.hpp"
+#include "particle_bench.hpp"
+#include "gpu_particle_check.hpp"
 
 namespace
 {
@@ -61,6 +73,12 @@ namespace
 	// PI constant
 	constexpr float PI = 3.1415926f;
 
+	// Max. screen-space error of the terrain LODs, in pixels
+	constexpr float kMaxLodPixelError = 1.f;
+
+	// Max. bytes of asset data uploaded per frame while loading
+	constexpr std::size_t kAssetUploadBytesPerFrame = 8 << 20;
+
 	enum CameraState
 	{
 		FREE_CAM,
@@ -85,14 +103,19 @@ namespace
 		ShaderProgram* mainProgram;
 		ShaderProgram* blinnPhongProgram;
 		ShaderProgram* particlesProgram;
+		ShaderProgram* particlesComputeProgram;
 		ShaderProgram* rectProgram;
 		ShaderProgram* textProgram;
 
 		GLuint terrainTextureID;
 		GLuint particleTextureID;
 
-		// Particle generator initialising
-		ParticleGenerator generator{ 500, Vec3f{ 5.f, -5.1f, -20.f } };
+		// Particle generator initialising. Particles live for one second on
+		// average, so about 450 are alive at a time.
+		ParticleGenerator generator{ 500, 450.f, Vec3f{ 5.f, -5.1f, -20.f } };
+		// Same particles, simulated by a compute shader (G toggles)
+		GpuParticleGenerator gpuGenerator{ 500, 450.f, Vec3f{ 5.f, -5.1f, -20.f } };
+		bool gpuParticles;
 
 		// Whether or not the flying animation is active or not
 		bool animationActive;
@@ -109,6 +132,13 @@ namespace
 		Vec4f buttonOneColor;
 		Vec4f buttonTwoColor;
 
+		// Terrain tiles and triangles drawn this frame, over all viewports
+		std::size_t terrainTilesDrawn;
+		std::size_t terrainTrianglesDrawn;
+
+		// Visibility of the terrain tiles (scratch space for renderScene())
+		std::vector<std::uint64_t> tileVisibility;
+
 		struct Camera
 		{
 			// Whether the camera is active or not
@@ -221,11 +251,46 @@ void renderScene(State_& state, float dt, float fbwidth, float fbheight, bool se
 	Mat44f projection = make_perspective_projection(60.0f * PI / 180.0f, (state.splitScreen ? fbwidth/2 : fbwidth) / fbheight, 0.1f, 200.0f);
 
 	// Normal matrix calculated from modelMatrix
-	Mat33f normalMatrix = mat44_to_mat33(transpose(invert(modelMatrix)));
+	Mat33f normalMatrix = normal_matrix(modelMatrix);
 
 	// All matrices combined
 	Mat44f mvpMatrix = projection * viewMatrix * modelMatrix;
 
+	// Model matrices of the launchpads
+	Mat44f const launchpadOneModel = make_translation(Vec3f{ 5.f, -0.97f, -20.f }) * make_scaling(3.f, 3.f, 3.f);
+	Mat44f const launchpadTwoModel = make_translation(Vec3f{ 40.f, -0.97f, 30.f }) * make_scaling(3.f, 3.f, 3.f);
+
+	// Setup spaceship. The rocket's placement is built as a Transform and only
+	// converted to a matrix once.
+	Transform spaceshipTransform = make_transform(spaceshipPos);
+
+	// Check if the animation is active
+	if (state.animationActive)
+	{
+		// Calculate angles and speed change for rocket
+		state.animationActiveFor += dt;
+		state.rocketPosDelta += Vec3f{ dt * state.animationActiveFor * 0.05f, std::min(dt * state.animationActiveFor * 0.5f, 5.f), 0.f };
+
+		// Change position and rotation over time for a slight curved path
+		spaceshipTransform = spaceshipTransform * make_transform(state.rocketPosDelta, make_quat_rotation_z(-state.animationActiveFor * 0.5f * PI / 180.f));
+	}
+
+	Mat44f const spaceshipModel = transform_to_mat44(spaceshipTransform);
+
+	// Frustum culling: test the world-space bounds of all objects at once and
+	// skip the draw calls of those that are not visible in this viewport.
+	enum CullObject_ { kCullTerrain, kCullLaunchpadOne, kCullLaunchpadTwo, kCullSpaceship, kCullObjectCount };
+
+	Aabb3f const objectBounds[kCullObjectCount] = {
+		parlahtiBounds,
+		transform_aabb(launchpadOneModel, launchpadBounds),
+		transform_aabb(launchpadTwoModel, launchpadBounds),
+		transform_aabb(spaceshipModel, spaceshipBounds)
+	};
+
+	std::uint64_t visible[cull_word_count(kCullObjectCount)];
+	cull(make_frustum(projection * viewMatrix), objectBounds, kCullObjectCount, visible);
+
 	// Draw scene
 	OGL_CHECKPOINT_DEBUG();
 
@@ -239,25 +304,50 @@ void renderScene(State_& state, float dt, float fbwidth, float fbheight, bool se
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 	}
 
-	// Use main shader program and set uniforms
-	glUseProgram(state.mainProgram->programId());
+	if (0 != parlahtiVAO.vao && is_visible(visible, kCullTerrain))
+	{
+		// Use main shader program and set uniforms
+		glUseProgram(state.mainProgram->programId());
 
-	glUniformMatrix4fv(0, 1, GL_TRUE, mvpMatrix.v);
+		glUniformMatrix4fv(0, 1, GL_TRUE, mvpMatrix.v);
+		setVertexFormatUniforms(state.mainProgram->programId(), parlahtiVAO.format);
 
-	// Bind terrtain texture
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, state.terrainTextureID);
+		// Bind terrtain texture
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, state.terrainTextureID);
 
-	// Bind the vertex array that has the vertices we want to draw
-	glBindVertexArray(parlahtiVAO);
+		// Bind the vertex array that has the vertices we want to draw
+		glBindVertexArray(parlahtiVAO.vao);
 
-	// Draw said vertices
-	glDrawArrays(GL_TRIANGLES, 0, (GLsizei) parlahtiVertexCount);
+		// Draw the tiles that are visible in this viewport, each with the
+		// coarsest LOD whose error stays below a pixel at the tile's closest
+		// point. (The terrain's model matrix is the identity, so the tile
+		// bounds are in world space.)
+		std::size_t const tileCount = parlahtiTileBounds.size();
+		state.tileVisibility.resize(cull_word_count(tileCount));
+		cull(make_frustum(projection * viewMatrix), parlahtiTileBounds.data(), tileCount, state.tileVisibility.data());
 
-	// Reset stuff
-	glBindVertexArray(0);
-	glUseProgram(0);
-	glBindTexture(GL_TEXTURE_2D, 0);
+		float const pixelScale = fbheight / (2.f * std::tan(30.f * PI / 180.f));
+		for (std::size_t i = 0; i < tileCount; ++i)
+		{
+			if (!is_visible(state.tileVisibility.data(), i))
+			{
+				continue;
+			}
+
+			MeshTile const& tile = parlahtiVAO.tiles[i];
+			std::size_t const lod = tile.firstLod + selectLod(&parlahtiVAO.lods[tile.firstLod], tile.lodCount, distance(tile.bounds, cameraPos), pixelScale, kMaxLodPixelError);
+			drawLod(parlahtiVAO, lod);
+
+			++state.terrainTilesDrawn;
+			state.terrainTrianglesDrawn += parlahtiVAO.lods[lod].indexCount / 3;
+		}
+
+		// Reset stuff
+		glBindVertexArray(0);
+		glUseProgram(0);
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
 
 	// Use launchpad shader program and set uniforms
 	glUseProgram(state.blinnPhongProgram->programId());
@@ -270,50 +360,48 @@ void renderScene(State_& state, float dt, float fbwidth, float fbheight, bool se
 	glUniform3fv(8, 1, &cameraPos.x);
 
 	// Move first launchpad
-	modelMatrix = modelMatrix * make_translation(Vec3f{ 5.f, -0.97f, -20.f });
-	modelMatrix = modelMatrix * make_scaling(3.f, 3.f, 3.f);
+	modelMatrix = launchpadOneModel;
 	mvpMatrix = projection * viewMatrix * modelMatrix;
-	normalMatrix = mat44_to_mat33(transpose(invert(modelMatrix)));
+	normalMatrix = normal_matrix(modelMatrix);
 
 	glUniformMatrix4fv(0, 1, GL_TRUE, mvpMatrix.v);
 	glUniformMatrix3fv(1, 1, GL_TRUE, normalMatrix.v);
+	setVertexFormatUniforms(state.blinnPhongProgram->programId(), launchpadVAO.format);
 
-	glBindVertexArray(launchpadVAO);
-	glDrawArrays(GL_TRIANGLES, 0, (GLsizei) launchpadVertexCount);
+	glBindVertexArray(launchpadVAO.vao);
+	if (0 != launchpadVAO.vao && is_visible(visible, kCullLaunchpadOne))
+	{
+		glDrawElements(GL_TRIANGLES, launchpadVAO.indexCount, launchpadVAO.indexType, nullptr);
+	}
 
 	// Move second launchpad
-	modelMatrix = kIdentity44f * make_translation(Vec3f{ 40.f, -0.97f, 30.f });
-	modelMatrix = modelMatrix * make_scaling(3.f, 3.f, 3.f);
+	modelMatrix = launchpadTwoModel;
 	mvpMatrix = projection * viewMatrix * modelMatrix;
 
 	glUniformMatrix4fv(0, 1, GL_TRUE, mvpMatrix.v);
 
 	// Draw second launchpad
-	glDrawArrays(GL_TRIANGLES, 0, (GLsizei) launchpadVertexCount);
-
-	// Setup spaceship
-	modelMatrix = kIdentity44f * make_translation(spaceshipPos);
-
-	// Check if the animation is active
-	if (state.animationActive)
+	if (0 != launchpadVAO.vao && is_visible(visible, kCullLaunchpadTwo))
 	{
-		// Calculate angles and speed change for rocket
-		state.animationActiveFor += dt;
-		state.rocketPosDelta += Vec3f{ dt * state.animationActiveFor * 0.05f, min(dt * state.animationActiveFor * 0.5f, 5.f), 0.f };
-
-		// Change position and rotation over time for a slight curved path
-		modelMatrix = modelMatrix * make_translation(state.rocketPosDelta) * make_rotation_z(-state.animationActiveFor * 0.5f * PI / 180.f);
+		glDrawElements(GL_TRIANGLES, launchpadVAO.indexCount, launchpadVAO.indexType, nullptr);
 	}
 
+	modelMatrix = spaceshipModel;
 	mvpMatrix = projection * viewMatrix * modelMatrix;
-	normalMatrix = mat44_to_mat33(transpose(invert(modelMatrix)));
+	normalMatrix = normal_matrix(spaceshipTransform);
 
 	glUniformMatrix4fv(0, 1, GL_TRUE, mvpMatrix.v);
 	glUniformMatrix3fv(1, 1, GL_TRUE, normalMatrix.v);
 
+	// The spaceship is built in code and keeps float attributes
+	setVertexFormatUniforms(state.blinnPhongProgram->programId(), kFloatVertexFormat);
+
 	// Bind and draw spaceship VAO
 	glBindVertexArray(spaceshipVAO);
-	glDrawArrays(GL_TRIANGLES, 0, (GLsizei) spaceshipVertexCount);
+	if (is_visible(visible, kCullSpaceship))
+	{
+		glDrawArrays(GL_TRIANGLES, 0, (GLsizei) spaceshipVertexCount);
+	}
 
 	// Check if rocket is flying so we can render particles
 	if (state.animationActive)
@@ -334,11 +422,15 @@ void renderScene(State_& state, float dt, float fbwidth, float fbheight, bool se
 
 		// Enable GL_PROGRAM_POINT_SIZE so we can use gl_PointSize in the vertex shader
 		glEnable(GL_PROGRAM_POINT_SIZE);
-		glBindVertexArray(state.generator.vao);
-		// Make sure to draw with GL_POINTS
-		glDrawArrays(GL_POINTS, 0, (GLsizei) state.generator.particles.positions.size());
+		if (state.gpuParticles)
+		{
+			state.gpuGenerator.draw();
+		}
+		else
+		{
+			state.generator.draw();
+		}
 
-		glBindVertexArray(0);
 		glBindTexture(GL_TEXTURE_2D, 0);
 		glUseProgram(0);
 		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -350,8 +442,36 @@ void renderScene(State_& state, float dt, float fbwidth, float fbheight, bool se
 	OGL_CHECKPOINT_DEBUG();
 }
 
-int main() try
+int main( int aArgc, char* aArgv[] ) try
 {
+	auto const programStart = Clock::now();
+
+	// Benchmark modes. Loading and particles are measured right away (need
+	// no window).
+	char const* vertexLayoutBenchPath = nullptr;
+	bool gpuParticleCheck = false;
+	bool gpuParticles = false;
+	for( int i = 1; i < aArgc; ++i )
+	{
+		char const* const path = i+1 < aArgc ? aArgv[i+1] : "assets/parlahti.obj";
+		if( 0 == std::strcmp( aArgv[i], "--bench-load" ) )
+		{
+			runLoadBenchmark( path );
+			return 0;
+		}
+		if( 0 == std::strcmp( aArgv[i], "--bench-particles" ) )
+		{
+			runParticleBenchmark( i+1 < aArgc ? std::strtoul( aArgv[i+1], nullptr, 10 ) : 1000000 );
+			return 0;
+		}
+		if( 0 == std::strcmp( aArgv[i], "--bench-vertex-layout" ) )
+			vertexLayoutBenchPath = path;
+		if( 0 == std::strcmp( aArgv[i], "--check-gpu-particles" ) )
+			gpuParticleCheck = true;
+		if( 0 == std::strcmp( aArgv[i], "--gpu-particles" ) )
+			gpuParticles = true;
+	}
+
 	// Initialize GLFW
 	if( GLFW_TRUE != glfwInit() )
 	{
@@ -378,6 +498,10 @@ int main() try
 
 	glfwWindowHint( GLFW_DEPTH_BITS, 24 );
 
+	// The particle check draws offscreen only
+	if( gpuParticleCheck )
+		glfwWindowHint( GLFW_VISIBLE, GLFW_FALSE );
+
 #	if !defined(NDEBUG)
 	// When building in debug mode, request an OpenGL debug context. This
 	// enables additional debugging features. However, this can carry extra
@@ -455,9 +579,33 @@ int main() try
 
 	// Other initialization & loading
 	OGL_CHECKPOINT_ALWAYS();
+
+	// Start loading the assets first, so that the worker threads parse and
+	// decode them while the shaders compile. They are uploaded by the main
+	// loop, and drawn once they are ready; the textures have placeholders
+	// until then.
+	AssetLoader loader( kAssetUploadBytesPerFrame );
+
+	state.terrainTextureID = createSolidTexture2D( 128, 128, 128 );
+	state.particleTextureID = createSolidTexture2D( 255, 255, 255 );
+
+	if( !vertexLayoutBenchPath )
+	{
+		makeVAOs( loader );
+
+		loader.requestTexture( "assets/L4343A-4k.jpeg", [&state] (GLuint aTexture) {
+			glDeleteTextures( 1, &state.terrainTextureID );
+			state.terrainTextureID = aTexture;
+		} );
+		loader.requestTexture( "assets/white.png", [&state] (GLuint aTexture) {
+			glDeleteTextures( 1, &state.particleTextureID );
+			state.particleTextureID = aTexture;
+		} );
+	}
 	
 	// Further setup
 	state.splitScreen = false;
+	state.gpuParticles = gpuParticles;
 
 	// Setup shaders
 	ShaderProgram mainProgram({
@@ -475,6 +623,10 @@ int main() try
 		{ GL_FRAGMENT_SHADER, "assets/point-sprites.frag" }
 	});
 
+	ShaderProgram particlesCompute({
+		{ GL_COMPUTE_SHADER, "assets/particles.comp" }
+	});
+
 	ShaderProgram rectProgram({
 		{ GL_VERTEX_SHADER, "assets/rect.vert" },
 		{ GL_FRAGMENT_SHADER, "assets/rect.frag" }
@@ -488,9 +640,21 @@ int main() try
 	state.mainProgram = &mainProgram;
 	state.blinnPhongProgram = &blinnPhongLighting;
 	state.particlesProgram = &pointSprites;
+	state.particlesComputeProgram = &particlesCompute;
 	state.rectProgram = &rectProgram;
 	state.textProgram = &textProgram;
 
+	// Benchmark mode: measure the vertex buffer layouts and exit
+	if( vertexLayoutBenchPath )
+	{
+		runVertexLayoutBenchmark( vertexLayoutBenchPath, mainProgram.programId() );
+		return 0;
+	}
+
+	// Check mode: validate the GPU particle simulation and exit
+	if( gpuParticleCheck )
+		return runGpuParticleCheck( particlesCompute, pointSprites.programId() ) ? 0 : 1;
+
 	// Setup camera values
 	
 	// Start with free cam state
@@ -513,19 +677,13 @@ int main() try
 
 	auto last = Clock::now();
 
-	// Make the VAOs after all the OpenGL stuff is set up
-	makeVAOs();
 	GLuint rectangle = makeRectangle();
 	GLuint rectangleLines = makeLines();
 	Vec4f black = { 0.f, 0.f, 0.f, 1.0f };
 
-	// Load terrain texture
-	state.terrainTextureID = loadTexture2D("assets/L4343A-4k.jpeg");
-	// Load particle texture
-	state.particleTextureID = loadTexture2D("assets/white.png");
-
 	// Setup ParticleGenerator
 	state.generator.createVAO();
+	state.gpuGenerator.createBuffers(particlesCompute);
 
 	// Setup fontstash
 	state.fs = glfonsCreate(512, 512, FONS_ZERO_TOPLEFT);
@@ -541,11 +699,20 @@ int main() try
 
 	OGL_CHECKPOINT_ALWAYS();
 
+	// Loading statistics: time to the first frame, and the longest frame
+	// until all assets are loaded
+	bool firstFrame = true;
+	bool loading = true;
+	float longestLoadingFrame = 0.f;
+
 	// Main loop
 	while( !glfwWindowShouldClose( window ) )
 	{
 		// Let GLFW process events
 		glfwPollEvents();
+
+		// Upload (a part of) the assets that are ready
+		loader.update();
 		
 		///////////
 		// SCENE //
@@ -588,9 +755,22 @@ int main() try
 		state.deltaTime = dt;
 		last = now;
 
-		if (state.animationActive) state.generator.update(dt, spaceshipPos + Vec3f{ -5.f, -9.2f, 20.f });
+		if (state.animationActive)
+		{
+			Vec3f const exhaustPos = spaceshipPos + Vec3f{ -5.f, -9.2f, 20.f };
+			if (state.gpuParticles)
+			{
+				state.gpuGenerator.update(dt, exhaustPos);
+			}
+			else
+			{
+				state.generator.update(dt, exhaustPos);
+			}
+		}
 
 		// Render scene
+		state.terrainTilesDrawn = 0;
+		state.terrainTrianglesDrawn = 0;
 		renderScene(state, dt, fbwidth, fbheight, false);
 
 		// Render a 2nd screen if split screen is enabled
@@ -723,6 +903,31 @@ int main() try
 		dx += fonsDrawText(state.fs, dx, dy, "Altitude: ", NULL);
 		fonsDrawText(state.fs, dx, dy, altitude, NULL);
 
+		// Draw terrain statistics below it
+		fonsSetSize(state.fs, 20.f);
+		char terrainStats[96];
+		std::snprintf(terrainStats, sizeof(terrainStats), "Terrain: %zu/%zu tiles, %zu triangles", state.terrainTilesDrawn, parlahtiVAO.tiles.size() * (state.splitScreen ? 2 : 1), state.terrainTrianglesDrawn);
+		fonsDrawText(state.fs, 0.f, dy + lineHeight, terrainStats, NULL);
+
+		// The GPU simulation's particle count stays on the GPU
+		char particleStats[96];
+		if (state.gpuParticles)
+		{
+			std::snprintf(particleStats, sizeof(particleStats), "Particles: GPU simulation, %d slots", state.gpuGenerator.maxParticles);
+		}
+		else
+		{
+			std::snprintf(particleStats, sizeof(particleStats), "Particles: %zu/%d, %zu upload stalls", state.generator.particles.aliveCount(), state.generator.maxParticles, state.generator.fenceStallCount());
+		}
+		fonsDrawText(state.fs, 0.f, dy + 2.f * lineHeight, particleStats, NULL);
+
+		if (0 != loader.pendingCount())
+		{
+			char loadingStatus[96];
+			std::snprintf(loadingStatus, sizeof(loadingStatus), "Loading %zu assets (%.1f/%.1f MB uploaded)", loader.pendingCount(), loader.uploadedBytes() / 1e6, loader.readyBytes() / 1e6);
+			fonsDrawText(state.fs, 0.f, dy + 3.f * lineHeight, loadingStatus, NULL);
+		}
+
 		// Draw button text
 		fonsSetSize(state.fs, 24.f);
 		fonsSetAlign(state.fs, FONS_ALIGN_CENTER);
@@ -739,6 +944,22 @@ int main() try
 		// Display results
 		glfwSwapBuffers( window );
 
+		if (firstFrame)
+		{
+			std::printf("First frame after %.1f ms\n", std::chrono::duration<double, std::milli>(Clock::now() - programStart).count());
+			firstFrame = false;
+		}
+		else if (loading)
+		{
+			longestLoadingFrame = std::max(longestLoadingFrame, dt);
+		}
+
+		if (loading && 0 == loader.pendingCount())
+		{
+			std::printf("Assets loaded after %.1f ms, longest frame while loading %.1f ms\n", std::chrono::duration<double, std::milli>(Clock::now() - programStart).count(), longestLoadingFrame * 1e3f);
+			loading = false;
+		}
+
 		processMovement(state);
 	}
 
@@ -814,6 +1035,18 @@ namespace
 						std::fprintf(stderr, "Keeping old shader.\n");
 					}
 
+					try
+					{
+						state->particlesComputeProgram->reload();
+						std::fprintf(stderr, "Shaders reloaded and recompiled.\n");
+					}
+					catch (std::exception const& eErr)
+					{
+						std::fprintf(stderr, "Error when reloading shader:\n");
+						std::fprintf(stderr, "%s\n", eErr.what());
+						std::fprintf(stderr, "Keeping old shader.\n");
+					}
+
 					try
 					{
 						state->textProgram->reload();
@@ -840,6 +1073,7 @@ namespace
 				}
 
 				state->generator.resetParticles();
+				state->gpuGenerator.resetParticles();
 			}
 
 			// Enable / disable camera
@@ -934,6 +1168,14 @@ namespace
 				}
 			}
 
+			// Toggle between simulating the particles on the CPU and on the GPU
+			if (GLFW_KEY_G == aKey && GLFW_PRESS == aAction)
+			{
+				state->gpuParticles = !state->gpuParticles;
+				state->generator.resetParticles();
+				state->gpuGenerator.resetParticles();
+			}
+
 			// Toggle split screen
 			if (GLFW_KEY_V == aKey && GLFW_PRESS == aAction)
 			{
@@ -0,0 +1,61 @@
+#include "mesh_builder.hpp"
+
+MeshBuilder::MeshBuilder(std::size_t reserveVertices, std::size_t reserveParts)
+{
+	reserve(reserveVertices);
+	parts.reserve(reserveParts);
+}
+
+void MeshBuilder::reserve(std::size_t vertexCount)
+{
+	mesh.positions.reserve(vertexCount);
+	mesh.colors.reserve(vertexCount);
+	mesh.normals.reserve(vertexCount);
+}
+
+void MeshBuilder::beginPart(char const* name)
+{
+	endPart();
+
+	parts.push_back(MeshPart{ name, mesh.positions.size(), 0 });
+	partOpen = true;
+}
+
+std::size_t MeshBuilder::appendVertices(std::size_t count)
+{
+	if (!partOpen)
+	{
+		beginPart("");
+	}
+
+	std::size_t const first = mesh.positions.size();
+	mesh.positions.resize(first + count);
+	mesh.colors.resize(first + count);
+	mesh.normals.resize(first + count);
+
+	return first;
+}
+
+TexturelessSimpleMeshData MeshBuilder::release(std::vector<MeshPart>* partsOut)
+{
+	endPart();
+
+	if (partsOut)
+	{
+		*partsOut = std::move(parts);
+	}
+	parts.clear();
+
+	TexturelessSimpleMeshData ret = std::move(mesh);
+	mesh = TexturelessSimpleMeshData{};
+	return ret;
+}
+
+void MeshBuilder::endPart()
+{
+	if (partOpen)
+	{
+		parts.back().vertexCount = mesh.positions.size() - parts.back().firstVertex;
+		partOpen = false;
+	}
+}
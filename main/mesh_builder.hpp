@@ -0,0 +1,61 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+#include "simple_mesh.hpp"
+
+// Range of vertices that belongs to one part of a mesh built with
+// MeshBuilder, e.g., to draw, cull or animate the part on its own.
+struct MeshPart
+{
+	char const* name;
+	std::size_t firstVertex;
+	std::size_t vertexCount;
+};
+
+// Builds a TexturelessSimpleMeshData out of several parts, each made of
+// one or more shapes (see the append functions in shapes.hpp). The shapes
+// write their vertices directly into the builder's arrays, so with enough
+// space reserved up front the whole mesh is built without reallocating or
+// copying.
+//
+//	MeshBuilder builder(cylinderVertexCount(32) + coneVertexCount(32));
+//	builder.beginPart("booster");
+//	appendCylinder(builder, 32, ...);
+//	appendCone(builder, 32, ...);
+//	TexturelessSimpleMeshData mesh = builder.release(&parts);
+class MeshBuilder
+{
+public:
+	explicit MeshBuilder(std::size_t reserveVertices = 0, std::size_t reserveParts = 0);
+
+	void reserve(std::size_t vertexCount);
+
+	// Ends the current part (if any) and starts a new one. Vertices that are
+	// appended before the first call form an unnamed part.
+	void beginPart(char const* name);
+
+	// Adds count vertices to the current part and returns the index of the
+	// first one. The new vertices are zero; fill them in through
+	// positions(), colors() and normals(). The pointers from these are
+	// invalidated by the next appendVertices() if it has to grow the arrays.
+	std::size_t appendVertices(std::size_t count);
+
+	Vec3f* positions() { return mesh.positions.data(); }
+	Vec3f* colors() { return mesh.colors.data(); }
+	Vec3f* normals() { return mesh.normals.data(); }
+
+	std::size_t vertexCount() const { return mesh.positions.size(); }
+
+	// Ends the current part and moves the mesh (and optionally the parts, in
+	// the order they were begun) out. The builder is empty afterwards.
+	TexturelessSimpleMeshData release(std::vector<MeshPart>* partsOut = nullptr);
+
+private:
+	void endPart();
+
+	TexturelessSimpleMeshData mesh;
+	std::vector<MeshPart> parts;
+	bool partOpen = false;
+};
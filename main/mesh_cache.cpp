@@ -0,0 +1,375 @@
+#include "mesh_cache.hpp"
+
+#include <string>
+#include <vector>
+#include <type_traits>
+
+#include <cstdio>
+#include <cstring>
+
+#include "../support/error.hpp"
+#include "../support/mapped_file.hpp"
+
+#include "defaults.hpp"
+#include "loadobj.hpp"
+
+namespace
+{
+	constexpr char kMagic_[8] = { 'S', 'D', 'M', 'E', 'S', 'H', '\r', '\n' };
+	constexpr std::uint32_t kEndianTag_ = 0x01020304u;
+	constexpr std::uint64_t kAlignment_ = 16;
+
+	static_assert(std::is_trivially_copyable_v<MeshCacheHeader>);
+	static_assert(sizeof(MeshCacheHeader) == 160);
+	static_assert(std::is_trivially_copyable_v<MeshLod> && sizeof(MeshLod) == 12);
+	static_assert(std::is_trivially_copyable_v<MeshTile> && sizeof(MeshTile) == 32);
+
+	constexpr std::uint64_t alignUp_(std::uint64_t aOffset)
+	{
+		return (aOffset + kAlignment_ - 1) & ~(kAlignment_ - 1);
+	}
+
+	// Fills in the counts and the offsets of a header
+	void computeLayout_(MeshCacheHeader& aHeader, std::uint64_t aVertexCount, std::uint64_t aIndexCount, std::uint32_t aIndexSize, std::uint64_t aLodCount, std::uint64_t aTileCount)
+	{
+		aHeader.vertexCount = std::uint32_t(aVertexCount);
+		aHeader.indexCount = std::uint32_t(aIndexCount);
+		aHeader.indexSize = aIndexSize;
+		aHeader.vertexSize = sizeof(QuantizedVertex);
+		aHeader.lodCount = std::uint32_t(aLodCount);
+		aHeader.tileCount = std::uint32_t(aTileCount);
+
+		aHeader.verticesOffset = alignUp_(sizeof(MeshCacheHeader));
+		aHeader.indicesOffset = alignUp_(aHeader.verticesOffset + aVertexCount * sizeof(QuantizedVertex));
+		aHeader.lodsOffset = alignUp_(aHeader.indicesOffset + aIndexCount * aIndexSize);
+		aHeader.tilesOffset = alignUp_(aHeader.lodsOffset + aLodCount * sizeof(MeshLod));
+		aHeader.fileSize = aHeader.tilesOffset + aTileCount * sizeof(MeshTile);
+	}
+
+	std::vector<MeshLod> readLods_(MappedFile const& aCache, MeshCacheHeader const& aHeader)
+	{
+		std::vector<MeshLod> lods(aHeader.lodCount);
+		std::memcpy(lods.data(), static_cast<unsigned char const*>(aCache.data()) + aHeader.lodsOffset, lods.size() * sizeof(MeshLod));
+		return lods;
+	}
+
+	std::vector<MeshTile> readTiles_(MappedFile const& aCache, MeshCacheHeader const& aHeader)
+	{
+		std::vector<MeshTile> tiles(aHeader.tileCount);
+		std::memcpy(tiles.data(), static_cast<unsigned char const*>(aCache.data()) + aHeader.tilesOffset, tiles.size() * sizeof(MeshTile));
+		return tiles;
+	}
+
+	bool sameOptions_(MeshLoadOptions const& aLeft, MeshLoadOptions const& aRight)
+	{
+		return aLeft.tilesX == aRight.tilesX && aLeft.tilesZ == aRight.tilesZ && aLeft.maxLods == aRight.maxLods;
+	}
+
+	// Writes aSize bytes at aOffset, padding with zeros from the current
+	// position
+	void writeAt_(std::FILE* aFile, std::uint64_t& aPosition, std::uint64_t aOffset, void const* aData, std::size_t aSize, char const* aPath)
+	{
+		static constexpr char kZeros[kAlignment_] = {};
+		if (aOffset - aPosition > 0 && 1 != std::fwrite(kZeros, std::size_t(aOffset - aPosition), 1, aFile))
+		{
+			throw Error("Unable to write mesh cache '%s'", aPath);
+		}
+
+		if (aSize > 0 && 1 != std::fwrite(aData, aSize, 1, aFile))
+		{
+			throw Error("Unable to write mesh cache '%s'", aPath);
+		}
+
+		aPosition = aOffset + aSize;
+	}
+
+	double millisecondsSince_(Clock::time_point aStart)
+	{
+		return std::chrono::duration<double, std::milli>(Clock::now() - aStart).count();
+	}
+
+	// Reads one byte per page, which makes the OS load the whole mapping
+	void touchPages_(unsigned char const* aData, std::size_t aSize)
+	{
+		constexpr std::size_t kPageSize = 4096;
+
+		unsigned char sum = 0;
+		for (std::size_t i = 0; i < aSize; i += kPageSize)
+		{
+			sum ^= static_cast<unsigned char const volatile*>(aData)[i];
+		}
+		(void)sum;
+	}
+
+}
+
+std::uint64_t meshSourceChecksum(void const* aData, std::size_t aSize)
+{
+	// FNV-1a style mixing of 64-bit words in four independent lanes, so that
+	// the multiplications overlap; the rotation lets the high bits of each
+	// word influence the low bits of the result. Runs at memory speed, which
+	// is much faster than parsing the file.
+	constexpr std::uint64_t kPrime = 0x100000001b3ull;
+
+	auto const rotl = [] (std::uint64_t aX, int aK) {
+		return (aX << aK) | (aX >> (64 - aK));
+	};
+
+	unsigned char const* bytes = static_cast<unsigned char const*>(aData);
+
+	std::uint64_t h[4] = {
+		0xcbf29ce484222325ull, 0x84222325cbf29ce4ull,
+		0x9e3779b97f4a7c15ull, 0xc2b2ae3d27d4eb4full
+	};
+
+	std::size_t i = 0;
+	for (; i + 32 <= aSize; i += 32)
+	{
+		for (std::size_t lane = 0; lane < 4; ++lane)
+		{
+			std::uint64_t word;
+			std::memcpy(&word, bytes + i + 8*lane, sizeof(word));
+			h[lane] = rotl((h[lane] ^ word) * kPrime, 29);
+		}
+	}
+
+	for (; i < aSize; ++i)
+	{
+		h[0] = (h[0] ^ bytes[i]) * kPrime;
+	}
+
+	// Combine the lanes and the size, then avalanche (from MurmurHash3)
+	std::uint64_t ret = aSize;
+	for (std::uint64_t lane : h)
+	{
+		ret = rotl((ret ^ lane) * kPrime, 29);
+	}
+
+	ret ^= ret >> 33;
+	ret *= 0xff51afd7ed558ccdull;
+	ret ^= ret >> 33;
+	ret *= 0xc4ceb9fe1a85ec53ull;
+	ret ^= ret >> 33;
+	return ret;
+}
+
+void writeMeshCache(char const* path, QuantizedMeshData const& aMesh, Aabb3f const& aBounds, MeshLoadOptions const& aOptions, std::uint64_t aSourceSize, std::uint64_t aSourceChecksum)
+{
+	std::size_t const vertexCount = aMesh.vertices.size();
+	std::uint32_t const indexSize = vertexCount <= 65536 ? 2 : 4;
+
+	MeshCacheHeader header{};
+	std::memcpy(header.magic, kMagic_, sizeof(kMagic_));
+	header.version = kMeshCacheVersion;
+	header.endianTag = kEndianTag_;
+	header.sourceSize = aSourceSize;
+	header.sourceChecksum = aSourceChecksum;
+	header.bounds = aBounds;
+	header.positions = aMesh.format.positions;
+	header.octahedralNormals = aMesh.format.octahedralNormals ? 1 : 0;
+	header.options = aOptions;
+	computeLayout_(header, vertexCount, aMesh.indices.size(), indexSize, aMesh.lods.size(), aMesh.tiles.size());
+
+	// Indices are stored in the format that is uploaded to the GPU
+	std::vector<std::uint16_t> indices16;
+	void const* indexData = aMesh.indices.data();
+	if (2 == indexSize)
+	{
+		indices16.assign(aMesh.indices.begin(), aMesh.indices.end());
+		indexData = indices16.data();
+	}
+
+	std::string const tempPath = std::string(path) + ".tmp";
+	std::FILE* file = std::fopen(tempPath.c_str(), "wb");
+	if (!file)
+	{
+		throw Error("Unable to open '%s' for writing", tempPath.c_str());
+	}
+
+	try
+	{
+		std::uint64_t position = 0;
+		writeAt_(file, position, 0, &header, sizeof(header), path);
+		writeAt_(file, position, header.verticesOffset, aMesh.vertices.data(), vertexCount * sizeof(QuantizedVertex), path);
+		writeAt_(file, position, header.indicesOffset, indexData, aMesh.indices.size() * indexSize, path);
+		writeAt_(file, position, header.lodsOffset, aMesh.lods.data(), aMesh.lods.size() * sizeof(MeshLod), path);
+		writeAt_(file, position, header.tilesOffset, aMesh.tiles.data(), aMesh.tiles.size() * sizeof(MeshTile), path);
+	}
+	catch (...)
+	{
+		std::fclose(file);
+		std::remove(tempPath.c_str());
+		throw;
+	}
+
+	if (0 != std::fclose(file))
+	{
+		std::remove(tempPath.c_str());
+		throw Error("Unable to write mesh cache '%s'", path);
+	}
+
+	// std::rename() does not replace existing files on all platforms
+	std::remove(path);
+	if (0 != std::rename(tempPath.c_str(), path))
+	{
+		std::remove(tempPath.c_str());
+		throw Error("Unable to rename '%s' to '%s'", tempPath.c_str(), path);
+	}
+}
+
+bool validateMeshCache(MappedFile const& aCache, MeshLoadOptions const& aOptions, std::uint64_t aSourceSize, std::uint64_t aSourceChecksum, MeshCacheHeader& aHeader)
+{
+	if (aCache.size() < sizeof(MeshCacheHeader))
+	{
+		return false;
+	}
+
+	std::memcpy(&aHeader, aCache.data(), sizeof(MeshCacheHeader));
+
+	if (0 != std::memcmp(aHeader.magic, kMagic_, sizeof(kMagic_)) ||
+		kMeshCacheVersion != aHeader.version ||
+		kEndianTag_ != aHeader.endianTag ||
+		aCache.size() != aHeader.fileSize)
+	{
+		return false;
+	}
+
+	if (aSourceSize != aHeader.sourceSize || aSourceChecksum != aHeader.sourceChecksum || !sameOptions_(aOptions, aHeader.options))
+	{
+		return false;
+	}
+
+	// The layout is fully determined by the counts; recomputing it rejects
+	// any inconsistent offsets.
+	if ((2 != aHeader.indexSize && 4 != aHeader.indexSize) || aHeader.octahedralNormals > 1 || 0 == aHeader.lodCount || 0 == aHeader.tileCount)
+	{
+		return false;
+	}
+
+	MeshCacheHeader expected = aHeader;
+	computeLayout_(expected, aHeader.vertexCount, aHeader.indexCount, aHeader.indexSize, aHeader.lodCount, aHeader.tileCount);
+
+	if (0 != std::memcmp(&expected, &aHeader, sizeof(MeshCacheHeader)))
+	{
+		return false;
+	}
+
+	// The LODs must lie within the index buffer, and the tiles' LODs within
+	// the LOD table
+	for (MeshLod const& lod : readLods_(aCache, aHeader))
+	{
+		if (lod.firstIndex > aHeader.indexCount || lod.indexCount > aHeader.indexCount - lod.firstIndex || !(lod.error >= 0.f))
+		{
+			return false;
+		}
+	}
+
+	for (MeshTile const& tile : readTiles_(aCache, aHeader))
+	{
+		if (0 == tile.lodCount || tile.firstLod > aHeader.lodCount || tile.lodCount > aHeader.lodCount - tile.firstLod)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+PreparedMesh prepareCachedWavefrontOBJ(char const* path, MeshLoadOptions const& aOptions)
+{
+	auto const start = Clock::now();
+
+	std::uint64_t sourceSize = 0, sourceChecksum = 0;
+	{
+		MappedFile const source(path);
+		sourceSize = source.size();
+		sourceChecksum = meshSourceChecksum(source.data(), source.size());
+	}
+
+	std::string const cachePath = std::string(path) + ".meshcache";
+
+	// A missing or unreadable cache is simply a cache miss
+	PreparedMesh ret{};
+	MeshCacheHeader header;
+	bool valid = false;
+	try
+	{
+		ret.cache = MappedFile(cachePath.c_str());
+		valid = validateMeshCache(ret.cache, aOptions, sourceSize, sourceChecksum, header);
+	}
+	catch (Error const&)
+	{
+		valid = false;
+	}
+
+	if (valid)
+	{
+		unsigned char const* base = static_cast<unsigned char const*>(ret.cache.data());
+		touchPages_(base, ret.cache.size());
+
+		// The vertices start at a 16-byte aligned offset into a page-aligned
+		// mapping, so they can be used in place.
+		ret.vertices = reinterpret_cast<QuantizedVertex const*>(base + header.verticesOffset);
+		ret.vertexCount = header.vertexCount;
+		ret.indices = base + header.indicesOffset;
+		ret.indexCount = header.indexCount;
+		ret.indexType = 2 == header.indexSize ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+		ret.format.positions = header.positions;
+		ret.format.octahedralNormals = 0 != header.octahedralNormals;
+		ret.lods = readLods_(ret.cache, header);
+		ret.tiles = readTiles_(ret.cache, header);
+		ret.bounds = header.bounds;
+
+		std::printf("%s: loaded from '%s' in %.1f ms\n", path, cachePath.c_str(), millisecondsSince_(start));
+		return ret;
+	}
+
+	ret.cache = MappedFile();
+
+	SimpleMeshData mesh = loadWavefrontOBJ(path);
+	IndexedMeshData indexed = makeIndexed(mesh);
+	printIndexingStats(path, mesh, indexed);
+	if (aOptions.tilesX * aOptions.tilesZ > 1)
+	{
+		tileMesh(path, indexed, aOptions.tilesX, aOptions.tilesZ);
+	}
+	generateLods(path, indexed, aOptions.maxLods);
+	optimizeMesh(path, indexed);
+
+	ret.built = quantizeMesh(indexed);
+	std::printf("%s: quantized vertices, %zu -> %zu bytes per vertex\n", path, 3*sizeof(Vec3f) + sizeof(Vec2f), sizeof(QuantizedVertex));
+
+	ret.bounds = make_aabb(indexed.vertices.positions.data(), indexed.vertices.positions.size());
+
+	try
+	{
+		writeMeshCache(cachePath.c_str(), ret.built, ret.bounds, aOptions, sourceSize, sourceChecksum);
+	}
+	catch (Error const& eErr)
+	{
+		std::fprintf(stderr, "Warning: %s\n", eErr.what());
+	}
+
+	// Same index type as the cache (and createVAO(QuantizedMeshData const&))
+	QuantizedMeshData& built = ret.built;
+	ret.vertices = built.vertices.data();
+	ret.vertexCount = built.vertices.size();
+	ret.indexCount = built.indices.size();
+	if (ret.vertexCount <= 65536)
+	{
+		ret.builtIndices16.assign(built.indices.begin(), built.indices.end());
+		ret.indices = ret.builtIndices16.data();
+		ret.indexType = GL_UNSIGNED_SHORT;
+	}
+	else
+	{
+		ret.indices = built.indices.data();
+		ret.indexType = GL_UNSIGNED_INT;
+	}
+	ret.format = built.format;
+	ret.lods = built.lods;
+	ret.tiles = built.tiles;
+
+	std::printf("%s: parsed in %.1f ms\n", path, millisecondsSince_(start));
+	return ret;
+}
@@ -0,0 +1,126 @@
+// Binary cache for meshes loaded from Wavefront OBJ files
+//
+// Parsing and triangulating the OBJ files dominates the start-up time, and
+// generating LODs takes even longer. The result of loadWavefrontOBJ() +
+// makeIndexed() + tileMesh() + generateLods() + optimizeMesh() +
+// quantizeMesh() is therefore stored in a binary file next to the OBJ
+// ("<path>.meshcache"). Later runs map the cache file into memory, and the
+// AssetLoader uploads the vertex and index buffers straight from the
+// mapping, without parsing.
+//
+// The cache records the size and a checksum of the OBJ file it was made
+// from, and is ignored (and rewritten) when either differs. Note that the
+// material library (.mtl) is not part of the checksum; delete the cache
+// after changing material colors.
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "simple_mesh.hpp"
+
+#include "../vmlib/bounds.hpp"
+
+#include "../support/mapped_file.hpp"
+
+// Cache file layout. All values are stored in the native byte order (the
+// endianTag catches a mismatch). The header is followed by the vertices
+// (vertexCount QuantizedVertex entries), the index buffer (indexCount
+// entries of indexSize bytes), the LOD table (lodCount MeshLod entries) and
+// the tile table (tileCount MeshTile entries); each starts at a 16-byte
+// aligned offset from the start of the file. tilesX, tilesZ and maxLods are
+// the options the mesh was built with.
+//
+// Bump kMeshCacheVersion whenever the layout changes, or when the OBJ loader,
+// makeIndexed(), tileMesh(), generateLods(), optimizeMesh() or quantizeMesh()
+// produce different data.
+constexpr std::uint32_t kMeshCacheVersion = 5;
+
+// How a mesh is prepared for rendering: split into tilesX x tilesZ tiles
+// (see tileMesh()), with up to maxLods levels of detail per tile (see
+// generateLods()). The defaults keep the mesh in one piece.
+struct MeshLoadOptions
+{
+	std::uint32_t tilesX = 1;
+	std::uint32_t tilesZ = 1;
+	std::uint32_t maxLods = 1;
+};
+
+struct MeshCacheHeader
+{
+	char magic[8];
+	std::uint32_t version;
+	std::uint32_t endianTag;
+	std::uint64_t fileSize;
+
+	std::uint64_t sourceSize;
+	std::uint64_t sourceChecksum;
+
+	std::uint32_t vertexCount;
+	std::uint32_t indexCount;
+	std::uint32_t indexSize; // 2 or 4 bytes
+	std::uint32_t vertexSize; // sizeof(QuantizedVertex)
+
+	Aabb3f bounds;
+	PositionQuantization positions;
+	std::uint32_t octahedralNormals;
+	std::uint32_t lodCount;
+	std::uint32_t tileCount;
+	MeshLoadOptions options;
+
+	std::uint64_t verticesOffset;
+	std::uint64_t indicesOffset;
+	std::uint64_t lodsOffset;
+	std::uint64_t tilesOffset;
+};
+
+// Checksum of the source file contents. Not cryptographic; it only has to
+// detect that the OBJ file was modified.
+std::uint64_t meshSourceChecksum(void const* data, std::size_t size);
+
+// Writes the cache file. The file is first written under a temporary name
+// and then renamed, so that an interrupted write never leaves a partial
+// cache behind. Throws Error on failure.
+void writeMeshCache(char const* path, QuantizedMeshData const&, Aabb3f const& bounds, MeshLoadOptions const&, std::uint64_t sourceSize, std::uint64_t sourceChecksum);
+
+// Checks that the mapped file is a complete cache of the current version
+// that was made from a source with the given size and checksum, with the
+// given options. Returns false otherwise; the header is only valid if true
+// was returned.
+bool validateMeshCache(MappedFile const&, MeshLoadOptions const&, std::uint64_t sourceSize, std::uint64_t sourceChecksum, MeshCacheHeader&);
+
+// Loads an OBJ file through its cache, without OpenGL: maps the cache if it
+// is valid, and otherwise parses the OBJ file and (re)writes the cache.
+// Failing to write the cache is not an error, the mesh is still returned.
+// Prints the time taken to stdout. May run on any thread; the AssetLoader
+// uploads the result.
+//
+// A PreparedMesh either keeps the cache file mapped (its pages are touched,
+// so that the upload does not wait for the disk), or holds the mesh that
+// was just built; vertices and indices point into one of them.
+struct PreparedMesh
+{
+	MappedFile cache;
+	QuantizedMeshData built;
+	std::vector<std::uint16_t> builtIndices16;
+
+	QuantizedVertex const* vertices;
+	std::size_t vertexCount;
+	void const* indices;
+	std::size_t indexCount;
+	GLenum indexType;
+
+	VertexFormat format;
+	std::vector<MeshLod> lods;
+	std::vector<MeshTile> tiles;
+	Aabb3f bounds;
+};
+
+PreparedMesh prepareCachedWavefrontOBJ(char const* path, MeshLoadOptions const& = MeshLoadOptions{});
+
+// Mesh handed over by the AssetLoader once it is uploaded
+struct LoadedMesh
+{
+	IndexedVAO vao;
+	Aabb3f bounds;
+};
@@ -0,0 +1,85 @@
+#include "particle_bench.hpp"
+
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+#include <cstdio>
+#include <cstring>
+
+#include "defaults.hpp"
+#include "particles.hpp"
+
+#include "../support/thread_pool.hpp"
+
+namespace
+{
+	constexpr float kDeltaTime_ = 1.f / 60.f;
+	constexpr int kWarmupFrames_ = 150; // particles live up to 2 s
+	constexpr int kFrames_ = 100;
+	constexpr std::uint64_t kSeed_ = 42;
+
+	bool sameParticles_(Particles const& aX, Particles const& aY)
+	{
+		std::size_t const n = aX.aliveCount();
+		if (n != aY.aliveCount())
+		{
+			return false;
+		}
+
+		auto const same = [n](float const* aA, float const* aB) {
+			return 0 == std::memcmp(aA, aB, n * sizeof(float));
+		};
+		return same(aX.positions.x(), aY.positions.x()) && same(aX.positions.y(), aY.positions.y()) && same(aX.positions.z(), aY.positions.z())
+			&& same(aX.velocities.x(), aY.velocities.x()) && same(aX.velocities.y(), aY.velocities.y()) && same(aX.velocities.z(), aY.velocities.z())
+			&& same(aX.lifeTimes.data(), aY.lifeTimes.data());
+	}
+}
+
+void runParticleBenchmark(std::size_t aParticleCount)
+{
+	// Particles live for one second on average; keep the pool ~90% full
+	int const maxParticles = int(aParticleCount);
+	float const spawnRate = 0.9f * float(aParticleCount);
+	Vec3f const emitter{ 0.f, 0.f, 0.f };
+
+	std::printf("%zu particles, %.0f spawned per second\n", aParticleCount, spawnRate);
+
+	std::size_t const hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+
+	std::vector<std::size_t> threadCounts;
+	for (std::size_t n = 1; n < hardwareThreads; n *= 2)
+	{
+		threadCounts.emplace_back(n);
+	}
+	threadCounts.emplace_back(hardwareThreads);
+
+	double single = 0.0;
+	Particles reference;
+	for (std::size_t const threads : threadCounts)
+	{
+		ThreadPool pool(threads);
+		ParticleGenerator generator(maxParticles, spawnRate, emitter, kSeed_, pool);
+
+		for (int i = 0; i < kWarmupFrames_; ++i)
+		{
+			generator.simulate(kDeltaTime_, emitter);
+		}
+
+		auto const start = Clock::now();
+		for (int i = 0; i < kFrames_; ++i)
+		{
+			generator.simulate(kDeltaTime_, emitter);
+		}
+		double const ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / kFrames_;
+
+		if (1 == threads)
+		{
+			single = ms;
+			reference = generator.particles;
+		}
+
+		bool const identical = sameParticles_(reference, generator.particles);
+		std::printf("  %3zu threads  %9.3f ms/update   speedup %5.2fx   %zu alive, %s\n", threads, ms, single / ms, generator.particles.aliveCount(), identical ? "identical" : "DIFFERENT from 1 thread");
+	}
+}
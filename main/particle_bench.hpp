@@ -0,0 +1,17 @@
+// Benchmark for ParticleGenerator::simulate()
+//
+// Started with
+//
+//	main --bench-particles [particle count]
+//
+// Simulates a pool of the given size (by default one million particles)
+// with thread pools of 1, 2, 4, ... threads, up to the number of hardware
+// threads, and prints the time per update (mean over a number of frames,
+// once the pool is full) and the speedup over a single thread to stdout. It
+// also checks that every thread count ends up with exactly the same
+// particles as the single-threaded run.
+#pragma once
+
+#include <cstddef>
+
+void runParticleBenchmark(std::size_t aParticleCount);
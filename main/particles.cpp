@@ -1,133 +1,393 @@
 #include "particles.hpp"
 
+#include <chrono>
+#include <utility>
+#include <algorithm>
+
+#include "defaults.hpp"
+
+#include "../vmlib/random.hpp"
+#include "../vmlib/fastmath.hpp"
+#include "../vmlib/particle_integrate.hpp"
+
 // PI constant
 constexpr float PI = 3.1415926f;
 
-ParticleGenerator::ParticleGenerator(int maxParticles, Vec3f initialPosition) : maxParticles(maxParticles), conePosition(initialPosition), coneDirection(Vec3f{0.f, -1.f, 0.f})
+namespace
+{
+	// SplitMix64 step, to derive the seeds of the random number streams
+	std::uint64_t mix_(std::uint64_t x)
+	{
+		x += 0x9e3779b97f4a7c15ull;
+		x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+		x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+		return x ^ (x >> 31);
+	}
+
+	// Streams for the particles appended at the end of the pool; those of
+	// the chunks are numbered from zero
+	constexpr std::uint64_t kAppendStreams_ = std::uint64_t(1) << 32;
+}
+
+void Particles::reserve(std::size_t count)
+{
+	this->positions.reserve(count);
+	this->velocities.reserve(count);
+	this->lifeTimes.reserve(count);
+}
+
+void Particles::resize(std::size_t count)
+{
+	this->positions.resize(count);
+	this->velocities.resize(count);
+	this->lifeTimes.resize(count);
+}
+
+// Remove the particle by moving the last one into its place
+void Particles::swapRemove(std::size_t index)
 {
-	// Initialise random number generator using uniform real distribution
-	unsigned seed = (unsigned int) std::chrono::system_clock::now().time_since_epoch().count();
-	std::default_random_engine gen(seed);
-	this->generator = gen;
+	std::size_t const last = this->aliveCount() - 1;
+
+	this->positions.set(index, this->positions.get(last));
+	this->velocities.set(index, this->velocities.get(last));
+	this->lifeTimes[index] = this->lifeTimes[last];
+
+	this->resize(last);
+}
+
+void Particles::clear()
+{
+	this->positions.clear();
+	this->velocities.clear();
+	this->lifeTimes.clear();
+}
 
-	std::uniform_real_distribution<float> dist(0.f, 1.f);
-	this->distribution = dist;
+ParticleGenerator::ParticleGenerator(int maxParticles, float spawnRate, Vec3f initialPosition)
+	: ParticleGenerator(maxParticles, spawnRate, initialPosition, std::uint64_t(std::chrono::system_clock::now().time_since_epoch().count()))
+{}
 
+ParticleGenerator::ParticleGenerator(int maxParticles, float spawnRate, Vec3f initialPosition, std::uint64_t seed, ThreadPool& pool) : maxParticles(maxParticles), spawnRate(spawnRate), conePosition(initialPosition), coneDirection(Vec3f{0.f, -1.f, 0.f}), pool(&pool), seed(seed)
+{
 	this->initParticles();
 }
 
 void ParticleGenerator::initParticles()
 {
-	// Create maxParticles amount of particles by filling the 3 std::vectors in Particles struct
-	for (int i = 0; i < this->maxParticles; i++)
-	{
-		this->particles.positions.emplace_back(conePosition);
+	// Start with an empty pool; update() spawns the particles
+	this->particles.reserve(this->maxParticles);
+	this->spawnRemainder = 0.f;
+}
 
-		// Gets a random velocity for each particle base on the cone direction of the rocket
-		Vec3f velocity;
-		velocity = this->getRandomVectorInCone(0.8f);
-		velocity = normalize(velocity);
-		velocity = velocity * 5.f;
-		this->particles.velocities.emplace_back(velocity);
+// Place particle at the given position with a random velocity base on the
+// cone direction of the rocket, and a random lifetime. Uses
+// kRandomsPerParticle uniform random numbers.
+void ParticleGenerator::spawnParticle(std::size_t index, Vec3f position, float const* randoms)
+{
+	this->particles.positions.set(index, position);
 
-		this->particles.lifeTimes.emplace_back(2.f * this->distribution(this->generator));
-	}
+	Vec3f velocity;
+	velocity = this->getRandomVectorInCone(0.8f, randoms[0], randoms[1]);
+	velocity = kUseFastMath ? normalize_fast(velocity) : normalize(velocity);
+	velocity = velocity * 5.f;
+	this->particles.velocities.set(index, velocity);
+
+	this->particles.lifeTimes[index] = 2.f * randoms[2];
 }
 
 void ParticleGenerator::resetParticles()
 {
-	// Reset particles when rocket animation is reset and recalculate particles
-	this->particles.positions.clear();
-	this->particles.velocities.clear();
-	this->particles.lifeTimes.clear();
+	// Reset particles when rocket animation is reset
+	this->particles.clear();
 
 	this->initParticles();
 }
 
 // Calculates a random vector in a conical shape based on
 // https://math.stackexchange.com/a/205589
-Vec3f ParticleGenerator::getRandomVectorInCone(float deviation)
+// u0 and u1 are uniform random numbers in [0,1).
+Vec3f ParticleGenerator::getRandomVectorInCone(float deviation, float u0, float u1)
 {
-	float cosAngle = cos(deviation);
-	float theta = (this->distribution(this->generator) * 2.f * PI);
-	float z = cosAngle + (this->distribution(this->generator) * (1 - cosAngle));
-	float root1MinusSq = sqrt(1 - z * z);
-	
-	float x = root1MinusSq * cos(theta);
-	float y = root1MinusSq * sin(theta);
+	float theta = (u0 * 2.f * PI);
+	float u = u1;
+
+	float x, y, z;
+	if constexpr (kUseFastMath)
+	{
+		float const cosAngle = cos_fast(deviation);
+		z = cosAngle + (u * (1 - cosAngle));
 
-	Vec4f direction = Vec4f{ x, y, z, 1 };
+		// sqrt(a) = a * rsqrt(a); max() avoids 0 * inf at the cone tip
+		float const oneMinusSq = std::max(1 - z * z, 1e-30f);
+		float const root1MinusSq = oneMinusSq * rsqrt_fast(oneMinusSq);
 
-	Vec3f rotateAxis = normalize(cross(this->coneDirection, Vec3f{ 0.f, 0.f, 1.f }));
-	float rotateAngle = acos(dot(this->coneDirection, Vec3f{ 0.f, 0.f, 1.f }));
-	Mat44f rotationMatrix = rotate(-rotateAngle, rotateAxis);
-	direction = rotationMatrix * direction;
+		float sinTheta, cosTheta;
+		sincos_fast(theta, sinTheta, cosTheta);
+		x = root1MinusSq * cosTheta;
+		y = root1MinusSq * sinTheta;
+	}
+	else
+	{
+		float cosAngle = cos(deviation);
+		z = cosAngle + (u * (1 - cosAngle));
+		float root1MinusSq = sqrt(1 - z * z);
 
-	Vec3f newDir = Vec3f{ direction.x, direction.y, direction.z };
+		x = root1MinusSq * cos(theta);
+		y = root1MinusSq * sin(theta);
+	}
 
-	return newDir;
+	// The cone above is centered around +z. Rotate it to the cone direction;
+	// a quaternion does this without trigonometry or a full 4x4 matrix.
+	Quatf rotation = make_quat_rotation_between(Vec3f{ 0.f, 0.f, 1.f }, this->coneDirection);
+
+	return rotate(rotation, Vec3f{ x, y, z });
 }
 
 // Create VAO for the particle positions
 void ParticleGenerator::createVAO()
 {
+	this->segmentSize = std::size_t(this->maxParticles);
+
  	this->vbo = 0;
 	glGenBuffers(1, &this->vbo);
 	glBindBuffer(GL_ARRAY_BUFFER, this->vbo);
-	glBufferData(GL_ARRAY_BUFFER, this->particles.positions.size() * sizeof(Vec3f), this->particles.positions.data(), GL_STATIC_DRAW);
 
+	if (GLAD_GL_VERSION_4_4 && this->segmentSize > 0)
+	{
+		// Coherent, so that writes through the mapping are seen by draws
+		// issued after them without explicit flushes
+		GLbitfield const flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		GLsizeiptr const size = GLsizeiptr(kRingSegments * this->segmentSize * sizeof(Vec3f));
+
+		glBufferStorage(GL_ARRAY_BUFFER, size, nullptr, flags);
+		this->mapped = static_cast<Vec3f*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, size, flags));
+	}
+	else
+	{
+		glBufferData(GL_ARRAY_BUFFER, this->segmentSize * sizeof(Vec3f), nullptr, GL_DYNAMIC_DRAW);
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	this->uploadPositions();
+
+	// The VBO is bound to binding 0 in draw(), at the segment to read
 	this->vao = 0;
 	glGenVertexArrays(1, &this->vao);
 	glBindVertexArray(this->vao);
 
-	glBindBuffer(GL_ARRAY_BUFFER, this->vbo);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, 0);
+	glVertexAttribFormat(0, 3, GL_FLOAT, GL_FALSE, 0);
+	glVertexAttribBinding(0, 0);
 	glEnableVertexAttribArray(0);
 
 	glBindVertexArray(0);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
 	// We don't delete the VBO here like we would usually,
 	// since we need it to continue to exist later on
-	// when we need to update the positions in the VBO
-	// using glMapBuffer.
+	// when we need to update the positions in the VBO.
 }
 
 void ParticleGenerator::update(float deltaTime, Vec3f updatedShipPos)
 {
-	// Iterates over all particles and updates their position and life time
-	for (int i = 0; i < this->maxParticles; i++)
+	this->simulate(deltaTime, updatedShipPos);
+	this->uploadPositions();
+}
+
+void ParticleGenerator::simulate(float deltaTime, Vec3f updatedShipPos)
+{
+	std::size_t const aliveCount = this->particles.aliveCount();
+	std::size_t const chunkCount = (aliveCount + kChunkSize - 1) / kChunkSize;
+
+	// Move and age the live particles in one branch-free pass, which marks
+	// the particles that died in deathMask and counts them per chunk
+	this->deathMask.resize(death_mask_words(aliveCount));
+	this->chunkCounts.resize(chunkCount);
+
+	this->pool->parallel_for(aliveCount, kChunkSize, [&](std::size_t begin, std::size_t end) {
+		Particles& p = this->particles;
+		this->chunkCounts[begin / kChunkSize] = integrate_particles(deltaTime, std::as_const(p.velocities).view(begin, end - begin), p.positions.view(begin, end - begin), p.lifeTimes.data() + begin, this->deathMask.data() + begin / 64);
+	});
+
+	std::size_t deadCount = 0;
+	for (std::size_t count : this->chunkCounts)
 	{
-		// Check for 'dead' particles
-		if (this->particles.lifeTimes[i] < 0.f)
+		deadCount += count;
+	}
+
+	// Spawn the particles that are due, up to the size of the pool. The
+	// fraction left over carries over to the next update, so the rate does
+	// not depend on the frame rate; particles that do not fit are dropped.
+	this->spawnRemainder += this->spawnRate * deltaTime;
+	std::size_t const due = std::size_t(this->spawnRemainder);
+	this->spawnRemainder -= float(due);
+
+	std::size_t const room = std::size_t(this->maxParticles) - aliveCount + deadCount;
+	std::size_t const spawnCount = std::min(due, room);
+
+	// New particles first take the places of the dead ones, in order. Turn
+	// the dead counts into the number of particles to respawn per chunk.
+	std::size_t const respawnCount = std::min(spawnCount, deadCount);
+
+	std::size_t remaining = respawnCount;
+	for (std::size_t& count : this->chunkCounts)
+	{
+		count = std::min(count, remaining);
+		remaining -= count;
+	}
+
+	this->pool->parallel_for(aliveCount, kChunkSize, [&](std::size_t begin, std::size_t end) {
+		std::size_t const chunk = begin / kChunkSize;
+		this->respawnInChunk(begin, end, this->chunkCounts[chunk], updatedShipPos, this->streamSeed(chunk));
+	});
+
+	this->removeDead();
+
+	// Append the particles that did not fit into the slots of dead ones
+	std::size_t const first = this->particles.aliveCount();
+	std::size_t const appendCount = spawnCount - respawnCount;
+	this->particles.resize(first + appendCount);
+
+	this->pool->parallel_for(appendCount, kChunkSize, [&](std::size_t begin, std::size_t end) {
+		Xoshiro128x8 rng(this->streamSeed(kAppendStreams_ + begin / kChunkSize));
+		for (std::size_t i = begin; i < end; i++)
+		{
+			float randoms[kRandomsPerParticle];
+			rng.fill_uniform(randoms, kRandomsPerParticle);
+			this->spawnParticle(first + i, updatedShipPos, randoms);
+		}
+	});
+
+	this->updateCount++;
+}
+
+// Seed of a random number stream for the current update
+std::uint64_t ParticleGenerator::streamSeed(std::uint64_t stream) const
+{
+	return mix_(mix_(this->seed ^ mix_(this->updateCount)) ^ stream);
+}
+
+// Replace the first respawnCount particles marked in the chunk's part of
+// deathMask by new ones, and clear their marks
+void ParticleGenerator::respawnInChunk(std::size_t begin, std::size_t end, std::size_t respawnCount, Vec3f position, std::uint64_t streamSeed)
+{
+	if (0 == respawnCount)
+	{
+		return;
+	}
+
+	Xoshiro128x8 rng(streamSeed);
+	std::uint64_t* const mask = this->deathMask.data() + begin / 64;
+
+	std::size_t respawned = 0;
+	for_each_set_bit(mask, death_mask_words(end - begin), [&](std::size_t offset) {
+		if (respawned == respawnCount)
 		{
-			this->particles.positions[i] = updatedShipPos;
+			return;
+		}
+
+		float randoms[kRandomsPerParticle];
+		rng.fill_uniform(randoms, kRandomsPerParticle);
+		this->spawnParticle(begin + offset, position, randoms);
 
-			Vec3f velocity;
-			velocity = this->getRandomVectorInCone(0.8f);
-			velocity = normalize(velocity);
-			velocity = velocity * 5.f;
-			this->particles.velocities[i] = velocity;
+		mask[offset / 64] &= ~(std::uint64_t(1) << (offset % 64));
+		respawned++;
+	});
+}
+
+// Remove the particles that are still marked in deathMask. The order of the
+// particles does not matter (they are blended additively), so a removed
+// particle is replaced by the last one. Dead particles at the end are
+// dropped first, so that the replacement is always alive.
+void ParticleGenerator::removeDead()
+{
+	auto const isDead = [this](std::size_t index) {
+		return (this->deathMask[index / 64] >> (index % 64)) & 1;
+	};
 
-			this->particles.lifeTimes[i] = 2.f * this->distribution(this->generator);
+	for_each_set_bit(this->deathMask.data(), this->deathMask.size(), [&](std::size_t index) {
+		while (this->particles.aliveCount() > index && isDead(this->particles.aliveCount() - 1))
+		{
+			this->particles.resize(this->particles.aliveCount() - 1);
 		}
-		// Otherwise just update as normal
-		else
+
+		if (this->particles.aliveCount() > index)
 		{
-			Vec3f change = this->particles.velocities[i] * deltaTime;
-			this->particles.positions[i] += change;
-			this->particles.lifeTimes[i] -= deltaTime;
+			this->particles.swapRemove(index);
 		}
+	});
+}
+
+// Write the positions into the VBO. The SoA positions are interleaved
+// directly into the mapped buffer, without an intermediate copy.
+void ParticleGenerator::uploadPositions()
+{
+	if (this->mapped)
+	{
+		this->segment = (this->segment + 1) % kRingSegments;
+		this->waitForSegment();
+
+		interleave(this->particles.positions, this->mapped + this->segment * this->segmentSize);
+		return;
 	}
 
-	// Update data in VBO
 	glBindBuffer(GL_ARRAY_BUFFER, this->vbo);
 
 	void* ptr = glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY);
 	if (ptr)
 	{
-		std::memcpy(ptr, this->particles.positions.data(), this->particles.positions.size() * sizeof(Vec3f));
+		interleave(this->particles.positions, static_cast<Vec3f*>(ptr));
 		glUnmapBuffer(GL_ARRAY_BUFFER);
 	}
 
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
-}
\ No newline at end of file
+}
+
+// Wait until the GPU is done with the draws that read the current segment.
+// Normally the fence has long been signalled; if not, this is a stall.
+void ParticleGenerator::waitForSegment()
+{
+	GLsync& fence = this->fences[this->segment];
+	if (!fence)
+	{
+		return;
+	}
+
+	GLenum status = glClientWaitSync(fence, 0, 0);
+	if (GL_TIMEOUT_EXPIRED == status)
+	{
+		++this->stallCount;
+
+		// Flush, as the fence may still be in an unsubmitted command buffer
+		constexpr GLuint64 kTimeoutNs = 1000000000;
+		do
+		{
+			status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, kTimeoutNs);
+		} while (GL_TIMEOUT_EXPIRED == status);
+	}
+
+	glDeleteSync(fence);
+	fence = nullptr;
+}
+
+void ParticleGenerator::draw()
+{
+	glBindVertexArray(this->vao);
+	glBindVertexBuffer(0, this->vbo, GLintptr(this->segment * this->segmentSize * sizeof(Vec3f)), sizeof(Vec3f));
+
+	// All drawn particles are alive. The lifetime attribute (1) is not
+	// enabled, so point-sprites.vert gets this constant instead.
+	glVertexAttrib1f(1, 0.f);
+
+	glDrawArrays(GL_POINTS, 0, GLsizei(this->particles.aliveCount()));
+	glBindVertexArray(0);
+
+	if (this->mapped)
+	{
+		// Drawn more than once per update (split screen): the last fence
+		// covers all of them
+		GLsync& fence = this->fences[this->segment];
+		if (fence)
+		{
+			glDeleteSync(fence);
+		}
+		fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+}
@@ -1,46 +1,151 @@
 #pragma once
 
+#include <new>
 #include <vector>
-#include <random>
-#include <chrono>
+#include <cstdint>
 
 #include "glad.h"
 #include "../vmlib/vec3.hpp"
 #include "../vmlib/mat44.hpp"
+#include "../vmlib/quat.hpp"
+#include "../vmlib/vec3_stream.hpp"
 #include "../support/program.hpp"
+#include "../support/thread_pool.hpp"
+
+// Allocator for std::vector whose storage starts on a cache line, like the
+// arrays of a Vec3Stream
+template <typename T>
+struct CacheLineAllocator
+{
+	using value_type = T;
+
+	CacheLineAllocator() = default;
+	template <typename U>
+	CacheLineAllocator(CacheLineAllocator<U> const&) {}
+
+	T* allocate(std::size_t count)
+	{
+		return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(Vec3Stream::kAlignment)));
+	}
+	void deallocate(T* ptr, std::size_t)
+	{
+		::operator delete(ptr, std::align_val_t(Vec3Stream::kAlignment));
+	}
+
+	template <typename U>
+	bool operator==(CacheLineAllocator<U> const&) const { return true; }
+	template <typename U>
+	bool operator!=(CacheLineAllocator<U> const&) const { return false; }
+};
 
 // Struct to hold the position, velocities and lifetimes of all particles.
 // A particle can be defined by the same index from all 3 attributes.
+// Positions and velocities are stored as structure-of-arrays so that the
+// integration runs on full SIMD registers (see vmlib/vec3_stream.hpp).
+//
+// Only live particles are stored, packed at the front of the arrays: new
+// particles are appended, and a dead particle is replaced by the last one.
+// The storage is reserved up front, so neither reallocates.
 struct Particles
 {
-	std::vector<Vec3f> positions;
-	std::vector<Vec3f> velocities;
-	std::vector<float> lifeTimes;
+	Vec3Stream positions;
+	Vec3Stream velocities;
+	std::vector<float, CacheLineAllocator<float>> lifeTimes;
+
+	std::size_t aliveCount() const { return lifeTimes.size(); }
+
+	void reserve(std::size_t count);
+	void resize(std::size_t count);
+	void swapRemove(std::size_t index);
+	void clear();
 };
 
 // Class to deal with generating the particles and handling updating, creation and deletion.
 class ParticleGenerator
 {
 public:
-	ParticleGenerator(int maxParticles, Vec3f initialPosition);
+	// Particles are spawned at spawnRate per second, as long as fewer than
+	// maxParticles are alive. The first constructor seeds the random number
+	// generator from the clock. Pass an explicit seed to get the same
+	// particles on every run (e.g., for benchmarks); the particles are then
+	// also the same for any number of threads in the pool.
+	ParticleGenerator(int maxParticles, float spawnRate, Vec3f initialPosition);
+	ParticleGenerator(int maxParticles, float spawnRate, Vec3f initialPosition, std::uint64_t seed, ThreadPool& pool = default_thread_pool());
 	void initParticles();
 	void resetParticles();
 	void createVAO();
+
+	// simulate() followed by uploading the positions to the VBO
 	void update(float deltaTime, Vec3f updatedShipPos);
 
+	// Moves, ages, removes and spawns particles, without touching OpenGL.
+	// Large pools are processed in chunks of kChunkSize particles on the
+	// thread pool.
+	void simulate(float deltaTime, Vec3f updatedShipPos);
+
+	// Draws the positions uploaded by the last update() as GL_POINTS. The
+	// caller sets up the program (point-sprites.vert) and textures.
+	void draw();
+
+	// Number of uploads that had to wait for the GPU to finish drawing
+	// from the ring segment they were about to overwrite
+	std::size_t fenceStallCount() const { return stallCount; }
+
 	Particles particles;
 	int maxParticles{};
+	float spawnRate{};
 	Vec3f conePosition;
 	Vec3f coneDirection;
 	Mat44f rotation;
 	GLuint vao;
 
 private:
-	Vec3f getRandomVectorInCone(float angleDeviation);
+	Vec3f getRandomVectorInCone(float angleDeviation, float u0, float u1);
+	void spawnParticle(std::size_t index, Vec3f position, float const* randoms);
+	void respawnInChunk(std::size_t begin, std::size_t end, std::size_t respawnCount, Vec3f position, std::uint64_t streamSeed);
+	void removeDead();
+	std::uint64_t streamSeed(std::uint64_t stream) const;
+	void uploadPositions();
+	void waitForSegment();
 
 	GLuint vbo;
 
-	std::default_random_engine generator;
-	std::uniform_real_distribution<float> distribution;
+	// With GL 4.4, the VBO holds kRingSegments copies of the positions
+	// and stays persistently mapped. Each update writes to the next
+	// segment, and draw() places a fence behind the draw that reads it,
+	// so the CPU only waits if the GPU falls kRingSegments frames behind.
+	// Without GL 4.4, there is a single segment that is mapped and
+	// unmapped on every update.
+	static constexpr std::size_t kRingSegments = 3;
+
+	Vec3f* mapped = nullptr;
+	std::size_t segmentSize = 0;
+	std::size_t segment = 0;
+	GLsync fences[kRingSegments]{};
+	std::size_t stallCount = 0;
+
+	// Each (re)spawned particle uses kRandomsPerParticle random numbers.
+	static constexpr std::size_t kRandomsPerParticle = 3;
+
+	// Chunks are the unit of work for the thread pool. Their size does not
+	// depend on the number of threads, and each chunk draws its random
+	// numbers from its own stream, seeded from the generator's seed, the
+	// update and the chunk. The results are therefore the same for any
+	// number of threads. The size is a multiple of 64 particles, so that
+	// chunks cover whole words of the death mask and start on cache lines
+	// in all arrays.
+	static constexpr std::size_t kChunkSize = 4096;
+
+	ThreadPool* pool;
+	std::uint64_t seed;
+	std::uint64_t updateCount = 0;
+	std::vector<std::size_t> chunkCounts;
+
+	// Fraction of a particle that was due but not yet spawned
+	float spawnRemainder = 0.f;
+
+	// One bit per live particle, set by update() for the particles that
+	// died (see vmlib/particle_integrate.hpp)
+	std::vector<std::uint64_t, CacheLineAllocator<std::uint64_t>> deathMask;
 };
 
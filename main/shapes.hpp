@@ -1,9 +1,26 @@
 #pragma once
 
 #include "simple_mesh.hpp"
+#include "mesh_builder.hpp"
 
 #include "../vmlib/mat44.hpp"
 
 TexturelessSimpleMeshData makeCylinder(std::size_t subDivs = 16, Vec3f color = { 1.f, 1.f, 1.f }, Mat44f preTransform = kIdentity44f, bool isCapped = true);
 TexturelessSimpleMeshData makeCone(std::size_t subDivs, Vec3f color, Mat44f preTransform = kIdentity44f, bool isCapped = true);
-TexturelessSimpleMeshData makePyramid(Vec3f color, Mat44f preTransform = kIdentity44f);
\ No newline at end of file
+TexturelessSimpleMeshData makePyramid(Vec3f color, Mat44f preTransform = kIdentity44f);
+
+// Same shapes, added to the current part of a MeshBuilder in place. The
+// vertex counts can be used to reserve space in the builder beforehand.
+void appendCylinder(MeshBuilder&, std::size_t subDivs = 16, Vec3f color = { 1.f, 1.f, 1.f }, Mat44f preTransform = kIdentity44f, bool isCapped = true);
+void appendCone(MeshBuilder&, std::size_t subDivs, Vec3f color, Mat44f preTransform = kIdentity44f, bool isCapped = true);
+void appendPyramid(MeshBuilder&, Vec3f color, Mat44f preTransform = kIdentity44f);
+
+constexpr std::size_t cylinderVertexCount(std::size_t subDivs, bool isCapped = true)
+{
+	return subDivs * (isCapped ? 12 : 6);
+}
+constexpr std::size_t coneVertexCount(std::size_t subDivs, bool isCapped = true)
+{
+	return subDivs * (isCapped ? 6 : 3);
+}
+constexpr std::size_t kPyramidVertexCount = 18;
@@ -1,5 +1,138 @@
 #include "simple_mesh.hpp"
 
+#include <limits>
+#include <algorithm>
+
+#include <cstdio>
+#include <cstddef>
+#include <cstring>
+#include <utility>
+#include <initializer_list>
+
+#include "../vmlib/bounds.hpp"
+#include "../vmlib/mesh_optimize.hpp"
+#include "../vmlib/mesh_simplify.hpp"
+#include "../vmlib/mesh_tiles.hpp"
+
+namespace
+{
+	// One attribute stream of a mesh, with 'components' floats per vertex
+	struct AttributeStream_
+	{
+		float const* data;
+		GLint components;
+	};
+
+	// Creates a buffer with the given contents and binds it to aTarget.
+	// Immutable storage lets the driver place the buffer optimally. It is
+	// core in OpenGL 4.4, and the demo only requests a 4.3 context, so fall
+	// back to glBufferData() if necessary (and for empty buffers, which
+	// glBufferStorage() rejects).
+	GLuint createStaticBuffer_(GLenum aTarget, void const* aData, std::size_t aSize)
+	{
+		GLuint buffer = 0;
+		glGenBuffers(1, &buffer);
+		glBindBuffer(aTarget, buffer);
+
+		if (GLAD_GL_VERSION_4_4 && aSize > 0)
+		{
+			glBufferStorage(aTarget, GLsizeiptr(aSize), aData, 0);
+		}
+		else
+		{
+			glBufferData(aTarget, GLsizeiptr(aSize), aData, GL_STATIC_DRAW);
+		}
+
+		return buffer;
+	}
+
+	// Creates an element buffer and makes it part of the VAO. Binding it
+	// while the VAO is bound makes it part of the VAO; the VAO is unbound
+	// before the element buffer, since unbinding the element buffer while
+	// the VAO is bound would remove it from the VAO.
+	void attachElementBuffer_(GLuint aVao, void const* aIndices, std::size_t aSize)
+	{
+		glBindVertexArray(aVao);
+
+		GLuint const indexBuffer = createStaticBuffer_(GL_ELEMENT_ARRAY_BUFFER, aIndices, aSize);
+
+		glBindVertexArray(0);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+		glDeleteBuffers(1, &indexBuffer);
+	}
+
+	// Creates a VAO with a single VBO, into which the streams are interleaved.
+	// The streams are assigned consecutive attribute locations, starting at 0.
+	GLuint createInterleavedVAO_(std::size_t aVertexCount, std::initializer_list<AttributeStream_> aStreams)
+	{
+		GLint stride = 0; // in floats
+		for (auto const& stream : aStreams)
+		{
+			stride += stream.components;
+		}
+
+		std::vector<float> packed(aVertexCount * stride);
+
+		GLint offset = 0;
+		for (auto const& stream : aStreams)
+		{
+			for (std::size_t i = 0; i < aVertexCount; ++i)
+			{
+				std::memcpy(&packed[i * stride + offset], stream.data + i * stream.components, stream.components * sizeof(float));
+			}
+
+			offset += stream.components;
+		}
+
+		GLuint const vbo = createStaticBuffer_(GL_ARRAY_BUFFER, packed.data(), packed.size() * sizeof(float));
+
+		GLuint vao = 0;
+		glGenVertexArrays(1, &vao);
+		glBindVertexArray(vao);
+
+		// All attributes are sourced from binding point 0
+		glBindVertexBuffer(0, vbo, 0, GLsizei(stride * sizeof(float)));
+
+		GLuint location = 0;
+		GLuint relativeOffset = 0;
+		for (auto const& stream : aStreams)
+		{
+			glVertexAttribFormat(location, stream.components, GL_FLOAT, GL_FALSE, relativeOffset);
+			glVertexAttribBinding(location, 0);
+			glEnableVertexAttribArray(location);
+
+			relativeOffset += GLuint(stream.components * sizeof(float));
+			++location;
+		}
+
+		glBindVertexArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glDeleteBuffers(1, &vbo);
+
+		return vao;
+	}
+
+	// Number of indices of the full resolution mesh: the LOD 0 ranges of all
+	// tiles, which come first in the index buffer
+	std::size_t fullIndexCount_(std::vector<MeshLod> const& aLods, std::vector<MeshTile> const& aTiles)
+	{
+		std::size_t ret = 0;
+		for (MeshTile const& tile : aTiles)
+		{
+			ret += aLods[tile.firstLod].indexCount;
+		}
+
+		return ret;
+	}
+
+	template< class tVec >
+	AttributeStream_ stream_(std::vector<tVec> const& aStream)
+	{
+		static_assert(sizeof(tVec) % sizeof(float) == 0);
+		return AttributeStream_{ reinterpret_cast<float const*>(aStream.data()), GLint(sizeof(tVec) / sizeof(float)) };
+	}
+}
+
 // Concatenates two SimpleMeshData's together
 SimpleMeshData concatenate(SimpleMeshData rMesh, SimpleMeshData const& lMesh)
 {
@@ -12,8 +145,18 @@ SimpleMeshData concatenate(SimpleMeshData rMesh, SimpleMeshData const& lMesh)
 }
 
 // Creates a VAO for a given SimpleMeshData
-GLuint createVAO(SimpleMeshData const& aMeshData)
+GLuint createVAO(SimpleMeshData const& aMeshData, VertexLayout aLayout)
 {
+	if (VertexLayout::interleaved == aLayout)
+	{
+		return createInterleavedVAO_(aMeshData.positions.size(), {
+			stream_(aMeshData.positions),
+			stream_(aMeshData.colors),
+			stream_(aMeshData.normals),
+			stream_(aMeshData.texcoords)
+		});
+	}
+
 	// Positions Vertex Buffer Object
 	GLuint positionVBO = 0;
 	glGenBuffers(1, &positionVBO);
@@ -72,18 +215,520 @@ GLuint createVAO(SimpleMeshData const& aMeshData)
 }
 
 
-// Textureless variants of the methods above
-TexturelessSimpleMeshData concatenate(TexturelessSimpleMeshData rMesh, TexturelessSimpleMeshData const& lMesh)
+namespace
 {
-	rMesh.positions.insert(rMesh.positions.end(), lMesh.positions.begin(), lMesh.positions.end());
-	rMesh.colors.insert(rMesh.colors.end(), lMesh.colors.begin(), lMesh.colors.end());
-	rMesh.normals.insert(rMesh.normals.end(), lMesh.normals.begin(), lMesh.normals.end());
+	// All attributes of one vertex as raw bits, for hashing and comparison
+	struct VertexKey_
+	{
+		std::uint32_t bits[11];
 
-	return rMesh;
+		bool operator==(VertexKey_ const& aOther) const noexcept
+		{
+			return 0 == std::memcmp(bits, aOther.bits, sizeof(bits));
+		}
+	};
+
+	VertexKey_ vertexKey_(SimpleMeshData const& aMesh, std::size_t aI)
+	{
+		static_assert(sizeof(VertexKey_) == 3*sizeof(Vec3f) + sizeof(Vec2f));
+
+		VertexKey_ key;
+		std::memcpy(key.bits + 0, &aMesh.positions[aI], sizeof(Vec3f));
+		std::memcpy(key.bits + 3, &aMesh.colors[aI], sizeof(Vec3f));
+		std::memcpy(key.bits + 6, &aMesh.normals[aI], sizeof(Vec3f));
+		std::memcpy(key.bits + 9, &aMesh.texcoords[aI], sizeof(Vec2f));
+		return key;
+	}
+
+	std::uint64_t hash_(VertexKey_ const& aKey)
+	{
+		// FNV-1a over 32-bit words, with a final avalanche (from MurmurHash3)
+		// so that the low bits, which select the table slot, depend on all
+		// words.
+		std::uint64_t h = 0xcbf29ce484222325ull;
+		for (std::uint32_t word : aKey.bits)
+		{
+			h = (h ^ word) * 0x100000001b3ull;
+		}
+
+		h ^= h >> 33;
+		h *= 0xff51afd7ed558ccdull;
+		h ^= h >> 33;
+		return h;
+	}
+}
+
+IndexedMeshData makeIndexed(SimpleMeshData const& aMesh)
+{
+	std::size_t const count = aMesh.positions.size();
+
+	IndexedMeshData ret;
+	ret.indices.reserve(count);
+
+	// Open addressing hash table with linear probing. Each slot holds the
+	// index of a unique vertex (kEmpty if unused). The table is kept at most
+	// half full.
+	constexpr std::uint32_t kEmpty = ~std::uint32_t(0);
+
+	std::size_t tableSize = 16;
+	while (tableSize < 2 * count)
+	{
+		tableSize *= 2;
+	}
+
+	std::size_t const mask = tableSize - 1;
+	std::vector<std::uint32_t> table(tableSize, kEmpty);
+	std::vector<VertexKey_> keys;
+
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		VertexKey_ const key = vertexKey_(aMesh, i);
+
+		std::size_t slot = hash_(key) & mask;
+		while (kEmpty != table[slot] && !(keys[table[slot]] == key))
+		{
+			slot = (slot + 1) & mask;
+		}
+
+		if (kEmpty == table[slot])
+		{
+			table[slot] = std::uint32_t(keys.size());
+			keys.emplace_back(key);
+
+			ret.vertices.positions.emplace_back(aMesh.positions[i]);
+			ret.vertices.colors.emplace_back(aMesh.colors[i]);
+			ret.vertices.normals.emplace_back(aMesh.normals[i]);
+			ret.vertices.texcoords.emplace_back(aMesh.texcoords[i]);
+		}
+
+		ret.indices.emplace_back(table[slot]);
+	}
+
+	ret.lods.push_back(MeshLod{ 0, std::uint32_t(ret.indices.size()), 0.f });
+	ret.tiles.push_back(MeshTile{ make_aabb(ret.vertices.positions.data(), ret.vertices.positions.size()), 0, 1 });
+
+	return ret;
 }
 
-GLuint createVAO(TexturelessSimpleMeshData const& aMeshData)
+void printIndexingStats(char const* name, SimpleMeshData const& aMesh, IndexedMeshData const& aIndexed)
 {
+	constexpr std::size_t kVertexSize = 3*sizeof(Vec3f) + sizeof(Vec2f);
+	std::size_t const indexSize = aIndexed.vertices.positions.size() <= 65536 ? 2 : 4;
+
+	std::size_t const before = aMesh.positions.size() * kVertexSize;
+	std::size_t const after = aIndexed.vertices.positions.size() * kVertexSize + aIndexed.indices.size() * indexSize;
+
+	std::printf("%s: %zu vertices (%.2f MiB) -> %zu vertices + %zu %zu-bit indices (%.2f MiB, %.1f%%)\n",
+		name,
+		aMesh.positions.size(), before / (1024.0 * 1024.0),
+		aIndexed.vertices.positions.size(), aIndexed.indices.size(), indexSize * 8, after / (1024.0 * 1024.0),
+		before ? 100.0 * after / before : 100.0
+	);
+}
+
+void tileMesh(char const* name, IndexedMeshData& aMesh, std::size_t tilesX, std::size_t tilesZ)
+{
+	std::size_t const tileCount = tilesX * tilesZ;
+	std::vector<std::uint32_t> offsets(tileCount + 1);
+	std::vector<Aabb3f> bounds(tileCount);
+
+	partition_mesh_xz(
+		aMesh.indices.data(), aMesh.indices.size(),
+		aMesh.vertices.positions.data(), aMesh.tiles.front().bounds,
+		tilesX, tilesZ,
+		offsets.data(), bounds.data()
+	);
+
+	aMesh.lods.clear();
+	aMesh.tiles.clear();
+	for (std::size_t i = 0; i < tileCount; ++i)
+	{
+		if (offsets[i] == offsets[i + 1])
+		{
+			continue;
+		}
+
+		aMesh.tiles.push_back(MeshTile{ bounds[i], std::uint32_t(aMesh.lods.size()), 1 });
+		aMesh.lods.push_back(MeshLod{ offsets[i], offsets[i + 1] - offsets[i], 0.f });
+	}
+
+	std::printf("%s: %zu x %zu grid, %zu non-empty tiles\n", name, tilesX, tilesZ, aMesh.tiles.size());
+}
+
+void generateLods(char const* name, IndexedMeshData& aMesh, std::size_t maxLods)
+{
+	// Per-vertex attributes for the simplification: normal, texture
+	// coordinates and color. The weights are relative to the size of the
+	// tile (see simplify_mesh()); e.g., a normal that changes by 1 costs as
+	// much as moving the surface by 1% of the tile size.
+	constexpr std::size_t kAttributeCount = 8;
+	constexpr float kWeights[kAttributeCount] = {
+		0.01f, 0.01f, 0.01f,
+		0.05f, 0.05f,
+		0.01f, 0.01f, 0.01f
+	};
+	constexpr std::uint32_t kNoVertex = ~std::uint32_t(0);
+
+	SimpleMeshData const& vertices = aMesh.vertices;
+	std::size_t const vertexCount = vertices.positions.size();
+
+	// Vertices on the edges between tiles are locked
+	std::vector<std::uint8_t> locked(vertexCount, 0);
+	if (aMesh.tiles.size() > 1)
+	{
+		std::vector<std::uint32_t> offsets;
+		for (MeshTile const& tile : aMesh.tiles)
+		{
+			offsets.push_back(aMesh.lods[tile.firstLod].firstIndex);
+		}
+		MeshLod const& last = aMesh.lods[aMesh.tiles.back().firstLod];
+		offsets.push_back(last.firstIndex + last.indexCount);
+
+		mark_tile_borders(aMesh.indices.data(), offsets.data(), aMesh.tiles.size(), vertices.positions.data(), vertexCount, locked.data());
+	}
+
+	// Each tile is simplified on its own, with its vertices copied to a
+	// compact local array, so that the cost depends only on the tile's size
+	std::vector<std::uint32_t> localIndex(vertexCount, kNoVertex);
+
+	std::vector<MeshLod> lods;
+	std::vector<MeshTile> tiles;
+	for (MeshTile const& tile : aMesh.tiles)
+	{
+		MeshLod const full = aMesh.lods[tile.firstLod];
+
+		std::vector<std::uint32_t> globalIndex;
+		std::vector<std::uint32_t> local(full.indexCount);
+		for (std::uint32_t i = 0; i < full.indexCount; ++i)
+		{
+			std::uint32_t const v = aMesh.indices[full.firstIndex + i];
+			if (kNoVertex == localIndex[v])
+			{
+				localIndex[v] = std::uint32_t(globalIndex.size());
+				globalIndex.push_back(v);
+			}
+			local[i] = localIndex[v];
+		}
+
+		std::size_t const localCount = globalIndex.size();
+		std::vector<Vec3f> positions(localCount);
+		std::vector<float> attributes(localCount * kAttributeCount);
+		std::vector<std::uint8_t> localLocked(localCount);
+		for (std::size_t i = 0; i < localCount; ++i)
+		{
+			std::uint32_t const v = globalIndex[i];
+			localIndex[v] = kNoVertex;
+
+			positions[i] = vertices.positions[v];
+			localLocked[i] = locked[v];
+
+			float* attr = &attributes[i * kAttributeCount];
+			Vec3f const normal = length(vertices.normals[v]) > 0.f ? normalize(vertices.normals[v]) : vertices.normals[v];
+			attr[0] = normal.x;
+			attr[1] = normal.y;
+			attr[2] = normal.z;
+			attr[3] = vertices.texcoords[v].x;
+			attr[4] = vertices.texcoords[v].y;
+			attr[5] = vertices.colors[v].x;
+			attr[6] = vertices.colors[v].y;
+			attr[7] = vertices.colors[v].z;
+		}
+
+		tiles.push_back(MeshTile{ tile.bounds, std::uint32_t(lods.size()), 1 });
+		lods.push_back(full);
+
+		// Each level is simplified from the previous one, which is much
+		// faster than starting from LOD 0 each time. The error is still
+		// measured against LOD 0. Simplifying in steps can make a level's
+		// measured error smaller than that of the level before it; the errors
+		// are made monotonic (this keeps them upper bounds) so that
+		// selectLod() can rely on it.
+		std::vector<std::uint32_t> previous = local;
+		std::vector<std::uint32_t> simplified(previous.size());
+
+		while (tiles.back().lodCount < maxLods)
+		{
+			std::size_t const target = previous.size() / 2 / 3 * 3;
+			std::size_t const count = simplify_mesh(
+				simplified.data(), previous.data(), previous.size(),
+				positions.data(), localCount,
+				attributes.data(), kAttributeCount, kWeights,
+				target, std::numeric_limits<float>::max(),
+				nullptr, localLocked.data()
+			);
+
+			// Stop once the tile can no longer be reduced by at least 10%
+			if (0 == count || 10 * count > 9 * previous.size())
+			{
+				break;
+			}
+
+			float const error = mesh_vertex_distance(local.data(), local.size(), simplified.data(), count, positions.data(), localCount);
+
+			MeshLod lod;
+			lod.firstIndex = std::uint32_t(aMesh.indices.size());
+			lod.indexCount = std::uint32_t(count);
+			lod.error = std::max(error, lods.back().error);
+			lods.push_back(lod);
+			++tiles.back().lodCount;
+
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				aMesh.indices.push_back(globalIndex[simplified[i]]);
+			}
+			previous.assign(simplified.begin(), simplified.begin() + count);
+		}
+	}
+
+	aMesh.lods = std::move(lods);
+	aMesh.tiles = std::move(tiles);
+
+	// Summary per level, over all tiles (tiles that ran out of levels
+	// count with their coarsest one)
+	std::size_t levels = 0;
+	for (MeshTile const& tile : aMesh.tiles)
+	{
+		levels = std::max<std::size_t>(levels, tile.lodCount);
+	}
+
+	for (std::size_t level = 0; level < levels; ++level)
+	{
+		std::size_t triangles = 0;
+		float maxError = 0.f;
+		for (MeshTile const& tile : aMesh.tiles)
+		{
+			MeshLod const& lod = aMesh.lods[tile.firstLod + std::min<std::size_t>(level, tile.lodCount - 1)];
+			triangles += lod.indexCount / 3;
+			maxError = std::max(maxError, lod.error);
+		}
+
+		std::printf("%s: LOD %zu: %zu triangles, max. error %g\n", name, level, triangles, maxError);
+	}
+}
+
+void optimizeMesh(char const* name, IndexedMeshData& aMesh)
+{
+	std::size_t const vertexCount = aMesh.vertices.positions.size();
+	std::size_t const fullCount = fullIndexCount_(aMesh.lods, aMesh.tiles);
+
+	VertexCacheStats const before = simulate_vertex_cache(aMesh.indices.data(), fullCount, vertexCount);
+
+	for (MeshLod const& lod : aMesh.lods)
+	{
+		std::uint32_t* const indices = aMesh.indices.data() + lod.firstIndex;
+		optimize_vertex_cache(indices, lod.indexCount, vertexCount);
+		optimize_overdraw(indices, lod.indexCount, aMesh.vertices.positions.data(), vertexCount);
+	}
+
+	VertexCacheStats const after = simulate_vertex_cache(aMesh.indices.data(), fullCount, vertexCount);
+
+	// Vertex fetch order; this does not change the cache statistics. The
+	// other LODs follow LOD 0 in the index buffer, so LOD 0's vertices come
+	// first.
+	std::vector<std::uint32_t> remap(vertexCount);
+	std::size_t const usedCount = optimize_vertex_fetch(aMesh.indices.data(), aMesh.indices.size(), vertexCount, remap.data());
+
+	SimpleMeshData remapped;
+	remapped.positions.resize(usedCount);
+	remapped.colors.resize(usedCount);
+	remapped.normals.resize(usedCount);
+	remapped.texcoords.resize(usedCount);
+
+	remap_vertices(remapped.positions.data(), aMesh.vertices.positions.data(), vertexCount, remap.data());
+	remap_vertices(remapped.colors.data(), aMesh.vertices.colors.data(), vertexCount, remap.data());
+	remap_vertices(remapped.normals.data(), aMesh.vertices.normals.data(), vertexCount, remap.data());
+	remap_vertices(remapped.texcoords.data(), aMesh.vertices.texcoords.data(), vertexCount, remap.data());
+
+	aMesh.vertices = std::move(remapped);
+
+	std::printf("%s: vertex cache (%zu entries) ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n",
+		name, kDefaultVertexCacheSize,
+		before.acmr, after.acmr,
+		before.atvr, after.atvr
+	);
+}
+
+std::size_t selectLod(MeshLod const* aLods, std::size_t lodCount, float distance, float pixelScale, float maxPixelError)
+{
+	// The errors increase with the level; the projected error of a level is
+	// error * pixelScale / distance.
+	std::size_t ret = 0;
+	while (ret + 1 < lodCount && aLods[ret + 1].error * pixelScale <= maxPixelError * distance)
+	{
+		++ret;
+	}
+
+	return ret;
+}
+
+void setVertexFormatUniforms(GLuint program, VertexFormat const& aFormat)
+{
+	// Looked up by name: default.vert does not use normals, so the compiler
+	// may remove uOctahedralNormals there (location -1 is ignored).
+	glUniform3fv(glGetUniformLocation(program, "uPositionOffset"), 1, &aFormat.positions.offset.x);
+	glUniform3fv(glGetUniformLocation(program, "uPositionScale"), 1, &aFormat.positions.scale.x);
+	glUniform1i(glGetUniformLocation(program, "uOctahedralNormals"), aFormat.octahedralNormals ? 1 : 0);
+}
+
+IndexedVAO createVAO(IndexedMeshData const& aMeshData, VertexLayout aLayout)
+{
+	IndexedVAO ret;
+	ret.vao = createVAO(aMeshData.vertices, aLayout);
+	ret.indexCount = (GLsizei) fullIndexCount_(aMeshData.lods, aMeshData.tiles);
+	ret.format = kFloatVertexFormat;
+	ret.lods = aMeshData.lods;
+	ret.tiles = aMeshData.tiles;
+
+	if (aMeshData.vertices.positions.size() <= 65536)
+	{
+		std::vector<std::uint16_t> const indices16(aMeshData.indices.begin(), aMeshData.indices.end());
+		attachElementBuffer_(ret.vao, indices16.data(), indices16.size() * sizeof(std::uint16_t));
+		ret.indexType = GL_UNSIGNED_SHORT;
+	}
+	else
+	{
+		attachElementBuffer_(ret.vao, aMeshData.indices.data(), aMeshData.indices.size() * sizeof(std::uint32_t));
+		ret.indexType = GL_UNSIGNED_INT;
+	}
+
+	return ret;
+}
+
+void drawLod(IndexedVAO const& aVao, std::size_t aLod)
+{
+	MeshLod const& lod = aVao.lods[aLod];
+	std::size_t const indexSize = GL_UNSIGNED_SHORT == aVao.indexType ? sizeof(std::uint16_t) : sizeof(std::uint32_t);
+
+	glDrawElements(GL_TRIANGLES, (GLsizei) lod.indexCount, aVao.indexType, reinterpret_cast<void const*>(lod.firstIndex * indexSize));
+}
+
+QuantizedMeshData quantizeMesh(IndexedMeshData const& aMesh)
+{
+	SimpleMeshData const& in = aMesh.vertices;
+	std::size_t const vertexCount = in.positions.size();
+
+	QuantizedMeshData ret;
+	ret.indices = aMesh.indices;
+	ret.lods = aMesh.lods;
+	ret.tiles = aMesh.tiles;
+	ret.format.octahedralNormals = true;
+	ret.format.positions = 0 != vertexCount
+		? make_position_quantization(make_aabb(in.positions.data(), vertexCount))
+		: kNoPositionQuantization;
+
+	ret.vertices.resize(vertexCount);
+	for (std::size_t i = 0; i < vertexCount; ++i)
+	{
+		QuantizedVertex& v = ret.vertices[i];
+
+		quantize_position(in.positions[i], ret.format.positions, v.position);
+		v.position[3] = 0;
+
+		// Guard against zero-length normals in the input
+		Vec3f const normal = length(in.normals[i]) > 0.f ? in.normals[i] : Vec3f{ 0.f, 0.f, 1.f };
+		quantize_octahedral16(normal, v.normal);
+
+		v.texcoord[0] = float_to_half(in.texcoords[i].x);
+		v.texcoord[1] = float_to_half(in.texcoords[i].y);
+
+		v.color[0] = quantize_unorm8(in.colors[i].x);
+		v.color[1] = quantize_unorm8(in.colors[i].y);
+		v.color[2] = quantize_unorm8(in.colors[i].z);
+		v.color[3] = 255;
+	}
+
+	return ret;
+}
+
+IndexedVAO createVAO(QuantizedMeshData const& aMeshData)
+{
+	std::size_t const vertexCount = aMeshData.vertices.size();
+
+	if (vertexCount <= 65536)
+	{
+		std::vector<std::uint16_t> const indices16(aMeshData.indices.begin(), aMeshData.indices.end());
+		return createVAO(aMeshData.vertices.data(), vertexCount, indices16.data(), indices16.size(), GL_UNSIGNED_SHORT, aMeshData.format, aMeshData.lods, aMeshData.tiles);
+	}
+
+	return createVAO(aMeshData.vertices.data(), vertexCount, aMeshData.indices.data(), aMeshData.indices.size(), GL_UNSIGNED_INT, aMeshData.format, aMeshData.lods, aMeshData.tiles);
+}
+
+IndexedVAO createVAO(QuantizedVertex const* aVertices, std::size_t aVertexCount, void const* aIndices, std::size_t aIndexCount, GLenum aIndexType, VertexFormat const& aFormat, std::vector<MeshLod> aLods, std::vector<MeshTile> aTiles)
+{
+	GLuint const vbo = createStaticBuffer_(GL_ARRAY_BUFFER, aVertices, aVertexCount * sizeof(QuantizedVertex));
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	std::size_t const indexSize = GL_UNSIGNED_SHORT == aIndexType ? sizeof(std::uint16_t) : sizeof(std::uint32_t);
+	// (GL_ELEMENT_ARRAY_BUFFER is VAO state, so use a neutral target here)
+	GLuint const ibo = createStaticBuffer_(GL_COPY_WRITE_BUFFER, aIndices, aIndexCount * indexSize);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	IndexedVAO ret = createVAO(vbo, ibo, aIndexCount, aIndexType, aFormat, std::move(aLods), std::move(aTiles));
+
+	// The VAO keeps the buffers alive
+	glDeleteBuffers(1, &vbo);
+	glDeleteBuffers(1, &ibo);
+
+	return ret;
+}
+
+IndexedVAO createVAO(GLuint aVertexBuffer, GLuint aIndexBuffer, std::size_t aIndexCount, GLenum aIndexType, VertexFormat const& aFormat, std::vector<MeshLod> aLods, std::vector<MeshTile> aTiles)
+{
+	static_assert(sizeof(QuantizedVertex) == 20);
+
+	IndexedVAO ret;
+	ret.indexType = aIndexType;
+	ret.format = aFormat;
+	ret.lods = std::move(aLods);
+	ret.tiles = std::move(aTiles);
+	if (ret.lods.empty())
+	{
+		// The quantization box covers the mesh
+		Aabb3f const bounds{ aFormat.positions.offset, aFormat.positions.offset + aFormat.positions.scale };
+		ret.lods.push_back(MeshLod{ 0, std::uint32_t(aIndexCount), 0.f });
+		ret.tiles.assign(1, MeshTile{ bounds, 0, 1 });
+	}
+	ret.indexCount = (GLsizei) fullIndexCount_(ret.lods, ret.tiles);
+
+	glGenVertexArrays(1, &ret.vao);
+	glBindVertexArray(ret.vao);
+
+	glBindVertexBuffer(0, aVertexBuffer, 0, sizeof(QuantizedVertex));
+
+	// Same attribute locations as the float layouts; normalized integer
+	// attributes arrive in the shaders as floats in [0,1] or [-1,1]
+	glVertexAttribFormat(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, offsetof(QuantizedVertex, position));
+	glVertexAttribFormat(1, 3, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(QuantizedVertex, color));
+	glVertexAttribFormat(2, 2, GL_SHORT, GL_TRUE, offsetof(QuantizedVertex, normal));
+	glVertexAttribFormat(3, 2, GL_HALF_FLOAT, GL_FALSE, offsetof(QuantizedVertex, texcoord));
+
+	for (GLuint location = 0; location < 4; ++location)
+	{
+		glVertexAttribBinding(location, 0);
+		glEnableVertexAttribArray(location);
+	}
+
+	// See attachElementBuffer_()
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, aIndexBuffer);
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+	return ret;
+}
+
+// Textureless variant of createVAO() above
+GLuint createVAO(TexturelessSimpleMeshData const& aMeshData, VertexLayout aLayout)
+{
+	if (VertexLayout::interleaved == aLayout)
+	{
+		return createInterleavedVAO_(aMeshData.positions.size(), {
+			stream_(aMeshData.positions),
+			stream_(aMeshData.colors),
+			stream_(aMeshData.normals)
+		});
+	}
+
 	// Positions Vertex Buffer Object
 	GLuint positionVBO = 0;
 	glGenBuffers(1, &positionVBO);
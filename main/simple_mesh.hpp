@@ -5,9 +5,13 @@
 #include <glad.h>
 
 #include <vector>
+#include <cstddef>
+#include <cstdint>
 
 #include "../vmlib/vec2.hpp"
 #include "../vmlib/vec3.hpp"
+#include "../vmlib/bounds.hpp"
+#include "../vmlib/quantize.hpp"
 
 struct SimpleMeshData
 {
@@ -19,7 +23,168 @@ struct SimpleMeshData
 
 SimpleMeshData concatenate(SimpleMeshData, SimpleMeshData const&);
 
-GLuint createVAO(SimpleMeshData const&);
+// Vertex buffer layouts for createVAO()
+//  - separate: one VBO per attribute stream, filled with glBufferData()
+//  - interleaved: all attributes of a vertex stored next to each other in a
+//    single VBO with immutable storage (glBufferStorage() where available).
+//    The format is described with glVertexAttribFormat()/glVertexAttribBinding().
+// Both produce the same attribute locations (0: position, 1: color,
+// 2: normal, 3: texture coordinates), so shaders work with either.
+enum class VertexLayout
+{
+	separate,
+	interleaved
+};
+
+GLuint createVAO(SimpleMeshData const&, VertexLayout = VertexLayout::interleaved);
+
+// Level of detail of (a tile of) an indexed mesh: a range of triangles in
+// its index buffer. All levels share the vertices. LOD 0 is the full
+// resolution; 'error' is the max. distance of its vertices to the surface
+// of the level (in model units), and increases with each level.
+struct MeshLod
+{
+	std::uint32_t firstIndex;
+	std::uint32_t indexCount;
+	float error;
+};
+
+// Part of a mesh that is culled and drawn on its own, with its LODs
+// lods[firstLod] (LOD 0) to lods[firstLod + lodCount - 1]
+struct MeshTile
+{
+	Aabb3f bounds;
+	std::uint32_t firstLod;
+	std::uint32_t lodCount;
+};
+
+// Indexed variant of SimpleMeshData. Each unique vertex (combination of
+// position, color, normal and texture coordinate) is stored once in
+// 'vertices'; every three entries of 'indices' form a triangle.
+//
+// The mesh consists of one or more tiles, each with at least LOD 0. The
+// LOD 0 ranges of all tiles come first in 'indices', in tile order; together
+// they form the full resolution mesh.
+struct IndexedMeshData
+{
+	SimpleMeshData vertices;
+	std::vector<std::uint32_t> indices;
+	std::vector<MeshLod> lods;
+	std::vector<MeshTile> tiles;
+};
+
+// Welds identical vertices of a non-indexed mesh, i.e., vertices whose
+// attributes are bitwise identical. The first occurrence of each vertex
+// is kept, so the order of the vertices is otherwise unchanged.
+IndexedMeshData makeIndexed(SimpleMeshData const&);
+
+// Prints the vertex count and memory use of a mesh before and after
+// indexing to stdout.
+void printIndexingStats(char const* name, SimpleMeshData const&, IndexedMeshData const&);
+
+// Splits a mesh with a single tile and LOD into a grid of tilesX x tilesZ
+// tiles over the xz plane (see vmlib/mesh_tiles.hpp); empty tiles are
+// dropped. Prints the tile count to stdout, labelled with 'name'.
+void tileMesh(char const* name, IndexedMeshData&, std::size_t tilesX, std::size_t tilesZ);
+
+// Appends up to maxLods-1 simplified levels to each tile of the mesh (see
+// vmlib/mesh_simplify.hpp). Each level has about half the triangles of the
+// previous one; generation stops early when a level no longer shrinks
+// noticeably. Normals, texture coordinates and colors are kept where they
+// vary, and the edges between tiles are kept, so that neighbouring tiles fit
+// together at any combination of levels. Prints the levels to stdout,
+// labelled with 'name'.
+void generateLods(char const* name, IndexedMeshData&, std::size_t maxLods);
+
+// Reorders an indexed mesh for rendering performance (see
+// vmlib/mesh_optimize.hpp): triangles for the post-transform vertex cache
+// and for less overdraw, then vertices in order of first use. Unreferenced
+// vertices are removed. Triangles are only reordered within each LOD, so
+// that the vertices of LOD 0 come first. Prints the simulated vertex cache
+// statistics (ACMR/ATVR) of the full resolution mesh before and after to
+// stdout, labelled with 'name'.
+void optimizeMesh(char const* name, IndexedMeshData&);
+
+// Coarsest of the lodCount levels whose error, projected to the screen, is
+// at most maxPixelError pixels. 'distance' is the distance from the camera
+// to the mesh or tile (e.g., to its bounding box) and pixelScale the
+// projection's scale, viewport height / (2 tan(fovy/2)).
+std::size_t selectLod(MeshLod const* lods, std::size_t lodCount, float distance, float pixelScale, float maxPixelError);
+
+// How the vertex shaders (default.vert, blinn-phong.vert) decode positions
+// and normals. Float vertex data uses kFloatVertexFormat, which matches the
+// defaults of the shader uniforms.
+struct VertexFormat
+{
+	PositionQuantization positions;
+	bool octahedralNormals;
+};
+
+constexpr VertexFormat kFloatVertexFormat = { kNoPositionQuantization, false };
+
+// Sets the decoding uniforms of the program, which must be current. The
+// uniforms keep their values; reset them with kFloatVertexFormat before
+// drawing float data with the same program.
+void setVertexFormatUniforms(GLuint program, VertexFormat const&);
+
+// VAO for an indexed mesh. The index buffer is part of the VAO; draw with
+//   setVertexFormatUniforms(program, format)
+//   glDrawElements(GL_TRIANGLES, indexCount, indexType, nullptr)
+// for the full resolution mesh, or drawLod() for one of 'lods' (e.g., of a
+// tile). Indices are uploaded as 16-bit values when the mesh has at most
+// 65536 vertices, and as 32-bit values otherwise.
+struct IndexedVAO
+{
+	GLuint vao;
+	GLsizei indexCount;
+	GLenum indexType;
+	VertexFormat format;
+	std::vector<MeshLod> lods;
+	std::vector<MeshTile> tiles;
+};
+
+IndexedVAO createVAO(IndexedMeshData const&, VertexLayout = VertexLayout::interleaved);
+
+// Draws one LOD of the VAO, which must be bound
+void drawLod(IndexedVAO const&, std::size_t lod);
+
+// Quantized vertex: 20 bytes instead of the 44 of SimpleMeshData (see
+// vmlib/quantize.hpp for the encodings and their errors)
+//  - position: 16-bit normalized, relative to the mesh's bounding box
+//  - normal: octahedral, 2x 16-bit signed normalized
+//  - texcoord: half floats
+//  - color: 8-bit normalized RGB
+// The unused fourth elements keep each attribute 4-byte aligned.
+struct QuantizedVertex
+{
+	std::uint16_t position[4];
+	std::int16_t normal[2];
+	std::uint16_t texcoord[2];
+	std::uint8_t color[4];
+};
+
+struct QuantizedMeshData
+{
+	std::vector<QuantizedVertex> vertices;
+	std::vector<std::uint32_t> indices;
+	std::vector<MeshLod> lods;
+	std::vector<MeshTile> tiles;
+	VertexFormat format;
+};
+
+QuantizedMeshData quantizeMesh(IndexedMeshData const&);
+
+// VAO for quantized vertices, interleaved in a single buffer. The second
+// form uploads directly from memory, e.g., a mapped file; indices holds
+// indexCount values of indexType (GL_UNSIGNED_SHORT or GL_UNSIGNED_INT),
+// lods and tiles describe the levels and tiles in them (if empty, a single
+// tile and level with all indices).
+IndexedVAO createVAO(QuantizedMeshData const&);
+IndexedVAO createVAO(QuantizedVertex const* vertices, std::size_t vertexCount, void const* indices, std::size_t indexCount, GLenum indexType, VertexFormat const&, std::vector<MeshLod> lods, std::vector<MeshTile> tiles);
+
+// VAO for quantized vertices that are already in GL buffers (e.g., uploaded
+// in pieces); the VAO keeps its own reference to both buffers.
+IndexedVAO createVAO(GLuint vertexBuffer, GLuint indexBuffer, std::size_t indexCount, GLenum indexType, VertexFormat const&, std::vector<MeshLod> lods, std::vector<MeshTile> tiles);
 
 // Use of a 'Textureless' simple mesh data to handle meshes that don't
 // contain texture coordinates so we can correctly use them in shaders and
@@ -31,6 +196,4 @@ struct TexturelessSimpleMeshData
 	std::vector<Vec3f> normals;
 };
 
-TexturelessSimpleMeshData concatenate(TexturelessSimpleMeshData, TexturelessSimpleMeshData const&);
-
-GLuint createVAO(TexturelessSimpleMeshData const&);
\ No newline at end of file
+GLuint createVAO(TexturelessSimpleMeshData const&, VertexLayout = VertexLayout::interleaved);
\ No newline at end of file
@@ -0,0 +1,107 @@
+#include "staging_buffer.hpp"
+
+#include <cstring>
+
+#include "../support/error.hpp"
+
+namespace
+{
+	// Offsets of the copies in the staging buffer. Texture uploads from a
+	// buffer need offsets that are a multiple of the texel size.
+	constexpr std::size_t kStagingAlignment_ = 16;
+
+	std::size_t alignUp_(std::size_t aOffset)
+	{
+		return (aOffset + kStagingAlignment_ - 1) & ~(kStagingAlignment_ - 1);
+	}
+}
+
+StagingBuffer::StagingBuffer(std::size_t capacity)
+	: bufferSize(capacity)
+{
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+	glBufferData(GL_COPY_READ_BUFFER, GLsizeiptr(bufferSize), nullptr, GL_STREAM_DRAW);
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+}
+
+StagingBuffer::~StagingBuffer()
+{
+	glDeleteBuffers(1, &buffer);
+}
+
+std::size_t StagingBuffer::available() const
+{
+	std::size_t const offset = alignUp_(used);
+	return offset < bufferSize ? bufferSize - offset : 0;
+}
+
+void StagingBuffer::copyToBuffer(GLuint target, std::size_t offset, void const* data, std::size_t size)
+{
+	std::size_t const stagingOffset = alignUp_(used);
+	used = stagingOffset + size;
+	copies.push_back(Copy{ target, false, offset, 0, 0, data, size, stagingOffset });
+}
+
+void StagingBuffer::copyToTexture(GLuint texture, GLint level, GLint width, GLint y, GLsizei height, void const* data)
+{
+	std::size_t const stagingOffset = alignUp_(used);
+	std::size_t const size = std::size_t(width) * std::size_t(height) * 4;
+	used = stagingOffset + size;
+	copies.push_back(Copy{ texture, true, std::size_t(y), level, width, data, size, stagingOffset });
+}
+
+void StagingBuffer::flush()
+{
+	if (copies.empty())
+	{
+		return;
+	}
+
+	if (used > bufferSize)
+	{
+		throw Error("StagingBuffer: %zu bytes queued, but only %zu fit", used, bufferSize);
+	}
+
+	// Fill the staging buffer
+	glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+	void* mapped = glMapBufferRange(GL_COPY_READ_BUFFER, 0, GLsizeiptr(used), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+	if (!mapped)
+	{
+		throw Error("StagingBuffer: glMapBufferRange() failed");
+	}
+
+	for (Copy const& copy : copies)
+	{
+		std::memcpy(static_cast<unsigned char*>(mapped) + copy.stagingOffset, copy.data, copy.size);
+	}
+
+	glUnmapBuffer(GL_COPY_READ_BUFFER);
+
+	// Copy to the destinations
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	for (Copy const& copy : copies)
+	{
+		if (copy.isTexture)
+		{
+			GLsizei const rows = GLsizei(copy.size / (std::size_t(copy.width) * 4));
+			glBindTexture(GL_TEXTURE_2D, copy.target);
+			glTexSubImage2D(GL_TEXTURE_2D, copy.level, 0, GLint(copy.targetOffset), copy.width, rows, GL_RGBA, GL_UNSIGNED_BYTE, reinterpret_cast<void const*>(copy.stagingOffset));
+		}
+		else
+		{
+			glBindBuffer(GL_COPY_WRITE_BUFFER, copy.target);
+			glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, GLintptr(copy.stagingOffset), GLintptr(copy.targetOffset), GLsizeiptr(copy.size));
+		}
+	}
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+
+	copies.clear();
+	used = 0;
+}
@@ -0,0 +1,64 @@
+// Staging buffer for streaming data into GL buffers and textures
+//
+// Uploads are queued during a frame with copyToBuffer() and
+// copyToTexture(), up to capacity() bytes in total. flush() then writes all
+// of them into the staging buffer with a single map, and has the GL copy
+// them to their destinations (glCopyBufferSubData(), and glTexSubImage2D()
+// from the buffer bound as GL_PIXEL_UNPACK_BUFFER). The map invalidates the
+// previous contents, so the driver can hand out fresh memory instead of
+// waiting for the copies of the previous frame.
+//
+// Limiting the bytes per frame bounds the time spent on uploads in each
+// frame, which turns one long stall into a number of short ones.
+#pragma once
+
+#include <glad.h>
+
+#include <vector>
+#include <cstddef>
+
+class StagingBuffer
+{
+public:
+	explicit StagingBuffer(std::size_t capacity);
+	~StagingBuffer();
+
+	StagingBuffer(StagingBuffer const&) = delete;
+	StagingBuffer& operator=(StagingBuffer const&) = delete;
+
+	std::size_t capacity() const { return bufferSize; }
+
+	// Bytes that can still be queued before the next flush()
+	std::size_t available() const;
+
+	// Queue size bytes from data. The data must stay valid until flush(), and
+	// size must not exceed available().
+	void copyToBuffer(GLuint buffer, std::size_t offset, void const* data, std::size_t size);
+
+	// Queue rows [y, y+height) of a level of a GL_RGBA / GL_UNSIGNED_BYTE
+	// texture; data holds height tightly packed rows of width texels.
+	void copyToTexture(GLuint texture, GLint level, GLint width, GLint y, GLsizei height, void const* data);
+
+	// Performs the queued copies. Leaves GL_COPY_READ_BUFFER,
+	// GL_COPY_WRITE_BUFFER, GL_PIXEL_UNPACK_BUFFER and GL_TEXTURE_2D
+	// unbound.
+	void flush();
+
+private:
+	struct Copy
+	{
+		GLuint target; // buffer or texture
+		bool isTexture;
+		std::size_t targetOffset; // buffer offset, or first row
+		GLint level; // texture level
+		GLint width; // texture width
+		void const* data;
+		std::size_t size;
+		std::size_t stagingOffset;
+	};
+
+	GLuint buffer = 0;
+	std::size_t bufferSize = 0;
+	std::size_t used = 0;
+	std::vector<Copy> copies;
+};
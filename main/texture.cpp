@@ -1,5 +1,7 @@
 #include "texture.hpp"
 
+#include <cmath>
+
 #include <stb_image.h>
 
 #include "../support/error.hpp"
@@ -7,21 +9,148 @@
 // Method to load a 2D texture and generate a OpenGL ID for it
 GLuint loadTexture2D(char const* aPath)
 {
-	stbi_set_flip_vertically_on_load(true);
-
-	int w, h, channels;
-	stbi_uc* ptr = stbi_load(aPath, &w, &h, &channels, 4);
-	if (!ptr)
-		throw Error("Unable to load image '%s'\n", aPath);
+	Image const image = loadImage(aPath);
 
 	GLuint textureID = 0;
 	glGenTextures(1, &textureID);
 	glBindTexture(GL_TEXTURE_2D, textureID);
 
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_SRGB8_ALPHA8, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, ptr);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_SRGB8_ALPHA8, image.width, image.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image.pixels.get());
 
 	glGenerateMipmap(GL_TEXTURE_2D);
 
+	setTextureParameters2D();
+
+	return textureID;
+}
+
+void Image::Deleter::operator()(unsigned char* aPixels) const
+{
+	stbi_image_free(aPixels);
+}
+
+Image loadImage(char const* aPath)
+{
+	// Per thread, so that images can be decoded on several threads at once
+	stbi_set_flip_vertically_on_load_thread(true);
+
+	Image ret{};
+	int channels;
+	ret.pixels.reset(stbi_load(aPath, &ret.width, &ret.height, &channels, 4));
+	if (!ret.pixels)
+		throw Error("Unable to load image '%s'\n", aPath);
+
+	return ret;
+}
+
+namespace
+{
+	// sRGB <-> linear; linear values are looked up with kLinearSteps_ steps,
+	// which is finer than the 8-bit sRGB steps everywhere
+	constexpr int kLinearSteps_ = 4096;
+
+	struct SrgbTables_
+	{
+		float toLinear[256];
+		unsigned char fromLinear[kLinearSteps_ + 1];
+
+		SrgbTables_()
+		{
+			for (int i = 0; i < 256; ++i)
+			{
+				float const c = i / 255.f;
+				toLinear[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+			}
+			for (int i = 0; i <= kLinearSteps_; ++i)
+			{
+				float const l = float(i) / kLinearSteps_;
+				float const c = l <= 0.0031308f ? 12.92f * l : 1.055f * std::pow(l, 1.f / 2.4f) - 0.055f;
+				fromLinear[i] = (unsigned char)std::lround(c * 255.f);
+			}
+		}
+	};
+
+	// Halves the size of an RGBA image (rounding down, at least 1)
+	void downsample_(unsigned char const* aIn, int aWidth, int aHeight, unsigned char* aOut, SrgbTables_ const& aTables)
+	{
+		int const width = aWidth > 1 ? aWidth / 2 : 1;
+		int const height = aHeight > 1 ? aHeight / 2 : 1;
+
+		for (int y = 0; y < height; ++y)
+		{
+			int const y0 = aHeight > 1 ? 2 * y : 0;
+			int const y1 = aHeight > 1 ? 2 * y + 1 : 0;
+			for (int x = 0; x < width; ++x)
+			{
+				int const x0 = aWidth > 1 ? 2 * x : 0;
+				int const x1 = aWidth > 1 ? 2 * x + 1 : 0;
+
+				unsigned char const* texels[4] = {
+					aIn + 4 * (std::size_t(y0) * aWidth + x0),
+					aIn + 4 * (std::size_t(y0) * aWidth + x1),
+					aIn + 4 * (std::size_t(y1) * aWidth + x0),
+					aIn + 4 * (std::size_t(y1) * aWidth + x1)
+				};
+
+				unsigned char* out = aOut + 4 * (std::size_t(y) * width + x);
+				for (int c = 0; c < 3; ++c)
+				{
+					float const sum = aTables.toLinear[texels[0][c]] + aTables.toLinear[texels[1][c]] + aTables.toLinear[texels[2][c]] + aTables.toLinear[texels[3][c]];
+					out[c] = aTables.fromLinear[std::lround(sum * (0.25f * kLinearSteps_))];
+				}
+
+				// Alpha is linear
+				out[3] = (unsigned char)((texels[0][3] + texels[1][3] + texels[2][3] + texels[3][3] + 2) / 4);
+			}
+		}
+	}
+}
+
+MipChain generateMipChain(Image const& aImage)
+{
+	static SrgbTables_ const tables;
+
+	MipChain ret;
+
+	// Sizes and offsets first, so that the pixels are allocated once
+	std::size_t size = 0;
+	for (int width = aImage.width, height = aImage.height; width > 1 || height > 1; )
+	{
+		width = width > 1 ? width / 2 : 1;
+		height = height > 1 ? height / 2 : 1;
+		ret.levels.push_back(MipChain::Level{ width, height, size });
+		size += std::size_t(width) * height * 4;
+	}
+
+	ret.pixels.resize(size);
+
+	unsigned char const* previous = aImage.pixels.get();
+	int previousWidth = aImage.width, previousHeight = aImage.height;
+	for (MipChain::Level const& level : ret.levels)
+	{
+		unsigned char* out = ret.pixels.data() + level.offset;
+		downsample_(previous, previousWidth, previousHeight, out, tables);
+
+		previous = out;
+		previousWidth = level.width;
+		previousHeight = level.height;
+	}
+
+	return ret;
+}
+
+GLsizei mipLevelCount(int aWidth, int aHeight)
+{
+	GLsizei levels = 1;
+	for (int size = aWidth > aHeight ? aWidth : aHeight; size > 1; size /= 2)
+	{
+		++levels;
+	}
+	return levels;
+}
+
+void setTextureParameters2D()
+{
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
 
@@ -29,6 +158,21 @@ GLuint loadTexture2D(char const* aPath)
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
 	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY, 6.f);
+}
+
+GLuint createSolidTexture2D(unsigned char aR, unsigned char aG, unsigned char aB, unsigned char aA)
+{
+	unsigned char const texel[4] = { aR, aG, aB, aA };
+
+	GLuint textureID = 0;
+	glGenTextures(1, &textureID);
+	glBindTexture(GL_TEXTURE_2D, textureID);
+
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_SRGB8_ALPHA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, texel);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 
+	glBindTexture(GL_TEXTURE_2D, 0);
 	return textureID;
 }
@@ -1,3 +1,56 @@
+#pragma once
+
 #include <glad.h>
 
+#include <vector>
+#include <memory>
+#include <cstddef>
+
 GLuint loadTexture2D(char const* aPath);
+
+// Decoded image, 8-bit RGBA, with the rows flipped so that the first one is
+// the bottom of the image (as glTexImage2D() expects). Loading only uses
+// the CPU and may run on any thread.
+struct Image
+{
+	struct Deleter
+	{
+		void operator()(unsigned char*) const;
+	};
+
+	int width;
+	int height;
+	std::unique_ptr<unsigned char[], Deleter> pixels;
+};
+
+Image loadImage(char const* aPath);
+
+// Mipmap levels 1, 2, ... of an image, down to 1x1, for an sRGB texture:
+// each texel averages (up to) 2x2 texels of the previous level in linear
+// space. The levels are stored one after the other in 'pixels'. Uses only
+// the CPU, like loadImage().
+struct MipChain
+{
+	struct Level
+	{
+		int width;
+		int height;
+		std::size_t offset;
+	};
+
+	std::vector<Level> levels;
+	std::vector<unsigned char> pixels;
+};
+
+MipChain generateMipChain(Image const&);
+
+// Number of mipmap levels of a full chain for the size
+GLsizei mipLevelCount(int aWidth, int aHeight);
+
+// Sets the filtering and wrapping used by the textures of loadTexture2D()
+// on the bound GL_TEXTURE_2D
+void setTextureParameters2D();
+
+// 1x1 texture of a single color, e.g., as placeholder for a texture that is
+// still loading
+GLuint createSolidTexture2D(unsigned char aR, unsigned char aG, unsigned char aB, unsigned char aA = 255);
@@ -1,113 +1,153 @@
 #pragma once
 
+#include <vector>
+
 #include "shapes.hpp"
+#include "mesh_builder.hpp"
 #include "loadobj.hpp"
-
-// VAOs and their respective vertex counts
-GLuint parlahtiVAO, launchpadVAO, spaceshipVAO;
-std::size_t parlahtiVertexCount, launchpadVertexCount, spaceshipVertexCount;
-
-// Create the VAOs for various meshes
-void makeVAOs()
+#include "mesh_cache.hpp"
+#include "asset_loader.hpp"
+
+#include "../vmlib/bounds.hpp"
+
+// VAOs and their respective vertex counts. The loaded meshes are indexed
+// (draw with glDrawElements), the spaceship is not. The loaded meshes' VAOs
+// are 0 until the AssetLoader has finished them.
+IndexedVAO parlahtiVAO, launchpadVAO;
+GLuint spaceshipVAO;
+std::size_t spaceshipVertexCount;
+
+// Vertex ranges of the parts of the spaceship in spaceshipVAO, in the order
+// cargo fairing, booster one, booster two, core stage
+constexpr std::size_t kSpaceshipPartCount = 4;
+std::vector<MeshPart> spaceshipParts;
+
+// The terrain is split into a grid of tiles that are culled separately,
+// each with its own chain of LODs (including the full resolution)
+constexpr MeshLoadOptions kTerrainOptions{ 8, 8, 6 };
+
+// Bounding boxes of the meshes, in model space (used for frustum culling)
+Aabb3f parlahtiBounds, launchpadBounds, spaceshipBounds;
+
+// Bounding boxes of the terrain tiles, parlahtiVAO.tiles[i].bounds, in one
+// array for batched culling
+std::vector<Aabb3f> parlahtiTileBounds;
+
+// Create the VAOs for various meshes. The spaceship is built right away;
+// the loaded meshes are requested from the loader, and their VAOs stay 0
+// (not drawn) until they are ready.
+void makeVAOs(AssetLoader& loader)
 {
 	// PI constant
 	constexpr float PI = 3.1415926f;
 
 	// Creating VBO's and VAO's
 
-	// Terrain VAO
-	SimpleMeshData parlahtiMesh = loadWavefrontOBJ("assets/parlahti.obj");
-	parlahtiVAO = createVAO(parlahtiMesh);
-	parlahtiVertexCount = parlahtiMesh.positions.size();
+	// Terrain VAO, in tiles with LODs
+	// (The OBJ files are only parsed when their binary cache is missing or
+	// out of date, see mesh_cache.hpp.)
+	loader.requestMesh("assets/parlahti.obj", kTerrainOptions, [] (LoadedMesh const& parlahti) {
+		parlahtiVAO = parlahti.vao;
+		parlahtiBounds = parlahti.bounds;
+
+		parlahtiTileBounds.clear();
+		for (MeshTile const& tile : parlahtiVAO.tiles)
+		{
+			parlahtiTileBounds.push_back(tile.bounds);
+		}
+	});
 
 	// Launchpad VAO
-	SimpleMeshData launchpadMesh = loadWavefrontOBJ("assets/landingpad.obj");
-	launchpadVAO = createVAO(launchpadMesh);
-	launchpadVertexCount = launchpadMesh.positions.size();
+	loader.requestMesh("assets/landingpad.obj", MeshLoadOptions{}, [] (LoadedMesh const& launchpad) {
+		launchpadVAO = launchpad.vao;
+		launchpadBounds = launchpad.bounds;
+	});
 
 	// Spaceship VAO
 	// (Based on NASA's SLS Block 2 Cargo spaceship)
+	// All shapes are generated straight into one set of vertex arrays, one
+	// part after the other
+	MeshBuilder ship(
+		2 * coneVertexCount(32) + cylinderVertexCount(32) + // cargo fairing
+		coneVertexCount(128) + 3 * coneVertexCount(32) + 2 * cylinderVertexCount(32) + // boosters
+		kPyramidVertexCount + cylinderVertexCount(32), // core stage
+		kSpaceshipPartCount
+	);
+
+	// Cargo fairing
+	// Made up of 1 cone, 1 upside down cone and 1 cylinder
+	ship.beginPart("cargo fairing");
+	appendCone(ship, 32, Vec3f{ 1.f, 1.f, 1.f },
+		make_rotation_z(270.f * (PI / 180.f)) *
+		make_translation(Vec3f{ 0.5f, 0.f, 0.f }) *
+		make_scaling(0.5f, 0.5f, 0.5f)
+	);
+	appendCylinder(ship, 32, Vec3f{ 1.f, 1.f, 1.f },
+		make_translation(Vec3f{ 0.f, -0.5f, 0.f }) *
+		make_rotation_z(90.f * (PI / 180.f)) *
+		make_scaling(1.f, 0.5f, 0.5f)
+	);
+	appendCone(ship, 32, Vec3f{ 1.f, 1.f, 1.f },
+		make_rotation_z(90.f * (PI / 180.f)) *
+		make_translation(Vec3f{ 0.5f, 0.f, 0.f }) *
+		make_scaling(0.5f, 0.5f, 0.5f)
+	);
 
 	// Advanced boosters (x2)
 	// Made up of 2 cones and 1 cylinder
-	TexturelessSimpleMeshData boosterConeOne = makeCone(128, Vec3f{ 1.f, 1.f, 1.f },
+	ship.beginPart("booster one");
+	appendCone(ship, 128, Vec3f{ 1.f, 1.f, 1.f },
 		make_translation(Vec3f{ -0.5f, -5.1f, 0.f }) *
 		make_rotation_z(90.f * (PI / 180.f)) *
 		make_scaling(0.1f, 0.1f, 0.1f)
 	);
-	TexturelessSimpleMeshData mainCylinderOne = makeCylinder(32, Vec3f{ 1.f, 1.f, 1.f },
+	appendCylinder(ship, 32, Vec3f{ 1.f, 1.f, 1.f },
 		make_translation(Vec3f{ -0.5f, -5.f, 0.f }) *
 		make_rotation_z(90.f * (PI / 180.f)) *
 		make_scaling(4.f, 0.1f, 0.1f) // the x-axis is now the axis pointing up due to the rotation
 	);
-	TexturelessSimpleMeshData topConeOne = makeCone(32, Vec3f{ 1.f, 1.f, 1.f },
+	appendCone(ship, 32, Vec3f{ 1.f, 1.f, 1.f },
 		make_translation(Vec3f{ -0.5f, -1.f, 0.f }) *
 		make_rotation_z(90.f * (PI / 180.f)) *
 		make_scaling(0.2f, 0.1f, 0.1f)
 	);
 
-	TexturelessSimpleMeshData boosterOne = concatenate(std::move(concatenate(std::move(boosterConeOne), mainCylinderOne)), topConeOne);
-
-	TexturelessSimpleMeshData boosterConeTwo = makeCone(32, Vec3f{ .8f, .8f, .8f },
+	ship.beginPart("booster two");
+	appendCone(ship, 32, Vec3f{ .8f, .8f, .8f },
 		make_translation(Vec3f{ 0.5f, -5.1f, 0.f }) *
 		make_rotation_z(90.f * (PI / 180.f)) *
 		make_scaling(0.1f, 0.1f, 0.1f)
 	);
-	TexturelessSimpleMeshData mainCylinderTwo = makeCylinder(32, Vec3f{ 1.f, 1.f, 1.f },
+	appendCylinder(ship, 32, Vec3f{ 1.f, 1.f, 1.f },
 		make_translation(Vec3f{ 0.5f, -5.f, 0.f }) *
 		make_rotation_z(90.f * (PI / 180.f)) *
 		make_scaling(4.f, 0.1f, 0.1f) // the x-axis is now the axis pointing up due to the rotation
 	);
-	TexturelessSimpleMeshData topConeTwo = makeCone(32, Vec3f{ 1.f, 1.f, 1.f },
+	appendCone(ship, 32, Vec3f{ 1.f, 1.f, 1.f },
 		make_translation(Vec3f{ 0.5f, -1.f, 0.f }) *
 		make_rotation_z(90.f * (PI / 180.f)) *
 		make_scaling(0.2f, 0.1f, 0.1f)
 	);
 
-	TexturelessSimpleMeshData boosterTwo = concatenate(std::move(concatenate(std::move(boosterConeTwo), mainCylinderTwo)), topConeTwo);
-
-	TexturelessSimpleMeshData boosters = concatenate(std::move(boosterOne), boosterTwo);
-
 	// Core Stage and Interstage
 	// Made up of 1 cylinder and 1 pyramid (for the engine, yes its a cone in real life but need
 	// for 3 different shape requirement)
-	TexturelessSimpleMeshData engineCone = makePyramid(Vec3f{ .8f, .8f, .8f },
+	ship.beginPart("core stage");
+	appendPyramid(ship, Vec3f{ .8f, .8f, .8f },
 		make_translation(Vec3f{ 0.f, -5.1f, 0.f }) *
 		make_scaling(0.3f, 0.3f, 0.3f)
 	);
-	TexturelessSimpleMeshData coreCylinder = makeCylinder(32, Vec3f{ .7f, .4f, 0.f },
+	appendCylinder(ship, 32, Vec3f{ .7f, .4f, 0.f },
 		make_translation(Vec3f{ 0.f, -5.f, 0.f }) *
 		make_rotation_z(90.f * (PI / 180.f)) *
 		make_scaling(5.f, 0.4f, 0.4f)
 	);
 
-	TexturelessSimpleMeshData coreStage = concatenate(std::move(engineCone), coreCylinder);
-
-	// Cargo fairing
-	// Made up of 1 cone, 1 upside down cone and 1 cylinder
-	TexturelessSimpleMeshData upsideCone = makeCone(32, Vec3f{ 1.f, 1.f, 1.f },
-		make_rotation_z(270.f * (PI / 180.f)) *
-		make_translation(Vec3f{ 0.5f, 0.f, 0.f }) *
-		make_scaling(0.5f, 0.5f, 0.5f)
-	);
-	TexturelessSimpleMeshData fairingCylinder = makeCylinder(32, Vec3f{ 1.f, 1.f, 1.f },
-		make_translation(Vec3f{ 0.f, -0.5f, 0.f }) *
-		make_rotation_z(90.f * (PI / 180.f)) *
-		make_scaling(1.f, 0.5f, 0.5f)
-	);
-	TexturelessSimpleMeshData tipCone = makeCone(32, Vec3f{ 1.f, 1.f, 1.f },
-		make_rotation_z(90.f * (PI / 180.f)) *
-		make_translation(Vec3f{ 0.5f, 0.f, 0.f }) *
-		make_scaling(0.5f, 0.5f, 0.5f)
-	);
-
-	TexturelessSimpleMeshData coneFairing = concatenate(std::move(concatenate(std::move(upsideCone), fairingCylinder)), tipCone);
-	TexturelessSimpleMeshData boosterAndEngine = concatenate(std::move(boosters), coreStage);
-
-	TexturelessSimpleMeshData entireShip = concatenate(std::move(coneFairing), boosterAndEngine);
+	TexturelessSimpleMeshData entireShip = ship.release(&spaceshipParts);
 
 	spaceshipVAO = createVAO(entireShip);
 	spaceshipVertexCount = entireShip.positions.size();
+	spaceshipBounds = make_aabb(entireShip.positions.data(), entireShip.positions.size());
 }
 
 // Arbitrary vertex data for a rectangle
@@ -0,0 +1,120 @@
+#include "vertex_layout_bench.hpp"
+
+#include <limits>
+#include <algorithm>
+
+#include <cstdio>
+
+#include "../vmlib/mat44.hpp"
+
+#include "defaults.hpp"
+#include "loadobj.hpp"
+#include "simple_mesh.hpp"
+
+namespace
+{
+	constexpr int kUploadRepeats_ = 20;
+	constexpr int kDrawRounds_ = 10;
+	constexpr int kDrawsPerRound_ = 50;
+
+	struct Result_
+	{
+		double uploadMs;
+		double drawMs;
+	};
+
+	struct Meshes_
+	{
+		IndexedMeshData indexed;
+		QuantizedMeshData quantized;
+	};
+
+	using CreateFn_ = IndexedVAO (*)(Meshes_ const&);
+
+	Result_ measure_(Meshes_ const& aMeshes, CreateFn_ aCreate, GLuint aProgram)
+	{
+		Result_ ret{ std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity() };
+
+		// Upload
+		IndexedVAO vao{};
+		for (int i = 0; i < kUploadRepeats_; ++i)
+		{
+			if (0 != vao.vao)
+			{
+				glDeleteVertexArrays(1, &vao.vao);
+			}
+
+			glFinish();
+			auto const start = Clock::now();
+
+			vao = aCreate(aMeshes);
+			glFinish();
+
+			auto const ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+			ret.uploadMs = std::min(ret.uploadMs, ms);
+		}
+
+		// Draw
+		glUseProgram(aProgram);
+		glUniformMatrix4fv(0, 1, GL_FALSE, kIdentity44f.v);
+		setVertexFormatUniforms(aProgram, vao.format);
+		glBindVertexArray(vao.vao);
+
+		GLuint query = 0;
+		glGenQueries(1, &query);
+
+		for (int round = 0; round < kDrawRounds_; ++round)
+		{
+			glBeginQuery(GL_TIME_ELAPSED, query);
+			for (int i = 0; i < kDrawsPerRound_; ++i)
+			{
+				glDrawElements(GL_TRIANGLES, vao.indexCount, vao.indexType, nullptr);
+			}
+			glEndQuery(GL_TIME_ELAPSED);
+
+			// Waits for the result
+			GLuint64 ns = 0;
+			glGetQueryObjectui64v(query, GL_QUERY_RESULT, &ns);
+			ret.drawMs = std::min(ret.drawMs, ns * 1e-6 / kDrawsPerRound_);
+		}
+
+		glDeleteQueries(1, &query);
+		setVertexFormatUniforms(aProgram, kFloatVertexFormat);
+		glBindVertexArray(0);
+		glUseProgram(0);
+		glDeleteVertexArrays(1, &vao.vao);
+
+		return ret;
+	}
+}
+
+void runVertexLayoutBenchmark(char const* aObjPath, GLuint aProgram)
+{
+	Meshes_ meshes;
+	meshes.indexed = makeIndexed(loadWavefrontOBJ(aObjPath));
+	meshes.quantized = quantizeMesh(meshes.indexed);
+
+	std::size_t const triangles = meshes.indexed.indices.size() / 3;
+	std::printf("%s: %zu vertices, %zu triangles\n", aObjPath, meshes.indexed.vertices.positions.size(), triangles);
+
+	struct
+	{
+		CreateFn_ create;
+		char const* name;
+	} const layouts[] = {
+		{ [] (Meshes_ const& aM) { return createVAO(aM.indexed, VertexLayout::separate); }, "separate" },
+		{ [] (Meshes_ const& aM) { return createVAO(aM.indexed, VertexLayout::interleaved); }, "interleaved" },
+		{ [] (Meshes_ const& aM) { return createVAO(aM.quantized); }, "quantized" }
+	};
+
+	for (auto const& layout : layouts)
+	{
+		Result_ const res = measure_(meshes, layout.create, aProgram);
+		std::printf("  %-12s upload %8.3f ms   draw %8.3f ms (%.1f Mtris/s)\n",
+			layout.name,
+			res.uploadMs,
+			res.drawMs,
+			res.drawMs > 0.0 ? triangles / (res.drawMs * 1e3) : 0.0
+		);
+	}
+}
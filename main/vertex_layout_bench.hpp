@@ -0,0 +1,21 @@
+// Benchmark for the vertex buffer layouts (see VertexLayout in simple_mesh.hpp)
+// and the quantized vertex format (QuantizedVertex)
+//
+// Started with
+//
+//	main --bench-vertex-layout [path/to/mesh.obj]
+//
+// Loads the mesh (by default the terrain), and for each layout measures
+//  - upload: CPU time of createVAO() until the GL has finished (glFinish()),
+//  - draw: GPU time per glDrawElements() of the whole mesh, measured with
+//    GL_TIME_ELAPSED queries.
+// The draws use an identity transform, so most of the terrain is clipped and
+// the vertex stage (including vertex fetch) dominates. Each value is the
+// best of several repetitions. Results are printed to stdout.
+#pragma once
+
+#include <glad.h>
+
+// aProgram must accept attributes 0-3, a mat4 uniform at location 0 and the
+// vertex format uniforms (e.g., assets/default.vert).
+void runVertexLayoutBenchmark(char const* aObjPath, GLuint aProgram);
@@ -150,4 +150,22 @@ project "vmlib-test"
 
 	files( sources )
 
+project "vmlib-bench"
+	local sources = { 
+		"vmlib-bench/**.cpp",
+		"vmlib-bench/**.hpp",
+		"vmlib-bench/**.hxx",
+		"vmlib-bench/**.inl"
+	}
+
+	kind "ConsoleApp"
+	location "vmlib-bench"
+
+	files( sources )
+
+	links "vmlib"
+	links "support"
+
+	files( sources )
+
 --EOF
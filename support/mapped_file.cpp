@@ -0,0 +1,133 @@
+#include "mapped_file.hpp"
+
+#include <utility>
+
+#include "error.hpp"
+
+#if defined(_WIN32)
+#	define WIN32_LEAN_AND_MEAN
+#	define NOMINMAX
+#	include <windows.h>
+#else
+#	include <fcntl.h>
+#	include <unistd.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#endif
+
+namespace
+{
+	void unmap_( void const* aData, std::size_t aSize ) noexcept
+	{
+		if( !aData )
+			return;
+
+#		if defined(_WIN32)
+		(void)aSize;
+		UnmapViewOfFile( aData );
+#		else
+		munmap( const_cast<void*>(aData), aSize );
+#		endif
+	}
+}
+
+MappedFile::MappedFile() noexcept
+	: mData( nullptr )
+	, mSize( 0 )
+{}
+
+#if defined(_WIN32)
+MappedFile::MappedFile( char const* aPath )
+	: mData( nullptr )
+	, mSize( 0 )
+{
+	HANDLE const file = CreateFileA( aPath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+	if( INVALID_HANDLE_VALUE == file )
+		throw Error( "Unable to open '%s' for mapping: error %lu", aPath, GetLastError() );
+
+	LARGE_INTEGER size;
+	if( !GetFileSizeEx( file, &size ) )
+	{
+		auto const err = GetLastError();
+		CloseHandle( file );
+		throw Error( "Unable to query size of '%s': error %lu", aPath, err );
+	}
+
+	mSize = std::size_t(size.QuadPart);
+	if( 0 == mSize )
+	{
+		CloseHandle( file );
+		return;
+	}
+
+	// The view keeps the mapping alive; both handles can be closed
+	HANDLE const mapping = CreateFileMappingA( file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+	CloseHandle( file );
+	if( !mapping )
+		throw Error( "Unable to map '%s': error %lu", aPath, GetLastError() );
+
+	mData = MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+	auto const err = GetLastError();
+	CloseHandle( mapping );
+
+	if( !mData )
+		throw Error( "Unable to map '%s': error %lu", aPath, err );
+}
+#else // POSIX
+MappedFile::MappedFile( char const* aPath )
+	: mData( nullptr )
+	, mSize( 0 )
+{
+	int const fd = open( aPath, O_RDONLY );
+	if( -1 == fd )
+		throw Error( "Unable to open '%s' for mapping", aPath );
+
+	struct stat st;
+	if( -1 == fstat( fd, &st ) )
+	{
+		close( fd );
+		throw Error( "Unable to query size of '%s'", aPath );
+	}
+
+	mSize = std::size_t(st.st_size);
+	if( 0 == mSize )
+	{
+		close( fd );
+		return;
+	}
+
+	// The mapping stays valid after the descriptor is closed
+	void* const ptr = mmap( nullptr, mSize, PROT_READ, MAP_PRIVATE, fd, 0 );
+	close( fd );
+
+	if( MAP_FAILED == ptr )
+		throw Error( "Unable to map '%s'", aPath );
+
+	mData = ptr;
+}
+#endif // ~ POSIX
+
+MappedFile::~MappedFile()
+{
+	unmap_( mData, mSize );
+}
+
+MappedFile::MappedFile( MappedFile&& aOther ) noexcept
+	: mData( std::exchange( aOther.mData, nullptr ) )
+	, mSize( std::exchange( aOther.mSize, 0 ) )
+{}
+MappedFile& MappedFile::operator= (MappedFile&& aOther) noexcept
+{
+	std::swap( mData, aOther.mData );
+	std::swap( mSize, aOther.mSize );
+	return *this;
+}
+
+void const* MappedFile::data() const noexcept
+{
+	return mData;
+}
+std::size_t MappedFile::size() const noexcept
+{
+	return mSize;
+}
@@ -0,0 +1,36 @@
+#ifndef MAPPED_FILE_HPP_685A0B63_A024_4EC2_9445_838819867077
+#define MAPPED_FILE_HPP_685A0B63_A024_4EC2_9445_838819867077
+
+#include <cstddef>
+
+// Read-only memory mapping of a whole file (mmap() on POSIX systems,
+// CreateFileMapping() on Windows). The pages are loaded by the OS on first
+// access, so mapping a file is cheap even if it is large; the contents can
+// be handed to e.g. glBufferData() directly.
+//
+// Throws Error if the file cannot be opened or mapped. Empty files can be
+// mapped; data() is then nullptr.
+class MappedFile final
+{
+	public:
+		MappedFile() noexcept;
+		explicit MappedFile( char const* aPath );
+
+		~MappedFile();
+
+		MappedFile( MappedFile const& ) = delete;
+		MappedFile& operator= (MappedFile const&) = delete;
+
+		MappedFile( MappedFile&& ) noexcept;
+		MappedFile& operator= (MappedFile&&) noexcept;
+
+	public:
+		void const* data() const noexcept;
+		std::size_t size() const noexcept;
+
+	private:
+		void const* mData;
+		std::size_t mSize;
+};
+
+#endif // MAPPED_FILE_HPP_685A0B63_A024_4EC2_9445_838819867077
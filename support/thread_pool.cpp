@@ -0,0 +1,144 @@
+#include "thread_pool.hpp"
+
+#include <algorithm>
+
+namespace
+{
+	// Set on the pool's worker threads, and on threads that are inside
+	// parallel_for(); nested loops run serially.
+	thread_local bool tInsideLoop_ = false;
+}
+
+ThreadPool::ThreadPool( std::size_t aThreadCount )
+	: mGeneration( 0 )
+	, mActive( 0 )
+	, mStop( false )
+	, mFunc( nullptr )
+	, mContext( nullptr )
+	, mCount( 0 )
+	, mGrain( 1 )
+	, mNext( 0 )
+{
+	if( 0 == aThreadCount )
+		aThreadCount = std::max( 1u, std::thread::hardware_concurrency() );
+
+	// The calling thread is one of the aThreadCount
+	for( std::size_t i = 1; i < aThreadCount; ++i )
+		mWorkers.emplace_back( [this] { worker_(); } );
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		mStop = true;
+	}
+	mWake.notify_all();
+
+	for( auto& worker : mWorkers )
+		worker.join();
+}
+
+std::size_t ThreadPool::thread_count() const noexcept
+{
+	return mWorkers.size() + 1;
+}
+
+void ThreadPool::run_( std::size_t aCount, std::size_t aGrain, RangeFn_ aFunc, void* aContext )
+{
+	// Serial: nested loops, single-threaded pools and single chunks
+	if( tInsideLoop_ || mWorkers.empty() || aCount <= aGrain )
+	{
+		for( std::size_t begin = 0; begin < aCount; begin += aGrain )
+			aFunc( aContext, begin, std::min( begin + aGrain, aCount ) );
+		return;
+	}
+
+	std::lock_guard<std::mutex> submit( mSubmitMutex );
+	tInsideLoop_ = true;
+
+	{
+		// Workers that woke up late for the previous loop may still be
+		// looking at it
+		std::unique_lock<std::mutex> lock( mMutex );
+		mDone.wait( lock, [this] { return 0 == mActive; } );
+
+		mFunc = aFunc;
+		mContext = aContext;
+		mCount = aCount;
+		mGrain = aGrain;
+		mNext.store( 0, std::memory_order_relaxed );
+		mError = nullptr;
+		++mGeneration;
+	}
+	mWake.notify_all();
+
+	execute_();
+
+	std::exception_ptr error;
+	{
+		std::unique_lock<std::mutex> lock( mMutex );
+		mDone.wait( lock, [this] { return 0 == mActive; } );
+		error = mError;
+		mError = nullptr;
+	}
+
+	tInsideLoop_ = false;
+
+	if( error )
+		std::rethrow_exception( error );
+}
+
+void ThreadPool::execute_() noexcept
+{
+	for( ;; )
+	{
+		std::size_t const begin = mNext.fetch_add( mGrain, std::memory_order_relaxed );
+		if( begin >= mCount )
+			return;
+
+		try
+		{
+			mFunc( mContext, begin, std::min( begin + mGrain, mCount ) );
+		}
+		catch( ... )
+		{
+			// Skip the remaining chunks
+			mNext.store( mCount, std::memory_order_relaxed );
+
+			std::lock_guard<std::mutex> lock( mMutex );
+			if( !mError )
+				mError = std::current_exception();
+		}
+	}
+}
+
+void ThreadPool::worker_() noexcept
+{
+	tInsideLoop_ = true;
+
+	std::uint64_t seen = 0;
+	for( ;; )
+	{
+		std::unique_lock<std::mutex> lock( mMutex );
+		mWake.wait( lock, [&] { return mStop || mGeneration != seen; } );
+		if( mStop )
+			return;
+
+		seen = mGeneration;
+		++mActive;
+		lock.unlock();
+
+		execute_();
+
+		lock.lock();
+		if( 0 == --mActive )
+			mDone.notify_all();
+	}
+}
+
+ThreadPool& default_thread_pool()
+{
+	static ThreadPool pool;
+	return pool;
+}
@@ -0,0 +1,88 @@
+#ifndef THREAD_POOL_HPP_E14452B6_B965_4DD9_9339_545766A141A1
+#define THREAD_POOL_HPP_E14452B6_B965_4DD9_9339_545766A141A1
+
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <condition_variable>
+
+// Fixed set of worker threads for data-parallel loops.
+//
+// parallel_for( count, grain, func ) splits [0, count) into chunks of
+// (at most) grain elements and calls func( begin, end ) for each chunk, on
+// the workers and on the calling thread. It returns once all chunks are
+// done. The chunks may run in any order and on any thread, so func must
+// only write to data that belongs to its range.
+//
+// If func throws, the remaining chunks are skipped and the first exception
+// is rethrown by parallel_for(). Calls from within func (nested loops) run
+// serially on the calling thread. Calls from several threads at once are
+// serialized.
+class ThreadPool final
+{
+	public:
+		// aThreadCount is the number of threads that work on a loop,
+		// including the calling thread; 0 selects one per hardware thread.
+		explicit ThreadPool( std::size_t aThreadCount = 0 );
+		~ThreadPool();
+
+		ThreadPool( ThreadPool const& ) = delete;
+		ThreadPool& operator= (ThreadPool const&) = delete;
+
+	public:
+		std::size_t thread_count() const noexcept;
+
+		template< class tFunc >
+		void parallel_for( std::size_t aCount, std::size_t aGrain, tFunc&& aFunc );
+
+	private:
+		using RangeFn_ = void (*)( void*, std::size_t, std::size_t );
+
+		void run_( std::size_t aCount, std::size_t aGrain, RangeFn_, void* );
+		void execute_() noexcept;
+		void worker_() noexcept;
+
+	private:
+		std::vector<std::thread> mWorkers;
+
+		std::mutex mSubmitMutex; // one loop at a time
+
+		std::mutex mMutex;
+		std::condition_variable mWake;
+		std::condition_variable mDone;
+		std::uint64_t mGeneration;
+		std::size_t mActive; // workers inside execute_()
+		bool mStop;
+
+		// Current loop; written under mMutex while mActive is zero
+		RangeFn_ mFunc;
+		void* mContext;
+		std::size_t mCount;
+		std::size_t mGrain;
+		std::atomic<std::size_t> mNext;
+		std::exception_ptr mError;
+};
+
+// Pool shared by the application, with one thread per hardware thread.
+// Created on first use.
+ThreadPool& default_thread_pool();
+
+
+template< class tFunc > inline
+void ThreadPool::parallel_for( std::size_t aCount, std::size_t aGrain, tFunc&& aFunc )
+{
+	if( 0 == aCount )
+		return;
+
+	auto const call = [] (void* aContext, std::size_t aBegin, std::size_t aEnd) {
+		(*static_cast<std::remove_reference_t<tFunc>*>(aContext))( aBegin, aEnd );
+	};
+
+	run_( aCount, aGrain > 0 ? aGrain : 1, call, &aFunc );
+}
+
+#endif // THREAD_POOL_HPP_E14452B6_B965_4DD9_9339_545766A141A1
@@ -0,0 +1,76 @@
+#include "harness.hpp"
+
+#include <vector>
+
+#include "../vmlib/batch_transform.hpp"
+
+namespace
+{
+	using bench::kArraySize;
+
+	std::vector<Vec3f> random_points_( unsigned aSeed )
+	{
+		auto const values = bench::random_floats( 3*kArraySize, -1.f, 1.f, aSeed );
+
+		std::vector<Vec3f> ret( kArraySize );
+		for( std::size_t i = 0; i < kArraySize; ++i )
+			ret[i] = Vec3f{ values[i*3+0], values[i*3+1], values[i*3+2] };
+		return ret;
+	}
+
+	Mat44f const kM = make_perspective_projection( 1.f, 1.5f, 0.1f, 100.f )
+		* make_translation( { 1.f, 2.f, -10.f } ) * make_rotation_y( 0.3f );
+	Mat44f const kAffine = make_translation( { 1.f, 2.f, 3.f } ) * make_rotation_y( 0.3f ) * make_scaling( 2.f, 1.f, 3.f );
+	Mat33f const kN = mat44_to_mat33( kAffine );
+
+	std::vector<Vec3f> const gIn = random_points_( 20 );
+	std::vector<Vec4f> const gIn4 = [] {
+		std::vector<Vec4f> ret;
+		for( auto const& p : gIn )
+			ret.emplace_back( Vec4f{ p.x, p.y, p.z, 1.f } );
+		return ret;
+	}();
+
+	std::vector<Vec3f> gOut( kArraySize );
+	std::vector<Vec4f> gOut4( kArraySize );
+
+	template< class tFunc > inline
+	void repeat_( std::size_t aIterations, tFunc&& aFunc )
+	{
+		for( std::size_t it = 0; it < aIterations; ++it )
+		{
+			aFunc();
+			bench::clobber_memory();
+		}
+	}
+
+	bench::Registrar const kBenchmarks_{
+		{ "transform_points", "scalar", kArraySize, [] (std::size_t aIt) {
+			repeat_( aIt, [] { detail::transform_points_scalar( kM, gIn.data(), gOut.data(), kArraySize ); } );
+		} },
+		{ "transform_points", "simd", kArraySize, [] (std::size_t aIt) {
+			repeat_( aIt, [] { transform_points( kM, gIn.data(), gOut.data(), kArraySize ); } );
+		} },
+
+		{ "transform_points_affine", "scalar", kArraySize, [] (std::size_t aIt) {
+			repeat_( aIt, [] { detail::transform_points_affine_scalar( kAffine, gIn.data(), gOut.data(), kArraySize ); } );
+		} },
+		{ "transform_points_affine", "simd", kArraySize, [] (std::size_t aIt) {
+			repeat_( aIt, [] { transform_points_affine( kAffine, gIn.data(), gOut.data(), kArraySize ); } );
+		} },
+
+		{ "transform_normals", "scalar", kArraySize, [] (std::size_t aIt) {
+			repeat_( aIt, [] { detail::transform_normals_scalar( kN, gIn.data(), gOut.data(), kArraySize ); } );
+		} },
+		{ "transform_normals", "simd", kArraySize, [] (std::size_t aIt) {
+			repeat_( aIt, [] { transform_normals( kN, gIn.data(), gOut.data(), kArraySize ); } );
+		} },
+
+		{ "transform_vec4", "scalar", kArraySize, [] (std::size_t aIt) {
+			repeat_( aIt, [] { detail::transform_vec4_scalar( kM, gIn4.data(), gOut4.data(), kArraySize ); } );
+		} },
+		{ "transform_vec4", "simd", kArraySize, [] (std::size_t aIt) {
+			repeat_( aIt, [] { transform_vec4( kM, gIn4.data(), gOut4.data(), kArraySize ); } );
+		} },
+	};
+}
@@ -0,0 +1,63 @@
+#include "harness.hpp"
+
+#include <vector>
+#include <algorithm>
+
+#include "../vmlib/bounds.hpp"
+
+namespace
+{
+	using bench::kArraySize;
+
+	// Boxes scattered around the camera; roughly a quarter of them are
+	// visible.
+	std::vector<Aabb3f> random_boxes_( unsigned aSeed )
+	{
+		auto const pos = bench::random_floats( 3*kArraySize, -100.f, 100.f, aSeed );
+		auto const ext = bench::random_floats( 3*kArraySize, 0.f, 5.f, aSeed+1 );
+
+		std::vector<Aabb3f> ret( kArraySize );
+		for( std::size_t i = 0; i < kArraySize; ++i )
+		{
+			Vec3f const c{ pos[i*3+0], pos[i*3+1], pos[i*3+2] };
+			Vec3f const e{ ext[i*3+0], ext[i*3+1], ext[i*3+2] };
+			ret[i] = Aabb3f{ c - e, c + e };
+		}
+		return ret;
+	}
+
+	Frustumf const kFrustum = make_frustum(
+		make_perspective_projection( 1.f, 16.f/9.f, 0.1f, 200.f )
+		* look_at( Vec3f{ 0.f, 0.f, 0.f }, Vec3f{ 0.f, 0.f, -1.f }, Vec3f{ 0.f, 1.f, 0.f } )
+	);
+
+	std::vector<Aabb3f> const gBoxes = random_boxes_( 60 );
+	std::vector<std::uint64_t> gVisible( cull_word_count( kArraySize ) );
+
+	template< class tFunc > inline
+	void repeat_( std::size_t aIterations, tFunc&& aFunc )
+	{
+		for( std::size_t it = 0; it < aIterations; ++it )
+		{
+			aFunc();
+			bench::clobber_memory();
+		}
+	}
+
+	bench::Registrar const kBenchmarks_{
+		// One intersects() call per box
+		{ "frustum_cull", "per_box", kArraySize, [] (std::size_t aIt) {
+			repeat_( aIt, [] {
+				std::fill( gVisible.begin(), gVisible.end(), 0 );
+				for( std::size_t i = 0; i < kArraySize; ++i )
+					gVisible[i / 64] |= std::uint64_t(intersects( kFrustum, gBoxes[i] )) << (i % 64);
+			} );
+		} },
+		{ "frustum_cull", "scalar", kArraySize, [] (std::size_t aIt) {
+			repeat_( aIt, [] { detail::cull_scalar( kFrustum, gBoxes.data(), kArraySize, gVisible.data() ); } );
+		} },
+		{ "frustum_cull", "simd", kArraySize, [] (std::size_t aIt) {
+			repeat_( aIt, [] { cull( kFrustum, gBoxes.data(), kArraySize, gVisible.data() ); } );
+		} },
+	};
+}
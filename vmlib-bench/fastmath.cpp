@@ -0,0 +1,105 @@
+#include "harness.hpp"
+
+#include <cmath>
+#include <vector>
+
+#include "../vmlib/fastmath.hpp"
+
+namespace
+{
+	using bench::kArraySize;
+
+	std::vector<float> const gAngles = bench::random_floats( kArraySize, -10.f, 10.f, 50 );
+	std::vector<float> const gCosines = bench::random_floats( kArraySize, -1.f, 1.f, 51 );
+	std::vector<float> const gCoords = bench::random_floats( 3*kArraySize, -1.f, 1.f, 52 );
+
+	std::vector<float> gOutA( kArraySize );
+	std::vector<float> gOutB( kArraySize );
+	std::vector<Vec3f> gOutV( kArraySize );
+
+	Vec3f point_( std::size_t aI )
+	{
+		return Vec3f{ gCoords[aI*3+0], gCoords[aI*3+1], gCoords[aI*3+2] + 2.f };
+	}
+
+	template< class tFunc > inline
+	void for_each_( std::size_t aIterations, tFunc&& aFunc )
+	{
+		for( std::size_t it = 0; it < aIterations; ++it )
+		{
+			for( std::size_t i = 0; i < kArraySize; ++i )
+				aFunc( i );
+
+			bench::clobber_memory();
+		}
+	}
+
+#	if !VMLIB_SIMD_NONE
+	// Process the arrays with the widest SIMD type.
+#	if VMLIB_SIMD_AVX
+	using Wide_ = simd::F32x8;
+#	else
+	using Wide_ = simd::F32x4;
+#	endif
+	constexpr std::size_t kWidth_ = sizeof(Wide_) / sizeof(float);
+
+	template< class tFunc > inline
+	void for_each_simd_( std::size_t aIterations, tFunc&& aFunc )
+	{
+		static_assert( kArraySize % kWidth_ == 0 );
+		for( std::size_t it = 0; it < aIterations; ++it )
+		{
+			for( std::size_t i = 0; i < kArraySize; i += kWidth_ )
+				aFunc( i );
+
+			bench::clobber_memory();
+		}
+	}
+#	endif // ~ !VMLIB_SIMD_NONE
+
+	bench::Registrar const kBenchmarks_{
+		// sin + cos of the same angle, e.g., for points on a circle
+		{ "sincos", "std", kArraySize, [] (std::size_t aIt) {
+			for_each_( aIt, [] (std::size_t i) {
+				gOutA[i] = std::sin( gAngles[i] );
+				gOutB[i] = std::cos( gAngles[i] );
+			} );
+		} },
+		{ "sincos", "fast", kArraySize, [] (std::size_t aIt) {
+			for_each_( aIt, [] (std::size_t i) {
+				sincos_fast( gAngles[i], gOutA[i], gOutB[i] );
+			} );
+		} },
+#		if !VMLIB_SIMD_NONE
+		{ "sincos", "fast_simd", kArraySize, [] (std::size_t aIt) {
+			for_each_simd_( aIt, [] (std::size_t i) {
+				Wide_ s, c;
+				simd::sincos_fast( simd::load<Wide_>( gAngles.data()+i ), s, c );
+				simd::store( gOutA.data()+i, s );
+				simd::store( gOutB.data()+i, c );
+			} );
+		} },
+#		endif // ~ !VMLIB_SIMD_NONE
+
+		{ "acos", "std", kArraySize, [] (std::size_t aIt) {
+			for_each_( aIt, [] (std::size_t i) { gOutA[i] = std::acos( gCosines[i] ); } );
+		} },
+		{ "acos", "fast", kArraySize, [] (std::size_t aIt) {
+			for_each_( aIt, [] (std::size_t i) { gOutA[i] = acos_fast( gCosines[i] ); } );
+		} },
+#		if !VMLIB_SIMD_NONE
+		{ "acos", "fast_simd", kArraySize, [] (std::size_t aIt) {
+			for_each_simd_( aIt, [] (std::size_t i) {
+				simd::store( gOutA.data()+i, simd::acos_fast( simd::load<Wide_>( gCosines.data()+i ) ) );
+			} );
+		} },
+#		endif // ~ !VMLIB_SIMD_NONE
+
+		{ "normalize", "std", kArraySize, [] (std::size_t aIt) {
+			for_each_( aIt, [] (std::size_t i) { gOutV[i] = normalize( point_( i ) ); } );
+		} },
+		{ "normalize", "fast", kArraySize, [] (std::size_t aIt) {
+			for_each_( aIt, [] (std::size_t i) { gOutV[i] = normalize_fast( point_( i ) ); } );
+		} },
+	};
+}
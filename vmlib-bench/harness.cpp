@@ -0,0 +1,191 @@
+#include "harness.hpp"
+
+#include <chrono>
+#include <random>
+#include <algorithm>
+
+#include "../vmlib/simd.hpp"
+
+namespace bench
+{
+	namespace
+	{
+		std::vector<Benchmark>& registry_()
+		{
+			// Function-local static: registration happens during static
+			// initialization of the other translation units.
+			static std::vector<Benchmark> benchmarks;
+			return benchmarks;
+		}
+
+		double time_( Benchmark const& aBench, std::size_t aIterations )
+		{
+			using Clock_ = std::chrono::steady_clock;
+
+			auto const t0 = Clock_::now();
+			aBench.body( aIterations );
+			clobber_memory();
+			auto const t1 = Clock_::now();
+
+			return std::chrono::duration<double>( t1 - t0 ).count();
+		}
+
+		std::string escape_json_( std::string const& aStr )
+		{
+			std::string ret;
+			for( char const c : aStr )
+			{
+				if( '"' == c || '\\' == c )
+					ret += '\\';
+				ret += c;
+			}
+			return ret;
+		}
+	}
+
+	Registrar::Registrar( std::initializer_list<Benchmark> aBenchmarks )
+	{
+		for( auto const& b : aBenchmarks )
+			registry_().emplace_back( b );
+	}
+	Registrar::Registrar( std::vector<Benchmark> const& aBenchmarks )
+	{
+		for( auto const& b : aBenchmarks )
+			registry_().emplace_back( b );
+	}
+
+	std::vector<Benchmark> const& registered()
+	{
+		return registry_();
+	}
+
+	std::vector<Result> run( Options const& aOptions )
+	{
+		std::vector<Result> results;
+		for( auto const& bench : registry_() )
+		{
+			std::string const id = bench.name + "/" + bench.variant;
+			if( !aOptions.filter.empty() && std::string::npos == id.find( aOptions.filter ) )
+				continue;
+
+			// Warm up (caches, lazily initialized data), then find the number
+			// of iterations that makes a sample take at least minSampleTime.
+			time_( bench, 1 );
+
+			std::size_t iterations = 1;
+			for( ;; )
+			{
+				double const t = time_( bench, iterations );
+				if( t >= aOptions.minSampleTime )
+					break;
+
+				double const scale = t > 0.0 ? 1.2 * aOptions.minSampleTime / t : 10.0;
+				iterations = std::max( iterations + 1, std::size_t(double(iterations) * std::min( scale, 10.0 )) );
+			}
+
+			std::vector<double> nsPerOp;
+			nsPerOp.reserve( aOptions.samples );
+			for( std::size_t i = 0; i < aOptions.samples; ++i )
+			{
+				double const t = time_( bench, iterations );
+				nsPerOp.emplace_back( 1e9 * t / double(iterations * bench.opsPerIteration) );
+			}
+
+			std::sort( nsPerOp.begin(), nsPerOp.end() );
+			double const median = nsPerOp[nsPerOp.size()/2];
+
+			results.emplace_back( Result{
+				bench.name,
+				bench.variant,
+				aOptions.samples,
+				iterations,
+				bench.opsPerIteration,
+				median,
+				nsPerOp.front(),
+				1e9 / median,
+				0.0
+			} );
+		}
+
+		for( auto& r : results )
+		{
+			auto const base = std::find_if( results.begin(), results.end(), [&r] (Result const& aOther) {
+				return aOther.name == r.name;
+			} );
+			r.speedup = base->nsPerOp / r.nsPerOp;
+		}
+
+		return results;
+	}
+
+	void print_table( std::FILE* aOut, std::vector<Result> const& aResults )
+	{
+		std::fprintf( aOut, "vmlib-bench (SIMD backend: %s)\n\n", simd_backend() );
+		std::fprintf( aOut, "%-28s %-10s %12s %12s %14s %8s\n", "benchmark", "variant", "ns/op", "min ns/op", "ops/s", "speedup" );
+
+		for( auto const& r : aResults )
+		{
+			std::fprintf( aOut, "%-28s %-10s %12.3f %12.3f %14.4g ", r.name.c_str(), r.variant.c_str(), r.nsPerOp, r.nsPerOpMin, r.opsPerSecond );
+			std::fprintf( aOut, "%7.2fx\n", r.speedup );
+		}
+	}
+
+	void write_csv( std::FILE* aOut, std::vector<Result> const& aResults )
+	{
+		std::fprintf( aOut, "name,variant,backend,samples,iterations,ops_per_iteration,ns_per_op,ns_per_op_min,ops_per_second,speedup\n" );
+		for( auto const& r : aResults )
+		{
+			std::fprintf( aOut, "%s,%s,%s,%zu,%zu,%zu,%.6f,%.6f,%.6g,%.4f\n",
+				r.name.c_str(), r.variant.c_str(), simd_backend(),
+				r.samples, r.iterations, r.opsPerIteration,
+				r.nsPerOp, r.nsPerOpMin, r.opsPerSecond, r.speedup
+			);
+		}
+	}
+
+	void write_json( std::FILE* aOut, std::vector<Result> const& aResults )
+	{
+		std::fprintf( aOut, "{\n" );
+		std::fprintf( aOut, "  \"backend\": \"%s\",\n", simd_backend() );
+		std::fprintf( aOut, "  \"fma\": %s,\n", VMLIB_SIMD_FMA ? "true" : "false" );
+		std::fprintf( aOut, "  \"results\": [\n" );
+		for( std::size_t i = 0; i < aResults.size(); ++i )
+		{
+			auto const& r = aResults[i];
+			std::fprintf( aOut,
+				"    { \"name\": \"%s\", \"variant\": \"%s\", \"samples\": %zu, \"iterations\": %zu, "
+				"\"ops_per_iteration\": %zu, \"ns_per_op\": %.6f, \"ns_per_op_min\": %.6f, "
+				"\"ops_per_second\": %.6g, \"speedup\": %.4f }%s\n",
+				escape_json_( r.name ).c_str(), escape_json_( r.variant ).c_str(),
+				r.samples, r.iterations, r.opsPerIteration,
+				r.nsPerOp, r.nsPerOpMin, r.opsPerSecond, r.speedup,
+				i+1 < aResults.size() ? "," : ""
+			);
+		}
+		std::fprintf( aOut, "  ]\n}\n" );
+	}
+
+	std::vector<float> random_floats( std::size_t aCount, float aMin, float aMax, unsigned aSeed )
+	{
+		std::mt19937 rng( aSeed );
+		std::uniform_real_distribution<float> dist( aMin, aMax );
+
+		std::vector<float> ret( aCount );
+		for( auto& v : ret )
+			v = dist( rng );
+		return ret;
+	}
+
+	char const* simd_backend() noexcept
+	{
+#		if VMLIB_SIMD_AVX
+		return "avx";
+#		elif VMLIB_SIMD_SSE
+		return "sse";
+#		elif VMLIB_SIMD_NEON
+		return "neon";
+#		else
+		return "none";
+#		endif
+	}
+}
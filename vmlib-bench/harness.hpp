@@ -0,0 +1,116 @@
+#ifndef HARNESS_HPP_D272ECA0_C6F0_4A94_B945_00B0422EE34A
+#define HARNESS_HPP_D272ECA0_C6F0_4A94_B945_00B0422EE34A
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+
+#if defined(_MSC_VER)
+#	include <intrin.h>
+#endif
+
+/** Minimal microbenchmark harness for vmlib
+ *
+ * Benchmarks are registered statically (see Registrar) and identified by a
+ * name and a variant, e.g. ("mat44_mul", "scalar") and ("mat44_mul", "simd").
+ * Variants with the same name perform the same work, so the reports include
+ * the speedup of each variant relative to the first one registered under that
+ * name (by convention the scalar reference).
+ *
+ * A benchmark body runs its workload aIterations times. Each iteration
+ * performs opsPerIteration operations (usually one per array element). The
+ * harness picks the number of iterations such that a sample takes at least
+ * Options::minSampleTime, and reports the median over Options::samples
+ * samples.
+ *
+ * Results are printed as a table and can additionally be written as CSV or
+ * JSON, for tracking regressions.
+ */
+namespace bench
+{
+	using Body = std::function<void(std::size_t aIterations)>;
+
+	struct Benchmark
+	{
+		std::string name;
+		std::string variant;
+		std::size_t opsPerIteration;
+		Body body;
+	};
+
+	struct Options
+	{
+		std::string filter;           // run benchmarks whose "name/variant" contains this
+		double minSampleTime = 0.01;  // seconds
+		std::size_t samples = 15;
+	};
+
+	struct Result
+	{
+		std::string name;
+		std::string variant;
+		std::size_t samples;
+		std::size_t iterations;     // per sample
+		std::size_t opsPerIteration;
+		double nsPerOp;             // median
+		double nsPerOpMin;
+		double opsPerSecond;        // from the median
+		double speedup;             // vs. the first variant with the same name
+	};
+
+	struct Registrar
+	{
+		Registrar( std::initializer_list<Benchmark> );
+		Registrar( std::vector<Benchmark> const& ); // e.g., built in a loop
+	};
+
+	std::vector<Benchmark> const& registered();
+
+	std::vector<Result> run( Options const& );
+
+	void print_table( std::FILE*, std::vector<Result> const& );
+	void write_csv( std::FILE*, std::vector<Result> const& );
+	void write_json( std::FILE*, std::vector<Result> const& );
+
+	// Name of the vmlib SIMD backend that was compiled in.
+	char const* simd_backend() noexcept;
+
+	// Number of elements in the input arrays of the benchmarks. Large enough
+	// to amortize the loop overhead, small enough to stay in the L2 cache.
+	constexpr std::size_t kArraySize = 4096;
+
+	// Uniformly distributed random floats in [aMin, aMax), with a fixed seed
+	// so that all runs use the same data.
+	std::vector<float> random_floats( std::size_t aCount, float aMin, float aMax, unsigned aSeed = 42 );
+
+
+	// Prevent the compiler from optimizing away a computation whose result
+	// is otherwise unused.
+	template< typename tType > inline
+	void do_not_optimize( tType const& aValue ) noexcept
+	{
+#		if defined(__GNUC__) || defined(__clang__)
+		asm volatile( "" : : "r,m"(aValue) : "memory" );
+#		else
+		static_cast<void>(*static_cast<char const volatile*>( static_cast<void const*>(&aValue) ));
+		_ReadWriteBarrier();
+#		endif
+	}
+
+	// Force pending writes to memory (e.g., to output arrays) to be
+	// considered observable.
+	inline
+	void clobber_memory() noexcept
+	{
+#		if defined(__GNUC__) || defined(__clang__)
+		asm volatile( "" : : : "memory" );
+#		else
+		_ReadWriteBarrier();
+#		endif
+	}
+}
+
+#endif // HARNESS_HPP_D272ECA0_C6F0_4A94_B945_00B0422EE34A
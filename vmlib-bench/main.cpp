@@ -0,0 +1,106 @@
+#include <typeinfo>
+#include <exception>
+#include <algorithm>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "../support/error.hpp"
+
+#include "harness.hpp"
+
+namespace
+{
+	void print_usage_( char const* aProgram )
+	{
+		std::printf( "Usage: %s [options]\n", aProgram );
+		std::printf( "  --filter <str>    only run benchmarks whose name/variant contains <str>\n" );
+		std::printf( "  --samples <n>     number of samples per benchmark (default: 15)\n" );
+		std::printf( "  --min-time <ms>   minimum duration of a sample (default: 10)\n" );
+		std::printf( "  --csv <file>      also write results as CSV (\"-\" for stdout)\n" );
+		std::printf( "  --json <file>     also write results as JSON (\"-\" for stdout)\n" );
+		std::printf( "  --list            list benchmarks and exit\n" );
+	}
+
+	void write_file_( char const* aPath, std::vector<bench::Result> const& aResults, void (*aWriter)( std::FILE*, std::vector<bench::Result> const& ) )
+	{
+		if( 0 == std::strcmp( aPath, "-" ) )
+		{
+			aWriter( stdout, aResults );
+			return;
+		}
+
+		std::FILE* fout = std::fopen( aPath, "w" );
+		if( !fout )
+			throw Error( "Unable to open '%s' for writing", aPath );
+
+		aWriter( fout, aResults );
+		std::fclose( fout );
+	}
+}
+
+int main( int aArgc, char* aArgv[] ) try
+{
+	bench::Options options;
+	char const* csvPath = nullptr;
+	char const* jsonPath = nullptr;
+	bool list = false;
+
+	for( int i = 1; i < aArgc; ++i )
+	{
+		char const* const arg = aArgv[i];
+		auto value_ = [&] () -> char const* {
+			if( i+1 >= aArgc )
+				throw Error( "Option '%s' requires an argument", arg );
+			return aArgv[++i];
+		};
+
+		if( 0 == std::strcmp( arg, "--filter" ) )
+			options.filter = value_();
+		else if( 0 == std::strcmp( arg, "--samples" ) )
+			options.samples = std::max( 1l, std::strtol( value_(), nullptr, 10 ) );
+		else if( 0 == std::strcmp( arg, "--min-time" ) )
+			options.minSampleTime = std::strtod( value_(), nullptr ) / 1000.0;
+		else if( 0 == std::strcmp( arg, "--csv" ) )
+			csvPath = value_();
+		else if( 0 == std::strcmp( arg, "--json" ) )
+			jsonPath = value_();
+		else if( 0 == std::strcmp( arg, "--list" ) )
+			list = true;
+		else if( 0 == std::strcmp( arg, "--help" ) || 0 == std::strcmp( arg, "-h" ) )
+		{
+			print_usage_( aArgv[0] );
+			return 0;
+		}
+		else
+			throw Error( "Unknown option '%s' (see --help)", arg );
+	}
+
+	if( list )
+	{
+		for( auto const& b : bench::registered() )
+			std::printf( "%s/%s\n", b.name.c_str(), b.variant.c_str() );
+		return 0;
+	}
+
+	auto const results = bench::run( options );
+
+	// Keep stdout machine-readable if one of the outputs goes there.
+	bool const toStdout = (csvPath && 0 == std::strcmp( csvPath, "-" )) || (jsonPath && 0 == std::strcmp( jsonPath, "-" ));
+	bench::print_table( toStdout ? stderr : stdout, results );
+
+	if( csvPath )
+		write_file_( csvPath, results, &bench::write_csv );
+	if( jsonPath )
+		write_file_( jsonPath, results, &bench::write_json );
+
+	return 0;
+}
+catch( std::exception const& eErr )
+{
+	std::fprintf( stderr, "Top-level Exception (%s):\n", typeid(eErr).name() );
+	std::fprintf( stderr, "%s\n", eErr.what() );
+	std::fprintf( stderr, "Bye.\n" );
+	return 1;
+}
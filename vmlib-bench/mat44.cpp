@@ -0,0 +1,173 @@
+#include "harness.hpp"
+
+#include <vector>
+
+#include "../vmlib/mat33.hpp"
+#include "../vmlib/mat44.hpp"
+#include "../vmlib/mat44cm.hpp"
+
+namespace
+{
+	using bench::kArraySize;
+
+	std::vector<Mat44f> random_matrices_( unsigned aSeed )
+	{
+		auto const values = bench::random_floats( 16*kArraySize, -2.f, 2.f, aSeed );
+
+		std::vector<Mat44f> ret( kArraySize );
+		for( std::size_t i = 0; i < kArraySize; ++i )
+		{
+			for( std::size_t j = 0; j < 16; ++j )
+				ret[i].v[j] = values[i*16 + j];
+
+			ret[i](3,3) += 5.f; // keep invert() well-conditioned
+		}
+		return ret;
+	}
+
+	// Affine matrices (last row is 0,0,0,1), for invert_affine() & co.
+	std::vector<Mat44f> random_affine_( unsigned aSeed )
+	{
+		auto const angles = bench::random_floats( 4*kArraySize, -3.f, 3.f, aSeed );
+
+		std::vector<Mat44f> ret( kArraySize );
+		for( std::size_t i = 0; i < kArraySize; ++i )
+		{
+			float const* a = &angles[i*4];
+			ret[i] = make_translation( { a[0], a[1], a[2] } ) * make_rotation_y( a[3] ) * make_rotation_x( a[0] );
+		}
+		return ret;
+	}
+
+	std::vector<Vec4f> random_vec4_( unsigned aSeed )
+	{
+		auto const values = bench::random_floats( 4*kArraySize, -1.f, 1.f, aSeed );
+
+		std::vector<Vec4f> ret( kArraySize );
+		for( std::size_t i = 0; i < kArraySize; ++i )
+			ret[i] = Vec4f{ values[i*4+0], values[i*4+1], values[i*4+2], values[i*4+3] };
+		return ret;
+	}
+
+	std::vector<Mat44f> const gA = random_matrices_( 1 );
+	std::vector<Mat44f> const gB = random_matrices_( 2 );
+	std::vector<Mat44f> const gAffine = random_affine_( 3 );
+	std::vector<Vec4f> const gX = random_vec4_( 4 );
+
+	std::vector<Mat44fCM> const gACM = [] {
+		std::vector<Mat44fCM> ret;
+		for( auto const& m : gA )
+			ret.emplace_back( to_column_major( m ) );
+		return ret;
+	}();
+	std::vector<Mat44fCM> const gBCM = [] {
+		std::vector<Mat44fCM> ret;
+		for( auto const& m : gB )
+			ret.emplace_back( to_column_major( m ) );
+		return ret;
+	}();
+
+	// Run aFunc( i ) for each array element, aIterations times.
+	template< class tFunc > inline
+	void for_each_( std::size_t aIterations, tFunc&& aFunc )
+	{
+		for( std::size_t it = 0; it < aIterations; ++it )
+		{
+			for( std::size_t i = 0; i < kArraySize; ++i )
+				aFunc( i );
+
+			bench::clobber_memory();
+		}
+	}
+
+	std::vector<Mat44f> gOut( kArraySize );
+	std::vector<Mat44fCM> gOutCM( kArraySize );
+	std::vector<Mat33f> gOut33( kArraySize );
+	std::vector<Vec4f> gOutX( kArraySize );
+
+	bench::Registrar const kBenchmarks_{
+		{ "mat44_mul", "scalar", kArraySize, [] (std::size_t aIt) {
+			for_each_( aIt, [] (std::size_t i) { gOut[i] = detail::mat44_mul_scalar( gA[i], gB[i] ); } );
+		} },
+#		if !VMLIB_SIMD_NONE
+		{ "mat44_mul", "simd", kArraySize, [] (std::size_t aIt) {
+			for_each_( aIt, [] (std::size_t i) { gOut[i] = detail::mat44_mul_simd( gA[i], gB[i] ); } );
+		} },
+#		endif
+
+		{ "mat44_mul_vec4", "scalar", kArraySize, [] (std::size_t aIt) {
+			for_each_( aIt, [] (std::size_t i) { gOutX[i] = detail::mat44_mul_scalar( gA[i], gX[i] ); } );
+		} },
+#		if !VMLIB_SIMD_NONE
+		{ "mat44_mul_vec4", "simd", kArraySize, [] (std::size_t aIt) {
+			for_each_( aIt, [] (std::size_t i) { gOutX[i] = detail::mat44_mul_simd( gA[i], gX[i] ); } );
+		} },
+#		endif
+
+		{ "mat44cm_mul", "scalar", kArraySize, [] (std::size_t aIt) {
+			for_each_( aIt, [] (std::size_t i) { gOutCM[i] = detail::mat44cm_mul_scalar( gACM[i], gBCM[i] ); } );
+		} },
+#		if !VMLIB_SIMD_NONE
+		{ "mat44cm_mul", "simd", kArraySize, [] (std::size_t aIt) {
+			for_each_( aIt, [] (std::size_t i) { gOutCM[i] = detail::mat44cm_mul_simd( gACM[i], gBCM[i] ); } );
+		} },
+#		endif
+
+		{ "to_column_major", "scalar", kArraySize, [] (std::size_t aIt) {
+			for_each_( aIt, [] (std::size_t i) { detail::transpose_flat_scalar( gA[i].v, gOutCM[i].v ); } );
+		} },
+#		if !VMLIB_SIMD_NONE
+		{ "to_column_major", "simd", kArraySize, [] (std::size_t aIt) {
+			for_each_( aIt, [] (std::size_t i) { detail::transpose_flat_simd( gA[i].v, gOutCM[i].v ); } );
+		} },
+#		endif
+
+		{ "invert", "general", kArraySize, [] (std::size_t aIt) {
+			for_each_( aIt, [] (std::size_t i) { gOut[i] = invert( gAffine[i] ); } );
+		} },
+		{ "invert", "affine", kArraySize, [] (std::size_t aIt) {
+			for_each_( aIt, [] (std::size_t i) { gOut[i] = invert_affine( gAffine[i] ); } );
+		} },
+		{ "invert", "rigid", kArraySize, [] (std::size_t aIt) {
+			for_each_( aIt, [] (std::size_t i) { gOut[i] = invert_rigid( gAffine[i] ); } );
+		} },
+
+		{ "normal_matrix", "inv_transp", kArraySize, [] (std::size_t aIt) {
+			for_each_( aIt, [] (std::size_t i) { gOut33[i] = mat44_to_mat33( transpose( invert( gAffine[i] ) ) ); } );
+		} },
+		{ "normal_matrix", "scalar", kArraySize, [] (std::size_t aIt) {
+			for_each_( aIt, [] (std::size_t i) { gOut33[i] = detail::normal_matrix_scalar( gAffine[i] ); } );
+		} },
+#		if !VMLIB_SIMD_NONE
+		{ "normal_matrix", "simd", kArraySize, [] (std::size_t aIt) {
+			for_each_( aIt, [] (std::size_t i) { gOut33[i] = detail::normal_matrix_simd( gAffine[i] ); } );
+		} },
+#		endif
+
+		{ "transpose", "scalar", kArraySize, [] (std::size_t aIt) {
+			for_each_( aIt, [] (std::size_t i) { gOut[i] = transpose( gA[i] ); } );
+		} },
+
+		{ "look_at", "scalar", kArraySize, [] (std::size_t aIt) {
+			for_each_( aIt, [] (std::size_t i) {
+				Vec3f const eye{ gX[i].x, gX[i].y, gX[i].z };
+				gOut[i] = look_at( eye, eye + Vec3f{ gX[i].w, 1.f, -1.f }, Vec3f{ 0.f, 1.f, 0.f } );
+			} );
+		} },
+
+		{ "make_perspective", "scalar", kArraySize, [] (std::size_t aIt) {
+			for_each_( aIt, [] (std::size_t i) {
+				gOut[i] = make_perspective_projection( 1.f + 0.5f * gX[i].x, 1.5f + gX[i].y, 0.1f, 100.f );
+			} );
+		} },
+
+		{ "make_rotation", "axis_angle", kArraySize, [] (std::size_t aIt) {
+			for_each_( aIt, [] (std::size_t i) {
+				gOut[i] = rotate( gX[i].w, Vec3f{ 0.f, 0.6f, 0.8f } );
+			} );
+		} },
+		{ "make_rotation", "z", kArraySize, [] (std::size_t aIt) {
+			for_each_( aIt, [] (std::size_t i) { gOut[i] = make_rotation_z( gX[i].w ); } );
+		} },
+	};
+}
@@ -0,0 +1,103 @@
+#include "harness.hpp"
+
+#include <array>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+#include "../vmlib/mesh_optimize.hpp"
+
+namespace
+{
+	// Grid of kGridSize x kGridSize quads with the triangles in random order,
+	// roughly the size of the terrain mesh
+	constexpr std::uint32_t kGridSize = 128;
+	constexpr std::size_t kVertexCount = (kGridSize+1) * (kGridSize+1);
+	constexpr std::size_t kTriangleCount = 2 * kGridSize * kGridSize;
+
+	std::vector<Vec3f> grid_positions_()
+	{
+		std::vector<Vec3f> ret;
+		for( std::uint32_t z = 0; z <= kGridSize; ++z )
+		{
+			for( std::uint32_t x = 0; x <= kGridSize; ++x )
+				ret.emplace_back( Vec3f{ float(x), float((x*7 + z*13) % 5), float(z) } );
+		}
+		return ret;
+	}
+
+	std::vector<std::uint32_t> shuffled_grid_indices_()
+	{
+		std::vector<std::array<std::uint32_t,3>> triangles;
+		for( std::uint32_t z = 0; z < kGridSize; ++z )
+		{
+			for( std::uint32_t x = 0; x < kGridSize; ++x )
+			{
+				std::uint32_t const i = z * (kGridSize+1) + x;
+				triangles.push_back( { i, i + kGridSize + 1, i + 1 } );
+				triangles.push_back( { i + 1, i + kGridSize + 1, i + kGridSize + 2 } );
+			}
+		}
+
+		std::mt19937 rng( 42 );
+		std::shuffle( triangles.begin(), triangles.end(), rng );
+
+		std::vector<std::uint32_t> ret;
+		for( auto const& t : triangles )
+			ret.insert( ret.end(), t.begin(), t.end() );
+		return ret;
+	}
+
+	std::vector<Vec3f> const gPositions = grid_positions_();
+	std::vector<std::uint32_t> const gShuffled = shuffled_grid_indices_();
+
+	std::vector<std::uint32_t> optimized_indices_()
+	{
+		auto ret = gShuffled;
+		optimize_vertex_cache( ret.data(), ret.size(), kVertexCount );
+		return ret;
+	}
+
+	std::vector<std::uint32_t> const gOptimized = optimized_indices_();
+
+	std::vector<std::uint32_t> gIndices( gShuffled.size() );
+	std::vector<std::uint32_t> gRemap( kVertexCount );
+
+	template< class tFunc > inline
+	void repeat_( std::size_t aIterations, tFunc&& aFunc )
+	{
+		for( std::size_t it = 0; it < aIterations; ++it )
+		{
+			aFunc();
+			bench::clobber_memory();
+		}
+	}
+
+	// All benchmarks count triangles. Each iteration starts from a fresh copy
+	// of the input.
+	bench::Registrar const kBenchmarks_{
+		{ "mesh_cache_simulate", "fifo16", kTriangleCount, [] (std::size_t aIt) {
+			repeat_( aIt, [] {
+				bench::do_not_optimize( simulate_vertex_cache( gShuffled.data(), gShuffled.size(), kVertexCount ) );
+			} );
+		} },
+		{ "mesh_vertex_cache", "tipsify", kTriangleCount, [] (std::size_t aIt) {
+			repeat_( aIt, [] {
+				std::copy( gShuffled.begin(), gShuffled.end(), gIndices.begin() );
+				optimize_vertex_cache( gIndices.data(), gIndices.size(), kVertexCount );
+			} );
+		} },
+		{ "mesh_overdraw", "clusters", kTriangleCount, [] (std::size_t aIt) {
+			repeat_( aIt, [] {
+				std::copy( gOptimized.begin(), gOptimized.end(), gIndices.begin() );
+				optimize_overdraw( gIndices.data(), gIndices.size(), gPositions.data(), kVertexCount );
+			} );
+		} },
+		{ "mesh_vertex_fetch", "first_use", kTriangleCount, [] (std::size_t aIt) {
+			repeat_( aIt, [] {
+				std::copy( gOptimized.begin(), gOptimized.end(), gIndices.begin() );
+				bench::do_not_optimize( optimize_vertex_fetch( gIndices.data(), gIndices.size(), kVertexCount, gRemap.data() ) );
+			} );
+		} },
+	};
+}
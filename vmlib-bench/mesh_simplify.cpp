@@ -0,0 +1,86 @@
+#include "harness.hpp"
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "../vmlib/mesh_simplify.hpp"
+
+namespace
+{
+	// Height field of kGridSize x kGridSize quads with texture coordinates,
+	// roughly the size of the terrain mesh
+	constexpr std::uint32_t kGridSize = 128;
+	constexpr std::size_t kVertexCount = (kGridSize+1) * (kGridSize+1);
+	constexpr std::size_t kTriangleCount = 2 * kGridSize * kGridSize;
+
+	std::vector<Vec3f> grid_positions_()
+	{
+		std::vector<Vec3f> ret;
+		for( std::uint32_t z = 0; z <= kGridSize; ++z )
+		{
+			for( std::uint32_t x = 0; x <= kGridSize; ++x )
+				ret.emplace_back( Vec3f{ float(x), 4.f * std::sin( x * 0.11f ) * std::cos( z * 0.07f ), float(z) } );
+		}
+		return ret;
+	}
+
+	std::vector<float> grid_texcoords_()
+	{
+		std::vector<float> ret;
+		for( std::uint32_t z = 0; z <= kGridSize; ++z )
+		{
+			for( std::uint32_t x = 0; x <= kGridSize; ++x )
+			{
+				ret.emplace_back( float(x) / kGridSize );
+				ret.emplace_back( float(z) / kGridSize );
+			}
+		}
+		return ret;
+	}
+
+	std::vector<std::uint32_t> grid_indices_()
+	{
+		std::vector<std::uint32_t> ret;
+		for( std::uint32_t z = 0; z < kGridSize; ++z )
+		{
+			for( std::uint32_t x = 0; x < kGridSize; ++x )
+			{
+				std::uint32_t const i = z * (kGridSize+1) + x;
+				ret.insert( ret.end(), { i, i + kGridSize + 1, i + 1 } );
+				ret.insert( ret.end(), { i + 1, i + kGridSize + 1, i + kGridSize + 2 } );
+			}
+		}
+		return ret;
+	}
+
+	std::vector<Vec3f> const gPositions = grid_positions_();
+	std::vector<float> const gTexcoords = grid_texcoords_();
+	std::vector<std::uint32_t> const gIndices = grid_indices_();
+
+	std::vector<std::uint32_t> gOut( gIndices.size() );
+
+	float const kWeights_[] = { 0.05f, 0.05f };
+
+	// All benchmarks count source triangles
+	bench::Registrar const kBenchmarks_{
+		{ "mesh_simplify", "half", kTriangleCount, [] (std::size_t aIt) {
+			for( std::size_t it = 0; it < aIt; ++it )
+			{
+				bench::do_not_optimize( simplify_mesh( gOut.data(), gIndices.data(), gIndices.size(), gPositions.data(), kVertexCount, gTexcoords.data(), 2, kWeights_, gIndices.size() / 2, std::numeric_limits<float>::max() ) );
+				bench::clobber_memory();
+			}
+		} },
+		{ "mesh_simplify", "eighth", kTriangleCount, [] (std::size_t aIt) {
+			for( std::size_t it = 0; it < aIt; ++it )
+			{
+				bench::do_not_optimize( simplify_mesh( gOut.data(), gIndices.data(), gIndices.size(), gPositions.data(), kVertexCount, gTexcoords.data(), 2, kWeights_, gIndices.size() / 8, std::numeric_limits<float>::max() ) );
+				bench::clobber_memory();
+			}
+		} },
+		{ "mesh_vertex_distance", "grid", kTriangleCount, [] (std::size_t aIt) {
+			for( std::size_t it = 0; it < aIt; ++it )
+				bench::do_not_optimize( mesh_vertex_distance( gIndices.data(), gIndices.size(), gIndices.data(), gIndices.size(), gPositions.data(), kVertexCount ) );
+		} },
+	};
+}
@@ -0,0 +1,104 @@
+#include "harness.hpp"
+
+#include <memory>
+#include <vector>
+
+#include "../vmlib/particle_integrate.hpp"
+
+namespace
+{
+	// Particle state for one pool size. Unlike the other benchmarks, the
+	// sizes go well past the caches: the emitters are mostly memory bound.
+	struct Pool_
+	{
+		Vec3Stream positions;
+		Vec3Stream velocities;
+		std::vector<float> lifeTimes;
+		std::vector<std::uint64_t> deathMask;
+	};
+
+	// Allocated on first use, so that filtered runs only pay for the sizes
+	// they run (10M particles take ~300 MB).
+	Pool_& pool_( std::size_t aCount )
+	{
+		static std::vector<std::pair<std::size_t, std::unique_ptr<Pool_>>> pools;
+		for( auto& p : pools )
+		{
+			if( p.first == aCount )
+				return *p.second;
+		}
+
+		auto const pos = bench::random_floats( 3*aCount, -100.f, 100.f, 50 );
+		auto const vel = bench::random_floats( 3*aCount, -5.f, 5.f, 51 );
+
+		auto pool = std::make_unique<Pool_>();
+		pool->positions.resize( aCount );
+		pool->velocities.resize( aCount );
+		deinterleave( reinterpret_cast<Vec3f const*>(pos.data()), pool->positions );
+		deinterleave( reinterpret_cast<Vec3f const*>(vel.data()), pool->velocities );
+		pool->lifeTimes = bench::random_floats( aCount, 0.f, 2.f, 52 );
+		pool->deathMask.resize( death_mask_words( aCount ) );
+
+		pools.emplace_back( aCount, std::move(pool) );
+		return *pools.back().second;
+	}
+
+	// Small enough that the lifetimes stay positive over many iterations;
+	// the kernels do not branch on them either way.
+	constexpr float kDeltaTime = 1e-6f;
+
+	std::vector<bench::Benchmark> make_benchmarks_()
+	{
+		std::vector<bench::Benchmark> ret;
+
+		std::pair<std::size_t, char const*> const sizes[] = {
+			{ 10000, "particle_integrate_10k" },
+			{ 100000, "particle_integrate_100k" },
+			{ 1000000, "particle_integrate_1M" },
+			{ 10000000, "particle_integrate_10M" }
+		};
+
+		for( auto const& [count, name] : sizes )
+		{
+			// Reference: the update as ParticleGenerator did it before, with
+			// separate passes for integration, ageing and finding the dead
+			ret.push_back( { name, "separate_passes", count, [count = count] (std::size_t aIt) {
+				Pool_& p = pool_( count );
+				for( std::size_t it = 0; it < aIt; ++it )
+				{
+					axpy( kDeltaTime, p.velocities, p.positions );
+					for( float& life : p.lifeTimes )
+						life -= kDeltaTime;
+
+					std::size_t dead = 0;
+					for( float life : p.lifeTimes )
+						dead += life < 0.f;
+
+					bench::do_not_optimize( dead );
+					bench::clobber_memory();
+				}
+			} } );
+
+			for( SimdIsa const isa : { SimdIsa::scalar, SimdIsa::sse2, SimdIsa::avx2, SimdIsa::avx512 } )
+			{
+				if( isa > cpu_simd_isa() )
+					break;
+
+				ret.push_back( { name, simd_isa_name( isa ), count, [count = count, isa] (std::size_t aIt) {
+					Pool_& p = pool_( count );
+					for( std::size_t it = 0; it < aIt; ++it )
+					{
+						std::size_t const dead = integrate_particles( isa, kDeltaTime, p.velocities, p.positions, p.lifeTimes.data(), p.deathMask.data() );
+
+						bench::do_not_optimize( dead );
+						bench::clobber_memory();
+					}
+				} } );
+			}
+		}
+
+		return ret;
+	}
+
+	bench::Registrar const kBenchmarks_( make_benchmarks_() );
+}
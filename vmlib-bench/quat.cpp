@@ -0,0 +1,77 @@
+#include "harness.hpp"
+
+#include <vector>
+
+#include "../vmlib/quat.hpp"
+#include "../vmlib/transform.hpp"
+
+namespace
+{
+	using bench::kArraySize;
+
+	std::vector<float> const gAngles = bench::random_floats( kArraySize, -3.f, 3.f, 30 );
+	std::vector<float> const gCoords = bench::random_floats( 3*kArraySize, -1.f, 1.f, 31 );
+
+	Vec3f point_( std::size_t aI )
+	{
+		return Vec3f{ gCoords[aI*3+0], gCoords[aI*3+1], gCoords[aI*3+2] };
+	}
+
+	Vec3f const kAxis = normalize( Vec3f{ 1.f, 2.f, 3.f } );
+
+	std::vector<Vec3f> gOut( kArraySize );
+	std::vector<Mat44f> gOutM( kArraySize );
+	std::vector<Transform> gOutT( kArraySize );
+
+	template< class tFunc > inline
+	void for_each_( std::size_t aIterations, tFunc&& aFunc )
+	{
+		for( std::size_t it = 0; it < aIterations; ++it )
+		{
+			for( std::size_t i = 0; i < kArraySize; ++i )
+				aFunc( i );
+
+			bench::clobber_memory();
+		}
+	}
+
+	bench::Registrar const kBenchmarks_{
+		// Rotate one vector by an axis-angle rotation, as done for particle
+		// emission.
+		{ "rotate_vec3", "mat44", kArraySize, [] (std::size_t aIt) {
+			for_each_( aIt, [] (std::size_t i) {
+				Vec3f const p = point_( i );
+				Vec4f const r = rotate( gAngles[i], kAxis ) * Vec4f{ p.x, p.y, p.z, 0.f };
+				gOut[i] = Vec3f{ r.x, r.y, r.z };
+			} );
+		} },
+		{ "rotate_vec3", "quat", kArraySize, [] (std::size_t aIt) {
+			for_each_( aIt, [] (std::size_t i) {
+				gOut[i] = rotate( make_quat_rotation( gAngles[i], kAxis ), point_( i ) );
+			} );
+		} },
+
+		// Compose a parent and a child placement into a model matrix.
+		{ "compose_trs", "mat44", kArraySize, [] (std::size_t aIt) {
+			for_each_( aIt, [] (std::size_t i) {
+				gOutM[i] = make_translation( point_( i ) ) * make_rotation_z( gAngles[i] )
+					* make_translation( { 1.f, 2.f, 3.f } ) * make_rotation_y( gAngles[i] );
+			} );
+		} },
+		{ "compose_trs", "transform", kArraySize, [] (std::size_t aIt) {
+			for_each_( aIt, [] (std::size_t i) {
+				Transform const parent = make_transform( point_( i ), make_quat_rotation_z( gAngles[i] ) );
+				Transform const child = make_transform( { 1.f, 2.f, 3.f }, make_quat_rotation_y( gAngles[i] ) );
+				gOutM[i] = transform_to_mat44( parent * child );
+			} );
+		} },
+
+		{ "slerp", "scalar", kArraySize, [] (std::size_t aIt) {
+			for_each_( aIt, [] (std::size_t i) {
+				Quatf const a = make_quat_rotation_z( gAngles[i] );
+				Quatf const b = make_quat_rotation( gAngles[i] + 1.f, kAxis );
+				gOutT[i].rotation = slerp( a, b, 0.3f );
+			} );
+		} },
+	};
+}
@@ -0,0 +1,54 @@
+#include "harness.hpp"
+
+#include <random>
+#include <vector>
+
+#include "../vmlib/random.hpp"
+
+namespace
+{
+	using bench::kArraySize;
+
+	std::vector<float> gOut( kArraySize );
+
+	template< class tFunc > inline
+	void repeat_( std::size_t aIterations, tFunc&& aFunc )
+	{
+		for( std::size_t it = 0; it < aIterations; ++it )
+		{
+			aFunc();
+			bench::clobber_memory();
+		}
+	}
+
+	std::default_random_engine gDefaultEngine( 42 );
+	std::mt19937 gMersenne( 42 );
+	std::uniform_real_distribution<float> gDist( 0.f, 1.f );
+	Xoshiro128x8 gXoshiro( 42 );
+
+	bench::Registrar const kBenchmarks_{
+		// Uniform floats in [0,1). The first variant is what the particle
+		// emitter used before.
+		{ "random_uniform", "std_default", kArraySize, [] (std::size_t aIt) {
+			repeat_( aIt, [] {
+				for( auto& x : gOut )
+					x = gDist( gDefaultEngine );
+			} );
+		} },
+		{ "random_uniform", "std_mt19937", kArraySize, [] (std::size_t aIt) {
+			repeat_( aIt, [] {
+				for( auto& x : gOut )
+					x = gDist( gMersenne );
+			} );
+		} },
+		{ "random_uniform", "xoshiro_single", kArraySize, [] (std::size_t aIt) {
+			repeat_( aIt, [] {
+				for( auto& x : gOut )
+					x = gXoshiro.uniform();
+			} );
+		} },
+		{ "random_uniform", "xoshiro_fill", kArraySize, [] (std::size_t aIt) {
+			repeat_( aIt, [] { gXoshiro.fill_uniform( gOut.data(), kArraySize ); } );
+		} },
+	};
+}
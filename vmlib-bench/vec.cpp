@@ -0,0 +1,108 @@
+#include "harness.hpp"
+
+#include <vector>
+
+#include "../vmlib/vec2.hpp"
+#include "../vmlib/vec3.hpp"
+#include "../vmlib/vec4.hpp"
+
+namespace
+{
+	using bench::kArraySize;
+
+	template< class tVec >
+	std::vector<tVec> random_vectors_( unsigned aSeed )
+	{
+		constexpr std::size_t kN = sizeof(tVec) / sizeof(float);
+		auto const values = bench::random_floats( kN*kArraySize, -1.f, 1.f, aSeed );
+
+		std::vector<tVec> ret( kArraySize );
+		for( std::size_t i = 0; i < kArraySize; ++i )
+		{
+			for( std::size_t j = 0; j < kN; ++j )
+				(&ret[i].x)[j] = values[i*kN + j] + 1e-3f; // avoid zero-length vectors
+		}
+		return ret;
+	}
+
+	std::vector<Vec2f> const gA2 = random_vectors_<Vec2f>( 10 );
+	std::vector<Vec2f> const gB2 = random_vectors_<Vec2f>( 11 );
+	std::vector<Vec3f> const gA3 = random_vectors_<Vec3f>( 12 );
+	std::vector<Vec3f> const gB3 = random_vectors_<Vec3f>( 13 );
+	std::vector<Vec4f> const gA4 = random_vectors_<Vec4f>( 14 );
+	std::vector<Vec4f> const gB4 = random_vectors_<Vec4f>( 15 );
+	std::vector<float> const gS = bench::random_floats( kArraySize, 0.5f, 2.f, 16 );
+
+	std::vector<Vec2f> gOut2( kArraySize );
+	std::vector<Vec3f> gOut3( kArraySize );
+	std::vector<Vec4f> gOut4( kArraySize );
+	std::vector<float> gOutS( kArraySize );
+
+	template< class tFunc > inline
+	void for_each_( std::size_t aIterations, tFunc&& aFunc )
+	{
+		for( std::size_t it = 0; it < aIterations; ++it )
+		{
+			for( std::size_t i = 0; i < kArraySize; ++i )
+				aFunc( i );
+
+			bench::clobber_memory();
+		}
+	}
+
+	bench::Registrar const kBenchmarks_{
+		// Vec2f
+		{ "vec2_add", "scalar", kArraySize, [] (std::size_t aIt) {
+			for_each_( aIt, [] (std::size_t i) { gOut2[i] = gA2[i] + gB2[i]; } );
+		} },
+		{ "vec2_scale", "scalar", kArraySize, [] (std::size_t aIt) {
+			for_each_( aIt, [] (std::size_t i) { gOut2[i] = gS[i] * gA2[i]; } );
+		} },
+		{ "vec2_dot", "scalar", kArraySize, [] (std::size_t aIt) {
+			for_each_( aIt, [] (std::size_t i) { gOutS[i] = dot( gA2[i], gB2[i] ); } );
+		} },
+		{ "vec2_length", "scalar", kArraySize, [] (std::size_t aIt) {
+			for_each_( aIt, [] (std::size_t i) { gOutS[i] = length( gA2[i] ); } );
+		} },
+
+		// Vec3f
+		{ "vec3_add", "scalar", kArraySize, [] (std::size_t aIt) {
+			for_each_( aIt, [] (std::size_t i) { gOut3[i] = gA3[i] + gB3[i]; } );
+		} },
+		{ "vec3_sub", "scalar", kArraySize, [] (std::size_t aIt) {
+			for_each_( aIt, [] (std::size_t i) { gOut3[i] = gA3[i] - gB3[i]; } );
+		} },
+		{ "vec3_scale", "scalar", kArraySize, [] (std::size_t aIt) {
+			for_each_( aIt, [] (std::size_t i) { gOut3[i] = gS[i] * gA3[i]; } );
+		} },
+		{ "vec3_div", "scalar", kArraySize, [] (std::size_t aIt) {
+			for_each_( aIt, [] (std::size_t i) { gOut3[i] = gA3[i] / gS[i]; } );
+		} },
+		{ "vec3_dot", "scalar", kArraySize, [] (std::size_t aIt) {
+			for_each_( aIt, [] (std::size_t i) { gOutS[i] = dot( gA3[i], gB3[i] ); } );
+		} },
+		{ "vec3_cross", "scalar", kArraySize, [] (std::size_t aIt) {
+			for_each_( aIt, [] (std::size_t i) { gOut3[i] = cross( gA3[i], gB3[i] ); } );
+		} },
+		{ "vec3_length", "scalar", kArraySize, [] (std::size_t aIt) {
+			for_each_( aIt, [] (std::size_t i) { gOutS[i] = length( gA3[i] ); } );
+		} },
+		{ "vec3_normalize", "scalar", kArraySize, [] (std::size_t aIt) {
+			for_each_( aIt, [] (std::size_t i) { gOut3[i] = normalize( gA3[i] ); } );
+		} },
+
+		// Vec4f
+		{ "vec4_add", "scalar", kArraySize, [] (std::size_t aIt) {
+			for_each_( aIt, [] (std::size_t i) { gOut4[i] = gA4[i] + gB4[i]; } );
+		} },
+		{ "vec4_scale", "scalar", kArraySize, [] (std::size_t aIt) {
+			for_each_( aIt, [] (std::size_t i) { gOut4[i] = gS[i] * gA4[i]; } );
+		} },
+		{ "vec4_dot", "scalar", kArraySize, [] (std::size_t aIt) {
+			for_each_( aIt, [] (std::size_t i) { gOutS[i] = dot( gA4[i], gB4[i] ); } );
+		} },
+		{ "vec4_length", "scalar", kArraySize, [] (std::size_t aIt) {
+			for_each_( aIt, [] (std::size_t i) { gOutS[i] = length( gA4[i] ); } );
+		} },
+	};
+}
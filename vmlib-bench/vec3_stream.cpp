@@ -0,0 +1,107 @@
+#include "harness.hpp"
+
+#include <vector>
+
+#include "../vmlib/vec3_stream.hpp"
+
+namespace
+{
+	using bench::kArraySize;
+
+	// The same random vectors, once as an array of Vec3f ("aos") and once as
+	// a Vec3Stream ("soa").
+	std::vector<Vec3f> random_aos_( unsigned aSeed )
+	{
+		auto const values = bench::random_floats( 3*kArraySize, -1.f, 1.f, aSeed );
+
+		std::vector<Vec3f> ret( kArraySize );
+		for( std::size_t i = 0; i < kArraySize; ++i )
+			ret[i] = Vec3f{ values[i*3+0], values[i*3+1], values[i*3+2] + 2.f };
+		return ret;
+	}
+	Vec3Stream to_soa_( std::vector<Vec3f> const& aAos )
+	{
+		Vec3Stream ret( aAos.size() );
+		deinterleave( aAos.data(), ret );
+		return ret;
+	}
+
+	std::vector<Vec3f> const gAosX = random_aos_( 40 );
+	std::vector<Vec3f> gAosY = random_aos_( 41 );
+	Vec3Stream const gSoaX = to_soa_( gAosX );
+	Vec3Stream gSoaY = to_soa_( gAosY );
+
+	std::vector<Vec3f> gAosOut( kArraySize );
+	Vec3Stream gSoaOut( kArraySize );
+	std::vector<float> gOutS( kArraySize );
+
+	template< class tFunc > inline
+	void repeat_( std::size_t aIterations, tFunc&& aFunc )
+	{
+		for( std::size_t it = 0; it < aIterations; ++it )
+		{
+			aFunc();
+			bench::clobber_memory();
+		}
+	}
+
+	bench::Registrar const kBenchmarks_{
+		// y += a x, e.g., particle integration. The AoS variants use the Vec3f
+		// operators, one element at a time.
+		{ "stream_axpy", "aos", kArraySize, [] (std::size_t aIt) {
+			repeat_( aIt, [] {
+				for( std::size_t i = 0; i < kArraySize; ++i )
+					gAosY[i] += 1e-3f * gAosX[i];
+			} );
+		} },
+		{ "stream_axpy", "soa_scalar", kArraySize, [] (std::size_t aIt) {
+			repeat_( aIt, [] { detail::axpy_scalar( 1e-3f, gSoaX, gSoaY ); } );
+		} },
+		{ "stream_axpy", "soa_simd", kArraySize, [] (std::size_t aIt) {
+			repeat_( aIt, [] { axpy( 1e-3f, gSoaX, gSoaY ); } );
+		} },
+
+		{ "stream_normalize", "aos", kArraySize, [] (std::size_t aIt) {
+			repeat_( aIt, [] {
+				for( std::size_t i = 0; i < kArraySize; ++i )
+					gAosOut[i] = normalize( gAosX[i] );
+			} );
+		} },
+		{ "stream_normalize", "soa_scalar", kArraySize, [] (std::size_t aIt) {
+			repeat_( aIt, [] { gSoaOut = gSoaX; detail::normalize_scalar( gSoaOut ); } );
+		} },
+		{ "stream_normalize", "soa_simd", kArraySize, [] (std::size_t aIt) {
+			repeat_( aIt, [] { gSoaOut = gSoaX; normalize( gSoaOut ); } );
+		} },
+
+		{ "stream_dot", "aos", kArraySize, [] (std::size_t aIt) {
+			repeat_( aIt, [] {
+				for( std::size_t i = 0; i < kArraySize; ++i )
+					gOutS[i] = dot( gAosX[i], gAosY[i] );
+			} );
+		} },
+		{ "stream_dot", "soa_scalar", kArraySize, [] (std::size_t aIt) {
+			repeat_( aIt, [] { detail::dot_scalar( gSoaX, gSoaY, gOutS.data() ); } );
+		} },
+		{ "stream_dot", "soa_simd", kArraySize, [] (std::size_t aIt) {
+			repeat_( aIt, [] { dot( gSoaX, gSoaY, gOutS.data() ); } );
+		} },
+
+		{ "stream_length", "aos", kArraySize, [] (std::size_t aIt) {
+			repeat_( aIt, [] {
+				for( std::size_t i = 0; i < kArraySize; ++i )
+					gOutS[i] = length( gAosX[i] );
+			} );
+		} },
+		{ "stream_length", "soa_scalar", kArraySize, [] (std::size_t aIt) {
+			repeat_( aIt, [] { detail::length_scalar( gSoaX, gOutS.data() ); } );
+		} },
+		{ "stream_length", "soa_simd", kArraySize, [] (std::size_t aIt) {
+			repeat_( aIt, [] { length( gSoaX, gOutS.data() ); } );
+		} },
+
+		{ "stream_interleave", "soa_simd", kArraySize, [] (std::size_t aIt) {
+			repeat_( aIt, [] { interleave( gSoaX, gAosOut.data() ); } );
+		} },
+	};
+}
@@ -0,0 +1,116 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <random>
+#include <vector>
+#include <algorithm>
+
+#include "../vmlib/batch_transform.hpp"
+
+namespace
+{
+	Mat44f random_matrix_( std::mt19937& aRng )
+	{
+		std::uniform_real_distribution<float> dist( -2.f, 2.f );
+
+		Mat44f ret;
+		for( auto& v : ret.v )
+			v = dist( aRng );
+
+		// Keep w well away from zero for the projective case.
+		ret(3,3) = 10.f;
+		return ret;
+	}
+
+	std::vector<Vec3f> random_points_( std::mt19937& aRng, std::size_t aCount )
+	{
+		std::uniform_real_distribution<float> dist( -1.f, 1.f );
+
+		std::vector<Vec3f> ret( aCount );
+		for( auto& p : ret )
+			p = Vec3f{ dist( aRng ), dist( aRng ), dist( aRng ) };
+		return ret;
+	}
+
+	// See mat44_simd.cpp: FMA may change the last bits of the results.
+	bool nearly_equal_( Vec3f aX, Vec3f aY )
+	{
+		for( std::size_t i = 0; i < 3; ++i )
+		{
+			if( std::abs( aX[i] - aY[i] ) > 1e-5f * std::max( std::abs( aX[i] ), std::abs( aY[i] ) ) + 1e-6f )
+				return false;
+		}
+		return true;
+	}
+}
+
+TEST_CASE("Batched point transform matches scalar", "[batch]") {
+
+	std::mt19937 rng( 42 );
+
+	// Cover all combinations of full SIMD blocks and remainders.
+	for( std::size_t count = 0; count < 40; ++count )
+	{
+		Mat44f const m = random_matrix_( rng );
+		Mat33f const n = mat44_to_mat33( m );
+		std::vector<Vec3f> const in = random_points_( rng, count );
+
+		std::vector<Vec3f> out( count ), ref( count );
+
+		transform_points( m, in.data(), out.data(), count );
+		detail::transform_points_scalar( m, in.data(), ref.data(), count );
+		for( std::size_t i = 0; i < count; ++i )
+			REQUIRE( nearly_equal_( out[i], ref[i] ) );
+
+		transform_points_affine( m, in.data(), out.data(), count );
+		detail::transform_points_affine_scalar( m, in.data(), ref.data(), count );
+		for( std::size_t i = 0; i < count; ++i )
+			REQUIRE( nearly_equal_( out[i], ref[i] ) );
+
+		transform_normals( n, in.data(), out.data(), count );
+		detail::transform_normals_scalar( n, in.data(), ref.data(), count );
+		for( std::size_t i = 0; i < count; ++i )
+			REQUIRE( nearly_equal_( out[i], ref[i] ) );
+	}
+}
+
+TEST_CASE("Batched point transform in-place", "[batch]") {
+
+	std::mt19937 rng( 7 );
+
+	Mat44f const m = make_translation( { 1.f, 2.f, 3.f } ) * make_rotation_y( 0.5f ) * make_scaling( 2.f, 2.f, 2.f );
+	std::vector<Vec3f> points = random_points_( rng, 37 );
+	std::vector<Vec3f> const original = points;
+
+	transform_points( m, points.data(), points.data(), points.size() );
+
+	for( std::size_t i = 0; i < points.size(); ++i )
+	{
+		Vec4f const t = m * Vec4f{ original[i].x, original[i].y, original[i].z, 1.f };
+		REQUIRE( nearly_equal_( points[i], Vec3f{ t.x, t.y, t.z } ) );
+	}
+}
+
+TEST_CASE("Batched Vec4f transform matches scalar", "[batch]") {
+
+	std::mt19937 rng( 1337 );
+	std::uniform_real_distribution<float> dist( -1.f, 1.f );
+
+	for( std::size_t count = 0; count < 40; ++count )
+	{
+		Mat44f const m = random_matrix_( rng );
+
+		std::vector<Vec4f> in( count );
+		for( auto& v : in )
+			v = Vec4f{ dist( rng ), dist( rng ), dist( rng ), dist( rng ) };
+
+		std::vector<Vec4f> out( count ), ref( count );
+		transform_vec4( m, in.data(), out.data(), count );
+		detail::transform_vec4_scalar( m, in.data(), ref.data(), count );
+
+		for( std::size_t i = 0; i < count; ++i )
+		{
+			REQUIRE( nearly_equal_( Vec3f{ out[i].x, out[i].y, out[i].z }, Vec3f{ ref[i].x, ref[i].y, ref[i].z } ) );
+			REQUIRE( std::abs( out[i].w - ref[i].w ) <= 1e-5f );
+		}
+	}
+}
@@ -0,0 +1,192 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <random>
+#include <vector>
+
+#include "../vmlib/bounds.hpp"
+
+namespace
+{
+	constexpr float kPi_ = 3.1415926f;
+
+	// Camera at (0,0,5) looking down -z, 90 degree vertical FOV
+	Frustumf test_frustum_()
+	{
+		Mat44f const proj = make_perspective_projection( 90.f * kPi_ / 180.f, 1.f, 1.f, 100.f );
+		Mat44f const view = look_at( Vec3f{ 0.f, 0.f, 5.f }, Vec3f{ 0.f, 0.f, 0.f }, Vec3f{ 0.f, 1.f, 0.f } );
+		return make_frustum( proj * view );
+	}
+
+	bool equal_( Vec3f aX, Vec3f aY )
+	{
+		return aX.x == aY.x && aX.y == aY.y && aX.z == aY.z;
+	}
+
+	Aabb3f make_box_( Vec3f aCenter, Vec3f aHalfExtents )
+	{
+		return Aabb3f{ aCenter - aHalfExtents, aCenter + aHalfExtents };
+	}
+
+	std::vector<Aabb3f> random_boxes_( std::mt19937& aRng, std::size_t aCount )
+	{
+		std::uniform_real_distribution<float> pos( -150.f, 150.f );
+		std::uniform_real_distribution<float> ext( 0.f, 20.f );
+
+		std::vector<Aabb3f> ret;
+		for( std::size_t i = 0; i < aCount; ++i )
+			ret.emplace_back( make_box_( Vec3f{ pos( aRng ), pos( aRng ), pos( aRng ) - 50.f }, Vec3f{ ext( aRng ), ext( aRng ), ext( aRng ) } ) );
+		return ret;
+	}
+}
+
+TEST_CASE("Aabb3f basics", "[bounds]") {
+
+	REQUIRE( is_empty( kEmptyAabb3f ) );
+
+	Vec3f const points[] = {
+		{ 1.f, 2.f, 3.f }, { -1.f, 5.f, 0.f }, { 0.f, -2.f, 7.f }
+	};
+	Aabb3f const box = make_aabb( points, 3 );
+	REQUIRE( equal_( box.min, Vec3f{ -1.f, -2.f, 0.f } ) );
+	REQUIRE( equal_( box.max, Vec3f{ 1.f, 5.f, 7.f } ) );
+	REQUIRE( !is_empty( box ) );
+	REQUIRE( contains( box, points[1] ) );
+	REQUIRE( !contains( box, Vec3f{ 0.f, 0.f, 8.f } ) );
+
+	REQUIRE( distance( box, points[2] ) == 0.f );
+	REQUIRE( distance( box, Vec3f{ 0.f, 0.f, 9.f } ) == Catch::Approx( 2.f ) );
+	REQUIRE( distance( box, Vec3f{ 4.f, 9.f, 3.f } ) == Catch::Approx( 5.f ) );
+
+	REQUIRE( is_empty( make_aabb( points, 0 ) ) );
+	REQUIRE( equal_( merge( kEmptyAabb3f, box ).min, box.min ) );
+	REQUIRE( equal_( merge( kEmptyAabb3f, box ).max, box.max ) );
+
+	REQUIRE( equal_( center( box ), Vec3f{ 0.f, 1.5f, 3.5f } ) );
+	REQUIRE( equal_( half_extents( box ), Vec3f{ 1.f, 3.5f, 3.5f } ) );
+
+	Spheref const s = bounding_sphere( box );
+	for( auto const& p : points )
+		REQUIRE( length( p - s.center ) <= s.radius );
+}
+
+TEST_CASE("transform_aabb", "[bounds]") {
+
+	Aabb3f const box{ { -1.f, -2.f, -3.f }, { 1.f, 2.f, 3.f } };
+
+	// Translation and scaling are exact
+	Aabb3f const t = transform_aabb( make_translation( { 10.f, 0.f, 0.f } ) * make_scaling( 2.f, 2.f, 2.f ), box );
+	REQUIRE( equal_( t.min, Vec3f{ 8.f, -4.f, -6.f } ) );
+	REQUIRE( equal_( t.max, Vec3f{ 12.f, 4.f, 6.f } ) );
+
+	// Rotated: the result contains all transformed corners
+	Mat44f const r = make_rotation_y( 0.7f ) * make_rotation_x( 0.3f );
+	Aabb3f const rb = transform_aabb( r, box );
+	for( int i = 0; i < 8; ++i )
+	{
+		Vec3f const corner{ (i & 1) ? 1.f : -1.f, (i & 2) ? 2.f : -2.f, (i & 4) ? 3.f : -3.f };
+		Vec4f const p = r * Vec4f{ corner.x, corner.y, corner.z, 1.f };
+		Vec3f const eps{ 1e-5f, 1e-5f, 1e-5f };
+		REQUIRE( contains( Aabb3f{ rb.min - eps, rb.max + eps }, Vec3f{ p.x, p.y, p.z } ) );
+	}
+}
+
+TEST_CASE("Frustum tests", "[bounds]") {
+
+	Frustumf const f = test_frustum_();
+
+	// Points
+	REQUIRE( contains( f, Vec3f{ 0.f, 0.f, 0.f } ) );
+	REQUIRE( contains( f, Vec3f{ 0.f, 9.f, -5.f } ) );   // inside at distance 10, |y| < 10
+	REQUIRE( !contains( f, Vec3f{ 0.f, 11.f, -5.f } ) ); // above
+	REQUIRE( !contains( f, Vec3f{ 0.f, 0.f, 4.5f } ) );  // before the near plane
+	REQUIRE( !contains( f, Vec3f{ 0.f, 0.f, -96.f } ) ); // beyond the far plane
+	REQUIRE( !contains( f, Vec3f{ 0.f, 0.f, 10.f } ) );  // behind the camera
+
+	// Plane distances are normalized: the near plane is at z = 4
+	REQUIRE( signed_distance( f.planes[Frustumf::kNear], Vec3f{ 0.f, 0.f, 0.f } ) == Catch::Approx( 4.f ) );
+
+	// Spheres
+	REQUIRE( intersects( f, Spheref{ { 0.f, 0.f, 0.f }, 1.f } ) );
+	REQUIRE( intersects( f, Spheref{ { 0.f, 11.f, -5.f }, 2.f } ) );
+	REQUIRE( !intersects( f, Spheref{ { 0.f, 20.f, -5.f }, 2.f } ) );
+	REQUIRE( !intersects( f, Spheref{ { 0.f, 0.f, 10.f }, 2.f } ) );
+
+	// Boxes
+	REQUIRE( intersects( f, make_box_( { 0.f, 0.f, 0.f }, { 1.f, 1.f, 1.f } ) ) );
+	REQUIRE( intersects( f, make_box_( { 0.f, 0.f, 0.f }, { 500.f, 500.f, 500.f } ) ) ); // contains the frustum
+	REQUIRE( intersects( f, make_box_( { 0.f, 12.f, -5.f }, { 1.f, 2.5f, 1.f } ) ) );   // straddles the top plane
+	REQUIRE( !intersects( f, make_box_( { 0.f, 15.f, -5.f }, { 1.f, 2.f, 1.f } ) ) );
+	REQUIRE( !intersects( f, make_box_( { -30.f, 0.f, -5.f }, { 1.f, 1.f, 1.f } ) ) );
+	REQUIRE( !intersects( f, make_box_( { 0.f, 0.f, 20.f }, { 1.f, 1.f, 1.f } ) ) );
+}
+
+TEST_CASE("Frustum culling is conservative", "[bounds]") {
+
+	Frustumf const f = test_frustum_();
+
+	std::mt19937 rng( 2024 );
+	auto const boxes = random_boxes_( rng, 2000 );
+
+	std::size_t visibleCount = 0;
+	for( auto const& box : boxes )
+	{
+		bool const visible = intersects( f, box );
+		visibleCount += visible;
+		if( visible )
+			continue;
+
+		// A rejected box must not contain any point inside the frustum
+		std::uniform_real_distribution<float> t( 0.f, 1.f );
+		for( std::size_t i = 0; i < 64; ++i )
+		{
+			Vec3f const p{
+				box.min.x + t( rng ) * (box.max.x - box.min.x),
+				box.min.y + t( rng ) * (box.max.y - box.min.y),
+				box.min.z + t( rng ) * (box.max.z - box.min.z)
+			};
+			REQUIRE( !contains( f, p ) );
+		}
+	}
+
+	// Sanity check: the test data has both visible and culled boxes
+	REQUIRE( visibleCount > 100 );
+	REQUIRE( visibleCount < boxes.size() - 100 );
+}
+
+TEST_CASE("Batched cull matches intersects", "[bounds]") {
+
+	Frustumf const f = test_frustum_();
+	std::mt19937 rng( 1337 );
+
+	// All combinations of full SIMD blocks, remainders and word boundaries
+	for( std::size_t count : { 0, 1, 3, 4, 5, 7, 8, 9, 15, 17, 63, 64, 65, 100, 130 } )
+	{
+		auto const boxes = random_boxes_( rng, count );
+
+		std::vector<std::uint64_t> visible( cull_word_count( count ), ~std::uint64_t(0) );
+		std::vector<std::uint64_t> ref( cull_word_count( count ), ~std::uint64_t(0) );
+
+		cull( f, boxes.data(), count, visible.data() );
+		detail::cull_scalar( f, boxes.data(), count, ref.data() );
+
+		for( std::size_t i = 0; i < count; ++i )
+		{
+			// FMA may change the last bits of the margin; only boxes that
+			// touch a plane could be classified differently.
+			if( is_visible( visible.data(), i ) != intersects( f, boxes[i] ) )
+			{
+				Aabb3f const grown{ boxes[i].min - Vec3f{ 1e-3f, 1e-3f, 1e-3f }, boxes[i].max + Vec3f{ 1e-3f, 1e-3f, 1e-3f } };
+				Aabb3f const shrunk{ boxes[i].min + Vec3f{ 1e-3f, 1e-3f, 1e-3f }, boxes[i].max - Vec3f{ 1e-3f, 1e-3f, 1e-3f } };
+				REQUIRE( intersects( f, grown ) != intersects( f, shrunk ) );
+			}
+			REQUIRE( is_visible( ref.data(), i ) == intersects( f, boxes[i] ) );
+		}
+
+		// Unused bits are cleared
+		if( count % 64 )
+		{
+			REQUIRE( (visible.back() >> (count % 64)) == 0 );
+			REQUIRE( (ref.back() >> (count % 64)) == 0 );
+		}
+	}
+}
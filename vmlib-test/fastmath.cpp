@@ -0,0 +1,200 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <limits>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+#include "../vmlib/fastmath.hpp"
+
+// The tests measure the max. error of each approximation over a dense set of
+// arguments, using the double precision functions as the reference, and
+// check that it stays within the documented bound.
+
+namespace
+{
+	std::vector<float> samples_( float aMin, float aMax, std::size_t aCount )
+	{
+		std::vector<float> ret;
+		ret.reserve( aCount + 2 );
+		for( std::size_t i = 0; i < aCount; ++i )
+			ret.emplace_back( aMin + (aMax - aMin) * float(double(i) / (aCount-1)) );
+
+		std::mt19937 rng( 1234 );
+		std::uniform_real_distribution<float> dist( aMin, aMax );
+		for( std::size_t i = 0; i < aCount; ++i )
+			ret.emplace_back( dist( rng ) );
+
+		return ret;
+	}
+
+	template< class tFunc, class tRef >
+	double max_abs_error_( std::vector<float> const& aArgs, tFunc&& aFunc, tRef&& aRef )
+	{
+		double ret = 0.0;
+		for( auto const x : aArgs )
+			ret = std::max( ret, std::abs( double(aFunc( x )) - aRef( double(x) ) ) );
+		return ret;
+	}
+
+#	if !VMLIB_SIMD_NONE
+	// Evaluate a SIMD function for a single argument, by placing the
+	// argument in each lane in turn.
+	template< class tVec, class tFunc >
+	auto lanes_( tFunc&& aFunc )
+	{
+		return [aFunc] (float aX) {
+			constexpr std::size_t kLanes = sizeof(tVec) / sizeof(float);
+
+			float in[kLanes], out[kLanes];
+			float ret = 0.f;
+			for( std::size_t lane = 0; lane < kLanes; ++lane )
+			{
+				std::fill_n( in, kLanes, 0.5f );
+				in[lane] = aX;
+				simd::store( out, aFunc( simd::load<tVec>( in ) ) );
+
+				// All lanes must give the same result
+				if( lane > 0 && out[lane] != ret )
+					return std::numeric_limits<float>::quiet_NaN();
+				ret = out[lane];
+			}
+			return ret;
+		};
+	}
+#	endif // ~ !VMLIB_SIMD_NONE
+}
+
+TEST_CASE("sin_fast/cos_fast error bound", "[fastmath]") {
+
+	auto const args = samples_( -kSinCosFastRange, kSinCosFastRange, 400000 );
+	auto const small = samples_( -10.f, 10.f, 100000 );
+
+	auto const sinRef = [] (double aX) { return std::sin( aX ); };
+	auto const cosRef = [] (double aX) { return std::cos( aX ); };
+
+	SECTION("scalar") {
+		REQUIRE( max_abs_error_( args, [] (float x) { return sin_fast( x ); }, sinRef ) <= kSinCosFastMaxError );
+		REQUIRE( max_abs_error_( args, [] (float x) { return cos_fast( x ); }, cosRef ) <= kSinCosFastMaxError );
+		REQUIRE( max_abs_error_( small, [] (float x) { return sin_fast( x ); }, sinRef ) <= kSinCosFastMaxError );
+		REQUIRE( max_abs_error_( small, [] (float x) { return cos_fast( x ); }, cosRef ) <= kSinCosFastMaxError );
+
+		// sincos_fast() gives the same results as the individual functions
+		for( auto const x : small )
+		{
+			float s, c;
+			sincos_fast( x, s, c );
+			REQUIRE( s == sin_fast( x ) );
+			REQUIRE( c == cos_fast( x ) );
+		}
+	}
+
+	SECTION("exact values") {
+		REQUIRE( sin_fast( 0.f ) == 0.f );
+		REQUIRE( std::abs( cos_fast( 0.f ) - 1.f ) <= kSinCosFastMaxError );
+		REQUIRE( std::abs( sin_fast( 1.5707963f ) - 1.f ) <= kSinCosFastMaxError );
+		REQUIRE( std::abs( sin_fast( -1.5707963f ) + 1.f ) <= kSinCosFastMaxError );
+	}
+
+#	if !VMLIB_SIMD_NONE
+	SECTION("F32x4") {
+		using simd::F32x4;
+		REQUIRE( max_abs_error_( args, lanes_<F32x4>( [] (F32x4 x) { return simd::sin_fast( x ); } ), sinRef ) <= kSinCosFastMaxError );
+		REQUIRE( max_abs_error_( args, lanes_<F32x4>( [] (F32x4 x) { return simd::cos_fast( x ); } ), cosRef ) <= kSinCosFastMaxError );
+	}
+#	endif // ~ !VMLIB_SIMD_NONE
+#	if VMLIB_SIMD_AVX
+	SECTION("F32x8") {
+		using simd::F32x8;
+		REQUIRE( max_abs_error_( args, lanes_<F32x8>( [] (F32x8 x) { return simd::sin_fast( x ); } ), sinRef ) <= kSinCosFastMaxError );
+		REQUIRE( max_abs_error_( args, lanes_<F32x8>( [] (F32x8 x) { return simd::cos_fast( x ); } ), cosRef ) <= kSinCosFastMaxError );
+	}
+#	endif // ~ AVX
+}
+
+TEST_CASE("acos_fast error bound", "[fastmath]") {
+
+	auto args = samples_( -1.f, 1.f, 200000 );
+	args.emplace_back( -1.f );
+	args.emplace_back( 1.f );
+
+	auto const acosRef = [] (double aX) { return std::acos( aX ); };
+
+	REQUIRE( max_abs_error_( args, [] (float x) { return acos_fast( x ); }, acosRef ) <= kAcosFastMaxError );
+
+#	if !VMLIB_SIMD_NONE
+	using simd::F32x4;
+	REQUIRE( max_abs_error_( args, lanes_<F32x4>( [] (F32x4 x) { return simd::acos_fast( x ); } ), acosRef ) <= kAcosFastMaxError );
+#	endif // ~ !VMLIB_SIMD_NONE
+#	if VMLIB_SIMD_AVX
+	using simd::F32x8;
+	REQUIRE( max_abs_error_( args, lanes_<F32x8>( [] (F32x8 x) { return simd::acos_fast( x ); } ), acosRef ) <= kAcosFastMaxError );
+#	endif // ~ AVX
+}
+
+TEST_CASE("rsqrt_fast error bound", "[fastmath]") {
+
+	// Cover a few binades completely, plus a wide range of magnitudes.
+	auto args = samples_( 0.25f, 4.f, 200000 );
+	for( float x = 1e-30f; x < 1e30f; x *= 1.37f )
+		args.emplace_back( x );
+
+	auto const relError = [&args] (auto&& aFunc) {
+		double ret = 0.0;
+		for( auto const x : args )
+		{
+			double const ref = 1.0 / std::sqrt( double(x) );
+			ret = std::max( ret, std::abs( aFunc( x ) - ref ) / ref );
+		}
+		return ret;
+	};
+
+	REQUIRE( relError( [] (float x) { return rsqrt_fast( x ); } ) <= kRsqrtFastMaxRelError );
+
+#	if !VMLIB_SIMD_NONE
+	using simd::F32x4;
+	REQUIRE( relError( lanes_<F32x4>( [] (F32x4 x) { return simd::rsqrt_fast( x ); } ) ) <= kRsqrtFastMaxRelError );
+#	endif // ~ !VMLIB_SIMD_NONE
+#	if VMLIB_SIMD_AVX
+	using simd::F32x8;
+	REQUIRE( relError( lanes_<F32x8>( [] (F32x8 x) { return simd::rsqrt_fast( x ); } ) ) <= kRsqrtFastMaxRelError );
+#	endif // ~ AVX
+}
+
+TEST_CASE("normalize_fast error bound", "[fastmath]") {
+
+	std::mt19937 rng( 4321 );
+	std::uniform_real_distribution<float> dist( -100.f, 100.f );
+
+	for( std::size_t i = 0; i < 10000; ++i )
+	{
+		Vec3f const v{ dist( rng ), dist( rng ), dist( rng ) };
+		Vec3f const n = normalize_fast( v );
+
+		double const len = std::sqrt( double(n.x)*n.x + double(n.y)*n.y + double(n.z)*n.z );
+		REQUIRE( std::abs( len - 1.0 ) <= kNormalizeFastMaxError );
+
+		// Same direction
+		REQUIRE( dot( n, normalize( v ) ) >= 1.f - kNormalizeFastMaxError );
+	}
+
+#	if !VMLIB_SIMD_NONE
+	alignas(16) float x[4] = { 3.f, 0.f, -1e-3f, 7.f };
+	alignas(16) float y[4] = { 4.f, 0.f, 2e-3f, -1.f };
+	alignas(16) float z[4] = { 0.f, 5.f, 2e-3f, 0.5f };
+
+	simd::F32x4 vx = simd::load4( x ), vy = simd::load4( y ), vz = simd::load4( z );
+	simd::normalize_fast( vx, vy, vz );
+	simd::store( x, vx );
+	simd::store( y, vy );
+	simd::store( z, vz );
+
+	for( std::size_t i = 0; i < 4; ++i )
+	{
+		double const len = std::sqrt( double(x[i])*x[i] + double(y[i])*y[i] + double(z[i])*z[i] );
+		REQUIRE( std::abs( len - 1.0 ) <= kNormalizeFastMaxError );
+	}
+	REQUIRE( std::abs( x[0] - 0.6f ) <= kNormalizeFastMaxError );
+	REQUIRE( std::abs( y[0] - 0.8f ) <= kNormalizeFastMaxError );
+#	endif // ~ !VMLIB_SIMD_NONE
+}
@@ -0,0 +1,102 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <random>
+
+#include "../vmlib/mat33.hpp"
+#include "../vmlib/mat44.hpp"
+
+namespace
+{
+	// Random rotation about a random axis, plus a random translation.
+	Mat44f random_rigid_( std::mt19937& aRng )
+	{
+		std::uniform_real_distribution<float> dist( -1.f, 1.f );
+
+		Vec3f const axis = normalize( Vec3f{ dist( aRng ), dist( aRng ), dist( aRng ) } + Vec3f{ 0.f, 0.f, 1e-3f } );
+		float const angle = 3.1415926f * dist( aRng );
+		Vec3f const t{ 10.f * dist( aRng ), 10.f * dist( aRng ), 10.f * dist( aRng ) };
+
+		return make_translation( t ) * rotate( angle, axis );
+	}
+
+	// Rigid transform combined with non-uniform scaling.
+	Mat44f random_affine_( std::mt19937& aRng )
+	{
+		std::uniform_real_distribution<float> scale( 0.1f, 5.f );
+		return random_rigid_( aRng ) * make_scaling( scale( aRng ), scale( aRng ), scale( aRng ) ) * random_rigid_( aRng );
+	}
+
+	float max_abs_diff_( Mat44f const& aX, Mat44f const& aY )
+	{
+		float ret = 0.f;
+		for( std::size_t i = 0; i < 16; ++i )
+			ret = std::max( ret, std::abs( aX.v[i] - aY.v[i] ) );
+		return ret;
+	}
+	float max_abs_diff_( Mat33f const& aX, Mat33f const& aY )
+	{
+		float ret = 0.f;
+		for( std::size_t i = 0; i < 9; ++i )
+			ret = std::max( ret, std::abs( aX.v[i] - aY.v[i] ) );
+		return ret;
+	}
+}
+
+TEST_CASE("Affine inverse matches general inverse", "[mat44][invert]") {
+
+	std::mt19937 rng( 2024 );
+
+	for( int n = 0; n < 1000; ++n )
+	{
+		Mat44f const m = random_affine_( rng );
+		Mat44f const inv = invert_affine( m );
+
+		REQUIRE( max_abs_diff_( inv, invert( m ) ) < 1e-3f );
+		REQUIRE( max_abs_diff_( inv * m, kIdentity44f ) < 1e-4f );
+		REQUIRE( max_abs_diff_( detail::invert_affine_scalar( m ), invert( m ) ) < 1e-3f );
+#		if !VMLIB_SIMD_NONE
+		REQUIRE( max_abs_diff_( detail::invert_affine_simd( m ), detail::invert_affine_scalar( m ) ) < 1e-4f );
+#		endif
+
+		// The last row must be exactly (0,0,0,1).
+		REQUIRE( inv(3,0) == 0.f );
+		REQUIRE( inv(3,1) == 0.f );
+		REQUIRE( inv(3,2) == 0.f );
+		REQUIRE( inv(3,3) == 1.f );
+	}
+}
+
+TEST_CASE("Rigid inverse matches general inverse", "[mat44][invert]") {
+
+	std::mt19937 rng( 99 );
+
+	for( int n = 0; n < 1000; ++n )
+	{
+		Mat44f const m = random_rigid_( rng );
+		Mat44f const inv = invert_rigid( m );
+
+		REQUIRE( max_abs_diff_( inv, invert( m ) ) < 1e-4f );
+		REQUIRE( max_abs_diff_( inv * m, kIdentity44f ) < 1e-5f );
+	}
+}
+
+TEST_CASE("Normal matrix matches inverse-transpose", "[mat33][invert]") {
+
+	std::mt19937 rng( 31337 );
+
+	for( int n = 0; n < 1000; ++n )
+	{
+		Mat44f const m = random_affine_( rng );
+		Mat33f const reference = mat44_to_mat33( transpose( invert( m ) ) );
+
+		REQUIRE( max_abs_diff_( normal_matrix( m ), reference ) < 1e-4f );
+		REQUIRE( max_abs_diff_( detail::normal_matrix_scalar( m ), reference ) < 1e-4f );
+#		if !VMLIB_SIMD_NONE
+		REQUIRE( max_abs_diff_( detail::normal_matrix_simd( m ), detail::normal_matrix_scalar( m ) ) < 1e-5f );
+#		endif
+	}
+
+	// Identity and pure translations have the identity as normal matrix.
+	REQUIRE( max_abs_diff_( normal_matrix( kIdentity44f ), kIdentity33f ) == 0.f );
+	REQUIRE( max_abs_diff_( normal_matrix( make_translation( { 1.f, 2.f, 3.f } ) ), kIdentity33f ) == 0.f );
+}
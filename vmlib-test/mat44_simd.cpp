@@ -0,0 +1,82 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <random>
+#include <algorithm>
+
+#include "../vmlib/mat44.hpp"
+#include "../vmlib/vec4.hpp"
+
+namespace
+{
+	Mat44f random_matrix_( std::mt19937& aRng )
+	{
+		std::uniform_real_distribution<float> dist( -10.f, 10.f );
+
+		Mat44f ret;
+		for( auto& v : ret.v )
+			v = dist( aRng );
+		return ret;
+	}
+
+	// The SIMD code evaluates the same sequence of operations as the scalar
+	// code. However, when FMA is available, either side may fuse a multiply
+	// and an add (the compiler is free to contract the scalar code), so the
+	// intermediate products are not always rounded. Allow for a small
+	// difference.
+	bool nearly_equal_( float aX, float aY )
+	{
+		return std::abs( aX - aY ) <= 1e-5f * std::max( std::abs( aX ), std::abs( aY ) ) + 1e-4f;
+	}
+}
+
+// The operators must remain usable in constant expressions.
+static_assert( kIdentity44f * kIdentity44f == kIdentity44f );
+static_assert( kIdentity44f * Vec4f{ 1.f, 2.f, 3.f, 4.f } == Vec4f{ 1.f, 2.f, 3.f, 4.f } );
+
+TEST_CASE("Matrix Multiplication SIMD matches scalar", "[mat44][simd]") {
+
+	std::mt19937 rng( 1234 );
+
+	for( int n = 0; n < 1000; ++n )
+	{
+		Mat44f const a = random_matrix_( rng );
+		Mat44f const b = random_matrix_( rng );
+
+		Mat44f const test = a * b;
+		Mat44f const reference = detail::mat44_mul_scalar( a, b );
+
+		for( std::size_t i = 0; i < 16; ++i )
+			REQUIRE( nearly_equal_( test.v[i], reference.v[i] ) );
+	}
+}
+
+TEST_CASE("Matrix Vector Multiplication SIMD matches scalar", "[mat44][simd]") {
+
+	std::mt19937 rng( 5678 );
+	std::uniform_real_distribution<float> dist( -10.f, 10.f );
+
+	for( int n = 0; n < 1000; ++n )
+	{
+		Mat44f const m = random_matrix_( rng );
+		Vec4f const x{ dist( rng ), dist( rng ), dist( rng ), dist( rng ) };
+
+		Vec4f const test = m * x;
+		Vec4f const reference = detail::mat44_mul_scalar( m, x );
+
+		for( std::size_t i = 0; i < 4; ++i )
+			REQUIRE( nearly_equal_( test[i], reference[i] ) );
+	}
+}
+
+TEST_CASE("Matrix Multiplication SIMD with special values", "[mat44][simd]") {
+
+	Mat44f a = kIdentity44f;
+	a(1, 2) = -0.f;
+	a(3, 0) = 1e30f;
+
+	Mat44f const b = make_translation( Vec3f{ 1.f, 2.f, 3.f } );
+
+	REQUIRE( a * b == detail::mat44_mul_scalar( a, b ) );
+	REQUIRE( a * kIdentity44f == a );
+	REQUIRE( kIdentity44f * b == b );
+}
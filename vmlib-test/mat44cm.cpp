@@ -0,0 +1,97 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <random>
+#include <cstring>
+
+#include "../vmlib/mat44.hpp"
+#include "../vmlib/mat44cm.hpp"
+
+namespace
+{
+	Mat44f random_matrix_( std::mt19937& aRng )
+	{
+		std::uniform_real_distribution<float> dist( -10.f, 10.f );
+
+		Mat44f ret;
+		for( auto& v : ret.v )
+			v = dist( aRng );
+		return ret;
+	}
+
+	bool nearly_equal_( float aX, float aY )
+	{
+		return std::abs( aX - aY ) <= 1e-5f * std::max( std::abs( aX ), std::abs( aY ) ) + 1e-4f;
+	}
+}
+
+// Both layouts are 16 byte aligned and the same size as a std140 mat4.
+static_assert( sizeof(Mat44f) == 64 && alignof(Mat44f) == 16 );
+static_assert( sizeof(Mat44fCM) == 64 && alignof(Mat44fCM) == 16 );
+
+// Conversions and operators must remain usable in constant expressions.
+static_assert( to_column_major( kIdentity44f ) == kIdentity44fCM );
+static_assert( to_row_major( kIdentity44fCM ) == kIdentity44f );
+static_assert( kIdentity44fCM * kIdentity44fCM == kIdentity44fCM );
+
+TEST_CASE("Column-major storage layout", "[mat44cm]") {
+
+	Mat44f const m = { {
+		 1.f,  2.f,  3.f,  4.f,
+		 5.f,  6.f,  7.f,  8.f,
+		 9.f, 10.f, 11.f, 12.f,
+		13.f, 14.f, 15.f, 16.f
+	} };
+
+	Mat44fCM const cm = to_column_major( m );
+
+	// The first column is stored first; this is what OpenGL/std140 expect.
+	float const expected[16] = {
+		1.f, 5.f,  9.f, 13.f,
+		2.f, 6.f, 10.f, 14.f,
+		3.f, 7.f, 11.f, 15.f,
+		4.f, 8.f, 12.f, 16.f
+	};
+	REQUIRE( 0 == std::memcmp( cm.v, expected, sizeof(expected) ) );
+
+	// operator() uses (row, column) in both layouts
+	for( std::size_t i = 0; i < 4; ++i )
+	{
+		for( std::size_t j = 0; j < 4; ++j )
+			REQUIRE( cm(i,j) == m(i,j) );
+	}
+
+	REQUIRE( to_row_major( cm ) == m );
+}
+
+TEST_CASE("Column-major operators match row-major", "[mat44cm]") {
+
+	std::mt19937 rng( 4711 );
+	std::uniform_real_distribution<float> dist( -10.f, 10.f );
+
+	for( int n = 0; n < 1000; ++n )
+	{
+		Mat44f const a = random_matrix_( rng );
+		Mat44f const b = random_matrix_( rng );
+		Vec4f const x{ dist( rng ), dist( rng ), dist( rng ), dist( rng ) };
+
+		Mat44fCM const acm = to_column_major( a );
+		Mat44fCM const bcm = to_column_major( b );
+
+		Mat44f const ab = a * b;
+		Mat44fCM const abcm = acm * bcm;
+		for( std::size_t i = 0; i < 4; ++i )
+		{
+			for( std::size_t j = 0; j < 4; ++j )
+				REQUIRE( nearly_equal_( abcm(i,j), ab(i,j) ) );
+		}
+
+		Mat44fCM const reference = detail::mat44cm_mul_scalar( acm, bcm );
+		for( std::size_t i = 0; i < 16; ++i )
+			REQUIRE( nearly_equal_( abcm.v[i], reference.v[i] ) );
+
+		Vec4f const ax = a * x;
+		Vec4f const axcm = acm * x;
+		for( std::size_t i = 0; i < 4; ++i )
+			REQUIRE( nearly_equal_( axcm[i], ax[i] ) );
+	}
+}
@@ -0,0 +1,175 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <cmath>
+#include <array>
+#include <random>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+
+#include "../vmlib/mesh_optimize.hpp"
+
+namespace
+{
+	// Regular grid of aSize x aSize quads in the xz plane, with the
+	// triangles in random order
+	struct Grid_
+	{
+		std::vector<Vec3f> positions;
+		std::vector<std::uint32_t> indices;
+	};
+
+	Grid_ shuffled_grid_( std::uint32_t aSize, std::uint32_t aSeed )
+	{
+		Grid_ ret;
+		for( std::uint32_t z = 0; z <= aSize; ++z )
+		{
+			for( std::uint32_t x = 0; x <= aSize; ++x )
+				ret.positions.emplace_back( Vec3f{ float(x), 0.f, float(z) } );
+		}
+
+		std::vector<std::array<std::uint32_t,3>> triangles;
+		for( std::uint32_t z = 0; z < aSize; ++z )
+		{
+			for( std::uint32_t x = 0; x < aSize; ++x )
+			{
+				std::uint32_t const i = z * (aSize+1) + x;
+				triangles.push_back( { i, i + aSize + 1, i + 1 } );
+				triangles.push_back( { i + 1, i + aSize + 1, i + aSize + 2 } );
+			}
+		}
+
+		std::mt19937 rng( aSeed );
+		std::shuffle( triangles.begin(), triangles.end(), rng );
+
+		for( auto const& t : triangles )
+			ret.indices.insert( ret.indices.end(), t.begin(), t.end() );
+		return ret;
+	}
+
+	// Triangles as a sorted list, each rotated to start with its smallest
+	// index (this keeps the winding)
+	std::vector<std::array<std::uint32_t,3>> canonical_( std::vector<std::uint32_t> const& aIndices )
+	{
+		std::vector<std::array<std::uint32_t,3>> ret;
+		for( std::size_t i = 0; i < aIndices.size(); i += 3 )
+		{
+			std::array<std::uint32_t,3> t{ aIndices[i], aIndices[i+1], aIndices[i+2] };
+			std::rotate( t.begin(), std::min_element( t.begin(), t.end() ), t.end() );
+			ret.emplace_back( t );
+		}
+		std::sort( ret.begin(), ret.end() );
+		return ret;
+	}
+}
+
+TEST_CASE("simulate_vertex_cache", "[mesh_optimize]") {
+
+	SECTION("single triangle") {
+		std::uint32_t const indices[] = { 0, 1, 2 };
+		auto const stats = simulate_vertex_cache( indices, 3, 3 );
+		REQUIRE( stats.transformedVertices == 3 );
+		REQUIRE( stats.acmr == 3.f );
+		REQUIRE( stats.atvr == 1.f );
+	}
+
+	SECTION("FIFO eviction") {
+		// With a cache of 3 entries, vertex 0 is evicted by 1, 2, 3
+		std::uint32_t const indices[] = { 0, 1, 2,  1, 2, 3,  0, 2, 3 };
+		auto const stats = simulate_vertex_cache( indices, 9, 4, 3 );
+		REQUIRE( stats.transformedVertices == 5 );
+		REQUIRE( stats.acmr == Catch::Approx( 5.f / 3.f ) );
+		REQUIRE( stats.atvr == Catch::Approx( 5.f / 4.f ) );
+
+		// ... but not with a larger cache
+		REQUIRE( simulate_vertex_cache( indices, 9, 4, 4 ).transformedVertices == 4 );
+	}
+
+	SECTION("empty") {
+		auto const stats = simulate_vertex_cache( nullptr, 0, 0 );
+		REQUIRE( stats.transformedVertices == 0 );
+		REQUIRE( stats.acmr == 0.f );
+	}
+}
+
+TEST_CASE("optimize_vertex_cache", "[mesh_optimize]") {
+
+	auto grid = shuffled_grid_( 64, 7 );
+	auto const before = simulate_vertex_cache( grid.indices.data(), grid.indices.size(), grid.positions.size() );
+
+	auto optimized = grid.indices;
+	optimize_vertex_cache( optimized.data(), optimized.size(), grid.positions.size() );
+	auto const after = simulate_vertex_cache( optimized.data(), optimized.size(), grid.positions.size() );
+
+	// Same triangles, same winding
+	REQUIRE( canonical_( optimized ) == canonical_( grid.indices ) );
+
+	// A shuffled grid misses almost every vertex; Tipsify gets within a few
+	// tens of percent of the optimum (0.5) on grids.
+	REQUIRE( before.acmr > 2.5f );
+	REQUIRE( after.acmr < 0.8f );
+	REQUIRE( after.atvr < 1.6f );
+
+	SECTION("degenerate input") {
+		// Unreferenced vertices, repeated and degenerate triangles
+		std::vector<std::uint32_t> indices{ 4, 5, 6,  4, 5, 6,  2, 2, 2,  6, 5, 7 };
+		auto const ref = canonical_( indices );
+		optimize_vertex_cache( indices.data(), indices.size(), 10 );
+		REQUIRE( canonical_( indices ) == ref );
+
+		optimize_vertex_cache( nullptr, 0, 0 );
+	}
+}
+
+TEST_CASE("optimize_overdraw", "[mesh_optimize]") {
+
+	auto grid = shuffled_grid_( 64, 11 );
+	std::size_t const vertexCount = grid.positions.size();
+
+	// Bend the grid into a half cylinder, so that the clusters have
+	// different orientations
+	for( auto& p : grid.positions )
+		p = Vec3f{ 10.f * std::cos( p.x / 64.f * 3.1415926f ), 10.f * std::sin( p.x / 64.f * 3.1415926f ), p.z };
+
+	optimize_vertex_cache( grid.indices.data(), grid.indices.size(), vertexCount );
+	auto const cached = simulate_vertex_cache( grid.indices.data(), grid.indices.size(), vertexCount );
+
+	auto optimized = grid.indices;
+	optimize_overdraw( optimized.data(), optimized.size(), grid.positions.data(), vertexCount, 1.05f );
+	auto const after = simulate_vertex_cache( optimized.data(), optimized.size(), vertexCount );
+
+	REQUIRE( canonical_( optimized ) == canonical_( grid.indices ) );
+	REQUIRE( optimized != grid.indices );
+
+	// The reordering costs some cache efficiency, but not much
+	REQUIRE( after.acmr < cached.acmr * 1.25f );
+
+	// Lower thresholds give fewer, larger clusters
+	auto coarse = grid.indices;
+	optimize_overdraw( coarse.data(), coarse.size(), grid.positions.data(), vertexCount, 1.f );
+	REQUIRE( canonical_( coarse ) == canonical_( grid.indices ) );
+}
+
+TEST_CASE("optimize_vertex_fetch", "[mesh_optimize]") {
+
+	std::vector<std::uint32_t> indices{ 5, 2, 7,  7, 2, 0,  0, 5, 9 };
+	auto const original = indices;
+
+	std::vector<std::uint32_t> remap( 10 );
+	std::size_t const used = optimize_vertex_fetch( indices.data(), indices.size(), 10, remap.data() );
+
+	REQUIRE( used == 5 );
+	REQUIRE( indices == std::vector<std::uint32_t>{ 0, 1, 2,  2, 1, 3,  3, 0, 4 } );
+	REQUIRE( remap[1] == kUnusedVertex );
+	REQUIRE( remap[9] == 4 );
+
+	// Remapped attributes give the same triangles as before
+	std::vector<float> attribute( 10 );
+	std::iota( attribute.begin(), attribute.end(), 100.f );
+
+	std::vector<float> remapped( used );
+	remap_vertices( remapped.data(), attribute.data(), 10, remap.data() );
+
+	for( std::size_t i = 0; i < indices.size(); ++i )
+		REQUIRE( remapped[indices[i]] == attribute[original[i]] );
+}
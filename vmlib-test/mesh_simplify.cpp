@@ -0,0 +1,256 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <algorithm>
+
+#include "../vmlib/mesh_simplify.hpp"
+
+namespace
+{
+	// Grid of aSize x aSize quads in the xz plane, with heights from aHeight
+	// and texture coordinates (u,v) = (x,z) / aSize as attributes. With a
+	// seam, the vertices at x = aSize/2 are duplicated and the right half
+	// uses a different texture area (u offset by 1).
+	struct Grid_
+	{
+		std::vector<Vec3f> positions;
+		std::vector<float> texcoords;
+		std::vector<std::uint32_t> indices;
+		std::vector<bool> rightSide;
+	};
+
+	template< class tHeight >
+	Grid_ make_grid_( std::uint32_t aSize, tHeight&& aHeight, bool aSeam = false )
+	{
+		Grid_ ret;
+		std::vector<std::uint32_t> left( (aSize+1) * (aSize+1) ), right( (aSize+1) * (aSize+1) );
+
+		auto const add = [&] (std::uint32_t aX, std::uint32_t aZ, bool aRight) {
+			float const x = float(aX), z = float(aZ);
+			ret.positions.emplace_back( Vec3f{ x, aHeight( x, z ), z } );
+			ret.texcoords.emplace_back( x / aSize + (aRight ? 1.f : 0.f) );
+			ret.texcoords.emplace_back( z / aSize );
+			ret.rightSide.emplace_back( aRight );
+			return std::uint32_t(ret.positions.size() - 1);
+		};
+
+		for( std::uint32_t z = 0; z <= aSize; ++z )
+		{
+			for( std::uint32_t x = 0; x <= aSize; ++x )
+			{
+				std::uint32_t const i = z * (aSize+1) + x;
+				bool const onSeam = aSeam && 2*x == aSize;
+				left[i] = add( x, z, aSeam && 2*x > aSize );
+				right[i] = onSeam ? add( x, z, true ) : left[i];
+			}
+		}
+
+		for( std::uint32_t z = 0; z < aSize; ++z )
+		{
+			for( std::uint32_t x = 0; x < aSize; ++x )
+			{
+				std::uint32_t const i = z * (aSize+1) + x;
+				auto const& v = (aSeam && 2*x >= aSize) ? right : left;
+				ret.indices.insert( ret.indices.end(), { v[i], v[i + aSize + 1], v[i + 1] } );
+				ret.indices.insert( ret.indices.end(), { v[i + 1], v[i + aSize + 1], v[i + aSize + 2] } );
+			}
+		}
+
+		return ret;
+	}
+
+	float hills_( float aX, float aZ )
+	{
+		return 2.f * std::sin( aX * 0.3f ) * std::cos( aZ * 0.2f ) + 0.05f * aX;
+	}
+
+	// Max. distance of the vertices used by aSource to the surface aResult
+	// (brute force)
+	float source_distance_( std::vector<std::uint32_t> const& aSource, std::uint32_t const* aResult, std::size_t aResultCount, std::vector<Vec3f> const& aPositions )
+	{
+		std::vector<bool> used( aPositions.size(), false );
+		for( auto i : aSource )
+			used[i] = true;
+
+		float ret = 0.f;
+		for( std::size_t v = 0; v < aPositions.size(); ++v )
+		{
+			if( !used[v] )
+				continue;
+
+			float best = std::numeric_limits<float>::infinity();
+			for( std::size_t i = 0; i < aResultCount; i += 3 )
+				best = std::min( best, point_triangle_distance( aPositions[v], aPositions[aResult[i]], aPositions[aResult[i+1]], aPositions[aResult[i+2]] ) );
+
+			ret = std::max( ret, best );
+		}
+		return ret;
+	}
+
+	float area_( std::uint32_t const* aIndices, std::size_t aIndexCount, std::vector<Vec3f> const& aPositions )
+	{
+		float ret = 0.f;
+		for( std::size_t i = 0; i < aIndexCount; i += 3 )
+			ret += 0.5f * length( cross( aPositions[aIndices[i+1]] - aPositions[aIndices[i]], aPositions[aIndices[i+2]] - aPositions[aIndices[i]] ) );
+		return ret;
+	}
+}
+
+TEST_CASE("point_triangle_distance", "[mesh_simplify]") {
+
+	Vec3f const a{ 0.f, 0.f, 0.f }, b{ 2.f, 0.f, 0.f }, c{ 0.f, 2.f, 0.f };
+
+	REQUIRE( point_triangle_distance( Vec3f{ 0.5f, 0.5f, 3.f }, a, b, c ) == Catch::Approx( 3.f ) );   // face
+	REQUIRE( point_triangle_distance( Vec3f{ 1.f, -4.f, 3.f }, a, b, c ) == Catch::Approx( 5.f ) );   // edge ab
+	REQUIRE( point_triangle_distance( Vec3f{ -3.f, -4.f, 0.f }, a, b, c ) == Catch::Approx( 5.f ) );  // vertex a
+	REQUIRE( point_triangle_distance( Vec3f{ 2.f, 2.f, 0.f }, a, b, c ) == Catch::Approx( std::sqrt( 2.f ) ) ); // edge bc
+	REQUIRE( point_triangle_distance( Vec3f{ 5.f, 0.f, 4.f }, a, b, c ) == Catch::Approx( 5.f ) );   // vertex b
+}
+
+TEST_CASE("simplify_mesh LOD error bounds", "[mesh_simplify]") {
+
+	Grid_ const grid = make_grid_( 32, hills_ );
+	std::size_t const vertexCount = grid.positions.size();
+	float const weights[] = { 0.1f, 0.1f };
+
+	// LOD chain: halve the triangle count each time, starting from the
+	// source (as the renderer does)
+	std::vector<std::uint32_t> lod( grid.indices.size() );
+	std::size_t previous = grid.indices.size();
+
+	for( int level = 1; level <= 5; ++level )
+	{
+		std::size_t const target = (grid.indices.size() >> level) / 3 * 3;
+
+		float error = -1.f;
+		std::size_t const count = simplify_mesh( lod.data(), grid.indices.data(), grid.indices.size(), grid.positions.data(), vertexCount, grid.texcoords.data(), 2, weights, target, std::numeric_limits<float>::max(), &error );
+
+		INFO( "LOD " << level << ": " << count / 3 << " triangles, error " << error );
+
+		// Each collapse removes two triangles
+		REQUIRE( count % 3 == 0 );
+		REQUIRE( count <= target );
+		REQUIRE( count + 6 >= target );
+		REQUIRE( count < previous );
+		REQUIRE( std::all_of( lod.begin(), lod.begin() + count, [&] (std::uint32_t aI) { return aI < vertexCount; } ) );
+
+		// The reported error bounds the distance of every source vertex to
+		// the simplified surface
+		float const actual = source_distance_( grid.indices, lod.data(), count, grid.positions );
+		REQUIRE( actual <= error + 1e-5f );
+		REQUIRE( error > 0.f );
+
+		// The terrain keeps its outline
+		REQUIRE( area_( lod.data(), count, grid.positions ) > 0.95f * area_( grid.indices.data(), grid.indices.size(), grid.positions ) );
+
+		previous = count;
+	}
+}
+
+TEST_CASE("simplify_mesh target error", "[mesh_simplify]") {
+
+	Grid_ const grid = make_grid_( 16, [] (float, float) { return 0.f; } );
+	std::vector<std::uint32_t> out( grid.indices.size() );
+	float const weights[] = { 1.f, 1.f };
+
+	SECTION("flat grid collapses, borders stay") {
+		// Planar, with linear texture coordinates: every collapse is free
+		// except those that move the border
+		float error = -1.f;
+		std::size_t const count = simplify_mesh( out.data(), grid.indices.data(), grid.indices.size(), grid.positions.data(), grid.positions.size(), grid.texcoords.data(), 2, weights, 0, 1e-3f, &error );
+
+		REQUIRE( count / 3 <= 64 + 2 ); // at most the border vertices remain
+		REQUIRE( count / 3 >= 2 );
+		REQUIRE( error <= 1e-4f );
+		REQUIRE( area_( out.data(), count, grid.positions ) == Catch::Approx( 256.f ).epsilon( 1e-4 ) );
+	}
+
+	SECTION("a smaller target error keeps more triangles") {
+		Grid_ const hills = make_grid_( 16, hills_ );
+		auto const simplify = [&] (float aTargetError) {
+			return simplify_mesh( out.data(), hills.indices.data(), hills.indices.size(), hills.positions.data(), hills.positions.size(), nullptr, 0, nullptr, 0, aTargetError );
+		};
+
+		std::size_t const fine = simplify( 0.01f );
+		std::size_t const coarse = simplify( 0.5f );
+		REQUIRE( fine < hills.indices.size() );
+		REQUIRE( coarse < fine );
+	}
+
+	SECTION("empty input") {
+		float error = -1.f;
+		REQUIRE( 0 == simplify_mesh( out.data(), nullptr, 0, nullptr, 0, nullptr, 0, nullptr, 0, 1.f, &error ) );
+		REQUIRE( error == 0.f );
+	}
+}
+
+TEST_CASE("simplify_mesh keeps attribute seams", "[mesh_simplify]") {
+
+	Grid_ const grid = make_grid_( 16, [] (float, float) { return 0.f; }, true );
+	std::vector<std::uint32_t> out( grid.indices.size() );
+	float const weights[] = { 1.f, 1.f };
+
+	float error = -1.f;
+	std::size_t const count = simplify_mesh( out.data(), grid.indices.data(), grid.indices.size(), grid.positions.data(), grid.positions.size(), grid.texcoords.data(), 2, weights, 0, 1e-3f, &error );
+
+	REQUIRE( count < grid.indices.size() / 4 );
+	REQUIRE( error <= 1e-4f );
+	REQUIRE( area_( out.data(), count, grid.positions ) == Catch::Approx( 256.f ).epsilon( 1e-4 ) );
+
+	// No triangle mixes the texture areas of the two halves
+	for( std::size_t i = 0; i < count; i += 3 )
+	{
+		bool const side = grid.rightSide[out[i]];
+		REQUIRE( grid.rightSide[out[i+1]] == side );
+		REQUIRE( grid.rightSide[out[i+2]] == side );
+	}
+}
+
+TEST_CASE("mesh_vertex_distance", "[mesh_simplify]") {
+
+	Grid_ const grid = make_grid_( 24, hills_ );
+
+	// Chain of LODs, each simplified from the previous one; the distance to
+	// the source matches a brute force search
+	std::vector<std::uint32_t> previous = grid.indices;
+	for( int level = 1; level <= 4; ++level )
+	{
+		std::vector<std::uint32_t> lod( previous.size() );
+		std::size_t const count = simplify_mesh( lod.data(), previous.data(), previous.size(), grid.positions.data(), grid.positions.size(), nullptr, 0, nullptr, previous.size() / 2 / 3 * 3, std::numeric_limits<float>::max() );
+		lod.resize( count );
+
+		float const distance = mesh_vertex_distance( grid.indices.data(), grid.indices.size(), lod.data(), lod.size(), grid.positions.data(), grid.positions.size() );
+		REQUIRE( distance == Catch::Approx( source_distance_( grid.indices, lod.data(), lod.size(), grid.positions ) ).margin( 1e-6 ) );
+
+		previous = std::move( lod );
+	}
+
+	// The source itself is at distance zero
+	REQUIRE( 0.f == mesh_vertex_distance( grid.indices.data(), grid.indices.size(), grid.indices.data(), grid.indices.size(), grid.positions.data(), grid.positions.size() ) );
+}
+
+TEST_CASE("simplify_mesh keeps locked vertices", "[mesh_simplify]") {
+
+	Grid_ const grid = make_grid_( 16, hills_ );
+	std::vector<std::uint32_t> out( grid.indices.size() );
+
+	// Lock a column through the middle, as if the grid was split there
+	std::vector<std::uint8_t> locked( grid.positions.size(), 0 );
+	for( std::size_t v = 0; v < grid.positions.size(); ++v )
+		locked[v] = 8.f == grid.positions[v].x;
+
+	std::size_t const count = simplify_mesh( out.data(), grid.indices.data(), grid.indices.size(), grid.positions.data(), grid.positions.size(), nullptr, 0, nullptr, 0, std::numeric_limits<float>::max(), nullptr, locked.data() );
+	REQUIRE( count < grid.indices.size() / 4 );
+
+	std::vector<bool> used( grid.positions.size(), false );
+	for( std::size_t i = 0; i < count; ++i )
+		used[out[i]] = true;
+
+	for( std::size_t v = 0; v < grid.positions.size(); ++v )
+	{
+		if( locked[v] )
+			REQUIRE( used[v] );
+	}
+}
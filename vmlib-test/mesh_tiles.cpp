@@ -0,0 +1,123 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <array>
+#include <vector>
+#include <algorithm>
+
+#include "../vmlib/mesh_tiles.hpp"
+
+namespace
+{
+	// Grid of aSize x aSize unit quads in the xz plane
+	struct Grid_
+	{
+		std::vector<Vec3f> positions;
+		std::vector<std::uint32_t> indices;
+	};
+
+	Grid_ make_grid_( std::uint32_t aSize )
+	{
+		Grid_ ret;
+		for( std::uint32_t z = 0; z <= aSize; ++z )
+		{
+			for( std::uint32_t x = 0; x <= aSize; ++x )
+				ret.positions.emplace_back( Vec3f{ float(x), float((x + z) % 3), float(z) } );
+		}
+
+		for( std::uint32_t z = 0; z < aSize; ++z )
+		{
+			for( std::uint32_t x = 0; x < aSize; ++x )
+			{
+				std::uint32_t const i = z * (aSize+1) + x;
+				ret.indices.insert( ret.indices.end(), { i, i + aSize + 1, i + 1 } );
+				ret.indices.insert( ret.indices.end(), { i + 1, i + aSize + 1, i + aSize + 2 } );
+			}
+		}
+		return ret;
+	}
+
+	std::vector<std::array<std::uint32_t,3>> sorted_triangles_( std::vector<std::uint32_t> const& aIndices )
+	{
+		std::vector<std::array<std::uint32_t,3>> ret;
+		for( std::size_t i = 0; i < aIndices.size(); i += 3 )
+			ret.push_back( { aIndices[i], aIndices[i+1], aIndices[i+2] } );
+		std::sort( ret.begin(), ret.end() );
+		return ret;
+	}
+}
+
+TEST_CASE("partition_mesh_xz", "[mesh_tiles]") {
+
+	Grid_ grid = make_grid_( 16 );
+	auto const before = sorted_triangles_( grid.indices );
+
+	Aabb3f const bounds = make_aabb( grid.positions.data(), grid.positions.size() );
+
+	// 4 x 2 tiles of 4 x 8 quads
+	std::uint32_t offsets[4*2 + 1];
+	Aabb3f tileBounds[4*2];
+	partition_mesh_xz( grid.indices.data(), grid.indices.size(), grid.positions.data(), bounds, 4, 2, offsets, tileBounds );
+
+	// Same triangles (with the same winding), in tile order
+	REQUIRE( sorted_triangles_( grid.indices ) == before );
+	REQUIRE( offsets[0] == 0 );
+	REQUIRE( offsets[8] == grid.indices.size() );
+
+	for( std::size_t tile = 0; tile < 8; ++tile )
+	{
+		REQUIRE( offsets[tile+1] - offsets[tile] == 3 * 2*4*8 );
+
+		float const x0 = 4.f * float(tile % 4), z0 = 8.f * float(tile / 4);
+		REQUIRE( tileBounds[tile].min.x == x0 );
+		REQUIRE( tileBounds[tile].max.x == x0 + 4.f );
+		REQUIRE( tileBounds[tile].min.z == z0 );
+		REQUIRE( tileBounds[tile].max.z == z0 + 8.f );
+
+		for( std::size_t i = offsets[tile]; i < offsets[tile+1]; ++i )
+			REQUIRE( contains( tileBounds[tile], grid.positions[grid.indices[i]] ) );
+	}
+
+	SECTION("empty tiles") {
+		// A box twice as wide leaves the upper half of the tiles empty
+		Aabb3f wide = bounds;
+		wide.max.x += 16.f;
+
+		partition_mesh_xz( grid.indices.data(), grid.indices.size(), grid.positions.data(), wide, 4, 2, offsets, tileBounds );
+		REQUIRE( offsets[3] - offsets[2] == 0 );
+		REQUIRE( is_empty( tileBounds[3] ) );
+		REQUIRE( offsets[2] - offsets[1] == 3 * 2*8*8 );
+	}
+}
+
+TEST_CASE("mark_tile_borders", "[mesh_tiles]") {
+
+	Grid_ grid = make_grid_( 8 );
+
+	// Duplicate the vertex at (4, 6) for the triangles of the right half, as
+	// an attribute seam would
+	std::uint32_t const seam = 6 * 9 + 4;
+	grid.positions.emplace_back( grid.positions[seam] );
+	std::uint32_t const twin = std::uint32_t(grid.positions.size() - 1);
+
+	Aabb3f const bounds = make_aabb( grid.positions.data(), grid.positions.size() );
+
+	std::uint32_t offsets[2 + 1];
+	partition_mesh_xz( grid.indices.data(), grid.indices.size(), grid.positions.data(), bounds, 2, 1, offsets );
+
+	for( std::size_t i = offsets[1]; i < offsets[2]; ++i )
+	{
+		if( seam == grid.indices[i] )
+			grid.indices[i] = twin;
+	}
+
+	std::vector<std::uint8_t> border( grid.positions.size(), 2 );
+	mark_tile_borders( grid.indices.data(), offsets, 2, grid.positions.data(), grid.positions.size(), border.data() );
+
+	// The column x = 4 is shared; the seam vertex and its twin are each
+	// only used by one tile, but share a position
+	for( std::size_t v = 0; v < grid.positions.size(); ++v )
+	{
+		INFO( "vertex " << v );
+		REQUIRE( border[v] == (4.f == grid.positions[v].x ? 1 : 0) );
+	}
+}
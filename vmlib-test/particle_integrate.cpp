@@ -0,0 +1,99 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <random>
+#include <vector>
+#include <algorithm>
+
+#include "../vmlib/particle_integrate.hpp"
+
+namespace
+{
+	struct State_
+	{
+		Vec3Stream positions;
+		Vec3Stream velocities;
+		std::vector<float> lifeTimes;
+		std::vector<std::uint64_t> deathMask;
+	};
+
+	State_ random_state_( std::size_t aCount, unsigned aSeed )
+	{
+		std::mt19937 rng( aSeed );
+		std::uniform_real_distribution<float> coord( -100.f, 100.f );
+		std::uniform_real_distribution<float> life( -0.5f, 2.f );
+
+		State_ ret{ Vec3Stream( aCount ), Vec3Stream( aCount ), std::vector<float>( aCount ), std::vector<std::uint64_t>( death_mask_words( aCount ), ~std::uint64_t(0) ) };
+		for( std::size_t i = 0; i < aCount; ++i )
+		{
+			ret.positions.set( i, Vec3f{ coord( rng ), coord( rng ), coord( rng ) } );
+			ret.velocities.set( i, Vec3f{ coord( rng ), coord( rng ), coord( rng ) } );
+			ret.lifeTimes[i] = life( rng );
+		}
+		return ret;
+	}
+
+	// Equal up to rounding of the multiply-add (fused or not)
+	bool close_( Vec3Stream const& aX, Vec3Stream const& aY )
+	{
+		if( aX.size() != aY.size() )
+			return false;
+
+		for( std::size_t i = 0; i < aX.size(); ++i )
+		{
+			if( length( aX.get( i ) - aY.get( i ) ) > 1e-5f * (1.f + length( aY.get( i ) )) )
+				return false;
+		}
+		return true;
+	}
+}
+
+TEST_CASE("integrate_particles", "[particle_integrate]") {
+
+	float const dt = 0.016f;
+
+	for( std::size_t const count : { 0, 1, 15, 63, 64, 65, 200, 4099 } )
+	{
+		INFO( "count " << count );
+
+		// Reference: one particle at a time
+		State_ ref = random_state_( count, 7 );
+		State_ const initial = ref;
+
+		std::size_t refDead = 0;
+		for( std::size_t i = 0; i < count; ++i )
+		{
+			ref.positions.set( i, ref.positions.get( i ) + dt * ref.velocities.get( i ) );
+			ref.lifeTimes[i] -= dt;
+			refDead += ref.lifeTimes[i] < 0.f;
+		}
+
+		for( SimdIsa const isa : { SimdIsa::scalar, SimdIsa::sse2, SimdIsa::avx2, SimdIsa::avx512 } )
+		{
+			INFO( "isa " << simd_isa_name( std::min( isa, cpu_simd_isa() ) ) );
+
+			State_ state = initial;
+			std::size_t const dead = integrate_particles( isa, dt, state.velocities, state.positions, state.lifeTimes.data(), state.deathMask.data() );
+
+			REQUIRE( dead == refDead );
+			REQUIRE( close_( state.positions, ref.positions ) );
+			REQUIRE( state.lifeTimes == ref.lifeTimes );
+
+			// The mask matches the lifetimes, and is clear past the end
+			for( std::size_t i = 0; i < 64 * state.deathMask.size(); ++i )
+			{
+				bool const bit = (state.deathMask[i / 64] >> (i % 64)) & 1;
+				REQUIRE( bit == (i < count && state.lifeTimes[i] < 0.f) );
+			}
+		}
+	}
+}
+
+TEST_CASE("for_each_set_bit", "[particle_integrate]") {
+
+	std::uint64_t const mask[] = { 0x8000000000000001ull, 0, 0x12ull };
+
+	std::vector<std::size_t> bits;
+	for_each_set_bit( mask, 3, [&] (std::size_t aI) { bits.emplace_back( aI ); } );
+
+	REQUIRE( bits == std::vector<std::size_t>{ 0, 63, 129, 132 } );
+}
@@ -0,0 +1,190 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <cstring>
+
+#include "../vmlib/quantize.hpp"
+
+namespace
+{
+	float angle_between_( Vec3f aX, Vec3f aY )
+	{
+		// atan2 of |cross| and dot is accurate also for tiny angles
+		return std::atan2( length( cross( aX, aY ) ), dot( aX, aY ) );
+	}
+
+	Vec3f random_unit_( std::mt19937& aRng )
+	{
+		std::normal_distribution<float> dist;
+		while( true )
+		{
+			Vec3f const v{ dist( aRng ), dist( aRng ), dist( aRng ) };
+			if( length( v ) > 1e-3f )
+				return normalize( v );
+		}
+	}
+}
+
+TEST_CASE("Fixed point quantization", "[quantize]") {
+
+	std::mt19937 rng( 5 );
+	std::uniform_real_distribution<float> unit( 0.f, 1.f );
+	std::uniform_real_distribution<float> signedUnit( -1.f, 1.f );
+
+	float maxErr8 = 0.f, maxErr16 = 0.f, maxErrS8 = 0.f, maxErrS16 = 0.f;
+	for( int i = 0; i < 100000; ++i )
+	{
+		float const x = unit( rng );
+		maxErr8 = std::max( maxErr8, std::abs( dequantize_unorm8( quantize_unorm8( x ) ) - x ) );
+		maxErr16 = std::max( maxErr16, std::abs( dequantize_unorm16( quantize_unorm16( x ) ) - x ) );
+
+		float const s = signedUnit( rng );
+		maxErrS8 = std::max( maxErrS8, std::abs( dequantize_snorm8( quantize_snorm8( s ) ) - s ) );
+		maxErrS16 = std::max( maxErrS16, std::abs( dequantize_snorm16( quantize_snorm16( s ) ) - s ) );
+	}
+
+	// Half a step, plus float rounding
+	constexpr float kEps = 1e-7f;
+	REQUIRE( maxErr8 <= 0.5f / 255.f + kEps );
+	REQUIRE( maxErr16 <= 0.5f / 65535.f + kEps );
+	REQUIRE( maxErrS8 <= 0.5f / 127.f + kEps );
+	REQUIRE( maxErrS16 <= 0.5f / 32767.f + kEps );
+
+	// End points are exact, out-of-range values are clamped
+	REQUIRE( quantize_unorm8( 0.f ) == 0 );
+	REQUIRE( quantize_unorm8( 1.f ) == 255 );
+	REQUIRE( quantize_unorm8( 2.f ) == 255 );
+	REQUIRE( quantize_unorm16( -1.f ) == 0 );
+	REQUIRE( dequantize_snorm16( quantize_snorm16( -1.f ) ) == -1.f );
+	REQUIRE( dequantize_snorm8( -128 ) == -1.f );
+}
+
+TEST_CASE("Position quantization", "[quantize]") {
+
+	Aabb3f const box{ { -500.f, 2.f, -3000.f }, { 1500.f, 90.f, 1000.f } };
+	PositionQuantization const quant = make_position_quantization( box );
+	Vec3f const extent = box.max - box.min;
+
+	std::mt19937 rng( 17 );
+	std::uniform_real_distribution<float> t( 0.f, 1.f );
+
+	Vec3f maxErr{ 0.f, 0.f, 0.f };
+	for( int i = 0; i < 100000; ++i )
+	{
+		Vec3f const p{
+			box.min.x + t( rng ) * extent.x,
+			box.min.y + t( rng ) * extent.y,
+			box.min.z + t( rng ) * extent.z
+		};
+
+		std::uint16_t q[3];
+		quantize_position( p, quant, q );
+		Vec3f const err = dequantize_position( q, quant ) - p;
+
+		maxErr.x = std::max( maxErr.x, std::abs( err.x ) );
+		maxErr.y = std::max( maxErr.y, std::abs( err.y ) );
+		maxErr.z = std::max( maxErr.z, std::abs( err.z ) );
+	}
+
+	// Half a step, plus float rounding (a few ulps at the box's magnitude)
+	REQUIRE( maxErr.x <= extent.x / (2.f * 65535.f) + 1500.f * 5e-7f );
+	REQUIRE( maxErr.y <= extent.y / (2.f * 65535.f) + 90.f * 5e-7f );
+	REQUIRE( maxErr.z <= extent.z / (2.f * 65535.f) + 3000.f * 5e-7f );
+
+	// Corners are exact; flat boxes work
+	std::uint16_t q[3];
+	quantize_position( box.max, quant, q );
+	REQUIRE( q[0] == 65535 );
+	REQUIRE( q[1] == 65535 );
+	REQUIRE( q[2] == 65535 );
+
+	PositionQuantization const flat = make_position_quantization( Aabb3f{ { 0.f, 1.f, 0.f }, { 10.f, 1.f, 10.f } } );
+	quantize_position( Vec3f{ 5.f, 1.f, 5.f }, flat, q );
+	REQUIRE( dequantize_position( q, flat ).y == 1.f );
+}
+
+TEST_CASE("Octahedral normals", "[quantize]") {
+
+	std::mt19937 rng( 23 );
+
+	float maxErr16 = 0.f, maxErr8 = 0.f, maxErrExact = 0.f;
+	for( int i = 0; i < 200000; ++i )
+	{
+		Vec3f const n = random_unit_( rng );
+
+		maxErrExact = std::max( maxErrExact, angle_between_( n, decode_octahedral( encode_octahedral( n ) ) ) );
+
+		std::int16_t q16[2];
+		quantize_octahedral16( n, q16 );
+		maxErr16 = std::max( maxErr16, angle_between_( n, dequantize_octahedral16( q16 ) ) );
+
+		std::int8_t q8[2];
+		quantize_octahedral8( n, q8 );
+		maxErr8 = std::max( maxErr8, angle_between_( n, dequantize_octahedral8( q8 ) ) );
+	}
+
+	REQUIRE( maxErrExact < 1e-6f );
+	REQUIRE( maxErr16 <= kOct16MaxAngleError );
+	REQUIRE( maxErr8 <= kOct8MaxAngleError );
+
+	// Axes and the folded edges of the lower hemisphere
+	for( Vec3f const n : {
+		Vec3f{ 1.f, 0.f, 0.f }, Vec3f{ -1.f, 0.f, 0.f },
+		Vec3f{ 0.f, 1.f, 0.f }, Vec3f{ 0.f, -1.f, 0.f },
+		Vec3f{ 0.f, 0.f, 1.f }, Vec3f{ 0.f, 0.f, -1.f },
+		Vec3f{ 0.f, -0.6f, -0.8f }, Vec3f{ -0.6f, 0.f, -0.8f } } )
+	{
+		std::int16_t q16[2];
+		quantize_octahedral16( n, q16 );
+		REQUIRE( angle_between_( n, dequantize_octahedral16( q16 ) ) <= kOct16MaxAngleError );
+	}
+}
+
+TEST_CASE("Half floats", "[quantize]") {
+
+	SECTION("all halves round trip") {
+		for( std::uint32_t h = 0; h < 0x10000u; ++h )
+		{
+			float const f = half_to_float( std::uint16_t(h) );
+			if( std::isnan( f ) )
+			{
+				REQUIRE( std::isnan( half_to_float( float_to_half( f ) ) ) );
+				continue;
+			}
+
+			REQUIRE( float_to_half( f ) == h );
+		}
+	}
+
+	SECTION("known values") {
+		REQUIRE( float_to_half( 1.f ) == 0x3c00 );
+		REQUIRE( float_to_half( -2.f ) == 0xc000 );
+		REQUIRE( float_to_half( 65504.f ) == 0x7bff );
+		REQUIRE( float_to_half( 65519.f ) == 0x7bff );
+		REQUIRE( float_to_half( 65520.f ) == 0x7c00 );
+		REQUIRE( float_to_half( std::numeric_limits<float>::infinity() ) == 0x7c00 );
+		REQUIRE( float_to_half( 5.9604645e-8f ) == 0x0001 );   // smallest subnormal
+		REQUIRE( float_to_half( 2.9802322e-8f ) == 0x0000 );   // tie, rounds to even
+		REQUIRE( float_to_half( 1.f + 1.f/2048.f ) == 0x3c00 ); // tie, rounds to even
+		REQUIRE( float_to_half( 1.f + 3.f/2048.f ) == 0x3c02 ); // tie, rounds to even
+		REQUIRE( half_to_float( 0x3555 ) == Catch::Approx( 1.f/3.f ).epsilon( 1e-3 ) );
+	}
+
+	SECTION("relative error") {
+		std::mt19937 rng( 29 );
+		std::uniform_real_distribution<float> exponent( -14.f, 15.f );
+		std::uniform_real_distribution<float> mantissa( 1.f, 2.f );
+
+		for( int i = 0; i < 100000; ++i )
+		{
+			float const x = std::ldexp( mantissa( rng ), int(std::floor( exponent( rng ) )) );
+			if( x > 65504.f )
+				continue;
+
+			float const y = half_to_float( float_to_half( x ) );
+			REQUIRE( std::abs( y - x ) <= x * (1.f / 2048.f) );
+		}
+	}
+}
@@ -0,0 +1,207 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <random>
+
+#include "../vmlib/quat.hpp"
+#include "../vmlib/transform.hpp"
+
+namespace
+{
+	Vec3f random_unit_( std::mt19937& aRng )
+	{
+		std::uniform_real_distribution<float> dist( -1.f, 1.f );
+		return normalize( Vec3f{ dist( aRng ), dist( aRng ), dist( aRng ) } + Vec3f{ 0.f, 0.f, 1e-3f } );
+	}
+
+	Quatf random_rotation_( std::mt19937& aRng )
+	{
+		std::uniform_real_distribution<float> dist( -3.1415926f, 3.1415926f );
+		return make_quat_rotation( dist( aRng ), random_unit_( aRng ) );
+	}
+
+	Transform random_transform_( std::mt19937& aRng )
+	{
+		std::uniform_real_distribution<float> dist( -10.f, 10.f );
+		std::uniform_real_distribution<float> scale( 0.2f, 5.f );
+		return make_transform( Vec3f{ dist( aRng ), dist( aRng ), dist( aRng ) }, random_rotation_( aRng ), scale( aRng ) );
+	}
+
+	bool nearly_equal_( Vec3f aX, Vec3f aY, float aEps )
+	{
+		return length( aX - aY ) <= aEps * (1.f + length( aY ));
+	}
+
+	// q and -q are the same rotation
+	bool same_rotation_( Quatf const& aX, Quatf const& aY, float aEps )
+	{
+		return std::abs( std::abs( dot( aX, aY ) ) - 1.f ) <= aEps;
+	}
+
+	float max_abs_diff_( Mat44f const& aX, Mat44f const& aY )
+	{
+		float ret = 0.f;
+		for( std::size_t i = 0; i < 16; ++i )
+			ret = std::max( ret, std::abs( aX.v[i] - aY.v[i] ) );
+		return ret;
+	}
+}
+
+static_assert( kIdentityQuatf * kIdentityQuatf == kIdentityQuatf );
+static_assert( quat_to_mat44( kIdentityQuatf ) == kIdentity44f );
+
+TEST_CASE("Quaternion rotation matches rotation matrix", "[quat]") {
+
+	std::mt19937 rng( 123 );
+	std::uniform_real_distribution<float> angle( -3.1415926f, 3.1415926f );
+
+	for( int n = 0; n < 1000; ++n )
+	{
+		float const a = angle( rng );
+		Vec3f const axis = random_unit_( rng );
+		Vec3f const v = 5.f * random_unit_( rng );
+
+		Quatf const q = make_quat_rotation( a, axis );
+		Mat44f const m = rotate( a, axis );
+
+		REQUIRE( max_abs_diff_( quat_to_mat44( q ), m ) < 1e-5f );
+
+		Vec4f const mv = m * Vec4f{ v.x, v.y, v.z, 0.f };
+		REQUIRE( nearly_equal_( rotate( q, v ), Vec3f{ mv.x, mv.y, mv.z }, 1e-5f ) );
+	}
+
+	// Axis-aligned helpers match the matrix versions.
+	REQUIRE( max_abs_diff_( quat_to_mat44( make_quat_rotation_x( 0.3f ) ), make_rotation_x( 0.3f ) ) < 1e-6f );
+	REQUIRE( max_abs_diff_( quat_to_mat44( make_quat_rotation_y( 0.3f ) ), make_rotation_y( 0.3f ) ) < 1e-6f );
+	REQUIRE( max_abs_diff_( quat_to_mat44( make_quat_rotation_z( 0.3f ) ), make_rotation_z( 0.3f ) ) < 1e-6f );
+}
+
+TEST_CASE("Quaternion product composes rotations", "[quat]") {
+
+	std::mt19937 rng( 456 );
+
+	for( int n = 0; n < 1000; ++n )
+	{
+		Quatf const p = random_rotation_( rng );
+		Quatf const q = random_rotation_( rng );
+		Vec3f const v = random_unit_( rng );
+
+		REQUIRE( nearly_equal_( rotate( p * q, v ), rotate( p, rotate( q, v ) ), 1e-5f ) );
+		REQUIRE( max_abs_diff_( quat_to_mat44( p * q ), quat_to_mat44( p ) * quat_to_mat44( q ) ) < 1e-5f );
+
+		// The conjugate undoes the rotation
+		REQUIRE( nearly_equal_( rotate( conjugate( q ), rotate( q, v ) ), v, 1e-5f ) );
+	}
+}
+
+TEST_CASE("Quaternion from matrix round trip", "[quat]") {
+
+	std::mt19937 rng( 789 );
+
+	for( int n = 0; n < 1000; ++n )
+	{
+		Quatf const q = random_rotation_( rng );
+
+		REQUIRE( same_rotation_( mat33_to_quat( quat_to_mat33( q ) ), q, 1e-5f ) );
+		REQUIRE( same_rotation_( mat44_to_quat( quat_to_mat44( q ) ), q, 1e-5f ) );
+	}
+
+	// Exercise each branch: 180 degree turns have a zero trace.
+	for( Vec3f axis : { Vec3f{ 1.f, 0.f, 0.f }, Vec3f{ 0.f, 1.f, 0.f }, Vec3f{ 0.f, 0.f, 1.f } } )
+	{
+		Quatf const q = make_quat_rotation( 3.1415926f, axis );
+		REQUIRE( same_rotation_( mat33_to_quat( quat_to_mat33( q ) ), q, 1e-5f ) );
+	}
+}
+
+TEST_CASE("Quaternion rotation between vectors", "[quat]") {
+
+	std::mt19937 rng( 1011 );
+
+	for( int n = 0; n < 1000; ++n )
+	{
+		Vec3f const a = random_unit_( rng );
+		Vec3f const b = random_unit_( rng );
+
+		REQUIRE( nearly_equal_( rotate( make_quat_rotation_between( a, b ), a ), b, 1e-4f ) );
+	}
+
+	// Opposite vectors
+	Vec3f const z{ 0.f, 0.f, 1.f };
+	REQUIRE( nearly_equal_( rotate( make_quat_rotation_between( z, -z ), z ), -z, 1e-5f ) );
+	Vec3f const x{ 1.f, 0.f, 0.f };
+	REQUIRE( nearly_equal_( rotate( make_quat_rotation_between( x, -x ), x ), -x, 1e-5f ) );
+}
+
+TEST_CASE("Quaternion slerp", "[quat]") {
+
+	std::mt19937 rng( 1213 );
+
+	for( int n = 0; n < 1000; ++n )
+	{
+		Quatf const p = random_rotation_( rng );
+		Quatf const q = random_rotation_( rng );
+
+		REQUIRE( same_rotation_( slerp( p, q, 0.f ), p, 1e-5f ) );
+		REQUIRE( same_rotation_( slerp( p, q, 1.f ), q, 1e-5f ) );
+		REQUIRE( std::abs( length( slerp( p, q, 0.3f ) ) - 1.f ) < 1e-5f );
+	}
+
+	// Constant angular velocity about a fixed axis
+	Vec3f const axis = normalize( Vec3f{ 1.f, 2.f, 3.f } );
+	Quatf const p = make_quat_rotation( 0.2f, axis );
+	Quatf const q = make_quat_rotation( 1.4f, axis );
+	REQUIRE( same_rotation_( slerp( p, q, 0.25f ), make_quat_rotation( 0.5f, axis ), 1e-5f ) );
+	REQUIRE( same_rotation_( slerp( p, -q, 0.25f ), make_quat_rotation( 0.5f, axis ), 1e-5f ) );
+
+	// Nearly identical inputs use the normalized lerp
+	Quatf const r = make_quat_rotation( 0.2001f, axis );
+	REQUIRE( same_rotation_( slerp( p, r, 0.5f ), make_quat_rotation( 0.20005f, axis ), 1e-6f ) );
+}
+
+TEST_CASE("Transform matches matrices", "[transform]") {
+
+	std::mt19937 rng( 1415 );
+
+	for( int n = 0; n < 1000; ++n )
+	{
+		Transform const a = random_transform_( rng );
+		Transform const b = random_transform_( rng );
+		Vec3f const p = 10.f * random_unit_( rng );
+
+		Mat44f const ma = transform_to_mat44( a );
+		Mat44f const mb = transform_to_mat44( b );
+
+		Mat44f const reference = make_translation( a.translation ) * quat_to_mat44( a.rotation ) * make_scaling( a.scale, a.scale, a.scale );
+		REQUIRE( max_abs_diff_( ma, reference ) < 1e-5f );
+
+		Vec4f const mp = ma * Vec4f{ p.x, p.y, p.z, 1.f };
+		REQUIRE( nearly_equal_( transform_point( a, p ), Vec3f{ mp.x, mp.y, mp.z }, 1e-5f ) );
+
+		Vec4f const mv = ma * Vec4f{ p.x, p.y, p.z, 0.f };
+		REQUIRE( nearly_equal_( transform_vector( a, p ), Vec3f{ mv.x, mv.y, mv.z }, 1e-5f ) );
+
+		// Composition
+		Transform const ab = a * b;
+		REQUIRE( nearly_equal_( transform_point( ab, p ), transform_point( a, transform_point( b, p ) ), 1e-5f ) );
+		REQUIRE( max_abs_diff_( transform_to_mat44( ab ), ma * mb ) < 1e-3f );
+
+		// Inverse
+		REQUIRE( nearly_equal_( transform_point( invert( a ), transform_point( a, p ) ), p, 1e-4f ) );
+		REQUIRE( max_abs_diff_( transform_to_mat44( invert( a ) ), invert( ma ) ) < 1e-4f );
+	}
+}
+
+TEST_CASE("Transform normal matrix", "[transform]") {
+
+	std::mt19937 rng( 1617 );
+
+	for( int n = 0; n < 100; ++n )
+	{
+		Transform const t = random_transform_( rng );
+		Mat33f const reference = normal_matrix( transform_to_mat44( t ) );
+		Mat33f const nm = normal_matrix( t );
+
+		for( std::size_t i = 0; i < 9; ++i )
+			REQUIRE( std::abs( nm.v[i] - reference.v[i] ) < 1e-4f );
+	}
+}
@@ -0,0 +1,138 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <vector>
+#include <cstdint>
+
+#include "../vmlib/random.hpp"
+
+namespace
+{
+	// Reference: a single xoshiro128+ generator, one value at a time
+	struct Xoshiro128Plus_
+	{
+		std::uint32_t s[4];
+
+		std::uint32_t next()
+		{
+			std::uint32_t const result = s[0] + s[3];
+			std::uint32_t const t = s[1] << 9;
+			s[2] ^= s[0];
+			s[3] ^= s[1];
+			s[1] ^= s[2];
+			s[0] ^= s[3];
+			s[2] ^= t;
+			s[3] = (s[3] << 11) | (s[3] >> 21);
+			return result;
+		}
+	};
+
+	std::vector<float> draw_( Xoshiro128x8& aRng, std::size_t aCount )
+	{
+		std::vector<float> ret( aCount );
+		aRng.fill_uniform( ret.data(), aCount );
+		return ret;
+	}
+}
+
+TEST_CASE("Xoshiro128x8 lanes are xoshiro128+", "[random]") {
+
+	Xoshiro128x8 rng( 42 );
+	auto const values = draw_( rng, 8 * 100 );
+
+	// Reconstruct the state of lane 3 the same way as seed() does, then
+	// compare its outputs.
+	std::uint64_t sm = 42;
+	auto const splitmix = [&sm] {
+		std::uint64_t z = (sm += 0x9e3779b97f4a7c15ull);
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+		return z ^ (z >> 31);
+	};
+
+	std::uint64_t a = 0, b = 0;
+	for( int lane = 0; lane <= 3; ++lane )
+	{
+		a = splitmix();
+		b = splitmix();
+	}
+
+	Xoshiro128Plus_ ref{ { std::uint32_t(a), std::uint32_t(a >> 32), std::uint32_t(b), std::uint32_t(b >> 32) } };
+	for( std::size_t i = 0; i < 100; ++i )
+		REQUIRE( values[i*8 + 3] == float(ref.next() >> 8) / float(1u << 24) );
+}
+
+TEST_CASE("Xoshiro128x8 is reproducible", "[random]") {
+
+	Xoshiro128x8 a( 1234 ), b( 1234 ), c( 1235 );
+
+	auto const va = draw_( a, 1000 );
+	auto const vb = draw_( b, 1000 );
+	auto const vc = draw_( c, 1000 );
+
+	REQUIRE( va == vb );
+	REQUIRE( va != vc );
+
+	// Reseeding restarts the sequence
+	a.seed( 1234 );
+	REQUIRE( draw_( a, 1000 ) == va );
+
+	SECTION("independent of request sizes") {
+		Xoshiro128x8 rng( 1234 );
+
+		std::vector<float> mixed;
+		for( std::size_t count : { 1, 3, 8, 13, 0, 7, 64, 5 } )
+		{
+			auto const part = draw_( rng, count );
+			mixed.insert( mixed.end(), part.begin(), part.end() );
+			mixed.emplace_back( rng.uniform() );
+		}
+
+		REQUIRE( mixed.size() < va.size() );
+		for( std::size_t i = 0; i < mixed.size(); ++i )
+			REQUIRE( mixed[i] == va[i] );
+	}
+}
+
+TEST_CASE("Xoshiro128x8 distribution", "[random]") {
+
+	Xoshiro128x8 rng( 7 );
+
+	constexpr std::size_t kCount = 1 << 20;
+	constexpr std::size_t kBuckets = 64;
+
+	auto const values = draw_( rng, kCount );
+
+	double sum = 0.0, sumSq = 0.0;
+	std::vector<std::size_t> buckets( kBuckets, 0 );
+	for( auto const x : values )
+	{
+		REQUIRE( x >= 0.f );
+		REQUIRE( x < 1.f );
+
+		sum += x;
+		sumSq += double(x) * x;
+		++buckets[std::size_t(x * kBuckets)];
+	}
+
+	double const mean = sum / kCount;
+	double const variance = sumSq / kCount - mean*mean;
+	REQUIRE( mean == Catch::Approx( 0.5 ).margin( 2e-3 ) );
+	REQUIRE( variance == Catch::Approx( 1.0 / 12.0 ).margin( 2e-3 ) );
+
+	// Chi-squared test with 63 degrees of freedom; 110 is far beyond the
+	// 99.9% quantile (~103).
+	double chi2 = 0.0;
+	double const expected = double(kCount) / kBuckets;
+	for( auto const n : buckets )
+		chi2 += (n - expected) * (n - expected) / expected;
+	REQUIRE( chi2 < 110.0 );
+
+	// Scaled range
+	std::vector<float> scaled( 1000 );
+	rng.fill_uniform( scaled.data(), scaled.size(), -2.f, 3.f );
+	for( auto const x : scaled )
+	{
+		REQUIRE( x >= -2.f );
+		REQUIRE( x < 3.f );
+	}
+}
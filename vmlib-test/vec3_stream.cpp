@@ -0,0 +1,167 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <random>
+#include <vector>
+#include <cstdint>
+
+#include "../vmlib/vec3_stream.hpp"
+
+namespace
+{
+	Vec3Stream random_stream_( std::mt19937& aRng, std::size_t aCount )
+	{
+		std::uniform_real_distribution<float> dist( -2.f, 2.f );
+
+		Vec3Stream ret;
+		for( std::size_t i = 0; i < aCount; ++i )
+			ret.push_back( Vec3f{ dist( aRng ), dist( aRng ), dist( aRng ) + 4.f } );
+		return ret;
+	}
+
+	// See mat44_simd.cpp: FMA may change the last bits of the results.
+	bool nearly_equal_( float aX, float aY )
+	{
+		return std::abs( aX - aY ) <= 1e-5f * std::max( std::abs( aX ), std::abs( aY ) ) + 1e-6f;
+	}
+	bool nearly_equal_( Vec3f aX, Vec3f aY )
+	{
+		return nearly_equal_( aX.x, aY.x ) && nearly_equal_( aX.y, aY.y ) && nearly_equal_( aX.z, aY.z );
+	}
+}
+
+TEST_CASE("Vec3Stream storage", "[vec3stream]") {
+
+	Vec3Stream s;
+	REQUIRE( s.empty() );
+
+	for( std::size_t i = 0; i < 37; ++i )
+		s.push_back( Vec3f{ float(i), float(2*i), float(3*i) } );
+
+	REQUIRE( s.size() == 37 );
+	REQUIRE( s.capacity() >= 37 );
+	REQUIRE( s.capacity() % (Vec3Stream::kAlignment / sizeof(float)) == 0 );
+
+	// Each component array is aligned
+	REQUIRE( reinterpret_cast<std::uintptr_t>(s.x()) % Vec3Stream::kAlignment == 0 );
+	REQUIRE( reinterpret_cast<std::uintptr_t>(s.y()) % Vec3Stream::kAlignment == 0 );
+	REQUIRE( reinterpret_cast<std::uintptr_t>(s.z()) % Vec3Stream::kAlignment == 0 );
+	REQUIRE( s.component_offset( 1 ) == s.capacity() * sizeof(float) );
+	REQUIRE( s.size_bytes() == 3 * s.capacity() * sizeof(float) );
+
+	for( std::size_t i = 0; i < 37; ++i )
+	{
+		REQUIRE( s.get( i ).x == float(i) );
+		REQUIRE( s.get( i ).y == float(2*i) );
+		REQUIRE( s.get( i ).z == float(3*i) );
+	}
+
+	// Copy, move, resize
+	Vec3Stream copy( s );
+	REQUIRE( copy.size() == 37 );
+	REQUIRE( copy.get( 36 ).z == 108.f );
+
+	Vec3Stream moved( std::move(copy) );
+	REQUIRE( moved.size() == 37 );
+	REQUIRE( copy.size() == 0 );
+
+	moved.resize( 40, Vec3f{ 1.f, 2.f, 3.f } );
+	REQUIRE( moved.get( 36 ).z == 108.f );
+	REQUIRE( moved.get( 39 ).y == 2.f );
+
+	moved.clear();
+	REQUIRE( moved.empty() );
+
+	// Views on subranges
+	auto const v = s.view( 10, 5 );
+	REQUIRE( v.size == 5 );
+	REQUIRE( v.x[0] == 10.f );
+	REQUIRE( v.z[4] == 42.f );
+}
+
+TEST_CASE("Vec3Stream kernels match scalar", "[vec3stream]") {
+
+	std::mt19937 rng( 5150 );
+
+	// All combinations of full SIMD blocks and remainders
+	for( std::size_t count = 0; count < 40; ++count )
+	{
+		Vec3Stream const a = random_stream_( rng, count );
+		Vec3Stream const b = random_stream_( rng, count );
+
+		Vec3Stream out = b, ref = b;
+		axpy( 0.37f, a, out );
+		detail::axpy_scalar( 0.37f, a, ref );
+		for( std::size_t i = 0; i < count; ++i )
+			REQUIRE( nearly_equal_( out.get( i ), ref.get( i ) ) );
+
+		out = a; ref = a;
+		scale( out, -1.5f );
+		detail::scale_scalar( ref, -1.5f );
+		for( std::size_t i = 0; i < count; ++i )
+			REQUIRE( out.get( i ).x == ref.get( i ).x );
+
+		out = a; ref = a;
+		normalize( out );
+		detail::normalize_scalar( ref );
+		for( std::size_t i = 0; i < count; ++i )
+		{
+			REQUIRE( nearly_equal_( out.get( i ), ref.get( i ) ) );
+			REQUIRE( nearly_equal_( out.get( i ), normalize( a.get( i ) ) ) );
+		}
+
+		std::vector<float> d( count ), dref( count );
+		dot( a, b, d.data() );
+		detail::dot_scalar( a, b, dref.data() );
+		for( std::size_t i = 0; i < count; ++i )
+			REQUIRE( nearly_equal_( d[i], dref[i] ) );
+
+		length( a, d.data() );
+		detail::length_scalar( a, dref.data() );
+		for( std::size_t i = 0; i < count; ++i )
+			REQUIRE( nearly_equal_( d[i], dref[i] ) );
+	}
+}
+
+TEST_CASE("Vec3Stream kernels on subranges", "[vec3stream]") {
+
+	std::mt19937 rng( 77 );
+
+	Vec3Stream s = random_stream_( rng, 29 );
+	Vec3Stream const original = s;
+
+	// Only elements [3, 3+17) are modified
+	scale( s.view( 3, 17 ), 2.f );
+	for( std::size_t i = 0; i < s.size(); ++i )
+	{
+		float const f = (i >= 3 && i < 20) ? 2.f : 1.f;
+		REQUIRE( s.get( i ).y == f * original.get( i ).y );
+	}
+}
+
+TEST_CASE("Vec3Stream interleave round trip", "[vec3stream]") {
+
+	std::mt19937 rng( 99 );
+
+	for( std::size_t count = 0; count < 40; ++count )
+	{
+		Vec3Stream const s = random_stream_( rng, count );
+
+		std::vector<Vec3f> aos( count );
+		interleave( s, aos.data() );
+		for( std::size_t i = 0; i < count; ++i )
+		{
+			REQUIRE( aos[i].x == s.get( i ).x );
+			REQUIRE( aos[i].y == s.get( i ).y );
+			REQUIRE( aos[i].z == s.get( i ).z );
+		}
+
+		Vec3Stream back( count );
+		deinterleave( aos.data(), back );
+		for( std::size_t i = 0; i < count; ++i )
+		{
+			REQUIRE( back.get( i ).x == aos[i].x );
+			REQUIRE( back.get( i ).y == aos[i].y );
+			REQUIRE( back.get( i ).z == aos[i].z );
+		}
+	}
+}
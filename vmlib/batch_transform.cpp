@@ -0,0 +1,201 @@
+#include "batch_transform.hpp"
+
+#include "simd.hpp"
+
+// The SIMD kernels access arrays of Vec3f/Vec4f as flat float arrays.
+static_assert( sizeof(Vec3f) == 3*sizeof(float) );
+static_assert( sizeof(Vec4f) == 4*sizeof(float) );
+
+namespace
+{
+#	if !VMLIB_SIMD_NONE
+	// Each kernel processes as many full blocks of tVec::kWidth elements as
+	// possible and returns the number of elements processed. The remaining
+	// elements are left to the next (narrower) kernel or the scalar code.
+	//
+	// The sums are evaluated in the same order as in the scalar operator*.
+
+	template< class tVec, bool tProjective >
+	std::size_t transform_points_simd_( Mat44f const& aM, Vec3f const* aIn, Vec3f* aOut, std::size_t aCount ) noexcept
+	{
+		using namespace simd;
+		constexpr std::size_t kWidth = tVec::kWidth;
+
+		tVec m[16];
+		for( std::size_t i = 0; i < 16; ++i )
+			m[i] = splat<tVec>( aM.v[i] );
+
+		std::size_t i = 0;
+		for( ; i + kWidth <= aCount; i += kWidth )
+		{
+			tVec x, y, z;
+			load_xyz( &aIn[i].x, x, y, z );
+
+			tVec tx = add( madd( m[2], z, madd( m[1], y, mul( m[0], x ) ) ), m[3] );
+			tVec ty = add( madd( m[6], z, madd( m[5], y, mul( m[4], x ) ) ), m[7] );
+			tVec tz = add( madd( m[10], z, madd( m[9], y, mul( m[8], x ) ) ), m[11] );
+
+			if constexpr( tProjective )
+			{
+				tVec const tw = add( madd( m[14], z, madd( m[13], y, mul( m[12], x ) ) ), m[15] );
+				tx = div( tx, tw );
+				ty = div( ty, tw );
+				tz = div( tz, tw );
+			}
+
+			store_xyz( &aOut[i].x, tx, ty, tz );
+		}
+
+		return i;
+	}
+
+	template< class tVec >
+	std::size_t transform_normals_simd_( Mat33f const& aN, Vec3f const* aIn, Vec3f* aOut, std::size_t aCount ) noexcept
+	{
+		using namespace simd;
+		constexpr std::size_t kWidth = tVec::kWidth;
+
+		tVec n[9];
+		for( std::size_t i = 0; i < 9; ++i )
+			n[i] = splat<tVec>( aN.v[i] );
+
+		std::size_t i = 0;
+		for( ; i + kWidth <= aCount; i += kWidth )
+		{
+			tVec x, y, z;
+			load_xyz( &aIn[i].x, x, y, z );
+
+			tVec const tx = madd( n[2], z, madd( n[1], y, mul( n[0], x ) ) );
+			tVec const ty = madd( n[5], z, madd( n[4], y, mul( n[3], x ) ) );
+			tVec const tz = madd( n[8], z, madd( n[7], y, mul( n[6], x ) ) );
+
+			store_xyz( &aOut[i].x, tx, ty, tz );
+		}
+
+		return i;
+	}
+
+	template< class tVec >
+	std::size_t transform_vec4_simd_( Mat44f const& aM, Vec4f const* aIn, Vec4f* aOut, std::size_t aCount ) noexcept
+	{
+		using namespace simd;
+
+		// Each load picks up kWidth/4 consecutive Vec4f. Four loads are then
+		// transposed (per 128-bit lane for F32x8), yielding x, y, z and w of
+		// kWidth vectors. The transpose back restores the original order.
+		constexpr std::size_t kWidth = tVec::kWidth;
+		constexpr std::size_t kPerLoad = kWidth / 4;
+
+		tVec m[16];
+		for( std::size_t i = 0; i < 16; ++i )
+			m[i] = splat<tVec>( aM.v[i] );
+
+		std::size_t i = 0;
+		for( ; i + kWidth <= aCount; i += kWidth )
+		{
+			tVec x = load<tVec>( &aIn[i + 0*kPerLoad].x );
+			tVec y = load<tVec>( &aIn[i + 1*kPerLoad].x );
+			tVec z = load<tVec>( &aIn[i + 2*kPerLoad].x );
+			tVec w = load<tVec>( &aIn[i + 3*kPerLoad].x );
+			transpose4( x, y, z, w );
+
+			tVec tx = madd( m[3], w, madd( m[2], z, madd( m[1], y, mul( m[0], x ) ) ) );
+			tVec ty = madd( m[7], w, madd( m[6], z, madd( m[5], y, mul( m[4], x ) ) ) );
+			tVec tz = madd( m[11], w, madd( m[10], z, madd( m[9], y, mul( m[8], x ) ) ) );
+			tVec tw = madd( m[15], w, madd( m[14], z, madd( m[13], y, mul( m[12], x ) ) ) );
+			transpose4( tx, ty, tz, tw );
+
+			store( &aOut[i + 0*kPerLoad].x, tx );
+			store( &aOut[i + 1*kPerLoad].x, ty );
+			store( &aOut[i + 2*kPerLoad].x, tz );
+			store( &aOut[i + 3*kPerLoad].x, tw );
+		}
+
+		return i;
+	}
+#	endif // ~ !VMLIB_SIMD_NONE
+}
+
+void transform_points( Mat44f const& aM, Vec3f const* aIn, Vec3f* aOut, std::size_t aCount ) noexcept
+{
+	std::size_t done = 0;
+#	if VMLIB_SIMD_AVX
+	done += transform_points_simd_<simd::F32x8, true>( aM, aIn+done, aOut+done, aCount-done );
+#	endif
+#	if !VMLIB_SIMD_NONE
+	done += transform_points_simd_<simd::F32x4, true>( aM, aIn+done, aOut+done, aCount-done );
+#	endif
+	detail::transform_points_scalar( aM, aIn+done, aOut+done, aCount-done );
+}
+
+void transform_points_affine( Mat44f const& aM, Vec3f const* aIn, Vec3f* aOut, std::size_t aCount ) noexcept
+{
+	std::size_t done = 0;
+#	if VMLIB_SIMD_AVX
+	done += transform_points_simd_<simd::F32x8, false>( aM, aIn+done, aOut+done, aCount-done );
+#	endif
+#	if !VMLIB_SIMD_NONE
+	done += transform_points_simd_<simd::F32x4, false>( aM, aIn+done, aOut+done, aCount-done );
+#	endif
+	detail::transform_points_affine_scalar( aM, aIn+done, aOut+done, aCount-done );
+}
+
+void transform_normals( Mat33f const& aN, Vec3f const* aIn, Vec3f* aOut, std::size_t aCount ) noexcept
+{
+	std::size_t done = 0;
+#	if VMLIB_SIMD_AVX
+	done += transform_normals_simd_<simd::F32x8>( aN, aIn+done, aOut+done, aCount-done );
+#	endif
+#	if !VMLIB_SIMD_NONE
+	done += transform_normals_simd_<simd::F32x4>( aN, aIn+done, aOut+done, aCount-done );
+#	endif
+	detail::transform_normals_scalar( aN, aIn+done, aOut+done, aCount-done );
+}
+
+void transform_vec4( Mat44f const& aM, Vec4f const* aIn, Vec4f* aOut, std::size_t aCount ) noexcept
+{
+	std::size_t done = 0;
+#	if VMLIB_SIMD_AVX
+	done += transform_vec4_simd_<simd::F32x8>( aM, aIn+done, aOut+done, aCount-done );
+#	endif
+#	if !VMLIB_SIMD_NONE
+	done += transform_vec4_simd_<simd::F32x4>( aM, aIn+done, aOut+done, aCount-done );
+#	endif
+	detail::transform_vec4_scalar( aM, aIn+done, aOut+done, aCount-done );
+}
+
+
+namespace detail
+{
+	void transform_points_scalar( Mat44f const& aM, Vec3f const* aIn, Vec3f* aOut, std::size_t aCount ) noexcept
+	{
+		for( std::size_t i = 0; i < aCount; ++i )
+		{
+			Vec4f t = mat44_mul_scalar( aM, Vec4f{ aIn[i].x, aIn[i].y, aIn[i].z, 1.f } );
+			t /= t.w;
+
+			aOut[i] = Vec3f{ t.x, t.y, t.z };
+		}
+	}
+
+	void transform_points_affine_scalar( Mat44f const& aM, Vec3f const* aIn, Vec3f* aOut, std::size_t aCount ) noexcept
+	{
+		for( std::size_t i = 0; i < aCount; ++i )
+		{
+			Vec4f const t = mat44_mul_scalar( aM, Vec4f{ aIn[i].x, aIn[i].y, aIn[i].z, 1.f } );
+			aOut[i] = Vec3f{ t.x, t.y, t.z };
+		}
+	}
+
+	void transform_normals_scalar( Mat33f const& aN, Vec3f const* aIn, Vec3f* aOut, std::size_t aCount ) noexcept
+	{
+		for( std::size_t i = 0; i < aCount; ++i )
+			aOut[i] = aN * aIn[i];
+	}
+
+	void transform_vec4_scalar( Mat44f const& aM, Vec4f const* aIn, Vec4f* aOut, std::size_t aCount ) noexcept
+	{
+		for( std::size_t i = 0; i < aCount; ++i )
+			aOut[i] = mat44_mul_scalar( aM, aIn[i] );
+	}
+}
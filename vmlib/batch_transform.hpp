@@ -0,0 +1,45 @@
+#ifndef BATCH_TRANSFORM_HPP_0439E73A_97CE_4899_AA28_E8C76B343806
+#define BATCH_TRANSFORM_HPP_0439E73A_97CE_4899_AA28_E8C76B343806
+
+#include <cstddef>
+
+#include "vec3.hpp"
+#include "vec4.hpp"
+#include "mat33.hpp"
+#include "mat44.hpp"
+
+/* Batched transforms
+ *
+ * Transform arrays of points/vectors with a single matrix. These are
+ * equivalent to calling the corresponding operator* once per element, but
+ * process 4 (SSE, NEON) or 8 (AVX) elements per iteration.
+ *
+ * All functions take an input and an output array with aCount elements
+ * each. The input and output may be the same array (in-place transform),
+ * but must otherwise not overlap.
+ */
+
+// Points: out = (M * (in,1)).xyz / w
+void transform_points( Mat44f const&, Vec3f const* aIn, Vec3f* aOut, std::size_t aCount ) noexcept;
+
+// Points, assuming that the last row of M is (0,0,0,1). Skips the divide.
+void transform_points_affine( Mat44f const&, Vec3f const* aIn, Vec3f* aOut, std::size_t aCount ) noexcept;
+
+// Normals/directions: out = N * in. The results are not re-normalized. Pass
+// the normal matrix (see mat33.hpp) to transform surface normals.
+void transform_normals( Mat33f const&, Vec3f const* aIn, Vec3f* aOut, std::size_t aCount ) noexcept;
+
+// Homogeneous vectors: out = M * in
+void transform_vec4( Mat44f const&, Vec4f const* aIn, Vec4f* aOut, std::size_t aCount ) noexcept;
+
+
+// Scalar reference implementations (one element at a time).
+namespace detail
+{
+	void transform_points_scalar( Mat44f const&, Vec3f const*, Vec3f*, std::size_t ) noexcept;
+	void transform_points_affine_scalar( Mat44f const&, Vec3f const*, Vec3f*, std::size_t ) noexcept;
+	void transform_normals_scalar( Mat33f const&, Vec3f const*, Vec3f*, std::size_t ) noexcept;
+	void transform_vec4_scalar( Mat44f const&, Vec4f const*, Vec4f*, std::size_t ) noexcept;
+}
+
+#endif // BATCH_TRANSFORM_HPP_0439E73A_97CE_4899_AA28_E8C76B343806
@@ -0,0 +1,196 @@
+#include "bounds.hpp"
+
+#include <cmath>
+#include <cstring>
+
+#include "simd.hpp"
+
+// The SIMD kernel accesses arrays of Aabb3f as flat arrays of Vec3f.
+static_assert( sizeof(Aabb3f) == 2*sizeof(Vec3f) );
+
+namespace
+{
+	Vec4f normalize_plane_( Vec4f aPlane ) noexcept
+	{
+		float const len = std::sqrt( aPlane.x*aPlane.x + aPlane.y*aPlane.y + aPlane.z*aPlane.z );
+		return aPlane / len;
+	}
+
+	// Box vs. frustum: for each plane, the box is outside if its center is
+	// further behind the plane than the box extends towards the plane (the
+	// projection of the half extents onto the plane normal). The smallest
+	// such margin over all planes decides; negative means outside.
+	//
+	// The SIMD kernel below evaluates the same expressions in the same
+	// order.
+	float min_margin_( Frustumf const& aFrustum, Aabb3f const& aBox ) noexcept
+	{
+		Vec3f const c = center( aBox );
+		Vec3f const e = half_extents( aBox );
+
+		float ret = std::numeric_limits<float>::infinity();
+		for( auto const& p : aFrustum.planes )
+		{
+			float const dist = p.z*c.z + (p.y*c.y + (p.x*c.x + p.w));
+			float const ext = std::abs(p.z)*e.z + (std::abs(p.y)*e.y + std::abs(p.x)*e.x);
+			float const margin = dist + ext;
+			ret = margin < ret ? margin : ret;
+		}
+		return ret;
+	}
+
+	void cull_scalar_( Frustumf const& aFrustum, Aabb3f const* aBoxes, std::size_t aBegin, std::size_t aEnd, std::uint64_t* aVisible ) noexcept
+	{
+		for( std::size_t i = aBegin; i < aEnd; ++i )
+		{
+			if( !std::signbit( min_margin_( aFrustum, aBoxes[i] ) ) )
+				aVisible[i / 64] |= std::uint64_t(1) << (i % 64);
+		}
+	}
+
+#	if !VMLIB_SIMD_NONE
+	// Processes full blocks of tVec::kWidth boxes, starting at aBegin, and
+	// returns the index of the first unprocessed box. aBegin must be a
+	// multiple of kWidth, so that a block never straddles two words of
+	// aVisible.
+	template< class tVec >
+	std::size_t cull_simd_( Frustumf const& aFrustum, Aabb3f const* aBoxes, std::size_t aBegin, std::size_t aEnd, std::uint64_t* aVisible ) noexcept
+	{
+		using namespace simd;
+		constexpr std::size_t kWidth = tVec::kWidth;
+		static_assert( 64 % kWidth == 0 );
+
+		tVec n[Frustumf::kPlaneCount][4], a[Frustumf::kPlaneCount][3];
+		for( std::size_t j = 0; j < Frustumf::kPlaneCount; ++j )
+		{
+			for( std::size_t k = 0; k < 4; ++k )
+				n[j][k] = splat<tVec>( aFrustum.planes[j][k] );
+			for( std::size_t k = 0; k < 3; ++k )
+				a[j][k] = splat<tVec>( std::abs( aFrustum.planes[j][k] ) );
+		}
+
+		tVec const half = splat<tVec>( 0.5f );
+
+		std::size_t i = aBegin;
+		for( ; i + kWidth <= aEnd; i += kWidth )
+		{
+			// kWidth boxes are 2*kWidth Vec3f: min0 max0 min1 max1 ...
+			tVec x0, y0, z0, x1, y1, z1;
+			load_xyz( &aBoxes[i].min.x, x0, y0, z0 );
+			load_xyz( &aBoxes[i + kWidth/2].min.x, x1, y1, z1 );
+
+			tVec minX, maxX, minY, maxY, minZ, maxZ;
+			unzip( x0, x1, minX, maxX );
+			unzip( y0, y1, minY, maxY );
+			unzip( z0, z1, minZ, maxZ );
+
+			tVec const cx = mul( half, add( minX, maxX ) );
+			tVec const cy = mul( half, add( minY, maxY ) );
+			tVec const cz = mul( half, add( minZ, maxZ ) );
+			tVec const ex = mul( half, sub( maxX, minX ) );
+			tVec const ey = mul( half, sub( maxY, minY ) );
+			tVec const ez = mul( half, sub( maxZ, minZ ) );
+
+			tVec margin = splat<tVec>( std::numeric_limits<float>::infinity() );
+			for( std::size_t j = 0; j < Frustumf::kPlaneCount; ++j )
+			{
+				tVec const dist = madd( n[j][2], cz, madd( n[j][1], cy, madd( n[j][0], cx, n[j][3] ) ) );
+				tVec const ext = madd( a[j][2], ez, madd( a[j][1], ey, mul( a[j][0], ex ) ) );
+				margin = min( add( dist, ext ), margin );
+			}
+
+			std::uint64_t const culled = sign_mask( margin );
+			std::uint64_t const visible = ~culled & ((std::uint64_t(1) << kWidth) - 1);
+			aVisible[i / 64] |= visible << (i % 64);
+		}
+
+		return i;
+	}
+#	endif // ~ !VMLIB_SIMD_NONE
+}
+
+Aabb3f make_aabb( Vec3f const* aPoints, std::size_t aCount ) noexcept
+{
+	Aabb3f ret = kEmptyAabb3f;
+	for( std::size_t i = 0; i < aCount; ++i )
+		ret = expand( ret, aPoints[i] );
+	return ret;
+}
+
+Aabb3f transform_aabb( Mat44f const& aTransform, Aabb3f const& aBox ) noexcept
+{
+	// Transform the center, and project the (rotated and scaled) half
+	// extents back onto the axes (J. Arvo, "Transforming Axis-Aligned
+	// Bounding Boxes", Graphics Gems, 1990).
+	Vec3f const c = center( aBox );
+	Vec3f const e = half_extents( aBox );
+
+	Vec3f tc, te;
+	for( std::size_t i = 0; i < 3; ++i )
+	{
+		tc[i] = aTransform( i, 0 )*c.x + aTransform( i, 1 )*c.y + aTransform( i, 2 )*c.z + aTransform( i, 3 );
+		te[i] = std::abs( aTransform( i, 0 ) )*e.x + std::abs( aTransform( i, 1 ) )*e.y + std::abs( aTransform( i, 2 ) )*e.z;
+	}
+
+	return Aabb3f{ tc - te, tc + te };
+}
+
+Frustumf make_frustum( Mat44f const& aM ) noexcept
+{
+	// Gribb & Hartmann: a point p is inside the OpenGL clip volume when
+	// -w <= x, y, z <= w, where (x,y,z,w) = M p. Each inequality is a plane
+	// formed from the fourth row of M plus/minus one of the other rows.
+	auto const row = [&aM] (std::size_t aI) {
+		return Vec4f{ aM( aI, 0 ), aM( aI, 1 ), aM( aI, 2 ), aM( aI, 3 ) };
+	};
+
+	Vec4f const r0 = row( 0 ), r1 = row( 1 ), r2 = row( 2 ), r3 = row( 3 );
+
+	Frustumf ret;
+	ret.planes[Frustumf::kLeft] = normalize_plane_( r3 + r0 );
+	ret.planes[Frustumf::kRight] = normalize_plane_( r3 - r0 );
+	ret.planes[Frustumf::kBottom] = normalize_plane_( r3 + r1 );
+	ret.planes[Frustumf::kTop] = normalize_plane_( r3 - r1 );
+	ret.planes[Frustumf::kNear] = normalize_plane_( r3 + r2 );
+	ret.planes[Frustumf::kFar] = normalize_plane_( r3 - r2 );
+	return ret;
+}
+
+bool intersects( Frustumf const& aFrustum, Spheref const& aSphere ) noexcept
+{
+	for( auto const& plane : aFrustum.planes )
+	{
+		if( signed_distance( plane, aSphere.center ) < -aSphere.radius )
+			return false;
+	}
+	return true;
+}
+
+bool intersects( Frustumf const& aFrustum, Aabb3f const& aBox ) noexcept
+{
+	return !std::signbit( min_margin_( aFrustum, aBox ) );
+}
+
+void cull( Frustumf const& aFrustum, Aabb3f const* aBoxes, std::size_t aCount, std::uint64_t* aVisible ) noexcept
+{
+	std::memset( aVisible, 0, cull_word_count( aCount ) * sizeof(std::uint64_t) );
+
+	std::size_t done = 0;
+#	if VMLIB_SIMD_AVX
+	done = cull_simd_<simd::F32x8>( aFrustum, aBoxes, done, aCount, aVisible );
+#	endif
+#	if !VMLIB_SIMD_NONE
+	done = cull_simd_<simd::F32x4>( aFrustum, aBoxes, done, aCount, aVisible );
+#	endif
+	cull_scalar_( aFrustum, aBoxes, done, aCount, aVisible );
+}
+
+
+namespace detail
+{
+	void cull_scalar( Frustumf const& aFrustum, Aabb3f const* aBoxes, std::size_t aCount, std::uint64_t* aVisible ) noexcept
+	{
+		std::memset( aVisible, 0, cull_word_count( aCount ) * sizeof(std::uint64_t) );
+		cull_scalar_( aFrustum, aBoxes, 0, aCount, aVisible );
+	}
+}
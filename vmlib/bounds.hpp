@@ -0,0 +1,187 @@
+#ifndef BOUNDS_HPP_29976B91_0CFD_4DDB_A0BA_368BBB1692CE
+#define BOUNDS_HPP_29976B91_0CFD_4DDB_A0BA_368BBB1692CE
+
+#include <limits>
+#include <cstddef>
+#include <cstdint>
+
+#include "vec3.hpp"
+#include "vec4.hpp"
+#include "mat44.hpp"
+
+/** Bounding volumes and view frustum tests
+ *
+ * Aabb3f is an axis-aligned box given by its min and max corners, Spheref a
+ * sphere. Frustumf holds the six planes of a view frustum, extracted from a
+ * combined projection * view (* model) matrix; see make_frustum().
+ *
+ * All frustum tests are conservative: they never reject a volume that is
+ * (partially) visible, but may accept some volumes that are just outside
+ * near the frustum's edges and corners.
+ */
+struct Aabb3f
+{
+	Vec3f min;
+	Vec3f max;
+};
+
+struct Spheref
+{
+	Vec3f center;
+	float radius;
+};
+
+// Planes (a,b,c,d) with dot( (a,b,c), p ) + d >= 0 for points p inside the
+// frustum. (a,b,c) is normalized, so the expression gives the distance to
+// the plane.
+struct Frustumf
+{
+	enum Plane : std::size_t { kLeft, kRight, kBottom, kTop, kNear, kFar, kPlaneCount };
+
+	Vec4f planes[kPlaneCount];
+};
+
+// Empty box: expand() and merge() with it yield the other argument
+constexpr Aabb3f kEmptyAabb3f = {
+	{ std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity() },
+	{ -std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity() }
+};
+
+
+// Box operations
+constexpr
+bool is_empty( Aabb3f const& aBox ) noexcept
+{
+	return aBox.min.x > aBox.max.x || aBox.min.y > aBox.max.y || aBox.min.z > aBox.max.z;
+}
+
+constexpr
+Vec3f center( Aabb3f const& aBox ) noexcept
+{
+	return 0.5f * (aBox.min + aBox.max);
+}
+constexpr
+Vec3f half_extents( Aabb3f const& aBox ) noexcept
+{
+	return 0.5f * (aBox.max - aBox.min);
+}
+
+constexpr
+Aabb3f expand( Aabb3f const& aBox, Vec3f aPoint ) noexcept
+{
+	return Aabb3f{
+		Vec3f{
+			aPoint.x < aBox.min.x ? aPoint.x : aBox.min.x,
+			aPoint.y < aBox.min.y ? aPoint.y : aBox.min.y,
+			aPoint.z < aBox.min.z ? aPoint.z : aBox.min.z
+		},
+		Vec3f{
+			aPoint.x > aBox.max.x ? aPoint.x : aBox.max.x,
+			aPoint.y > aBox.max.y ? aPoint.y : aBox.max.y,
+			aPoint.z > aBox.max.z ? aPoint.z : aBox.max.z
+		}
+	};
+}
+constexpr
+Aabb3f merge( Aabb3f const& aLeft, Aabb3f const& aRight ) noexcept
+{
+	return expand( expand( aLeft, aRight.min ), aRight.max );
+}
+
+constexpr
+bool contains( Aabb3f const& aBox, Vec3f aPoint ) noexcept
+{
+	return aPoint.x >= aBox.min.x && aPoint.x <= aBox.max.x
+		&& aPoint.y >= aBox.min.y && aPoint.y <= aBox.max.y
+		&& aPoint.z >= aBox.min.z && aPoint.z <= aBox.max.z
+	;
+}
+
+// Distance from the point to the closest point of the box (0 inside)
+inline
+float distance( Aabb3f const& aBox, Vec3f aPoint ) noexcept
+{
+	Vec3f const d{
+		aPoint.x < aBox.min.x ? aBox.min.x - aPoint.x : (aPoint.x > aBox.max.x ? aPoint.x - aBox.max.x : 0.f),
+		aPoint.y < aBox.min.y ? aBox.min.y - aPoint.y : (aPoint.y > aBox.max.y ? aPoint.y - aBox.max.y : 0.f),
+		aPoint.z < aBox.min.z ? aBox.min.z - aPoint.z : (aPoint.z > aBox.max.z ? aPoint.z - aBox.max.z : 0.f)
+	};
+	return length( d );
+}
+
+// Smallest box that contains the aCount points. Returns kEmptyAabb3f for
+// aCount == 0.
+Aabb3f make_aabb( Vec3f const* aPoints, std::size_t aCount ) noexcept;
+
+// Box that contains the transformed box. aTransform must be affine (last
+// row (0,0,0,1)); e.g., a model matrix.
+Aabb3f transform_aabb( Mat44f const& aTransform, Aabb3f const& aBox ) noexcept;
+
+// Sphere that contains the box
+inline
+Spheref bounding_sphere( Aabb3f const& aBox ) noexcept
+{
+	return Spheref{ center( aBox ), length( half_extents( aBox ) ) };
+}
+
+
+// Frustum
+//
+// Pass projection * view to get the frustum in world space, or
+// projection * view * model for the frustum in the model's local space
+// (testing local bounds against it avoids transforming each box).
+Frustumf make_frustum( Mat44f const& aViewProjection ) noexcept;
+
+constexpr
+float signed_distance( Vec4f aPlane, Vec3f aPoint ) noexcept
+{
+	return aPlane.x*aPoint.x + aPlane.y*aPoint.y + aPlane.z*aPoint.z + aPlane.w;
+}
+
+constexpr
+bool contains( Frustumf const& aFrustum, Vec3f aPoint ) noexcept
+{
+	for( auto const& plane : aFrustum.planes )
+	{
+		if( signed_distance( plane, aPoint ) < 0.f )
+			return false;
+	}
+	return true;
+}
+
+// Whether the sphere/box is potentially visible. The box must not be empty.
+bool intersects( Frustumf const&, Spheref const& ) noexcept;
+bool intersects( Frustumf const&, Aabb3f const& ) noexcept;
+
+
+/* Batched culling
+ *
+ * Tests aCount boxes against the frustum, 4 (SSE, NEON) or 8 (AVX) boxes at
+ * a time. The results are written as a bit set: bit (i % 64) of
+ * aVisible[i / 64] is set if box i is potentially visible (same result as
+ * intersects()), and cleared otherwise. aVisible must have
+ * cull_word_count( aCount ) elements; unused bits of the last word are
+ * cleared.
+ */
+constexpr
+std::size_t cull_word_count( std::size_t aCount ) noexcept
+{
+	return (aCount + 63) / 64;
+}
+
+constexpr
+bool is_visible( std::uint64_t const* aVisible, std::size_t aI ) noexcept
+{
+	return (aVisible[aI / 64] >> (aI % 64)) & 1u;
+}
+
+void cull( Frustumf const&, Aabb3f const* aBoxes, std::size_t aCount, std::uint64_t* aVisible ) noexcept;
+
+
+// Scalar reference implementations (one element at a time).
+namespace detail
+{
+	void cull_scalar( Frustumf const&, Aabb3f const*, std::size_t, std::uint64_t* ) noexcept;
+}
+
+#endif // BOUNDS_HPP_29976B91_0CFD_4DDB_A0BA_368BBB1692CE
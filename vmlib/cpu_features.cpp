@@ -0,0 +1,72 @@
+#include "cpu_features.hpp"
+
+#include "simd.hpp"
+
+#if !VMLIB_SIMD_NONE && (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86))
+#	define VMLIB_CPU_X86_ 1
+#else
+#	define VMLIB_CPU_X86_ 0
+#endif
+
+#if VMLIB_CPU_X86_ && defined(_MSC_VER) && !defined(__clang__)
+#	include <intrin.h>
+#	include <immintrin.h>
+#endif
+
+namespace
+{
+	SimdIsa detect_() noexcept
+	{
+#		if !VMLIB_CPU_X86_
+		return SimdIsa::scalar;
+#		elif defined(__GNUC__) || defined(__clang__)
+		// Also checks that the OS saves the wide registers (XGETBV)
+		__builtin_cpu_init();
+		if( __builtin_cpu_supports( "avx512f" ) )
+			return SimdIsa::avx512;
+		if( __builtin_cpu_supports( "avx2" ) && __builtin_cpu_supports( "fma" ) )
+			return SimdIsa::avx2;
+		return SimdIsa::sse2;
+#		else
+		int regs[4];
+		__cpuid( regs, 0 );
+		int const maxLeaf = regs[0];
+
+		__cpuid( regs, 1 );
+		bool const osxsave = regs[2] & (1 << 27);
+		bool const fma = regs[2] & (1 << 12);
+		if( !osxsave || maxLeaf < 7 )
+			return SimdIsa::sse2;
+
+		// XCR0: SSE and AVX state (bits 1, 2), AVX-512 state (bits 5-7)
+		unsigned long long const xcr0 = _xgetbv( 0 );
+		bool const ymm = (xcr0 & 0x6) == 0x6;
+		bool const zmm = (xcr0 & 0xe6) == 0xe6;
+
+		__cpuidex( regs, 7, 0 );
+		if( zmm && (regs[1] & (1 << 16)) )
+			return SimdIsa::avx512;
+		if( ymm && fma && (regs[1] & (1 << 5)) )
+			return SimdIsa::avx2;
+		return SimdIsa::sse2;
+#		endif
+	}
+}
+
+SimdIsa cpu_simd_isa() noexcept
+{
+	static SimdIsa const isa = detect_();
+	return isa;
+}
+
+char const* simd_isa_name( SimdIsa aIsa ) noexcept
+{
+	switch( aIsa )
+	{
+		case SimdIsa::scalar: return "scalar";
+		case SimdIsa::sse2: return "sse2";
+		case SimdIsa::avx2: return "avx2";
+		case SimdIsa::avx512: return "avx512";
+	}
+	return "unknown";
+}
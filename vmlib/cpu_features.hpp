@@ -0,0 +1,29 @@
+#ifndef CPU_FEATURES_HPP_62B24FFB_E993_4A55_A9A9_77228A43F114
+#define CPU_FEATURES_HPP_62B24FFB_E993_4A55_A9A9_77228A43F114
+
+/** Runtime CPU feature detection
+ *
+ * Most of vmlib selects its SIMD code at compile time (see simd.hpp). Hot
+ * kernels that should use the widest vectors of the machine they run on,
+ * independently of the build flags, instead compile one variant per
+ * instruction set and pick one at runtime with cpu_simd_isa().
+ *
+ * Only x86 has more than one level. Elsewhere, and with VMLIB_NO_SIMD,
+ * cpu_simd_isa() returns SimdIsa::scalar.
+ */
+enum class SimdIsa
+{
+	scalar,
+	sse2,
+	avx2,    // AVX2 and FMA
+	avx512   // AVX-512F
+};
+
+// Widest instruction set that the CPU and the operating system support.
+// Detected once, on the first call.
+SimdIsa cpu_simd_isa() noexcept;
+
+// "scalar", "sse2", "avx2" or "avx512"
+char const* simd_isa_name( SimdIsa ) noexcept;
+
+#endif // CPU_FEATURES_HPP_62B24FFB_E993_4A55_A9A9_77228A43F114
@@ -0,0 +1,274 @@
+#ifndef FASTMATH_HPP_248EF567_EBB7_4AD7_907F_5EBC0852AFEB
+#define FASTMATH_HPP_248EF567_EBB7_4AD7_907F_5EBC0852AFEB
+
+#include <cmath>
+#include <type_traits>
+
+#include "vec3.hpp"
+#include "simd.hpp"
+
+/** Fast approximations of common math functions
+ *
+ * Polynomial approximations that avoid calls into the C math library. They
+ * are meant for code where a small, bounded error is acceptable, e.g.,
+ * particle emitters and procedural geometry. Each function documents its
+ * error bound; vmlib-test checks these bounds (fastmath.cpp).
+ *
+ * Every function exists as a scalar version (float) and as a SIMD version
+ * in namespace simd (F32x4 and, with AVX, F32x8). Both use the same
+ * algorithm, so the bounds hold for both.
+ *
+ *   sin_fast(x), cos_fast(x), sincos_fast(x, s, c)
+ *     Max. absolute error kSinCosFastMaxError for |x| <= kSinCosFastRange.
+ *     The argument is reduced to [-pi, pi] and then folded to [-pi/2, pi/2],
+ *     where a degree-9 odd minimax polynomial is used.
+ *
+ *   acos_fast(x)
+ *     Max. absolute error kAcosFastMaxError for x in [-1, 1]. Uses
+ *     sqrt(1-|x|) times a degree-7 polynomial (Abramowitz & Stegun 4.4.46).
+ *
+ *   rsqrt_fast(x)
+ *     Max. relative error kRsqrtFastMaxRelError for normal, positive x. The
+ *     hardware estimate (rsqrtps/vrsqrte) is refined with Newton-Raphson
+ *     steps. Without SIMD, this is 1/std::sqrt(x).
+ *
+ *   normalize_fast(v)
+ *     v * rsqrt_fast(dot(v,v)); the length of the result differs from 1 by
+ *     at most kNormalizeFastMaxError.
+ */
+constexpr float kSinCosFastRange = 1e4f;
+constexpr float kSinCosFastMaxError = 4e-7f;
+constexpr float kAcosFastMaxError = 5e-7f;
+constexpr float kRsqrtFastMaxRelError = 4e-7f;
+constexpr float kNormalizeFastMaxError = 1e-6f;
+
+namespace detail
+{
+	// The implementations are written once, as templates that work on both
+	// float and the SIMD types. The scalar overloads below provide the
+	// operations that the SIMD types get from simd.hpp.
+	namespace fastmath
+	{
+		inline float add( float aX, float aY ) noexcept { return aX + aY; }
+		inline float sub( float aX, float aY ) noexcept { return aX - aY; }
+		inline float mul( float aX, float aY ) noexcept { return aX * aY; }
+		inline float madd( float aX, float aY, float aZ ) noexcept { return aX * aY + aZ; }
+		inline float min( float aX, float aY ) noexcept { return aX < aY ? aX : aY; }
+		inline float max( float aX, float aY ) noexcept { return aX > aY ? aX : aY; }
+		inline float abs( float aX ) noexcept { return std::abs( aX ); }
+		inline float sqrt( float aX ) noexcept { return std::sqrt( aX ); }
+		inline float round( float aX ) noexcept { return std::nearbyint( aX ); }
+		inline float copysign( float aMag, float aSign ) noexcept { return std::copysign( aMag, aSign ); }
+
+		template< class tType > inline
+		tType constant( float aValue ) noexcept
+		{
+#			if !VMLIB_SIMD_NONE
+			if constexpr( !std::is_same_v<tType, float> )
+				return simd::splat<tType>( aValue );
+			else
+#			endif // ~ !VMLIB_SIMD_NONE
+				return aValue;
+		}
+
+		constexpr float kPi = 3.14159265358979f;
+		constexpr float kHalfPi = 1.57079632679490f;
+		constexpr float kInvTwoPi = 0.159154943091895f;
+
+		// 2 pi = kTwoPiHi + kTwoPiLo. kTwoPiHi has only a few significant
+		// bits, so k * kTwoPiHi is exact for the k that occur in range.
+		constexpr float kTwoPiHi = 6.28125f;
+		constexpr float kTwoPiLo = 0.00193530717958648f;
+
+		// sin(x) ~ x + x^3 (s3 + s5 x^2 + s7 x^4 + s9 x^6) on [-pi/2, pi/2]
+		// (max. error of the polynomial itself: 4.7e-9)
+		constexpr float kS3 = -0.166666570961183f;
+		constexpr float kS5 = 0.00833301728422625f;
+		constexpr float kS7 = -0.000198066147674421f;
+		constexpr float kS9 = 2.60005395393449e-6f;
+
+		// acos(x) ~ sqrt(1-x) (a0 + a1 x + ... + a7 x^7) on [0, 1]
+		constexpr float kA0 = 1.5707963050f;
+		constexpr float kA1 = -0.2145988016f;
+		constexpr float kA2 = 0.0889789874f;
+		constexpr float kA3 = -0.0501743046f;
+		constexpr float kA4 = 0.0308918810f;
+		constexpr float kA5 = -0.0170881256f;
+		constexpr float kA6 = 0.0066700901f;
+		constexpr float kA7 = -0.0012624911f;
+
+		// Reduce to [-pi, pi]
+		template< class tType > inline
+		tType reduce( tType aX ) noexcept
+		{
+			tType const k = round( mul( aX, constant<tType>( kInvTwoPi ) ) );
+			tType const r = sub( aX, mul( k, constant<tType>( kTwoPiHi ) ) );
+			return sub( r, mul( k, constant<tType>( kTwoPiLo ) ) );
+		}
+
+		template< class tType > inline
+		tType sin_poly( tType aX ) noexcept
+		{
+			tType const x2 = mul( aX, aX );
+			tType p = madd( constant<tType>( kS9 ), x2, constant<tType>( kS7 ) );
+			p = madd( p, x2, constant<tType>( kS5 ) );
+			p = madd( p, x2, constant<tType>( kS3 ) );
+			return madd( mul( p, x2 ), aX, aX );
+		}
+
+		// sin(r) = sin(pi-r) = sin(-pi-r): fold r from [-pi, pi] to [-pi/2, pi/2]
+		template< class tType > inline
+		tType fold_sin( tType aR ) noexcept
+		{
+			tType const pi = constant<tType>( kPi );
+			return max( min( aR, sub( pi, aR ) ), sub( sub( constant<tType>( 0.f ), pi ), aR ) );
+		}
+
+		// cos(r) = sin(pi/2 - |r|), with pi/2 - |r| in [-pi/2, pi/2]
+		template< class tType > inline
+		tType fold_cos( tType aR ) noexcept
+		{
+			return sub( constant<tType>( kHalfPi ), abs( aR ) );
+		}
+
+		template< class tType > inline
+		tType sin( tType aX ) noexcept
+		{
+			return sin_poly( fold_sin( reduce( aX ) ) );
+		}
+		template< class tType > inline
+		tType cos( tType aX ) noexcept
+		{
+			return sin_poly( fold_cos( reduce( aX ) ) );
+		}
+		template< class tType > inline
+		void sincos( tType aX, tType& aSin, tType& aCos ) noexcept
+		{
+			tType const r = reduce( aX );
+			aSin = sin_poly( fold_sin( r ) );
+			aCos = sin_poly( fold_cos( r ) );
+		}
+
+		template< class tType > inline
+		tType acos( tType aX ) noexcept
+		{
+			tType const a = abs( aX );
+
+			tType p = madd( constant<tType>( kA7 ), a, constant<tType>( kA6 ) );
+			p = madd( p, a, constant<tType>( kA5 ) );
+			p = madd( p, a, constant<tType>( kA4 ) );
+			p = madd( p, a, constant<tType>( kA3 ) );
+			p = madd( p, a, constant<tType>( kA2 ) );
+			p = madd( p, a, constant<tType>( kA1 ) );
+			p = madd( p, a, constant<tType>( kA0 ) );
+
+			// r = acos(|x|); acos(-x) = pi - acos(x)
+			tType const r = mul( sqrt( sub( constant<tType>( 1.f ), a ) ), p );
+			tType const halfPi = constant<tType>( kHalfPi );
+			return sub( halfPi, copysign( sub( halfPi, r ), aX ) );
+		}
+
+#		if !VMLIB_SIMD_NONE
+		// y' = y (3 - x y^2) / 2; each step roughly doubles the number of
+		// correct bits.
+		template< class tVec > inline
+		tVec rsqrt( tVec aX ) noexcept
+		{
+			tVec const half = constant<tVec>( 0.5f );
+			tVec const threeHalves = constant<tVec>( 1.5f );
+			tVec const halfX = mul( aX, half );
+
+			tVec y = simd::rsqrt_estimate( aX );
+			for( unsigned bits = simd::kRsqrtEstimateBits; bits < 22; bits *= 2 )
+				y = mul( y, sub( threeHalves, mul( mul( halfX, y ), y ) ) );
+			return y;
+		}
+#		endif // ~ !VMLIB_SIMD_NONE
+	}
+}
+
+inline
+float sin_fast( float aX ) noexcept
+{
+	return detail::fastmath::sin( aX );
+}
+inline
+float cos_fast( float aX ) noexcept
+{
+	return detail::fastmath::cos( aX );
+}
+inline
+void sincos_fast( float aX, float& aSin, float& aCos ) noexcept
+{
+	detail::fastmath::sincos( aX, aSin, aCos );
+}
+
+inline
+float acos_fast( float aX ) noexcept
+{
+	return detail::fastmath::acos( aX );
+}
+
+inline
+float rsqrt_fast( float aX ) noexcept
+{
+#	if !VMLIB_SIMD_NONE
+	return simd::first( detail::fastmath::rsqrt( simd::splat4( aX ) ) );
+#	else
+	return 1.f / std::sqrt( aX );
+#	endif
+}
+
+inline
+Vec3f normalize_fast( Vec3f aVec ) noexcept
+{
+	return aVec * rsqrt_fast( dot( aVec, aVec ) );
+}
+
+
+#if !VMLIB_SIMD_NONE
+namespace simd
+{
+	// SIMD versions; tVec is F32x4 or F32x8.
+	template< class tVec > inline
+	tVec sin_fast( tVec aX ) noexcept
+	{
+		return ::detail::fastmath::sin( aX );
+	}
+	template< class tVec > inline
+	tVec cos_fast( tVec aX ) noexcept
+	{
+		return ::detail::fastmath::cos( aX );
+	}
+	template< class tVec > inline
+	void sincos_fast( tVec aX, tVec& aSin, tVec& aCos ) noexcept
+	{
+		::detail::fastmath::sincos( aX, aSin, aCos );
+	}
+
+	template< class tVec > inline
+	tVec acos_fast( tVec aX ) noexcept
+	{
+		return ::detail::fastmath::acos( aX );
+	}
+
+	template< class tVec > inline
+	tVec rsqrt_fast( tVec aX ) noexcept
+	{
+		return ::detail::fastmath::rsqrt( aX );
+	}
+
+	// Normalize the vectors (aX[i], aY[i], aZ[i]) in place.
+	template< class tVec > inline
+	void normalize_fast( tVec& aX, tVec& aY, tVec& aZ ) noexcept
+	{
+		tVec const l2 = madd( aZ, aZ, madd( aY, aY, mul( aX, aX ) ) );
+		tVec const s = rsqrt_fast( l2 );
+		aX = mul( aX, s );
+		aY = mul( aY, s );
+		aZ = mul( aZ, s );
+	}
+}
+#endif // ~ !VMLIB_SIMD_NONE
+
+#endif // FASTMATH_HPP_248EF567_EBB7_4AD7_907F_5EBC0852AFEB
@@ -0,0 +1,77 @@
+#include "mat33.hpp"
+
+Mat33f normal_matrix( Mat44f const& aM ) noexcept
+{
+#	if !VMLIB_SIMD_NONE
+	return detail::normal_matrix_simd( aM );
+#	else
+	return detail::normal_matrix_scalar( aM );
+#	endif
+}
+
+namespace detail
+{
+	Mat33f normal_matrix_scalar( Mat44f const& aM ) noexcept
+	{
+		// The inverse of a 3x3 matrix is the transposed cofactor matrix
+		// divided by the determinant. The normal matrix is the transpose of
+		// the inverse, so it is simply the cofactor matrix divided by the
+		// determinant.
+		Mat33f ret;
+		ret(0,0) = aM(1,1)*aM(2,2) - aM(1,2)*aM(2,1);
+		ret(0,1) = aM(1,2)*aM(2,0) - aM(1,0)*aM(2,2);
+		ret(0,2) = aM(1,0)*aM(2,1) - aM(1,1)*aM(2,0);
+		ret(1,0) = aM(2,1)*aM(0,2) - aM(2,2)*aM(0,1);
+		ret(1,1) = aM(2,2)*aM(0,0) - aM(2,0)*aM(0,2);
+		ret(1,2) = aM(2,0)*aM(0,1) - aM(2,1)*aM(0,0);
+		ret(2,0) = aM(0,1)*aM(1,2) - aM(0,2)*aM(1,1);
+		ret(2,1) = aM(0,2)*aM(1,0) - aM(0,0)*aM(1,2);
+		ret(2,2) = aM(0,0)*aM(1,1) - aM(0,1)*aM(1,0);
+
+		float const d = aM(0,0) * ret(0,0) + aM(0,1) * ret(0,1) + aM(0,2) * ret(0,2);
+
+		for( auto& v : ret.v )
+			v /= d;
+
+		return ret;
+	}
+
+#	if !VMLIB_SIMD_NONE
+	Mat33f normal_matrix_simd( Mat44f const& aM ) noexcept
+	{
+		using namespace simd;
+
+		// Rows of the cofactor matrix are cross products of the rows of the
+		// 3x3 matrix: c0 = r1 x r2, c1 = r2 x r0 and c2 = r0 x r1. The fourth
+		// element of each row (the translation) ends up in the fourth
+		// element of the products, where it is ignored.
+		F32x4 const r0 = load4( aM.v + 0 );
+		F32x4 const r1 = load4( aM.v + 4 );
+		F32x4 const r2 = load4( aM.v + 8 );
+
+		F32x4 const r0yzx = permute<1,2,0,3>( r0 ), r0zxy = permute<2,0,1,3>( r0 );
+		F32x4 const r1yzx = permute<1,2,0,3>( r1 ), r1zxy = permute<2,0,1,3>( r1 );
+		F32x4 const r2yzx = permute<1,2,0,3>( r2 ), r2zxy = permute<2,0,1,3>( r2 );
+
+		F32x4 const c0 = sub( mul( r1yzx, r2zxy ), mul( r1zxy, r2yzx ) );
+		F32x4 const c1 = sub( mul( r2yzx, r0zxy ), mul( r2zxy, r0yzx ) );
+		F32x4 const c2 = sub( mul( r0yzx, r1zxy ), mul( r0zxy, r1yzx ) );
+
+		float rd[4];
+		store4( rd, mul( r0, c0 ) );
+		F32x4 const invDet = div( splat4( 1.f ), splat4( rd[0] + rd[1] + rd[2] ) );
+
+		// Rows are stored with a 4-float store each; the last one would
+		// write past the end of the Mat33f, so it goes through a temporary.
+		Mat33f ret;
+		float last[4];
+		store4( ret.v + 0, mul( c0, invDet ) );
+		store4( ret.v + 3, mul( c1, invDet ) );
+		store4( last, mul( c2, invDet ) );
+		ret.v[6] = last[0];
+		ret.v[7] = last[1];
+		ret.v[8] = last[2];
+		return ret;
+	}
+#	endif // ~ !VMLIB_SIMD_NONE
+}
@@ -80,4 +80,18 @@ Mat33f mat44_to_mat33( Mat44f const& aM )
 	return ret;
 }
 
+// Normal matrix, i.e., the inverse-transpose of the upper 3x3 part of aM.
+// For affine aM, this is equivalent to
+//    mat44_to_mat33(transpose(invert(aM)))
+// but only needs the 3x3 cofactors instead of a full 4x4 inverse.
+Mat33f normal_matrix( Mat44f const& aM ) noexcept;
+
+namespace detail
+{
+	Mat33f normal_matrix_scalar( Mat44f const& aM ) noexcept;
+#	if !VMLIB_SIMD_NONE
+	Mat33f normal_matrix_simd( Mat44f const& aM ) noexcept;
+#	endif
+}
+
 #endif // MAT33_HPP_61F3107B_CBE4_48DE_9F39_EA959B4BF694
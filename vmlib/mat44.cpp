@@ -67,3 +67,17 @@ Mat44f invert( Mat44f const& aM ) noexcept
 	return ret;
 }
 
+Mat44f invert_rigid( Mat44f const& aM ) noexcept
+{
+	// For a rotation R, R^-1 = R^T. The inverse is thus [ R^T  -R^T t ; 0 1 ].
+	Mat44f ret = kIdentity44f;
+	for( std::size_t i = 0; i < 3; ++i )
+	{
+		for( std::size_t j = 0; j < 3; ++j )
+			ret(i,j) = aM(j,i);
+
+		ret(i,3) = -(ret(i,0) * aM(0,3) + ret(i,1) * aM(1,3) + ret(i,2) * aM(2,3));
+	}
+
+	return ret;
+}
@@ -7,6 +7,7 @@
 
 #include "vec3.hpp"
 #include "vec4.hpp"
+#include "simd.hpp"
 #include <iostream>
 
 /** Mat44f: 4x4 matrix with floats
@@ -15,6 +16,8 @@
  * intentionally kept simple and somewhat bare bones.
  *
  * The matrix is stored in row-major order (careful when passing it to OpenGL).
+ * See mat44cm.hpp for a column-major variant that can be passed to OpenGL
+ * (and copied into uniform buffers) as-is.
  *
  * The overloaded operator () allows access to individual elements. Example:
  *    Mat44f m = ...;
@@ -28,7 +31,7 @@
  *   ⎜ 2,0  2,1  2,2  2,3 ⎟
  *   ⎝ 3,0  3,1  3,2  3,3 ⎠
  */
-struct Mat44f
+struct alignas(16) Mat44f
 {
 	float v[16];
 
@@ -68,59 +71,263 @@ bool operator==(Mat44f const& aLeft, Mat44f const& aRight) noexcept{
 	return true;
 }
 
-
-
-constexpr
-Mat44f operator*( Mat44f const& aLeft, Mat44f const& aRight ) noexcept
+// The operators below are implemented twice: a scalar version, which is
+// used during constant evaluation and serves as the reference, and a SIMD
+// version (see simd.hpp) that is used at runtime when available. The scalar
+// versions live in the detail namespace, so that they can be tested and
+// benchmarked against the SIMD versions.
+namespace detail
 {
+	constexpr
+	Mat44f mat44_mul_scalar( Mat44f const& aLeft, Mat44f const& aRight ) noexcept
+	{
+		Mat44f ret = { {0.f, 0.f, 0.f, 0.f,
+						0.f, 0.f, 0.f, 0.f,
+						0.f, 0.f, 0.f, 0.f,
+						0.f, 0.f, 0.f, 0.f} };
+
+		ret(0, 0) = aLeft(0, 0) * aRight(0, 0) + aLeft(0, 1) * aRight(1, 0) + aLeft(0, 2) * aRight(2, 0) + aLeft(0, 3) * aRight(3, 0);
+		ret(0, 1) = aLeft(0, 0) * aRight(0, 1) + aLeft(0, 1) * aRight(1, 1) + aLeft(0, 2) * aRight(2, 1) + aLeft(0, 3) * aRight(3, 1);
+		ret(0, 2) = aLeft(0, 0) * aRight(0, 2) + aLeft(0, 1) * aRight(1, 2) + aLeft(0, 2) * aRight(2, 2) + aLeft(0, 3) * aRight(3, 2);
+		ret(0, 3) = aLeft(0, 0) * aRight(0, 3) + aLeft(0, 1) * aRight(1, 3) + aLeft(0, 2) * aRight(2, 3) + aLeft(0, 3) * aRight(3, 3);
+
+		ret(1, 0) = aLeft(1, 0) * aRight(0, 0) + aLeft(1, 1) * aRight(1, 0) + aLeft(1, 2) * aRight(2, 0) + aLeft(1, 3) * aRight(3, 0);
+		ret(1, 1) = aLeft(1, 0) * aRight(0, 1) + aLeft(1, 1) * aRight(1, 1) + aLeft(1, 2) * aRight(2, 1) + aLeft(1, 3) * aRight(3, 1);
+		ret(1, 2) = aLeft(1, 0) * aRight(0, 2) + aLeft(1, 1) * aRight(1, 2) + aLeft(1, 2) * aRight(2, 2) + aLeft(1, 3) * aRight(3, 2);
+		ret(1, 3) = aLeft(1, 0) * aRight(0, 3) + aLeft(1, 1) * aRight(1, 3) + aLeft(1, 2) * aRight(2, 3) + aLeft(1, 3) * aRight(3, 3);
+
+		ret(2, 0) = aLeft(2, 0) * aRight(0, 0) + aLeft(2, 1) * aRight(1, 0) + aLeft(2, 2) * aRight(2, 0) + aLeft(2, 3) * aRight(3, 0);
+		ret(2, 1) = aLeft(2, 0) * aRight(0, 1) + aLeft(2, 1) * aRight(1, 1) + aLeft(2, 2) * aRight(2, 1) + aLeft(2, 3) * aRight(3, 1);
+		ret(2, 2) = aLeft(2, 0) * aRight(0, 2) + aLeft(2, 1) * aRight(1, 2) + aLeft(2, 2) * aRight(2, 2) + aLeft(2, 3) * aRight(3, 2);
+		ret(2, 3) = aLeft(2, 0) * aRight(0, 3) + aLeft(2, 1) * aRight(1, 3) + aLeft(2, 2) * aRight(2, 3) + aLeft(2, 3) * aRight(3, 3);
+
+		ret(3, 0) = aLeft(3, 0) * aRight(0, 0) + aLeft(3, 1) * aRight(1, 0) + aLeft(3, 2) * aRight(2, 0) + aLeft(3, 3) * aRight(3, 0);
+		ret(3, 1) = aLeft(3, 0) * aRight(0, 1) + aLeft(3, 1) * aRight(1, 1) + aLeft(3, 2) * aRight(2, 1) + aLeft(3, 3) * aRight(3, 1);
+		ret(3, 2) = aLeft(3, 0) * aRight(0, 2) + aLeft(3, 1) * aRight(1, 2) + aLeft(3, 2) * aRight(2, 2) + aLeft(3, 3) * aRight(3, 2);
+		ret(3, 3) = aLeft(3, 0) * aRight(0, 3) + aLeft(3, 1) * aRight(1, 3) + aLeft(3, 2) * aRight(2, 3) + aLeft(3, 3) * aRight(3, 3);
+
+		return ret;
+	}
 
+	constexpr
+	Vec4f mat44_mul_scalar( Mat44f const& aLeft, Vec4f const& aRight ) noexcept
+	{
+		return Vec4f{
+			aLeft(0, 0) * aRight.x + aLeft(0, 1) * aRight.y + aLeft(0, 2) * aRight.z + aLeft(0, 3) * aRight.w,
+			aLeft(1, 0) * aRight.x + aLeft(1, 1) * aRight.y + aLeft(1, 2) * aRight.z + aLeft(1, 3) * aRight.w,
+			aLeft(2, 0) * aRight.x + aLeft(2, 1) * aRight.y + aLeft(2, 2) * aRight.z + aLeft(2, 3) * aRight.w,
+			aLeft(3, 0) * aRight.x + aLeft(3, 1) * aRight.y + aLeft(3, 2) * aRight.z + aLeft(3, 3) * aRight.w
+		};
+	}
 
-	Mat44f ret = { {0.f, 0.f, 0.f, 0.f,
-					0.f, 0.f, 0.f, 0.f,
-					0.f, 0.f, 0.f, 0.f,
-					0.f, 0.f, 0.f, 0.f} };
+#	if !VMLIB_SIMD_NONE
+	// Multiply two row-major 4x4 matrices stored as flat arrays. Since
+	// (A B)^T = B^T A^T, the same function multiplies column-major matrices
+	// when the arguments are swapped (see mat44cm.hpp).
+	inline
+	void mat44_mul_rows_simd( float const* aLeft, float const* aRight, float* aOut ) noexcept
+	{
+		using namespace simd;
+
+		// Row i of the result is a linear combination of the rows of aRight,
+		// weighted by the elements of row i of aLeft. The sums are evaluated
+		// in the same order as in the scalar version.
+#		if VMLIB_SIMD_AVX
+		// Process two rows at a time: the lower 128-bit lane holds row i and
+		// the upper lane row i+1.
+		F32x8 const b0 = load4x2( aRight + 0 );
+		F32x8 const b1 = load4x2( aRight + 4 );
+		F32x8 const b2 = load4x2( aRight + 8 );
+		F32x8 const b3 = load4x2( aRight + 12 );
+
+		for( std::size_t i = 0; i < 4; i += 2 )
+		{
+			F32x8 const a = load8( aLeft + i*4 );
+
+			F32x8 r = mul( splat_in_lanes<0>( a ), b0 );
+			r = madd( splat_in_lanes<1>( a ), b1, r );
+			r = madd( splat_in_lanes<2>( a ), b2, r );
+			r = madd( splat_in_lanes<3>( a ), b3, r );
+
+			store8( aOut + i*4, r );
+		}
+#		else
+		F32x4 const b0 = load4( aRight + 0 );
+		F32x4 const b1 = load4( aRight + 4 );
+		F32x4 const b2 = load4( aRight + 8 );
+		F32x4 const b3 = load4( aRight + 12 );
+
+		for( std::size_t i = 0; i < 4; ++i )
+		{
+			F32x4 r = mul( splat4( aLeft[i*4+0] ), b0 );
+			r = madd( splat4( aLeft[i*4+1] ), b1, r );
+			r = madd( splat4( aLeft[i*4+2] ), b2, r );
+			r = madd( splat4( aLeft[i*4+3] ), b3, r );
+
+			store4( aOut + i*4, r );
+		}
+#		endif
+	}
 
-	ret(0, 0) = aLeft(0, 0) * aRight(0, 0) + aLeft(0, 1) * aRight(1, 0) + aLeft(0, 2) * aRight(2, 0) + aLeft(0, 3) * aRight(3, 0);
-	ret(0, 1) = aLeft(0, 0) * aRight(0, 1) + aLeft(0, 1) * aRight(1, 1) + aLeft(0, 2) * aRight(2, 1) + aLeft(0, 3) * aRight(3, 1);
-	ret(0, 2) = aLeft(0, 0) * aRight(0, 2) + aLeft(0, 1) * aRight(1, 2) + aLeft(0, 2) * aRight(2, 2) + aLeft(0, 3) * aRight(3, 2);
-	ret(0, 3) = aLeft(0, 0) * aRight(0, 3) + aLeft(0, 1) * aRight(1, 3) + aLeft(0, 2) * aRight(2, 3) + aLeft(0, 3) * aRight(3, 3);
+	inline
+	Mat44f mat44_mul_simd( Mat44f const& aLeft, Mat44f const& aRight ) noexcept
+	{
+		Mat44f ret;
+		mat44_mul_rows_simd( aLeft.v, aRight.v, ret.v );
+		return ret;
+	}
 
-	ret(1, 0) = aLeft(1, 0) * aRight(0, 0) + aLeft(1, 1) * aRight(1, 0) + aLeft(1, 2) * aRight(2, 0) + aLeft(1, 3) * aRight(3, 0);
-	ret(1, 1) = aLeft(1, 0) * aRight(0, 1) + aLeft(1, 1) * aRight(1, 1) + aLeft(1, 2) * aRight(2, 1) + aLeft(1, 3) * aRight(3, 1);
-	ret(1, 2) = aLeft(1, 0) * aRight(0, 2) + aLeft(1, 1) * aRight(1, 2) + aLeft(1, 2) * aRight(2, 2) + aLeft(1, 3) * aRight(3, 2);
-	ret(1, 3) = aLeft(1, 0) * aRight(0, 3) + aLeft(1, 1) * aRight(1, 3) + aLeft(1, 2) * aRight(2, 3) + aLeft(1, 3) * aRight(3, 3);
+	inline
+	Vec4f mat44_mul_simd( Mat44f const& aLeft, Vec4f const& aRight ) noexcept
+	{
+		using namespace simd;
 
-	ret(2, 0) = aLeft(2, 0) * aRight(0, 0) + aLeft(2, 1) * aRight(1, 0) + aLeft(2, 2) * aRight(2, 0) + aLeft(2, 3) * aRight(3, 0);
-	ret(2, 1) = aLeft(2, 0) * aRight(0, 1) + aLeft(2, 1) * aRight(1, 1) + aLeft(2, 2) * aRight(2, 1) + aLeft(2, 3) * aRight(3, 1);
-	ret(2, 2) = aLeft(2, 0) * aRight(0, 2) + aLeft(2, 1) * aRight(1, 2) + aLeft(2, 2) * aRight(2, 2) + aLeft(2, 3) * aRight(3, 2);
-	ret(2, 3) = aLeft(2, 0) * aRight(0, 3) + aLeft(2, 1) * aRight(1, 3) + aLeft(2, 2) * aRight(2, 3) + aLeft(2, 3) * aRight(3, 3);
+		// Multiply each row with the vector, then transpose the products so
+		// that the horizontal sums become three vertical adds.
+		F32x4 const x = load4( &aRight.x );
+		F32x4 p0 = mul( load4( aLeft.v + 0 ), x );
+		F32x4 p1 = mul( load4( aLeft.v + 4 ), x );
+		F32x4 p2 = mul( load4( aLeft.v + 8 ), x );
+		F32x4 p3 = mul( load4( aLeft.v + 12 ), x );
 
-	ret(3, 0) = aLeft(3, 0) * aRight(0, 0) + aLeft(3, 1) * aRight(1, 0) + aLeft(3, 2) * aRight(2, 0) + aLeft(3, 3) * aRight(3, 0);
-	ret(3, 1) = aLeft(3, 0) * aRight(0, 1) + aLeft(3, 1) * aRight(1, 1) + aLeft(3, 2) * aRight(2, 1) + aLeft(3, 3) * aRight(3, 1);
-	ret(3, 2) = aLeft(3, 0) * aRight(0, 2) + aLeft(3, 1) * aRight(1, 2) + aLeft(3, 2) * aRight(2, 2) + aLeft(3, 3) * aRight(3, 2);
-	ret(3, 3) = aLeft(3, 0) * aRight(0, 3) + aLeft(3, 1) * aRight(1, 3) + aLeft(3, 2) * aRight(2, 3) + aLeft(3, 3) * aRight(3, 3);
+		transpose4( p0, p1, p2, p3 );
 
-	return ret;
+		Vec4f ret;
+		store4( &ret.x, add( add( add( p0, p1 ), p2 ), p3 ) );
+		return ret;
+	}
+#	endif // ~ !VMLIB_SIMD_NONE
+}
 
-	
+constexpr
+Mat44f operator*( Mat44f const& aLeft, Mat44f const& aRight ) noexcept
+{
+#	if VMLIB_SIMD_RUNTIME_DISPATCH
+	if( !VMLIB_IS_CONSTANT_EVALUATED() )
+		return detail::mat44_mul_simd( aLeft, aRight );
+#	endif
+	return detail::mat44_mul_scalar( aLeft, aRight );
 }
 
 constexpr
 Vec4f operator*( Mat44f const& aLeft, Vec4f const& aRight ) noexcept
 {
-	//Vec4f vec;
-	return Vec4f{
-		aLeft(0, 0) * aRight.x + aLeft(0, 1) * aRight.y + aLeft(0, 2) * aRight.z + aLeft(0, 3) * aRight.w,
-		aLeft(1, 0) * aRight.x + aLeft(1, 1) * aRight.y + aLeft(1, 2) * aRight.z + aLeft(1, 3) * aRight.w,
-		aLeft(2, 0) * aRight.x + aLeft(2, 1) * aRight.y + aLeft(2, 2) * aRight.z + aLeft(2, 3) * aRight.w,
-		aLeft(3, 0) * aRight.x + aLeft(3, 1) * aRight.y + aLeft(3, 2) * aRight.z + aLeft(3, 3) * aRight.w
-	};
+#	if VMLIB_SIMD_RUNTIME_DISPATCH
+	if( !VMLIB_IS_CONSTANT_EVALUATED() )
+		return detail::mat44_mul_simd( aLeft, aRight );
+#	endif
+	return detail::mat44_mul_scalar( aLeft, aRight );
 }
 
 // Functions:
 
 Mat44f invert( Mat44f const& aM ) noexcept;
 
+// Faster inverses for special cases. invert_affine() requires that the last
+// row of aM is (0,0,0,1). invert_rigid() additionally requires that the
+// upper 3x3 part is a pure rotation (orthonormal, no scaling). The results
+// are undefined if these assumptions do not hold.
+//
+// invert_affine() is defined inline (like operator*), so that the result is
+// written directly to its destination.
+Mat44f invert_rigid( Mat44f const& aM ) noexcept;
+
+namespace detail
+{
+	inline
+	Mat44f invert_affine_scalar( Mat44f const& aM ) noexcept
+	{
+		// For M = [ A t ; 0 1 ], the inverse is [ A^-1  -A^-1 t ; 0 1 ]. A^-1
+		// is the transposed cofactor matrix of A divided by the determinant
+		// (see normal_matrix_scalar()); only one division is needed.
+		Mat44f ret;
+		ret(0,0) = aM(1,1)*aM(2,2) - aM(1,2)*aM(2,1);
+		ret(1,0) = aM(1,2)*aM(2,0) - aM(1,0)*aM(2,2);
+		ret(2,0) = aM(1,0)*aM(2,1) - aM(1,1)*aM(2,0);
+		ret(0,1) = aM(2,1)*aM(0,2) - aM(2,2)*aM(0,1);
+		ret(1,1) = aM(2,2)*aM(0,0) - aM(2,0)*aM(0,2);
+		ret(2,1) = aM(2,0)*aM(0,1) - aM(2,1)*aM(0,0);
+		ret(0,2) = aM(0,1)*aM(1,2) - aM(0,2)*aM(1,1);
+		ret(1,2) = aM(0,2)*aM(1,0) - aM(0,0)*aM(1,2);
+		ret(2,2) = aM(0,0)*aM(1,1) - aM(0,1)*aM(1,0);
+
+		float const invDet = 1.f / (aM(0,0) * ret(0,0) + aM(0,1) * ret(1,0) + aM(0,2) * ret(2,0));
+
+		for( std::size_t i = 0; i < 3; ++i )
+		{
+			ret(i,0) *= invDet;
+			ret(i,1) *= invDet;
+			ret(i,2) *= invDet;
+			ret(i,3) = -(ret(i,0) * aM(0,3) + ret(i,1) * aM(1,3) + ret(i,2) * aM(2,3));
+		}
+
+		ret(3,0) = 0.f;
+		ret(3,1) = 0.f;
+		ret(3,2) = 0.f;
+		ret(3,3) = 1.f;
+		return ret;
+	}
+
+#	if !VMLIB_SIMD_NONE
+	inline
+	Mat44f invert_affine_simd( Mat44f const& aM ) noexcept
+	{
+		using namespace simd;
+
+		// Cofactor rows as in normal_matrix_simd(). They are the columns of
+		// A^-1 (before the division by the determinant). Their fourth
+		// elements are ignored; they end up in the last row, which is
+		// overwritten.
+		F32x4 const r0 = load4( aM.v + 0 );
+		F32x4 const r1 = load4( aM.v + 4 );
+		F32x4 const r2 = load4( aM.v + 8 );
+
+		F32x4 const r0yzx = permute<1,2,0,3>( r0 ), r0zxy = permute<2,0,1,3>( r0 );
+		F32x4 const r1yzx = permute<1,2,0,3>( r1 ), r1zxy = permute<2,0,1,3>( r1 );
+		F32x4 const r2yzx = permute<1,2,0,3>( r2 ), r2zxy = permute<2,0,1,3>( r2 );
+
+		F32x4 c0 = sub( mul( r1yzx, r2zxy ), mul( r1zxy, r2yzx ) );
+		F32x4 c1 = sub( mul( r2yzx, r0zxy ), mul( r2zxy, r0yzx ) );
+		F32x4 c2 = sub( mul( r0yzx, r1zxy ), mul( r0zxy, r1yzx ) );
+
+		// Fourth column: -A^-1 t, again before the division
+		F32x4 c3 = mul( c0, permute<3,3,3,3>( r0 ) );
+		c3 = madd( c1, permute<3,3,3,3>( r1 ), c3 );
+		c3 = madd( c2, permute<3,3,3,3>( r2 ), c3 );
+		c3 = sub( splat4( 0.f ), c3 );
+
+		// Determinant r0 . c0 (first three elements), in every element
+		F32x4 const d = mul( r0, c0 );
+		F32x4 const det = add( add( permute<0,0,0,0>( d ), permute<1,1,1,1>( d ) ), permute<2,2,2,2>( d ) );
+		F32x4 const invDet = div( splat4( 1.f ), det );
+
+		// The columns become rows; the fourth row is replaced by (0,0,0,1).
+		// All rows are written with full stores, so that copying the result
+		// does not stall on store forwarding.
+		transpose4( c0, c1, c2, c3 );
+
+		static constexpr float kLastRow[4] = { 0.f, 0.f, 0.f, 1.f };
+
+		Mat44f ret;
+		store4( ret.v + 0, mul( c0, invDet ) );
+		store4( ret.v + 4, mul( c1, invDet ) );
+		store4( ret.v + 8, mul( c2, invDet ) );
+		store4( ret.v + 12, load4( kLastRow ) );
+		return ret;
+	}
+#	endif // ~ !VMLIB_SIMD_NONE
+}
+
+inline
+Mat44f invert_affine( Mat44f const& aM ) noexcept
+{
+#	if !VMLIB_SIMD_NONE
+	return detail::invert_affine_simd( aM );
+#	else
+	return detail::invert_affine_scalar( aM );
+#	endif
+}
+
 // Rotation method to rotate a matrix by an angle on a certain axis. Requires angle to be passed in as radians
 // From https://en.wikipedia.org/wiki/Rotation_matrix#Rotation_matrix_from_axis_and_angle
 inline
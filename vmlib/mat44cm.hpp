@@ -0,0 +1,212 @@
+#ifndef MAT44CM_HPP_AC324D7C_A951_4823_993A_C5442D16C2DD
+#define MAT44CM_HPP_AC324D7C_A951_4823_993A_C5442D16C2DD
+
+#include <cstddef>
+
+#include "vec4.hpp"
+#include "mat44.hpp"
+#include "simd.hpp"
+
+/** Mat44fCM: 4x4 matrix with floats, column-major storage
+ *
+ * Same as Mat44f, except that the elements are stored column by column:
+ *
+ *   ⎛ v[0]  v[4]  v[8]   v[12] ⎞
+ *   ⎜ v[1]  v[5]  v[9]   v[13] ⎟
+ *   ⎜ v[2]  v[6]  v[10]  v[14] ⎟
+ *   ⎝ v[3]  v[7]  v[11]  v[15] ⎠
+ *
+ * This is the layout that OpenGL expects by default. A Mat44fCM can be
+ * passed to glUniformMatrix4fv() with transpose = GL_FALSE, and it matches
+ * the std140 (and std430) layout of a mat4 (four vec4 columns, 16 byte
+ * aligned, 64 bytes in total). Per-object matrices can therefore be
+ * memcpy()'d directly into a (mapped) uniform buffer.
+ *
+ * operator() takes (row, column), like for Mat44f, so code that only uses
+ * operator() works with either layout.
+ *
+ * Use to_column_major() and to_row_major() to convert between the two.
+ */
+struct alignas(16) Mat44fCM
+{
+	float v[16];
+
+	constexpr
+	float& operator() (std::size_t aI, std::size_t aJ) noexcept
+	{
+		assert( aI < 4 && aJ < 4 );
+		return v[aJ*4 + aI];
+	}
+	constexpr
+	float const& operator() (std::size_t aI, std::size_t aJ) const noexcept
+	{
+		assert( aI < 4 && aJ < 4 );
+		return v[aJ*4 + aI];
+	}
+};
+
+static_assert( sizeof(Mat44fCM) == 64, "Mat44fCM must match the std140 size of a mat4" );
+static_assert( alignof(Mat44fCM) == 16, "Mat44fCM must match the std140 alignment of a mat4" );
+
+// Identity matrix
+constexpr Mat44fCM kIdentity44fCM = { {
+	1.f, 0.f, 0.f, 0.f,
+	0.f, 1.f, 0.f, 0.f,
+	0.f, 0.f, 1.f, 0.f,
+	0.f, 0.f, 0.f, 1.f
+} };
+
+// Conversions.
+namespace detail
+{
+	constexpr
+	void transpose_flat_scalar( float const* aIn, float* aOut ) noexcept
+	{
+		for( std::size_t i = 0; i < 4; ++i )
+		{
+			for( std::size_t j = 0; j < 4; ++j )
+				aOut[j*4 + i] = aIn[i*4 + j];
+		}
+	}
+
+#	if !VMLIB_SIMD_NONE
+	inline
+	void transpose_flat_simd( float const* aIn, float* aOut ) noexcept
+	{
+		using namespace simd;
+
+		F32x4 r0 = load4( aIn + 0 );
+		F32x4 r1 = load4( aIn + 4 );
+		F32x4 r2 = load4( aIn + 8 );
+		F32x4 r3 = load4( aIn + 12 );
+		transpose4( r0, r1, r2, r3 );
+		store4( aOut + 0, r0 );
+		store4( aOut + 4, r1 );
+		store4( aOut + 8, r2 );
+		store4( aOut + 12, r3 );
+	}
+#	endif // ~ !VMLIB_SIMD_NONE
+
+	constexpr
+	void transpose_flat( float const* aIn, float* aOut ) noexcept
+	{
+#		if VMLIB_SIMD_RUNTIME_DISPATCH
+		if( !VMLIB_IS_CONSTANT_EVALUATED() )
+		{
+			transpose_flat_simd( aIn, aOut );
+			return;
+		}
+#		endif
+		transpose_flat_scalar( aIn, aOut );
+	}
+}
+
+constexpr
+Mat44fCM to_column_major( Mat44f const& aM ) noexcept
+{
+	Mat44fCM ret{};
+	detail::transpose_flat( aM.v, ret.v );
+	return ret;
+}
+
+constexpr
+Mat44f to_row_major( Mat44fCM const& aM ) noexcept
+{
+	Mat44f ret{};
+	detail::transpose_flat( aM.v, ret.v );
+	return ret;
+}
+
+
+// Common operators for Mat44fCM.
+constexpr
+bool operator==( Mat44fCM const& aLeft, Mat44fCM const& aRight ) noexcept
+{
+	for( std::size_t i = 0; i < 16; ++i )
+	{
+		if( aLeft.v[i] != aRight.v[i] )
+			return false;
+	}
+	return true;
+}
+
+namespace detail
+{
+	constexpr
+	Mat44fCM mat44cm_mul_scalar( Mat44fCM const& aLeft, Mat44fCM const& aRight ) noexcept
+	{
+		Mat44fCM ret{};
+		for( std::size_t i = 0; i < 4; ++i )
+		{
+			for( std::size_t j = 0; j < 4; ++j )
+			{
+				ret(i,j) = aLeft(i,0) * aRight(0,j) + aLeft(i,1) * aRight(1,j)
+					+ aLeft(i,2) * aRight(2,j) + aLeft(i,3) * aRight(3,j);
+			}
+		}
+		return ret;
+	}
+
+	constexpr
+	Vec4f mat44cm_mul_scalar( Mat44fCM const& aLeft, Vec4f const& aRight ) noexcept
+	{
+		return Vec4f{
+			aLeft(0, 0) * aRight.x + aLeft(0, 1) * aRight.y + aLeft(0, 2) * aRight.z + aLeft(0, 3) * aRight.w,
+			aLeft(1, 0) * aRight.x + aLeft(1, 1) * aRight.y + aLeft(1, 2) * aRight.z + aLeft(1, 3) * aRight.w,
+			aLeft(2, 0) * aRight.x + aLeft(2, 1) * aRight.y + aLeft(2, 2) * aRight.z + aLeft(2, 3) * aRight.w,
+			aLeft(3, 0) * aRight.x + aLeft(3, 1) * aRight.y + aLeft(3, 2) * aRight.z + aLeft(3, 3) * aRight.w
+		};
+	}
+
+#	if !VMLIB_SIMD_NONE
+	inline
+	Mat44fCM mat44cm_mul_simd( Mat44fCM const& aLeft, Mat44fCM const& aRight ) noexcept
+	{
+		// The column-major storage of A B is the row-major storage of
+		// B^T A^T, and the column-major arrays of A and B are the row-major
+		// arrays of A^T and B^T.
+		Mat44fCM ret;
+		mat44_mul_rows_simd( aRight.v, aLeft.v, ret.v );
+		return ret;
+	}
+
+	inline
+	Vec4f mat44cm_mul_simd( Mat44fCM const& aLeft, Vec4f const& aRight ) noexcept
+	{
+		using namespace simd;
+
+		// With column-major storage, M x is a linear combination of the
+		// columns; no transpose is needed.
+		F32x4 r = mul( load4( aLeft.v + 0 ), splat4( aRight.x ) );
+		r = madd( load4( aLeft.v + 4 ), splat4( aRight.y ), r );
+		r = madd( load4( aLeft.v + 8 ), splat4( aRight.z ), r );
+		r = madd( load4( aLeft.v + 12 ), splat4( aRight.w ), r );
+
+		Vec4f ret;
+		store4( &ret.x, r );
+		return ret;
+	}
+#	endif // ~ !VMLIB_SIMD_NONE
+}
+
+constexpr
+Mat44fCM operator*( Mat44fCM const& aLeft, Mat44fCM const& aRight ) noexcept
+{
+#	if VMLIB_SIMD_RUNTIME_DISPATCH
+	if( !VMLIB_IS_CONSTANT_EVALUATED() )
+		return detail::mat44cm_mul_simd( aLeft, aRight );
+#	endif
+	return detail::mat44cm_mul_scalar( aLeft, aRight );
+}
+
+constexpr
+Vec4f operator*( Mat44fCM const& aLeft, Vec4f const& aRight ) noexcept
+{
+#	if VMLIB_SIMD_RUNTIME_DISPATCH
+	if( !VMLIB_IS_CONSTANT_EVALUATED() )
+		return detail::mat44cm_mul_simd( aLeft, aRight );
+#	endif
+	return detail::mat44cm_mul_scalar( aLeft, aRight );
+}
+
+#endif // MAT44CM_HPP_AC324D7C_A951_4823_993A_C5442D16C2DD
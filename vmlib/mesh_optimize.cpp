@@ -0,0 +1,319 @@
+#include "mesh_optimize.hpp"
+
+#include <vector>
+#include <numeric>
+#include <algorithm>
+
+namespace
+{
+	constexpr std::uint32_t kNoVertex_ = ~std::uint32_t(0);
+
+	// FIFO cache simulation with timestamps: a vertex is in the cache if it
+	// was inserted fewer than aCacheSize insertions ago. Advancing the time
+	// by more than aCacheSize empties the cache.
+	class FifoCache_ final
+	{
+		public:
+			FifoCache_( std::size_t aVertexCount, std::size_t aCacheSize )
+				: mStamps( aVertexCount, 0 )
+				, mTime( aCacheSize + 1 )
+				, mCacheSize( aCacheSize )
+			{}
+
+		public:
+			bool contains( std::uint32_t aVertex ) const noexcept
+			{
+				return mTime - mStamps[aVertex] <= mCacheSize;
+			}
+
+			// Returns the number of misses (0 or 1)
+			unsigned access( std::uint32_t aVertex ) noexcept
+			{
+				if( contains( aVertex ) )
+					return 0;
+
+				mStamps[aVertex] = mTime++;
+				return 1;
+			}
+
+			unsigned access_triangle( std::uint32_t const* aTriangle ) noexcept
+			{
+				return access( aTriangle[0] ) + access( aTriangle[1] ) + access( aTriangle[2] );
+			}
+
+			// Number of insertions since aVertex was inserted
+			std::size_t age( std::uint32_t aVertex ) const noexcept
+			{
+				return mTime - mStamps[aVertex];
+			}
+
+			void flush() noexcept
+			{
+				mTime += mCacheSize + 1;
+			}
+
+		private:
+			std::vector<std::size_t> mStamps;
+			std::size_t mTime;
+			std::size_t mCacheSize;
+	};
+
+	// Triangles adjacent to each vertex, in compressed row format:
+	// triangles[offsets[v] .. offsets[v+1]) use vertex v.
+	struct Adjacency_
+	{
+		std::vector<std::uint32_t> offsets;
+		std::vector<std::uint32_t> triangles;
+	};
+
+	Adjacency_ make_adjacency_( std::uint32_t const* aIndices, std::size_t aIndexCount, std::size_t aVertexCount )
+	{
+		Adjacency_ ret;
+		ret.offsets.assign( aVertexCount + 1, 0 );
+		for( std::size_t i = 0; i < aIndexCount; ++i )
+			++ret.offsets[aIndices[i] + 1];
+
+		std::partial_sum( ret.offsets.begin(), ret.offsets.end(), ret.offsets.begin() );
+
+		std::vector<std::uint32_t> fill( ret.offsets.begin(), ret.offsets.end() - 1 );
+		ret.triangles.resize( aIndexCount );
+		for( std::size_t i = 0; i < aIndexCount; ++i )
+			ret.triangles[fill[aIndices[i]]++] = std::uint32_t(i / 3);
+
+		return ret;
+	}
+}
+
+VertexCacheStats simulate_vertex_cache( std::uint32_t const* aIndices, std::size_t aIndexCount, std::size_t aVertexCount, std::size_t aCacheSize )
+{
+	FifoCache_ cache( aVertexCount, aCacheSize );
+
+	std::size_t misses = 0;
+	for( std::size_t i = 0; i < aIndexCount; ++i )
+		misses += cache.access( aIndices[i] );
+
+	std::size_t const triangles = aIndexCount / 3;
+	return VertexCacheStats{
+		misses,
+		triangles ? float(misses) / float(triangles) : 0.f,
+		aVertexCount ? float(misses) / float(aVertexCount) : 0.f
+	};
+}
+
+void optimize_vertex_cache( std::uint32_t* aIndices, std::size_t aIndexCount, std::size_t aVertexCount, std::size_t aCacheSize )
+{
+	std::size_t const triangleCount = aIndexCount / 3;
+	Adjacency_ const adj = make_adjacency_( aIndices, triangleCount * 3, aVertexCount );
+
+	// Number of not yet emitted triangles of each vertex
+	std::vector<std::uint32_t> live( aVertexCount );
+	for( std::size_t v = 0; v < aVertexCount; ++v )
+		live[v] = adj.offsets[v+1] - adj.offsets[v];
+
+	FifoCache_ cache( aVertexCount, aCacheSize );
+	std::vector<char> emitted( triangleCount, 0 );
+
+	std::vector<std::uint32_t> out;
+	out.reserve( triangleCount * 3 );
+
+	// Recently used vertices, and a cursor over all vertices, to continue
+	// from when the current fan runs out of candidates
+	std::vector<std::uint32_t> deadEnd;
+	deadEnd.reserve( triangleCount * 3 );
+	std::size_t cursor = 0;
+
+	auto const skip_dead_end = [&] () -> std::uint32_t {
+		while( !deadEnd.empty() )
+		{
+			std::uint32_t const v = deadEnd.back();
+			deadEnd.pop_back();
+			if( live[v] > 0 )
+				return v;
+		}
+
+		for( ; cursor < aVertexCount; ++cursor )
+		{
+			if( live[cursor] > 0 )
+				return std::uint32_t(cursor);
+		}
+
+		return kNoVertex_;
+	};
+
+	std::vector<std::uint32_t> candidates;
+
+	std::uint32_t fan = skip_dead_end();
+	while( kNoVertex_ != fan )
+	{
+		// Emit all remaining triangles around the fanning vertex
+		candidates.clear();
+		for( std::uint32_t a = adj.offsets[fan]; a < adj.offsets[fan+1]; ++a )
+		{
+			std::uint32_t const t = adj.triangles[a];
+			if( emitted[t] )
+				continue;
+
+			for( std::size_t c = 0; c < 3; ++c )
+			{
+				std::uint32_t const v = aIndices[t*3 + c];
+				out.emplace_back( v );
+				deadEnd.emplace_back( v );
+				candidates.emplace_back( v );
+				--live[v];
+				cache.access( v );
+			}
+
+			emitted[t] = 1;
+		}
+
+		// Next fanning vertex: the oldest candidate that will still be in
+		// the cache after emitting its own fan (each triangle adds at most
+		// two new vertices). Otherwise any candidate with triangles left.
+		std::uint32_t next = kNoVertex_;
+		std::size_t bestPriority = 0;
+		for( auto const v : candidates )
+		{
+			if( 0 == live[v] )
+				continue;
+
+			std::size_t priority = 1;
+			if( cache.age( v ) + 2*live[v] <= aCacheSize )
+				priority = 1 + cache.age( v );
+
+			if( priority > bestPriority )
+			{
+				bestPriority = priority;
+				next = v;
+			}
+		}
+
+		fan = kNoVertex_ != next ? next : skip_dead_end();
+	}
+
+	std::copy( out.begin(), out.end(), aIndices );
+}
+
+void optimize_overdraw( std::uint32_t* aIndices, std::size_t aIndexCount, Vec3f const* aPositions, std::size_t aVertexCount, float aThreshold, std::size_t aCacheSize )
+{
+	std::size_t const triangleCount = aIndexCount / 3;
+	if( 0 == triangleCount )
+		return;
+
+	// Hard boundaries: triangles that miss the cache with all vertices
+	// start a new cluster; the cache has been effectively flushed before.
+	std::vector<std::size_t> hard;
+	{
+		FifoCache_ cache( aVertexCount, aCacheSize );
+		for( std::size_t t = 0; t < triangleCount; ++t )
+		{
+			if( 3 == cache.access_triangle( aIndices + t*3 ) || 0 == t )
+				hard.emplace_back( t );
+		}
+		hard.emplace_back( triangleCount );
+	}
+
+	// Soft boundaries: split each hard cluster as soon as the ACMR of the
+	// current piece (simulated from an empty cache) is within the threshold
+	// of the whole cluster's.
+	std::vector<std::size_t> clusters;
+	{
+		FifoCache_ cache( aVertexCount, aCacheSize );
+		for( std::size_t h = 0; h + 1 < hard.size(); ++h )
+		{
+			std::size_t const begin = hard[h], end = hard[h+1];
+
+			cache.flush();
+			std::size_t clusterMisses = 0;
+			for( std::size_t t = begin; t < end; ++t )
+				clusterMisses += cache.access_triangle( aIndices + t*3 );
+
+			float const threshold = aThreshold * float(clusterMisses) / float(end - begin);
+
+			clusters.emplace_back( begin );
+			cache.flush();
+
+			std::size_t misses = 0, count = 0;
+			for( std::size_t t = begin; t < end; ++t )
+			{
+				misses += cache.access_triangle( aIndices + t*3 );
+				++count;
+
+				if( float(misses) <= threshold * float(count) && t + 1 < end )
+				{
+					clusters.emplace_back( t + 1 );
+					cache.flush();
+					misses = count = 0;
+				}
+			}
+		}
+		clusters.emplace_back( triangleCount );
+	}
+
+	std::size_t const clusterCount = clusters.size() - 1;
+
+	// Sort key: how far the cluster faces away from the mesh's centroid.
+	// Clusters on the outside of the mesh are drawn first, so that they can
+	// occlude the inner ones.
+	Vec3f meshCentroid{ 0.f, 0.f, 0.f };
+	for( std::size_t i = 0; i < triangleCount*3; ++i )
+		meshCentroid += aPositions[aIndices[i]];
+	meshCentroid /= float(triangleCount*3);
+
+	std::vector<float> keys( clusterCount );
+	for( std::size_t c = 0; c < clusterCount; ++c )
+	{
+		float area = 0.f;
+		Vec3f centroid{ 0.f, 0.f, 0.f };
+		Vec3f normal{ 0.f, 0.f, 0.f };
+
+		for( std::size_t t = clusters[c]; t < clusters[c+1]; ++t )
+		{
+			Vec3f const p0 = aPositions[aIndices[t*3+0]];
+			Vec3f const p1 = aPositions[aIndices[t*3+1]];
+			Vec3f const p2 = aPositions[aIndices[t*3+2]];
+
+			Vec3f const n = cross( p1 - p0, p2 - p0 );
+			float const a = length( n );
+
+			centroid += (p0 + p1 + p2) * (a / 3.f);
+			normal += n;
+			area += a;
+		}
+
+		float const normalLength = length( normal );
+		if( area > 0.f && normalLength > 0.f )
+			keys[c] = dot( centroid / area - meshCentroid, normal / normalLength );
+		else
+			keys[c] = 0.f;
+	}
+
+	std::vector<std::uint32_t> order( clusterCount );
+	std::iota( order.begin(), order.end(), 0u );
+	std::stable_sort( order.begin(), order.end(), [&keys] (std::uint32_t aX, std::uint32_t aY) {
+		return keys[aX] > keys[aY];
+	} );
+
+	std::vector<std::uint32_t> out;
+	out.reserve( triangleCount * 3 );
+	for( auto const c : order )
+		out.insert( out.end(), aIndices + clusters[c]*3, aIndices + clusters[c+1]*3 );
+
+	std::copy( out.begin(), out.end(), aIndices );
+}
+
+std::size_t optimize_vertex_fetch( std::uint32_t* aIndices, std::size_t aIndexCount, std::size_t aVertexCount, std::uint32_t* aRemap )
+{
+	std::fill_n( aRemap, aVertexCount, kUnusedVertex );
+
+	std::uint32_t next = 0;
+	for( std::size_t i = 0; i < aIndexCount; ++i )
+	{
+		std::uint32_t& remapped = aRemap[aIndices[i]];
+		if( kUnusedVertex == remapped )
+			remapped = next++;
+
+		aIndices[i] = remapped;
+	}
+
+	return next;
+}
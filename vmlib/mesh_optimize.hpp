@@ -0,0 +1,89 @@
+#ifndef MESH_OPTIMIZE_HPP_142A1869_6567_4251_80A0_BA66F1ECAFDE
+#define MESH_OPTIMIZE_HPP_142A1869_6567_4251_80A0_BA66F1ECAFDE
+
+#include <cstddef>
+#include <cstdint>
+
+#include "vec3.hpp"
+
+/** Index buffer optimization for triangle meshes
+ *
+ * The functions operate on indexed triangle lists (three indices per
+ * triangle, indices < vertex count). They only reorder triangles or renumber
+ * vertices; the winding of each triangle is kept, so the rendered result is
+ * the same (apart from the draw order of overlapping triangles).
+ *
+ * The usual pipeline is
+ *   1. optimize_vertex_cache(): order triangles for the post-transform
+ *      vertex cache, i.e., such that vertices are reused while their
+ *      transformed results are still cached,
+ *   2. optimize_overdraw(): reorder clusters of triangles such that
+ *      outward-facing parts are drawn first, without giving up much of the
+ *      cache locality from step 1,
+ *   3. optimize_vertex_fetch(): renumber the vertices in the order in which
+ *      they are first used, so that vertex data is read sequentially.
+ *
+ * simulate_vertex_cache() measures the effect of steps 1 and 2 on the CPU.
+ *
+ * References:
+ *   P. V. Sander, D. Nehab, J. Barczak, "Fast Triangle Reordering for Vertex
+ *   Locality and Reduced Overdraw", ACM SIGGRAPH 2007 (Tipsify).
+ */
+
+// Vertex cache size assumed by default. Current GPUs do not have a classic
+// FIFO post-transform cache anymore, but batch vertices in a comparable way;
+// 16 entries is a conservative choice that works well across vendors.
+constexpr std::size_t kDefaultVertexCacheSize = 16;
+
+// Results of a vertex cache simulation
+//  - transformedVertices: number of cache misses (vertex shader invocations)
+//  - acmr: average cache miss ratio, misses per triangle. 3 is the worst
+//    case; 0.5 is the optimum for large regular grids.
+//  - atvr: average transformed vertex ratio, misses per vertex. The optimum
+//    is 1 (each vertex is transformed once).
+struct VertexCacheStats
+{
+	std::size_t transformedVertices;
+	float acmr;
+	float atvr;
+};
+
+// Simulates a FIFO post-transform vertex cache with aCacheSize entries.
+VertexCacheStats simulate_vertex_cache( std::uint32_t const* aIndices, std::size_t aIndexCount, std::size_t aVertexCount, std::size_t aCacheSize = kDefaultVertexCacheSize );
+
+// Reorders the triangles in place with Tipsify. Runs in linear time.
+void optimize_vertex_cache( std::uint32_t* aIndices, std::size_t aIndexCount, std::size_t aVertexCount, std::size_t aCacheSize = kDefaultVertexCacheSize );
+
+// Reorders clusters of triangles in place to reduce overdraw (Sander et al.,
+// section 4). The input should already be optimized for the vertex cache.
+// It is split into clusters at points where the cache is effectively
+// flushed, and further wherever the ACMR of a cluster stays within
+// aThreshold times that of the whole mesh. The clusters are then sorted by
+// how much they face away from the mesh's centroid, so that outer surfaces
+// are drawn first. A larger aThreshold gives more, smaller clusters: less
+// overdraw, but a worse ACMR (at most by about that factor).
+void optimize_overdraw( std::uint32_t* aIndices, std::size_t aIndexCount, Vec3f const* aPositions, std::size_t aVertexCount, float aThreshold = 1.05f, std::size_t aCacheSize = kDefaultVertexCacheSize );
+
+// Renumbers the vertices in the order of their first use in aIndices, and
+// rewrites aIndices accordingly. aRemap (aVertexCount entries) receives the
+// new index of each old vertex, or kUnusedVertex for vertices that are not
+// referenced. Returns the number of referenced vertices; these are
+// numbered 0 .. count-1. Use remap_vertices() to reorder the attributes.
+constexpr std::uint32_t kUnusedVertex = ~std::uint32_t(0);
+
+std::size_t optimize_vertex_fetch( std::uint32_t* aIndices, std::size_t aIndexCount, std::size_t aVertexCount, std::uint32_t* aRemap );
+
+// Applies a remap table from optimize_vertex_fetch() to an attribute array.
+// Unused vertices are dropped. aOut must hold at least as many elements as
+// there are referenced vertices, and must not alias aIn.
+template< typename tType > inline
+void remap_vertices( tType* aOut, tType const* aIn, std::size_t aVertexCount, std::uint32_t const* aRemap )
+{
+	for( std::size_t i = 0; i < aVertexCount; ++i )
+	{
+		if( kUnusedVertex != aRemap[i] )
+			aOut[aRemap[i]] = aIn[i];
+	}
+}
+
+#endif // MESH_OPTIMIZE_HPP_142A1869_6567_4251_80A0_BA66F1ECAFDE
@@ -0,0 +1,913 @@
+#include "mesh_simplify.hpp"
+
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <vector>
+#include <numeric>
+#include <cstring>
+#include <algorithm>
+
+namespace
+{
+	constexpr std::uint32_t kNoVertex_ = ~std::uint32_t(0);
+
+	// Weight of the planes that keep open borders in place, relative to the
+	// planes of the triangles (per squared edge length)
+	constexpr float kBorderWeight_ = 10.f;
+
+	// Collapses may rotate a triangle's normal by at most ~87 degrees
+	constexpr float kMinNormalCos_ = 0.05f;
+
+	enum class Kind_ : std::uint8_t
+	{
+		manifold, // interior vertex, may collapse into any neighbour
+		border,   // on an open border, collapses along the border only
+		seam,     // one of two vertices of an attribute seam, collapses along the seam
+		locked    // never removed
+	};
+
+	// Quadric for the sum over i of w_i (dot(n_i, p) + d_i)^2, i.e.,
+	// p^T A p + 2 dot(b, p) + c with A = sum w n n^T, b = sum w d n and
+	// c = sum w d^2. w is the sum of the weights.
+	struct Quadric_
+	{
+		float a00, a11, a22, a01, a02, a12;
+		float b0, b1, b2;
+		float c;
+		float w;
+	};
+
+	// Quadric for the sum over i of w_i (dot(g_i, p) + d_i - s)^2, where s
+	// is an attribute value: q holds the terms without s, g and d the sums
+	// of w g and w d.
+	struct AttributeQuadric_
+	{
+		Quadric_ q;
+		Vec3f g;
+		float d;
+	};
+
+	Quadric_ make_quadric_( Vec3f aN, float aD, float aW ) noexcept
+	{
+		return Quadric_{
+			aW*aN.x*aN.x, aW*aN.y*aN.y, aW*aN.z*aN.z,
+			aW*aN.x*aN.y, aW*aN.x*aN.z, aW*aN.y*aN.z,
+			aW*aD*aN.x, aW*aD*aN.y, aW*aD*aN.z,
+			aW*aD*aD,
+			aW
+		};
+	}
+
+	void add_( Quadric_& aQ, Quadric_ const& aR ) noexcept
+	{
+		aQ.a00 += aR.a00; aQ.a11 += aR.a11; aQ.a22 += aR.a22;
+		aQ.a01 += aR.a01; aQ.a02 += aR.a02; aQ.a12 += aR.a12;
+		aQ.b0 += aR.b0; aQ.b1 += aR.b1; aQ.b2 += aR.b2;
+		aQ.c += aR.c;
+		aQ.w += aR.w;
+	}
+	void add_( AttributeQuadric_& aQ, AttributeQuadric_ const& aR ) noexcept
+	{
+		add_( aQ.q, aR.q );
+		aQ.g += aR.g;
+		aQ.d += aR.d;
+	}
+
+	float evaluate_( Quadric_ const& aQ, Vec3f aP ) noexcept
+	{
+		float const ax = aQ.a00*aP.x + aQ.a01*aP.y + aQ.a02*aP.z;
+		float const ay = aQ.a01*aP.x + aQ.a11*aP.y + aQ.a12*aP.z;
+		float const az = aQ.a02*aP.x + aQ.a12*aP.y + aQ.a22*aP.z;
+		return aP.x*ax + aP.y*ay + aP.z*az + 2.f*(aQ.b0*aP.x + aQ.b1*aP.y + aQ.b2*aP.z) + aQ.c;
+	}
+	float evaluate_( AttributeQuadric_ const& aQ, Vec3f aP, float aS ) noexcept
+	{
+		return evaluate_( aQ.q, aP ) - 2.f*aS*(dot( aQ.g, aP ) + aQ.d) + aS*aS*aQ.q.w;
+	}
+
+	std::uint64_t edge_key_( std::uint32_t aFrom, std::uint32_t aTo ) noexcept
+	{
+		return (std::uint64_t(aFrom) << 32) | aTo;
+	}
+
+	bool contains_( std::vector<std::uint64_t> const& aSorted, std::uint64_t aKey ) noexcept
+	{
+		return std::binary_search( aSorted.begin(), aSorted.end(), aKey );
+	}
+
+	struct Collapse_
+	{
+		float cost;
+		std::uint32_t from;
+		std::uint32_t to;
+
+		// Orders the priority queue by increasing cost (ties broken by the
+		// vertex indices, so that the result is deterministic)
+		bool operator< ( Collapse_ const& aOther ) const noexcept
+		{
+			if( cost != aOther.cost )
+				return cost > aOther.cost;
+			if( from != aOther.from )
+				return from > aOther.from;
+			return to > aOther.to;
+		}
+	};
+
+	class Simplifier_ final
+	{
+		public:
+			Simplifier_( std::uint32_t const* aIndices, std::size_t aIndexCount, Vec3f const* aPositions, std::size_t aVertexCount, float const* aAttributes, std::size_t aAttributeCount, float const* aAttributeWeights, std::uint8_t const* aLocked );
+
+		public:
+			// aTargetError is in the units of the input positions
+			void run( std::size_t aTargetIndexCount, float aTargetError );
+
+			std::size_t write( std::uint32_t* aOut ) const;
+
+
+		private:
+			void classify_();
+			void compute_quadrics_();
+
+			bool may_collapse_( std::uint32_t aFrom, std::uint32_t aTo ) const noexcept;
+			float cost_( std::uint32_t aFrom, std::uint32_t aTo, std::uint32_t aTwinFrom, std::uint32_t aTwinTo ) const noexcept;
+			bool check_( std::uint32_t aFrom, std::uint32_t aTo, std::uint32_t& aTwinFrom, std::uint32_t& aTwinTo );
+			void collapse_( std::uint32_t aFrom, std::uint32_t aTo );
+			void push_edges_( std::uint32_t aVertex );
+
+			std::uint32_t const* triangle_( std::uint32_t aTriangle ) const noexcept
+			{
+				return mTriangles.data() + 3*std::size_t(aTriangle);
+			}
+			bool has_position_( std::uint32_t aTriangle, std::uint32_t aPositionId ) const noexcept
+			{
+				std::uint32_t const* t = triangle_( aTriangle );
+				return mPositionIds[t[0]] == aPositionId || mPositionIds[t[1]] == aPositionId || mPositionIds[t[2]] == aPositionId;
+			}
+
+			template< class tFunc >
+			void for_each_triangle_( std::uint32_t aVertex, tFunc&& aFunc ) const
+			{
+				// All live triangles around the position of aVertex
+				std::uint32_t w = aVertex;
+				do
+				{
+					for( std::uint32_t t : mVertexTriangles[w] )
+					{
+						if( mAlive[t] )
+							aFunc( t );
+					}
+					w = mWedges[w];
+				} while( w != aVertex );
+			}
+
+		private:
+			std::size_t mVertexCount;
+			std::vector<Vec3f> mPositions; // normalized to the unit cube
+			std::uint8_t const* mLocked; // may be null
+			float mScale; // input units to normalized units
+
+			float const* mAttributes;
+			std::size_t mAttributeCount;
+			std::vector<float> mAttributeWeights; // squared
+
+			std::vector<std::uint32_t> mTriangles;
+			std::vector<std::uint8_t> mAlive;
+			std::vector<std::uint8_t> mBorderEdges; // bit e: edge from corner e to e+1
+			std::size_t mTriangleCount;
+			std::vector<std::vector<std::uint32_t>> mVertexTriangles;
+
+			// Vertices with equal positions share a position id (the smallest
+			// vertex index among them), and form a circular list in mWedges
+			std::vector<std::uint32_t> mPositionIds;
+			std::vector<std::uint32_t> mWedges;
+
+			std::vector<Kind_> mKinds;
+			std::vector<std::uint8_t> mUsed;
+			std::vector<std::uint32_t> mRemap;
+
+			std::vector<Quadric_> mQuadrics;
+			std::vector<AttributeQuadric_> mAttributeQuadrics;
+
+			std::priority_queue<Collapse_> mQueue;
+
+			// Scratch space for check_() and push_edges_()
+			std::vector<std::uint32_t> mNeighboursFrom, mNeighboursTo;
+	};
+
+	Simplifier_::Simplifier_( std::uint32_t const* aIndices, std::size_t aIndexCount, Vec3f const* aPositions, std::size_t aVertexCount, float const* aAttributes, std::size_t aAttributeCount, float const* aAttributeWeights, std::uint8_t const* aLocked )
+		: mVertexCount( aVertexCount )
+		, mPositions( aVertexCount )
+		, mLocked( aLocked )
+		, mAttributes( aAttributes )
+		, mAttributeCount( aAttributeCount )
+		, mTriangleCount( 0 )
+		, mVertexTriangles( aVertexCount )
+		, mPositionIds( aVertexCount )
+		, mWedges( aVertexCount )
+		, mKinds( aVertexCount, Kind_::locked )
+		, mUsed( aVertexCount, 0 )
+		, mRemap( aVertexCount )
+	{
+		for( std::size_t k = 0; k < aAttributeCount; ++k )
+			mAttributeWeights.emplace_back( aAttributeWeights[k] * aAttributeWeights[k] );
+
+		std::iota( mRemap.begin(), mRemap.end(), 0u );
+
+		// Normalize the positions, so that errors are relative to the mesh
+		// size (this also keeps the quadrics well-conditioned in floats)
+		Vec3f lo{ std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+		Vec3f hi = -lo;
+		for( std::size_t i = 0; i < aIndexCount; ++i )
+		{
+			Vec3f const p = aPositions[aIndices[i]];
+			lo = Vec3f{ std::min( lo.x, p.x ), std::min( lo.y, p.y ), std::min( lo.z, p.z ) };
+			hi = Vec3f{ std::max( hi.x, p.x ), std::max( hi.y, p.y ), std::max( hi.z, p.z ) };
+		}
+
+		float const extent = std::max( { hi.x - lo.x, hi.y - lo.y, hi.z - lo.z, 0.f } );
+		mScale = extent > 0.f ? 1.f / extent : 1.f;
+		for( std::size_t i = 0; i < aVertexCount; ++i )
+			mPositions[i] = (aPositions[i] - lo) * mScale;
+
+		// Position ids: sort the vertices by position and link runs of equal
+		// positions (compared bitwise, as in the input)
+		std::vector<std::uint32_t> order( aVertexCount );
+		std::iota( order.begin(), order.end(), 0u );
+		std::sort( order.begin(), order.end(), [aPositions] (std::uint32_t aA, std::uint32_t aB) {
+			int const c = std::memcmp( &aPositions[aA], &aPositions[aB], sizeof(Vec3f) );
+			return c != 0 ? c < 0 : aA < aB;
+		} );
+
+		for( std::size_t begin = 0; begin < aVertexCount; )
+		{
+			std::size_t end = begin + 1;
+			while( end < aVertexCount && 0 == std::memcmp( &aPositions[order[begin]], &aPositions[order[end]], sizeof(Vec3f) ) )
+				++end;
+
+			for( std::size_t i = begin; i < end; ++i )
+			{
+				mPositionIds[order[i]] = order[begin];
+				mWedges[order[i]] = order[i+1 < end ? i+1 : begin];
+			}
+
+			begin = end;
+		}
+
+		// Triangles; those with repeated positions have no area and are
+		// dropped right away
+		for( std::size_t i = 0; i+3 <= aIndexCount; i += 3 )
+		{
+			std::uint32_t const a = aIndices[i], b = aIndices[i+1], c = aIndices[i+2];
+			mUsed[a] = mUsed[b] = mUsed[c] = 1;
+
+			if( mPositionIds[a] == mPositionIds[b] || mPositionIds[b] == mPositionIds[c] || mPositionIds[a] == mPositionIds[c] )
+				continue;
+
+			std::uint32_t const t = std::uint32_t(mTriangleCount++);
+			mTriangles.insert( mTriangles.end(), { a, b, c } );
+			mVertexTriangles[a].emplace_back( t );
+			mVertexTriangles[b].emplace_back( t );
+			mVertexTriangles[c].emplace_back( t );
+		}
+
+		mAlive.assign( mTriangleCount, 1 );
+		mBorderEdges.assign( mTriangleCount, 0 );
+
+		mQuadrics.assign( aVertexCount, Quadric_{} );
+		mAttributeQuadrics.assign( aVertexCount * aAttributeCount, AttributeQuadric_{ Quadric_{}, Vec3f{ 0.f, 0.f, 0.f }, 0.f } );
+
+		classify_();
+		compute_quadrics_();
+	}
+
+	void Simplifier_::classify_()
+	{
+		// Directed edges, by position and by vertex
+		std::vector<std::uint64_t> positionEdges, vertexEdges;
+		positionEdges.reserve( mTriangles.size() );
+		vertexEdges.reserve( mTriangles.size() );
+
+		for( std::size_t i = 0; i < mTriangles.size(); i += 3 )
+		{
+			for( std::size_t e = 0; e < 3; ++e )
+			{
+				std::uint32_t const from = mTriangles[i+e], to = mTriangles[i+(e+1)%3];
+				positionEdges.emplace_back( edge_key_( mPositionIds[from], mPositionIds[to] ) );
+				vertexEdges.emplace_back( edge_key_( from, to ) );
+			}
+		}
+
+		std::sort( positionEdges.begin(), positionEdges.end() );
+		std::sort( vertexEdges.begin(), vertexEdges.end() );
+
+		// Locking any vertex locks its position; nonManifold also marks these
+		std::vector<std::uint8_t> nonManifold( mVertexCount, 0 );
+		if( mLocked )
+		{
+			for( std::uint32_t v = 0; v < mVertexCount; ++v )
+			{
+				if( mLocked[v] )
+					nonManifold[mPositionIds[v]] = 1;
+			}
+		}
+
+		std::vector<std::uint32_t> borderEdges( mVertexCount, 0 ), seamEdges( mVertexCount, 0 );
+
+		for( std::size_t i = 0; i < mTriangles.size(); i += 3 )
+		{
+			for( std::size_t e = 0; e < 3; ++e )
+			{
+				std::uint32_t const from = mTriangles[i+e], to = mTriangles[i+(e+1)%3];
+				std::uint32_t const pf = mPositionIds[from], pt = mPositionIds[to];
+
+				auto const range = std::equal_range( positionEdges.begin(), positionEdges.end(), edge_key_( pf, pt ) );
+				if( range.second - range.first > 1 )
+					nonManifold[pf] = nonManifold[pt] = 1;
+
+				if( !contains_( positionEdges, edge_key_( pt, pf ) ) )
+				{
+					mBorderEdges[i/3] |= std::uint8_t(1u << e);
+					++borderEdges[pf];
+					++borderEdges[pt];
+				}
+				else if( !contains_( vertexEdges, edge_key_( to, from ) ) )
+				{
+					++seamEdges[from];
+					++seamEdges[to];
+				}
+			}
+		}
+
+		for( std::uint32_t v = 0; v < mVertexCount; ++v )
+		{
+			std::uint32_t const p = mPositionIds[v];
+			std::uint32_t const twin = mWedges[v];
+			bool const single = twin == v;
+			bool const pair = !single && mWedges[twin] == v;
+
+			if( !mUsed[v] || nonManifold[p] )
+				mKinds[v] = Kind_::locked;
+			else if( borderEdges[p] > 0 )
+				mKinds[v] = single && 2 == borderEdges[p] ? Kind_::border : Kind_::locked;
+			else if( single )
+				mKinds[v] = 0 == seamEdges[v] ? Kind_::manifold : Kind_::locked;
+			else
+				mKinds[v] = pair && 2 == seamEdges[v] && 2 == seamEdges[twin] ? Kind_::seam : Kind_::locked;
+		}
+	}
+
+	void Simplifier_::compute_quadrics_()
+	{
+		std::size_t const attributeCount = mAttributeCount;
+
+		for( std::uint32_t t = 0; t < mTriangleCount; ++t )
+		{
+			std::uint32_t const* tri = triangle_( t );
+			Vec3f const p0 = mPositions[tri[0]], p1 = mPositions[tri[1]], p2 = mPositions[tri[2]];
+
+			Vec3f const e1 = p1 - p0, e2 = p2 - p0;
+			Vec3f const n2 = cross( e1, e2 );
+			float const area2 = length( n2 );
+			if( !(area2 > 0.f) )
+				continue;
+
+			Vec3f const n = n2 / area2;
+			float const area = 0.5f * area2;
+
+			Quadric_ const q = make_quadric_( n, -dot( n, p0 ), area );
+			for( std::size_t c = 0; c < 3; ++c )
+				add_( mQuadrics[tri[c]], q );
+
+			// Open borders: planes through the edge, perpendicular to the
+			// triangle
+			for( std::size_t e = 0; e < 3; ++e )
+			{
+				if( !(mBorderEdges[t] & (1u << e)) )
+					continue;
+
+				std::uint32_t const from = tri[e], to = tri[(e+1)%3];
+				Vec3f const edge = mPositions[to] - mPositions[from];
+				Vec3f const bn = cross( edge, n );
+				float const len = length( bn );
+				if( !(len > 0.f) )
+					continue;
+
+				Quadric_ const bq = make_quadric_( bn / len, -dot( bn, mPositions[from] ) / len, kBorderWeight_ * dot( edge, edge ) );
+				add_( mQuadrics[from], bq );
+				add_( mQuadrics[to], bq );
+			}
+
+			// Attributes: gradient g and offset d of the linear function that
+			// interpolates the attribute over the triangle, s(p) = dot(g,p)+d
+			if( 0 == attributeCount )
+				continue;
+
+			float const d11 = dot( e1, e1 ), d12 = dot( e1, e2 ), d22 = dot( e2, e2 );
+			float const det = d11*d22 - d12*d12;
+			if( !(det > 0.f) )
+				continue;
+
+			for( std::size_t k = 0; k < attributeCount; ++k )
+			{
+				float const s0 = mAttributes[tri[0]*attributeCount + k];
+				float const ds1 = mAttributes[tri[1]*attributeCount + k] - s0;
+				float const ds2 = mAttributes[tri[2]*attributeCount + k] - s0;
+
+				float const u = (d22*ds1 - d12*ds2) / det;
+				float const v = (d11*ds2 - d12*ds1) / det;
+				Vec3f const g = u*e1 + v*e2;
+				float const d = s0 - dot( g, p0 );
+
+				// (dot(g,p) + d - s)^2 = (dot(g,p) + d)^2 - 2 s (dot(g,p) + d) + s^2
+				AttributeQuadric_ const aq{ make_quadric_( g, d, area ), area * g, area * d };
+				for( std::size_t c = 0; c < 3; ++c )
+					add_( mAttributeQuadrics[tri[c]*attributeCount + k], aq );
+			}
+		}
+	}
+
+	bool Simplifier_::may_collapse_( std::uint32_t aFrom, std::uint32_t aTo ) const noexcept
+	{
+		switch( mKinds[aFrom] )
+		{
+			case Kind_::manifold:
+				return true;
+			case Kind_::border:
+				return Kind_::border == mKinds[aTo] || Kind_::locked == mKinds[aTo];
+			case Kind_::seam:
+				return Kind_::seam == mKinds[aTo] || Kind_::locked == mKinds[aTo];
+			case Kind_::locked:
+				break;
+		}
+		return false;
+	}
+
+	float Simplifier_::cost_( std::uint32_t aFrom, std::uint32_t aTo, std::uint32_t aTwinFrom, std::uint32_t aTwinTo ) const noexcept
+	{
+		Vec3f const p = mPositions[aTo];
+
+		// Position: the quadrics of all vertices at aFrom's position
+		Quadric_ q = mQuadrics[aFrom];
+		for( std::uint32_t w = mWedges[aFrom]; w != aFrom; w = mWedges[w] )
+			add_( q, mQuadrics[w] );
+
+		float ret = q.w > 0.f ? std::max( evaluate_( q, p ), 0.f ) / q.w : 0.f;
+
+		// Attributes of aFrom at aTo (and of the twins on the other side of
+		// a seam, when known)
+		auto const attributeError = [&] (std::uint32_t aA, std::uint32_t aB) {
+			float err = 0.f;
+			for( std::size_t k = 0; k < mAttributeCount; ++k )
+			{
+				AttributeQuadric_ const& aq = mAttributeQuadrics[aA*mAttributeCount + k];
+				if( aq.q.w > 0.f )
+					err += mAttributeWeights[k] * std::max( evaluate_( aq, p, mAttributes[aB*mAttributeCount + k] ), 0.f ) / aq.q.w;
+			}
+			return err;
+		};
+
+		ret += attributeError( aFrom, aTo );
+		if( kNoVertex_ != aTwinFrom )
+			ret += attributeError( aTwinFrom, aTwinTo );
+
+		return ret;
+	}
+
+	bool Simplifier_::check_( std::uint32_t aFrom, std::uint32_t aTo, std::uint32_t& aTwinFrom, std::uint32_t& aTwinTo )
+	{
+		aTwinFrom = aTwinTo = kNoVertex_;
+
+		if( !may_collapse_( aFrom, aTo ) )
+			return false;
+
+		std::uint32_t const pFrom = mPositionIds[aFrom], pTo = mPositionIds[aTo];
+
+		// Triangles on the edge. Borders have one, other edges two.
+		std::size_t shared = 0, sharedFrom = 0;
+		for_each_triangle_( aFrom, [&] (std::uint32_t aT) {
+			if( has_position_( aT, pTo ) )
+			{
+				++shared;
+				std::uint32_t const* t = triangle_( aT );
+				if( t[0] == aFrom || t[1] == aFrom || t[2] == aFrom )
+					++sharedFrom;
+			}
+		} );
+
+		if( 0 == sharedFrom )
+			return false; // no longer adjacent
+
+		switch( mKinds[aFrom] )
+		{
+			case Kind_::border:
+				if( 1 != shared )
+					return false;
+				break;
+
+			case Kind_::seam:
+			{
+				// Along the seam: one triangle on each side, and the other side
+				// uses the other vertex at aTo's position
+				if( 2 != shared || 1 != sharedFrom )
+					return false;
+
+				aTwinFrom = mWedges[aFrom];
+				for( std::uint32_t t : mVertexTriangles[aTwinFrom] )
+				{
+					if( !mAlive[t] )
+						continue;
+
+					std::uint32_t const* tri = triangle_( t );
+					for( std::size_t c = 0; c < 3; ++c )
+					{
+						if( mPositionIds[tri[c]] == pTo )
+							aTwinTo = tri[c];
+					}
+				}
+
+				if( kNoVertex_ == aTwinTo || aTwinTo == aTo )
+					return false;
+				break;
+			}
+
+			default:
+				break;
+		}
+
+		// Link condition: the positions adjacent to both end points must be
+		// exactly the opposite corners of the shared triangles. Otherwise the
+		// collapse would create a non-manifold edge.
+		auto const gatherNeighbours = [this] (std::uint32_t aVertex, std::vector<std::uint32_t>& aOut) {
+			aOut.clear();
+			std::uint32_t const self = mPositionIds[aVertex];
+			for_each_triangle_( aVertex, [&] (std::uint32_t aT) {
+				std::uint32_t const* t = triangle_( aT );
+				for( std::size_t c = 0; c < 3; ++c )
+				{
+					if( mPositionIds[t[c]] != self )
+						aOut.emplace_back( mPositionIds[t[c]] );
+				}
+			} );
+			std::sort( aOut.begin(), aOut.end() );
+			aOut.erase( std::unique( aOut.begin(), aOut.end() ), aOut.end() );
+		};
+
+		gatherNeighbours( aFrom, mNeighboursFrom );
+		gatherNeighbours( aTo, mNeighboursTo );
+
+		std::size_t common = 0;
+		for( std::size_t i = 0, j = 0; i < mNeighboursFrom.size() && j < mNeighboursTo.size(); )
+		{
+			if( mNeighboursFrom[i] < mNeighboursTo[j] )
+				++i;
+			else if( mNeighboursTo[j] < mNeighboursFrom[i] )
+				++j;
+			else
+			{
+				++common;
+				++i;
+				++j;
+			}
+		}
+
+		if( common != shared )
+			return false;
+
+		// The triangles that remain must not fold over
+		bool flips = false;
+		Vec3f const target = mPositions[aTo];
+		for_each_triangle_( aFrom, [&] (std::uint32_t aT) {
+			if( flips || has_position_( aT, pTo ) )
+				return;
+
+			std::uint32_t const* t = triangle_( aT );
+			Vec3f p[3] = { mPositions[t[0]], mPositions[t[1]], mPositions[t[2]] };
+			Vec3f const before = cross( p[1] - p[0], p[2] - p[0] );
+
+			for( std::size_t c = 0; c < 3; ++c )
+			{
+				if( mPositionIds[t[c]] == pFrom )
+					p[c] = target;
+			}
+
+			Vec3f const after = cross( p[1] - p[0], p[2] - p[0] );
+			if( dot( before, after ) <= kMinNormalCos_ * length( before ) * length( after ) )
+				flips = true;
+		} );
+
+		return !flips;
+	}
+
+	void Simplifier_::collapse_( std::uint32_t aFrom, std::uint32_t aTo )
+	{
+		mRemap[aFrom] = aTo;
+
+		for( std::uint32_t t : mVertexTriangles[aFrom] )
+		{
+			if( !mAlive[t] )
+				continue;
+
+			std::uint32_t* tri = mTriangles.data() + 3*std::size_t(t);
+			for( std::size_t c = 0; c < 3; ++c )
+			{
+				if( tri[c] == aFrom )
+					tri[c] = aTo;
+			}
+
+			if( mPositionIds[tri[0]] == mPositionIds[tri[1]] || mPositionIds[tri[1]] == mPositionIds[tri[2]] || mPositionIds[tri[0]] == mPositionIds[tri[2]] )
+			{
+				mAlive[t] = 0;
+				--mTriangleCount;
+			}
+			else
+			{
+				mVertexTriangles[aTo].emplace_back( t );
+			}
+		}
+
+		mVertexTriangles[aFrom].clear();
+		mVertexTriangles[aFrom].shrink_to_fit();
+
+		// Drop the triangles that died from the list of aTo as well
+		auto& list = mVertexTriangles[aTo];
+		list.erase( std::remove_if( list.begin(), list.end(), [this] (std::uint32_t aT) { return !mAlive[aT]; } ), list.end() );
+
+		add_( mQuadrics[aTo], mQuadrics[aFrom] );
+		for( std::size_t k = 0; k < mAttributeCount; ++k )
+			add_( mAttributeQuadrics[aTo*mAttributeCount + k], mAttributeQuadrics[aFrom*mAttributeCount + k] );
+	}
+
+	void Simplifier_::push_edges_( std::uint32_t aVertex )
+	{
+		mNeighboursFrom.clear();
+		for( std::uint32_t t : mVertexTriangles[aVertex] )
+		{
+			std::uint32_t const* tri = triangle_( t );
+			for( std::size_t c = 0; c < 3; ++c )
+			{
+				if( tri[c] != aVertex )
+					mNeighboursFrom.emplace_back( tri[c] );
+			}
+		}
+
+		std::sort( mNeighboursFrom.begin(), mNeighboursFrom.end() );
+		mNeighboursFrom.erase( std::unique( mNeighboursFrom.begin(), mNeighboursFrom.end() ), mNeighboursFrom.end() );
+
+		// The seam twins are not known yet, so the cost may be too low; run()
+		// recomputes it before the collapse.
+		for( std::uint32_t other : mNeighboursFrom )
+		{
+			if( may_collapse_( aVertex, other ) )
+				mQueue.push( Collapse_{ cost_( aVertex, other, kNoVertex_, kNoVertex_ ), aVertex, other } );
+			if( may_collapse_( other, aVertex ) )
+				mQueue.push( Collapse_{ cost_( other, aVertex, kNoVertex_, kNoVertex_ ), other, aVertex } );
+		}
+	}
+
+	void Simplifier_::run( std::size_t aTargetIndexCount, float aTargetError )
+	{
+		// Interior edges appear in two triangles, once in each direction;
+		// border edges only in one
+		for( std::uint32_t t = 0; t < mTriangleCount; ++t )
+		{
+			std::uint32_t const* tri = triangle_( t );
+			for( std::size_t e = 0; e < 3; ++e )
+			{
+				std::uint32_t const from = tri[e], to = tri[(e+1)%3];
+				if( may_collapse_( from, to ) )
+					mQueue.push( Collapse_{ cost_( from, to, kNoVertex_, kNoVertex_ ), from, to } );
+				if( (mBorderEdges[t] & (1u << e)) && may_collapse_( to, from ) )
+					mQueue.push( Collapse_{ cost_( to, from, kNoVertex_, kNoVertex_ ), to, from } );
+			}
+		}
+
+		float const maxCost = (aTargetError * mScale) * (aTargetError * mScale);
+
+		// Collapsing only increases quadrics, so a queued cost never exceeds
+		// the current one. The queue is updated lazily: stale entries are
+		// dropped or re-queued with their current cost when they come up.
+		while( !mQueue.empty() && 3*mTriangleCount > aTargetIndexCount )
+		{
+			Collapse_ const top = mQueue.top();
+			mQueue.pop();
+
+			if( mRemap[top.from] != top.from || mRemap[top.to] != top.to )
+				continue;
+
+			std::uint32_t twinFrom, twinTo;
+			if( !check_( top.from, top.to, twinFrom, twinTo ) )
+				continue;
+
+			float const cost = cost_( top.from, top.to, twinFrom, twinTo );
+			if( cost > top.cost )
+			{
+				mQueue.push( Collapse_{ cost, top.from, top.to } );
+				continue;
+			}
+
+			if( cost > maxCost )
+				break;
+
+			collapse_( top.from, top.to );
+			if( kNoVertex_ != twinFrom )
+				collapse_( twinFrom, twinTo );
+
+			push_edges_( top.to );
+			if( kNoVertex_ != twinTo )
+				push_edges_( twinTo );
+		}
+	}
+
+	std::size_t Simplifier_::write( std::uint32_t* aOut ) const
+	{
+		std::size_t count = 0;
+		for( std::size_t t = 0; t < mAlive.size(); ++t )
+		{
+			if( !mAlive[t] )
+				continue;
+
+			std::uint32_t const* tri = triangle_( std::uint32_t(t) );
+			aOut[count++] = tri[0];
+			aOut[count++] = tri[1];
+			aOut[count++] = tri[2];
+		}
+		return count;
+	}
+
+}
+
+std::size_t simplify_mesh( std::uint32_t* aOut, std::uint32_t const* aIndices, std::size_t aIndexCount, Vec3f const* aPositions, std::size_t aVertexCount, float const* aAttributes, std::size_t aAttributeCount, float const* aAttributeWeights, std::size_t aTargetIndexCount, float aTargetError, float* aResultError, std::uint8_t const* aLockedVertices )
+{
+	if( aResultError )
+		*aResultError = 0.f;
+
+	if( aIndexCount < 3 )
+		return 0;
+
+	Simplifier_ simplifier( aIndices, aIndexCount, aPositions, aVertexCount, aAttributes, aAttributeCount, aAttributeWeights, aLockedVertices );
+	simplifier.run( aTargetIndexCount, aTargetError );
+
+	std::size_t const ret = simplifier.write( aOut );
+
+	if( aResultError )
+		*aResultError = mesh_vertex_distance( aIndices, aIndexCount, aOut, ret, aPositions, aVertexCount );
+
+	return ret;
+}
+
+float mesh_vertex_distance( std::uint32_t const* aSourceIndices, std::size_t aSourceIndexCount, std::uint32_t const* aIndices, std::size_t aIndexCount, Vec3f const* aPositions, std::size_t aVertexCount )
+{
+	// The distance of each vertex to the surface is found with a uniform
+	// grid over the triangles: the grid cells are searched in rings around
+	// the vertex until the next ring cannot contain a closer triangle.
+	std::size_t const triangleCount = aIndexCount / 3;
+	if( 0 == triangleCount )
+		return 0.f;
+
+	std::vector<std::uint8_t> used( aVertexCount, 0 );
+	Vec3f lo{ std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+	Vec3f hi = -lo;
+	auto const include = [&] (std::uint32_t aVertex) {
+		Vec3f const p = aPositions[aVertex];
+		lo = Vec3f{ std::min( lo.x, p.x ), std::min( lo.y, p.y ), std::min( lo.z, p.z ) };
+		hi = Vec3f{ std::max( hi.x, p.x ), std::max( hi.y, p.y ), std::max( hi.z, p.z ) };
+	};
+
+	for( std::size_t i = 0; i < aSourceIndexCount; ++i )
+	{
+		used[aSourceIndices[i]] = 1;
+		include( aSourceIndices[i] );
+	}
+	for( std::size_t i = 0; i < 3*triangleCount; ++i )
+		include( aIndices[i] );
+
+	// About one cell per triangle for surfaces, and at most four cells per
+	// triangle
+	Vec3f const size = hi - lo;
+	float cell = std::max( { size.x, size.y, size.z } ) / std::max( 1.f, std::sqrt( float(triangleCount) ) );
+	if( !(cell > 0.f) )
+		cell = 1.f;
+
+	std::size_t dims[3];
+	for( ;; )
+	{
+		for( std::size_t a = 0; a < 3; ++a )
+			dims[a] = std::size_t( size[a] / cell ) + 1;
+
+		if( dims[0] * dims[1] * dims[2] <= 4 * triangleCount )
+			break;
+
+		cell *= 1.25f;
+	}
+
+	auto const cellOf = [&] (Vec3f aP, std::size_t aAxis) {
+		float const c = (aP[aAxis] - lo[aAxis]) / cell;
+		return std::min( std::size_t( std::max( c, 0.f ) ), dims[aAxis] - 1 );
+	};
+
+	// Triangles in each cell that their bounding box overlaps
+	std::vector<std::vector<std::uint32_t>> cells( dims[0] * dims[1] * dims[2] );
+	for( std::uint32_t t = 0; t < triangleCount; ++t )
+	{
+		std::uint32_t const* tri = aIndices + 3*std::size_t(t);
+		std::size_t from[3], to[3];
+		for( std::size_t a = 0; a < 3; ++a )
+		{
+			Vec3f const p0 = aPositions[tri[0]], p1 = aPositions[tri[1]], p2 = aPositions[tri[2]];
+			from[a] = cellOf( Vec3f{ std::min( { p0.x, p1.x, p2.x } ), std::min( { p0.y, p1.y, p2.y } ), std::min( { p0.z, p1.z, p2.z } ) }, a );
+			to[a] = cellOf( Vec3f{ std::max( { p0.x, p1.x, p2.x } ), std::max( { p0.y, p1.y, p2.y } ), std::max( { p0.z, p1.z, p2.z } ) }, a );
+		}
+
+		for( std::size_t z = from[2]; z <= to[2]; ++z )
+		{
+			for( std::size_t y = from[1]; y <= to[1]; ++y )
+			{
+				for( std::size_t x = from[0]; x <= to[0]; ++x )
+					cells[(z * dims[1] + y) * dims[0] + x].emplace_back( t );
+			}
+		}
+	}
+
+	float ret = 0.f;
+	for( std::size_t v = 0; v < aVertexCount; ++v )
+	{
+		if( !used[v] )
+			continue;
+
+		Vec3f const p = aPositions[v];
+		std::ptrdiff_t const c[3] = { std::ptrdiff_t(cellOf( p, 0 )), std::ptrdiff_t(cellOf( p, 1 )), std::ptrdiff_t(cellOf( p, 2 )) };
+		std::ptrdiff_t const maxRing = std::ptrdiff_t(std::max( { dims[0], dims[1], dims[2] } ));
+
+		float best = std::numeric_limits<float>::infinity();
+		for( std::ptrdiff_t ring = 0; ring <= maxRing; ++ring )
+		{
+			// Cells with a Chebyshev distance of exactly 'ring'
+			for( std::ptrdiff_t z = c[2] - ring; z <= c[2] + ring; ++z )
+			{
+				for( std::ptrdiff_t y = c[1] - ring; y <= c[1] + ring; ++y )
+				{
+					for( std::ptrdiff_t x = c[0] - ring; x <= c[0] + ring; ++x )
+					{
+						if( std::max( { std::abs( x - c[0] ), std::abs( y - c[1] ), std::abs( z - c[2] ) } ) != ring )
+							continue;
+						if( x < 0 || y < 0 || z < 0 || x >= std::ptrdiff_t(dims[0]) || y >= std::ptrdiff_t(dims[1]) || z >= std::ptrdiff_t(dims[2]) )
+							continue;
+
+						for( std::uint32_t t : cells[(std::size_t(z) * dims[1] + std::size_t(y)) * dims[0] + std::size_t(x)] )
+						{
+							std::uint32_t const* tri = aIndices + 3*std::size_t(t);
+							best = std::min( best, point_triangle_distance( p, aPositions[tri[0]], aPositions[tri[1]], aPositions[tri[2]] ) );
+						}
+					}
+				}
+			}
+
+			// Cells further out are at least ring * cell away
+			if( best <= float(ring) * cell )
+				break;
+		}
+
+		ret = std::max( ret, best );
+	}
+
+	return ret;
+}
+
+float point_triangle_distance( Vec3f aPoint, Vec3f aA, Vec3f aB, Vec3f aC ) noexcept
+{
+	// Closest point by Voronoi regions, see C. Ericson, "Real-Time Collision
+	// Detection", 2005, section 5.1.5
+	Vec3f const ab = aB - aA, ac = aC - aA, ap = aPoint - aA;
+
+	float const d1 = dot( ab, ap ), d2 = dot( ac, ap );
+	if( d1 <= 0.f && d2 <= 0.f )
+		return length( aPoint - aA );
+
+	Vec3f const bp = aPoint - aB;
+	float const d3 = dot( ab, bp ), d4 = dot( ac, bp );
+	if( d3 >= 0.f && d4 <= d3 )
+		return length( aPoint - aB );
+
+	float const vc = d1*d4 - d3*d2;
+	if( vc <= 0.f && d1 >= 0.f && d3 <= 0.f )
+		return length( aPoint - (aA + (d1 / (d1 - d3)) * ab) );
+
+	Vec3f const cp = aPoint - aC;
+	float const d5 = dot( ab, cp ), d6 = dot( ac, cp );
+	if( d6 >= 0.f && d5 <= d6 )
+		return length( aPoint - aC );
+
+	float const vb = d5*d2 - d1*d6;
+	if( vb <= 0.f && d2 >= 0.f && d6 <= 0.f )
+		return length( aPoint - (aA + (d2 / (d2 - d6)) * ac) );
+
+	float const va = d3*d6 - d5*d4;
+	if( va <= 0.f && (d4 - d3) >= 0.f && (d5 - d6) >= 0.f )
+		return length( aPoint - (aB + ((d4 - d3) / ((d4 - d3) + (d5 - d6))) * (aC - aB)) );
+
+	float const denom = 1.f / (va + vb + vc);
+	float const v = vb * denom, w = vc * denom;
+	return length( aPoint - (aA + v*ab + w*ac) );
+}
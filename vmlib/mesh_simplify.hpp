@@ -0,0 +1,88 @@
+#ifndef MESH_SIMPLIFY_HPP_5299FAA5_3D56_4622_938E_29A4B9E9BE1B
+#define MESH_SIMPLIFY_HPP_5299FAA5_3D56_4622_938E_29A4B9E9BE1B
+
+#include <cstddef>
+#include <cstdint>
+
+#include "vec3.hpp"
+
+/** Triangle mesh simplification
+ *
+ * simplify_mesh() reduces the number of triangles of an indexed triangle
+ * list by repeatedly collapsing the edge that changes the mesh the least.
+ * The collapses are half-edge collapses: one end point is merged into the
+ * other, so the result only references the input vertices and can share
+ * their vertex buffer (e.g., as a chain of LODs in one index buffer).
+ *
+ * The cost of a collapse is measured with quadric error metrics: each
+ * vertex accumulates the planes of the triangles that were merged into it,
+ * and the cost is the mean squared distance of the new position to those
+ * planes (Garland and Heckbert 1997). Vertex attributes (normals, texture
+ * coordinates, ...) contribute in the same way: each triangle adds the
+ * linear function that interpolates an attribute over it, and the cost is
+ * the squared difference between the surviving vertex's attribute and
+ * these functions at its position (after Hoppe 1999). Attributes that vary
+ * linearly over the surface therefore add no cost.
+ *
+ * Topology is preserved:
+ *   - vertices on open borders only move along the border,
+ *   - attribute seams (vertices with the same position but different
+ *     attributes) are collapsed on both sides at once, along the seam,
+ *   - vertices where several seams or borders meet, or where the mesh is
+ *     not manifold, are never removed,
+ *   - collapses that would fold over triangles or create non-manifold
+ *     edges are rejected.
+ *
+ * References:
+ *   M. Garland, P. S. Heckbert, "Surface Simplification Using Quadric
+ *   Error Metrics", SIGGRAPH 1997.
+ *   H. Hoppe, "New Quadric Metric for Simplifying Meshes with Appearance
+ *   Attributes", IEEE Visualization 1999.
+ */
+
+// Simplifies the triangles in aIndices (aIndexCount indices, referring to
+// aVertexCount vertices) and writes the result to aOut, which must hold
+// aIndexCount indices. Returns the number of indices written.
+//
+// Simplification stops when at most aTargetIndexCount indices remain, or
+// when the next collapse would exceed aTargetError. Both are in the
+// units of aPositions; the estimate is the root mean square distance
+// explained above, plus the weighted attribute error.
+//
+// aAttributes holds aAttributeCount floats per vertex (may be null if
+// aAttributeCount is 0), aAttributeWeights one weight per attribute. A
+// weight w makes an attribute difference of 1 count like a distance of w
+// times the mesh size (the largest extent of its bounding box).
+//
+// If aResultError is given, it receives the max. distance of the source
+// vertices (those used by aIndices) to the simplified surface, see
+// mesh_vertex_distance(). Unlike the estimate above, this is measured, but
+// only at the vertices: points inside the source triangles may be further
+// away.
+//
+// If aLockedVertices is given, vertices with a non-zero entry (and all
+// vertices at the same positions) are never removed; e.g., the edges that a
+// part of a mesh shares with other parts, so that it can be simplified on
+// its own without cracks.
+std::size_t simplify_mesh(
+	std::uint32_t* aOut,
+	std::uint32_t const* aIndices, std::size_t aIndexCount,
+	Vec3f const* aPositions, std::size_t aVertexCount,
+	float const* aAttributes, std::size_t aAttributeCount, float const* aAttributeWeights,
+	std::size_t aTargetIndexCount, float aTargetError,
+	float* aResultError = nullptr,
+	std::uint8_t const* aLockedVertices = nullptr
+);
+
+// Max. distance of the vertices used by aSourceIndices to the surface formed
+// by the triangles in aIndices; both refer to aPositions. This is the error
+// reported by simplify_mesh(). It is one-sided and sampled at the source
+// vertices only; it does not bound the distance of points inside the source
+// triangles. It can also be measured for a chain of simplifications (e.g.,
+// LODs simplified from the previous LOD).
+float mesh_vertex_distance( std::uint32_t const* aSourceIndices, std::size_t aSourceIndexCount, std::uint32_t const* aIndices, std::size_t aIndexCount, Vec3f const* aPositions, std::size_t aVertexCount );
+
+// Distance from aPoint to the closest point of the triangle (a, b, c)
+float point_triangle_distance( Vec3f aPoint, Vec3f aA, Vec3f aB, Vec3f aC ) noexcept;
+
+#endif // MESH_SIMPLIFY_HPP_5299FAA5_3D56_4622_938E_29A4B9E9BE1B
@@ -0,0 +1,113 @@
+#include "mesh_tiles.hpp"
+
+#include <vector>
+#include <numeric>
+#include <cstring>
+#include <algorithm>
+
+namespace
+{
+	constexpr std::uint32_t kNoTile_ = ~std::uint32_t(0);
+	constexpr std::uint32_t kManyTiles_ = ~std::uint32_t(0) - 1;
+
+	std::size_t cell_( float aValue, float aMin, float aExtent, std::size_t aCount ) noexcept
+	{
+		float const c = aExtent > 0.f ? (aValue - aMin) / aExtent * float(aCount) : 0.f;
+		if( !(c > 0.f) )
+			return 0;
+		return std::min( std::size_t(c), aCount - 1 );
+	}
+}
+
+void partition_mesh_xz( std::uint32_t* aIndices, std::size_t aIndexCount, Vec3f const* aPositions, Aabb3f const& aBounds, std::size_t aTilesX, std::size_t aTilesZ, std::uint32_t* aTileOffsets, Aabb3f* aTileBounds )
+{
+	std::size_t const tileCount = aTilesX * aTilesZ;
+	std::size_t const triangleCount = aIndexCount / 3;
+
+	// Counting sort of the triangles by tile
+	std::vector<std::uint32_t> tiles( triangleCount );
+	std::fill( aTileOffsets, aTileOffsets + tileCount + 1, 0u );
+
+	if( aTileBounds )
+		std::fill( aTileBounds, aTileBounds + tileCount, kEmptyAabb3f );
+
+	for( std::size_t t = 0; t < triangleCount; ++t )
+	{
+		Vec3f const p0 = aPositions[aIndices[3*t+0]], p1 = aPositions[aIndices[3*t+1]], p2 = aPositions[aIndices[3*t+2]];
+		Vec3f const centroid = (p0 + p1 + p2) / 3.f;
+
+		std::size_t const x = cell_( centroid.x, aBounds.min.x, aBounds.max.x - aBounds.min.x, aTilesX );
+		std::size_t const z = cell_( centroid.z, aBounds.min.z, aBounds.max.z - aBounds.min.z, aTilesZ );
+		std::size_t const tile = z * aTilesX + x;
+
+		tiles[t] = std::uint32_t(tile);
+		++aTileOffsets[tile + 1];
+
+		if( aTileBounds )
+			aTileBounds[tile] = expand( expand( expand( aTileBounds[tile], p0 ), p1 ), p2 );
+	}
+
+	for( std::size_t i = 0; i < tileCount; ++i )
+		aTileOffsets[i + 1] += aTileOffsets[i];
+
+	std::vector<std::uint32_t> sorted( 3*triangleCount );
+	std::vector<std::uint32_t> next( aTileOffsets, aTileOffsets + tileCount );
+	for( std::size_t t = 0; t < triangleCount; ++t )
+	{
+		std::uint32_t const to = next[tiles[t]]++;
+		std::copy( aIndices + 3*t, aIndices + 3*t + 3, sorted.begin() + 3*std::size_t(to) );
+	}
+
+	std::copy( sorted.begin(), sorted.end(), aIndices );
+
+	// Offsets in indices rather than triangles
+	for( std::size_t i = 0; i <= tileCount; ++i )
+		aTileOffsets[i] *= 3;
+}
+
+void mark_tile_borders( std::uint32_t const* aIndices, std::uint32_t const* aTileOffsets, std::size_t aTileCount, Vec3f const* aPositions, std::size_t aVertexCount, std::uint8_t* aBorder )
+{
+	// Tile of each vertex, or kManyTiles_ if it is used by several
+	std::vector<std::uint32_t> vertexTiles( aVertexCount, kNoTile_ );
+	for( std::size_t tile = 0; tile < aTileCount; ++tile )
+	{
+		for( std::size_t i = aTileOffsets[tile]; i < aTileOffsets[tile+1]; ++i )
+		{
+			std::uint32_t& vt = vertexTiles[aIndices[i]];
+			if( kNoTile_ == vt )
+				vt = std::uint32_t(tile);
+			else if( vt != tile )
+				vt = kManyTiles_;
+		}
+	}
+
+	// Combine vertices with equal positions: sort them by position and
+	// check each run
+	std::vector<std::uint32_t> order( aVertexCount );
+	std::iota( order.begin(), order.end(), 0u );
+	std::sort( order.begin(), order.end(), [aPositions] (std::uint32_t aA, std::uint32_t aB) {
+		return std::memcmp( &aPositions[aA], &aPositions[aB], sizeof(Vec3f) ) < 0;
+	} );
+
+	for( std::size_t begin = 0; begin < aVertexCount; )
+	{
+		std::size_t end = begin + 1;
+		while( end < aVertexCount && 0 == std::memcmp( &aPositions[order[begin]], &aPositions[order[end]], sizeof(Vec3f) ) )
+			++end;
+
+		std::uint32_t tile = kNoTile_;
+		for( std::size_t i = begin; i < end; ++i )
+		{
+			std::uint32_t const vt = vertexTiles[order[i]];
+			if( kNoTile_ == tile )
+				tile = vt;
+			else if( kNoTile_ != vt && vt != tile )
+				tile = kManyTiles_;
+		}
+
+		for( std::size_t i = begin; i < end; ++i )
+			aBorder[order[i]] = kManyTiles_ == tile ? 1 : 0;
+
+		begin = end;
+	}
+}
@@ -0,0 +1,50 @@
+#ifndef MESH_TILES_HPP_C217DD08_42F8_421C_89B5_09B6E1688CA0
+#define MESH_TILES_HPP_C217DD08_42F8_421C_89B5_09B6E1688CA0
+
+#include <cstddef>
+#include <cstdint>
+
+#include "vec3.hpp"
+#include "bounds.hpp"
+
+/** Splitting meshes into tiles
+ *
+ * partition_mesh_xz() sorts the triangles of an indexed triangle list into
+ * a regular grid of tiles over the xz plane (e.g., for a terrain), so that
+ * each tile is a contiguous range of the index buffer that can be culled
+ * and drawn on its own. A triangle belongs to the tile that contains its
+ * centroid. The tiles' bounds cover their triangles, so neighbouring tiles'
+ * bounds overlap slightly.
+ *
+ * mark_tile_borders() finds the vertices on the edges that tiles share.
+ * Keeping these fixed (see simplify_mesh()) lets each tile be simplified
+ * on its own without opening cracks between tiles.
+ */
+
+// Sorts the triangles in aIndices by tile; the order within a tile is kept.
+// The grid has aTilesX x aTilesZ cells over the xz extent of aBounds, which
+// should contain the mesh (centroids outside it go to the nearest cell).
+// Tiles are numbered row by row, tile = z * aTilesX + x.
+//
+// aTileOffsets receives aTilesX*aTilesZ+1 entries: tile t consists of the
+// indices [aTileOffsets[t], aTileOffsets[t+1]). If aTileBounds is given, it
+// receives the bounds of each tile's triangles (kEmptyAabb3f for tiles
+// without triangles).
+void partition_mesh_xz(
+	std::uint32_t* aIndices, std::size_t aIndexCount,
+	Vec3f const* aPositions, Aabb3f const& aBounds,
+	std::size_t aTilesX, std::size_t aTilesZ,
+	std::uint32_t* aTileOffsets, Aabb3f* aTileBounds = nullptr
+);
+
+// Sets aBorder[v] to 1 for the aVertexCount vertices whose position is used
+// by triangles of more than one of the aTileCount tiles, and to 0 otherwise.
+// Positions are compared bitwise, so vertices that were split by attribute
+// seams count as one. The tiles are given as by partition_mesh_xz().
+void mark_tile_borders(
+	std::uint32_t const* aIndices, std::uint32_t const* aTileOffsets, std::size_t aTileCount,
+	Vec3f const* aPositions, std::size_t aVertexCount,
+	std::uint8_t* aBorder
+);
+
+#endif // MESH_TILES_HPP_C217DD08_42F8_421C_89B5_09B6E1688CA0
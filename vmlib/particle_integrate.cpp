@@ -0,0 +1,185 @@
+#include "particle_integrate.hpp"
+
+#include <cassert>
+#include <algorithm>
+
+#include "simd.hpp"
+
+#if !VMLIB_SIMD_NONE && (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86))
+#	define VMLIB_PARTICLE_X86_ 1
+#	include <immintrin.h>
+#else
+#	define VMLIB_PARTICLE_X86_ 0
+#endif
+
+// GCC and clang only emit AVX instructions in functions compiled for them;
+// MSVC accepts the intrinsics anywhere.
+#if defined(__GNUC__) || defined(__clang__)
+#	define VMLIB_TARGET_( aIsa ) __attribute__((target( aIsa )))
+#else
+#	define VMLIB_TARGET_( aIsa )
+#endif
+
+namespace
+{
+	// Each kernel handles full words of the death mask (64 particles) and
+	// returns the number of particles processed; integrate_tail_() does the
+	// rest, and is also the scalar variant.
+	std::size_t integrate_tail_( std::size_t aBegin, float aDeltaTime, Vec3StreamConstView aV, Vec3StreamView aP, float* aLifeTimes, std::uint64_t* aDeathMask ) noexcept
+	{
+		std::size_t dead = 0;
+		for( std::size_t w = aBegin / 64; w * 64 < aP.size; ++w )
+		{
+			std::size_t const end = std::min( aP.size, w * 64 + 64 );
+
+			std::uint64_t word = 0;
+			for( std::size_t i = w * 64; i < end; ++i )
+			{
+				aP.x[i] = aP.x[i] + aDeltaTime * aV.x[i];
+				aP.y[i] = aP.y[i] + aDeltaTime * aV.y[i];
+				aP.z[i] = aP.z[i] + aDeltaTime * aV.z[i];
+
+				aLifeTimes[i] = aLifeTimes[i] - aDeltaTime;
+
+				bool const died = aLifeTimes[i] < 0.f;
+				word |= std::uint64_t(died) << (i % 64);
+				dead += died;
+			}
+
+			aDeathMask[w] = word;
+		}
+		return dead;
+	}
+
+#	if VMLIB_PARTICLE_X86_
+	std::size_t popcount_( std::uint64_t aX ) noexcept
+	{
+		aX = aX - ((aX >> 1) & 0x5555555555555555ull);
+		aX = (aX & 0x3333333333333333ull) + ((aX >> 2) & 0x3333333333333333ull);
+		aX = (aX + (aX >> 4)) & 0x0f0f0f0f0f0f0f0full;
+		return std::size_t((aX * 0x0101010101010101ull) >> 56);
+	}
+
+	std::size_t integrate_sse2_( float aDeltaTime, Vec3StreamConstView aV, Vec3StreamView aP, float* aLifeTimes, std::uint64_t* aDeathMask, std::size_t& aDead ) noexcept
+	{
+		__m128 const dt = _mm_set1_ps( aDeltaTime );
+		__m128 const zero = _mm_setzero_ps();
+
+		std::size_t const words = aP.size / 64;
+		for( std::size_t w = 0; w < words; ++w )
+		{
+			std::uint64_t word = 0;
+			for( std::size_t k = 0; k < 64; k += 4 )
+			{
+				std::size_t const i = w * 64 + k;
+				_mm_storeu_ps( aP.x + i, _mm_add_ps( _mm_loadu_ps( aP.x + i ), _mm_mul_ps( dt, _mm_loadu_ps( aV.x + i ) ) ) );
+				_mm_storeu_ps( aP.y + i, _mm_add_ps( _mm_loadu_ps( aP.y + i ), _mm_mul_ps( dt, _mm_loadu_ps( aV.y + i ) ) ) );
+				_mm_storeu_ps( aP.z + i, _mm_add_ps( _mm_loadu_ps( aP.z + i ), _mm_mul_ps( dt, _mm_loadu_ps( aV.z + i ) ) ) );
+
+				__m128 const life = _mm_sub_ps( _mm_loadu_ps( aLifeTimes + i ), dt );
+				_mm_storeu_ps( aLifeTimes + i, life );
+
+				word |= std::uint64_t(_mm_movemask_ps( _mm_cmplt_ps( life, zero ) )) << k;
+			}
+
+			aDeathMask[w] = word;
+			aDead += popcount_( word );
+		}
+
+		return words * 64;
+	}
+
+	VMLIB_TARGET_( "avx2,fma" )
+	std::size_t integrate_avx2_( float aDeltaTime, Vec3StreamConstView aV, Vec3StreamView aP, float* aLifeTimes, std::uint64_t* aDeathMask, std::size_t& aDead ) noexcept
+	{
+		__m256 const dt = _mm256_set1_ps( aDeltaTime );
+		__m256 const zero = _mm256_setzero_ps();
+
+		std::size_t const words = aP.size / 64;
+		for( std::size_t w = 0; w < words; ++w )
+		{
+			std::uint64_t word = 0;
+			for( std::size_t k = 0; k < 64; k += 8 )
+			{
+				std::size_t const i = w * 64 + k;
+				_mm256_storeu_ps( aP.x + i, _mm256_fmadd_ps( dt, _mm256_loadu_ps( aV.x + i ), _mm256_loadu_ps( aP.x + i ) ) );
+				_mm256_storeu_ps( aP.y + i, _mm256_fmadd_ps( dt, _mm256_loadu_ps( aV.y + i ), _mm256_loadu_ps( aP.y + i ) ) );
+				_mm256_storeu_ps( aP.z + i, _mm256_fmadd_ps( dt, _mm256_loadu_ps( aV.z + i ), _mm256_loadu_ps( aP.z + i ) ) );
+
+				__m256 const life = _mm256_sub_ps( _mm256_loadu_ps( aLifeTimes + i ), dt );
+				_mm256_storeu_ps( aLifeTimes + i, life );
+
+				word |= std::uint64_t(_mm256_movemask_ps( _mm256_cmp_ps( life, zero, _CMP_LT_OQ ) )) << k;
+			}
+
+			aDeathMask[w] = word;
+			aDead += popcount_( word );
+		}
+
+		return words * 64;
+	}
+
+	VMLIB_TARGET_( "avx512f" )
+	std::size_t integrate_avx512_( float aDeltaTime, Vec3StreamConstView aV, Vec3StreamView aP, float* aLifeTimes, std::uint64_t* aDeathMask, std::size_t& aDead ) noexcept
+	{
+		__m512 const dt = _mm512_set1_ps( aDeltaTime );
+		__m512 const zero = _mm512_setzero_ps();
+
+		std::size_t const words = aP.size / 64;
+		for( std::size_t w = 0; w < words; ++w )
+		{
+			std::uint64_t word = 0;
+			for( std::size_t k = 0; k < 64; k += 16 )
+			{
+				std::size_t const i = w * 64 + k;
+				_mm512_storeu_ps( aP.x + i, _mm512_fmadd_ps( dt, _mm512_loadu_ps( aV.x + i ), _mm512_loadu_ps( aP.x + i ) ) );
+				_mm512_storeu_ps( aP.y + i, _mm512_fmadd_ps( dt, _mm512_loadu_ps( aV.y + i ), _mm512_loadu_ps( aP.y + i ) ) );
+				_mm512_storeu_ps( aP.z + i, _mm512_fmadd_ps( dt, _mm512_loadu_ps( aV.z + i ), _mm512_loadu_ps( aP.z + i ) ) );
+
+				__m512 const life = _mm512_sub_ps( _mm512_loadu_ps( aLifeTimes + i ), dt );
+				_mm512_storeu_ps( aLifeTimes + i, life );
+
+				word |= std::uint64_t(_mm512_cmp_ps_mask( life, zero, _CMP_LT_OQ )) << k;
+			}
+
+			aDeathMask[w] = word;
+			aDead += popcount_( word );
+		}
+
+		return words * 64;
+	}
+#	endif // ~ VMLIB_PARTICLE_X86_
+}
+
+std::size_t integrate_particles( float aDeltaTime, Vec3StreamConstView aVelocities, Vec3StreamView aPositions, float* aLifeTimes, std::uint64_t* aDeathMask ) noexcept
+{
+	return integrate_particles( cpu_simd_isa(), aDeltaTime, aVelocities, aPositions, aLifeTimes, aDeathMask );
+}
+
+std::size_t integrate_particles( SimdIsa aIsa, float aDeltaTime, Vec3StreamConstView aVelocities, Vec3StreamView aPositions, float* aLifeTimes, std::uint64_t* aDeathMask ) noexcept
+{
+	assert( aVelocities.size == aPositions.size );
+
+	std::size_t dead = 0, done = 0;
+
+#	if VMLIB_PARTICLE_X86_
+	switch( std::min( aIsa, cpu_simd_isa() ) )
+	{
+		case SimdIsa::avx512:
+			done = integrate_avx512_( aDeltaTime, aVelocities, aPositions, aLifeTimes, aDeathMask, dead );
+			break;
+		case SimdIsa::avx2:
+			done = integrate_avx2_( aDeltaTime, aVelocities, aPositions, aLifeTimes, aDeathMask, dead );
+			break;
+		case SimdIsa::sse2:
+			done = integrate_sse2_( aDeltaTime, aVelocities, aPositions, aLifeTimes, aDeathMask, dead );
+			break;
+		case SimdIsa::scalar:
+			break;
+	}
+#	else
+	static_cast<void>(aIsa);
+#	endif
+
+	return dead + integrate_tail_( done, aDeltaTime, aVelocities, aPositions, aLifeTimes, aDeathMask );
+}
@@ -0,0 +1,81 @@
+#ifndef PARTICLE_INTEGRATE_HPP_17C9806C_E1B3_4E40_8503_842FB71E8F6B
+#define PARTICLE_INTEGRATE_HPP_17C9806C_E1B3_4E40_8503_842FB71E8F6B
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#	include <intrin.h>
+#endif
+
+#include "vec3_stream.hpp"
+#include "cpu_features.hpp"
+
+/** Particle integration
+ *
+ * One pass over the particle state that moves and ages every particle:
+ *
+ *   aPositions[i] += aDeltaTime * aVelocities[i]
+ *   aLifeTimes[i] -= aDeltaTime
+ *
+ * and records which particles died (aLifeTimes[i] < 0 afterwards) in a
+ * bit mask, instead of branching on them. The caller handles the dead
+ * particles in a separate pass (see for_each_set_bit()).
+ *
+ * The death mask holds one bit per particle, in 64-bit words: particle i
+ * is bit i % 64 of word i / 64. All words that cover particles are
+ * written; bits past the last particle are zero.
+ *
+ * There is one variant per instruction set, selected at runtime with
+ * cpu_simd_isa(). The lifetimes and the death mask are identical for all
+ * variants. The positions may differ in the last bit, since the AVX2 and
+ * AVX-512 variants use fused multiply-adds.
+ */
+namespace detail
+{
+	// Number of zero bits below the lowest set bit; aX must not be zero.
+	inline
+	unsigned count_trailing_zeros( std::uint64_t aX ) noexcept
+	{
+#		if defined(__GNUC__) || defined(__clang__)
+		return unsigned(__builtin_ctzll( aX ));
+#		elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+		unsigned long index;
+		_BitScanForward64( &index, aX );
+		return unsigned(index);
+#		else
+		unsigned ret = 0;
+		for( ; !(aX & 1); aX >>= 1 )
+			++ret;
+		return ret;
+#		endif
+	}
+}
+
+constexpr std::size_t death_mask_words( std::size_t aCount ) noexcept
+{
+	return (aCount + 63) / 64;
+}
+
+// Integrates aPositions.size particles (all views and aLifeTimes have that
+// many elements) and returns the number of particles that died.
+std::size_t integrate_particles( float aDeltaTime, Vec3StreamConstView aVelocities, Vec3StreamView aPositions, float* aLifeTimes, std::uint64_t* aDeathMask ) noexcept;
+
+// As above, with a given instruction set (e.g., for tests and benchmarks).
+// Instruction sets that the CPU does not support fall back to the best one
+// that it does.
+std::size_t integrate_particles( SimdIsa, float aDeltaTime, Vec3StreamConstView aVelocities, Vec3StreamView aPositions, float* aLifeTimes, std::uint64_t* aDeathMask ) noexcept;
+
+// Calls aFunc( i ) for every set bit i in aMask (aWordCount words), in
+// ascending order. Each word is read once, before its bits are visited.
+template< class tFunc > inline
+void for_each_set_bit( std::uint64_t const* aMask, std::size_t aWordCount, tFunc&& aFunc )
+{
+	for( std::size_t w = 0; w < aWordCount; ++w )
+	{
+		for( std::uint64_t bits = aMask[w]; 0 != bits; bits &= bits - 1 )
+			aFunc( w * 64 + detail::count_trailing_zeros( bits ) );
+	}
+}
+
+#endif // PARTICLE_INTEGRATE_HPP_17C9806C_E1B3_4E40_8503_842FB71E8F6B
@@ -0,0 +1,245 @@
+#ifndef QUANTIZE_HPP_9BA6FD7A_635B_45F8_90A1_DD549909EA09
+#define QUANTIZE_HPP_9BA6FD7A_635B_45F8_90A1_DD549909EA09
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "vec2.hpp"
+#include "vec3.hpp"
+#include "bounds.hpp"
+
+/** Quantization of vertex attributes
+ *
+ * Compact encodings for vertex data. Each has a matching decoder that
+ * mirrors how the GPU converts the value when it is passed as a normalized
+ * (or half float) vertex attribute, and how the shaders decode it, so the
+ * error bounds below carry over to the rendered result. vmlib-test checks
+ * them (quantize.cpp).
+ *
+ *   unorm8, unorm16, snorm8, snorm16
+ *     Fixed point in [0, 1] and [-1, 1]. Encoding rounds to nearest; the
+ *     max. error is half a step: 1/(2*255), 1/(2*65535), 1/(2*127),
+ *     1/(2*32767). Values outside the range are clamped.
+ *
+ *   Positions (3x unorm16)
+ *     Relative to a bounding box: p = offset + scale * q/65535, see
+ *     PositionQuantization. The max. error per axis is the box extent
+ *     along that axis divided by 2*65535.
+ *
+ *   Normals (octahedral, 2x snorm16 or 2x snorm8)
+ *     The unit sphere is mapped onto an octahedron, which is unfolded into
+ *     the square [-1,1]^2 (Q. Meyer et al., "On Floating-Point Normal
+ *     Vectors", 2010; Z. Cigolle et al., "A Survey of Efficient
+ *     Representations for Independent Unit Vectors", 2014). Max. angular
+ *     error kOct16MaxAngleError and kOct8MaxAngleError (radians).
+ *
+ *   Half floats (IEEE 754 binary16)
+ *     Round to nearest even. Relative error at most 2^-11 for normal
+ *     values (|x| in [2^-14, 65504]).
+ */
+constexpr float kOct16MaxAngleError = 8e-5f;  // ~0.005 degrees
+constexpr float kOct8MaxAngleError = 2e-2f;    // ~1.1 degrees
+
+// Fixed point
+inline
+std::uint8_t quantize_unorm8( float aX ) noexcept
+{
+	aX = aX < 0.f ? 0.f : (aX > 1.f ? 1.f : aX);
+	return std::uint8_t( std::lround( aX * 255.f ) );
+}
+inline
+std::uint16_t quantize_unorm16( float aX ) noexcept
+{
+	aX = aX < 0.f ? 0.f : (aX > 1.f ? 1.f : aX);
+	return std::uint16_t( std::lround( aX * 65535.f ) );
+}
+inline
+std::int8_t quantize_snorm8( float aX ) noexcept
+{
+	aX = aX < -1.f ? -1.f : (aX > 1.f ? 1.f : aX);
+	return std::int8_t( std::lround( aX * 127.f ) );
+}
+inline
+std::int16_t quantize_snorm16( float aX ) noexcept
+{
+	aX = aX < -1.f ? -1.f : (aX > 1.f ? 1.f : aX);
+	return std::int16_t( std::lround( aX * 32767.f ) );
+}
+
+constexpr float dequantize_unorm8( std::uint8_t aQ ) noexcept
+{
+	return float(aQ) / 255.f;
+}
+constexpr float dequantize_unorm16( std::uint16_t aQ ) noexcept
+{
+	return float(aQ) / 65535.f;
+}
+constexpr float dequantize_snorm8( std::int8_t aQ ) noexcept
+{
+	// -128 and -127 both map to -1 (OpenGL 4.2+ rule)
+	return float(aQ) / 127.f < -1.f ? -1.f : float(aQ) / 127.f;
+}
+constexpr float dequantize_snorm16( std::int16_t aQ ) noexcept
+{
+	return float(aQ) / 32767.f < -1.f ? -1.f : float(aQ) / 32767.f;
+}
+
+
+// Positions
+struct PositionQuantization
+{
+	Vec3f offset;
+	Vec3f scale;
+};
+
+// Positions stored as floats: p = (0,0,0) + (1,1,1) * attribute
+constexpr PositionQuantization kNoPositionQuantization = {
+	{ 0.f, 0.f, 0.f },
+	{ 1.f, 1.f, 1.f }
+};
+
+// Quantization that covers the box. The box must not be empty.
+constexpr
+PositionQuantization make_position_quantization( Aabb3f const& aBox ) noexcept
+{
+	return PositionQuantization{ aBox.min, aBox.max - aBox.min };
+}
+
+inline
+void quantize_position( Vec3f aPosition, PositionQuantization const& aQuant, std::uint16_t aOut[3] ) noexcept
+{
+	// Axes with zero extent only have one possible value
+	Vec3f const rel = aPosition - aQuant.offset;
+	aOut[0] = aQuant.scale.x > 0.f ? quantize_unorm16( rel.x / aQuant.scale.x ) : 0;
+	aOut[1] = aQuant.scale.y > 0.f ? quantize_unorm16( rel.y / aQuant.scale.y ) : 0;
+	aOut[2] = aQuant.scale.z > 0.f ? quantize_unorm16( rel.z / aQuant.scale.z ) : 0;
+}
+
+inline
+Vec3f dequantize_position( std::uint16_t const aQ[3], PositionQuantization const& aQuant ) noexcept
+{
+	return Vec3f{
+		aQuant.offset.x + aQuant.scale.x * dequantize_unorm16( aQ[0] ),
+		aQuant.offset.y + aQuant.scale.y * dequantize_unorm16( aQ[1] ),
+		aQuant.offset.z + aQuant.scale.z * dequantize_unorm16( aQ[2] )
+	};
+}
+
+
+// Octahedral normals. aNormal must have a non-zero length; it does not need
+// to be normalized.
+inline
+Vec2f encode_octahedral( Vec3f aNormal ) noexcept
+{
+	float const l1 = std::abs( aNormal.x ) + std::abs( aNormal.y ) + std::abs( aNormal.z );
+	float x = aNormal.x / l1;
+	float y = aNormal.y / l1;
+
+	// Lower hemisphere: fold over the diagonals
+	if( aNormal.z < 0.f )
+	{
+		float const fx = (1.f - std::abs( y )) * (x >= 0.f ? 1.f : -1.f);
+		float const fy = (1.f - std::abs( x )) * (y >= 0.f ? 1.f : -1.f);
+		x = fx;
+		y = fy;
+	}
+
+	return Vec2f{ x, y };
+}
+
+inline
+Vec3f decode_octahedral( Vec2f aEncoded ) noexcept
+{
+	float const z = 1.f - std::abs( aEncoded.x ) - std::abs( aEncoded.y );
+	float x = aEncoded.x, y = aEncoded.y;
+	if( z < 0.f )
+	{
+		x = (1.f - std::abs( aEncoded.y )) * (aEncoded.x >= 0.f ? 1.f : -1.f);
+		y = (1.f - std::abs( aEncoded.x )) * (aEncoded.y >= 0.f ? 1.f : -1.f);
+	}
+
+	return normalize( Vec3f{ x, y, z } );
+}
+
+inline
+void quantize_octahedral16( Vec3f aNormal, std::int16_t aOut[2] ) noexcept
+{
+	Vec2f const e = encode_octahedral( aNormal );
+	aOut[0] = quantize_snorm16( e.x );
+	aOut[1] = quantize_snorm16( e.y );
+}
+inline
+void quantize_octahedral8( Vec3f aNormal, std::int8_t aOut[2] ) noexcept
+{
+	Vec2f const e = encode_octahedral( aNormal );
+	aOut[0] = quantize_snorm8( e.x );
+	aOut[1] = quantize_snorm8( e.y );
+}
+
+inline
+Vec3f dequantize_octahedral16( std::int16_t const aQ[2] ) noexcept
+{
+	return decode_octahedral( Vec2f{ dequantize_snorm16( aQ[0] ), dequantize_snorm16( aQ[1] ) } );
+}
+inline
+Vec3f dequantize_octahedral8( std::int8_t const aQ[2] ) noexcept
+{
+	return decode_octahedral( Vec2f{ dequantize_snorm8( aQ[0] ), dequantize_snorm8( aQ[1] ) } );
+}
+
+
+// Half floats
+inline
+std::uint16_t float_to_half( float aX ) noexcept
+{
+	std::uint32_t bits;
+	std::memcpy( &bits, &aX, sizeof(bits) );
+
+	std::uint32_t const sign = (bits >> 16) & 0x8000u;
+	std::uint32_t const magnitude = bits & 0x7fffffffu;
+
+	// Inf and NaN (NaNs stay quiet NaNs)
+	if( magnitude >= 0x7f800000u )
+		return std::uint16_t( sign | 0x7c00u | (magnitude > 0x7f800000u ? 0x200u : 0u) );
+
+	// 65520 and above round to infinity
+	if( magnitude >= 0x477ff000u )
+		return std::uint16_t( sign | 0x7c00u );
+
+	// Below 2^-14: subnormal halves, in units of 2^-24. nearbyint() rounds to
+	// nearest even; the result may be 0x400, the smallest normal half.
+	if( magnitude < 0x38800000u )
+		return std::uint16_t( sign | std::uint32_t( std::nearbyint( std::abs( aX ) * 16777216.f ) ) );
+
+	// Normal: rebias the exponent and round the mantissa to 10 bits,
+	// nearest even. A carry out of the mantissa correctly increments the
+	// exponent.
+	std::uint32_t const rounded = magnitude + 0xfffu + ((magnitude >> 13) & 1u);
+	return std::uint16_t( sign | ((rounded - 0x38000000u) >> 13) );
+}
+
+inline
+float half_to_float( std::uint16_t aHalf ) noexcept
+{
+	std::uint32_t const sign = std::uint32_t(aHalf & 0x8000u) << 16;
+	std::uint32_t const exponent = (aHalf >> 10) & 0x1fu;
+	std::uint32_t const mantissa = aHalf & 0x3ffu;
+
+	if( 0 == exponent )
+	{
+		float const value = float(mantissa) / 16777216.f;
+		return sign ? -value : value;
+	}
+
+	std::uint32_t const bits = 31 == exponent
+		? sign | 0x7f800000u | (mantissa << 13)
+		: sign | ((exponent + 112) << 23) | (mantissa << 13)
+	;
+
+	float ret;
+	std::memcpy( &ret, &bits, sizeof(ret) );
+	return ret;
+}
+
+#endif // QUANTIZE_HPP_9BA6FD7A_635B_45F8_90A1_DD549909EA09
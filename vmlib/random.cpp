@@ -0,0 +1,107 @@
+#include "random.hpp"
+
+#include <algorithm>
+
+namespace
+{
+	// SplitMix64, used to expand the 64-bit seed into the generator states,
+	// as recommended by the xoshiro authors.
+	std::uint64_t splitmix64_( std::uint64_t& aState ) noexcept
+	{
+		std::uint64_t z = (aState += 0x9e3779b97f4a7c15ull);
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+		return z ^ (z >> 31);
+	}
+
+	// 24 random bits to a float in [0, 1); all values are exact.
+	constexpr float kToUnitFloat_ = 1.f / float(1u << 24);
+}
+
+Xoshiro128x8::Xoshiro128x8( std::uint64_t aSeed ) noexcept
+{
+	seed( aSeed );
+}
+
+void Xoshiro128x8::seed( std::uint64_t aSeed ) noexcept
+{
+	std::uint64_t sm = aSeed;
+	for( std::size_t lane = 0; lane < kLanes; ++lane )
+	{
+		// The state must not be all zero. SplitMix64 practically never
+		// produces two zero outputs in a row, but guard against it anyway.
+		std::uint64_t const a = splitmix64_( sm );
+		std::uint64_t const b = splitmix64_( sm ) | (0 == a ? 1u : 0u);
+
+		mState[0][lane] = std::uint32_t(a);
+		mState[1][lane] = std::uint32_t(a >> 32);
+		mState[2][lane] = std::uint32_t(b);
+		mState[3][lane] = std::uint32_t(b >> 32);
+	}
+
+	mBufferPos = kLanes;
+}
+
+void Xoshiro128x8::fill_uniform( float* aOut, std::size_t aCount ) noexcept
+{
+	// Values left over from uniform() or a previous call come first, so that
+	// the sequence does not depend on how it is requested.
+	std::size_t const buffered = std::min( aCount, kLanes - mBufferPos );
+	std::copy_n( mBuffer + mBufferPos, buffered, aOut );
+	mBufferPos += buffered;
+
+	std::size_t i = buffered;
+	for( ; i + kLanes <= aCount; i += kLanes )
+		next_( aOut + i );
+
+	if( i < aCount )
+	{
+		refill_();
+		std::size_t const rest = aCount - i;
+		std::copy_n( mBuffer, rest, aOut + i );
+		mBufferPos = rest;
+	}
+}
+
+void Xoshiro128x8::fill_uniform( float* aOut, std::size_t aCount, float aMin, float aMax ) noexcept
+{
+	fill_uniform( aOut, aCount );
+
+	float const scale = aMax - aMin;
+	for( std::size_t i = 0; i < aCount; ++i )
+		aOut[i] = aMin + aOut[i] * scale;
+}
+
+void Xoshiro128x8::next_( float* aOut ) noexcept
+{
+	// The loops over the lanes have a fixed trip count and no dependencies
+	// between lanes; GCC, clang and MSVC turn each into a few SIMD integer
+	// instructions.
+	std::uint32_t (&s)[4][kLanes] = mState;
+
+	std::uint32_t result[kLanes];
+	for( std::size_t l = 0; l < kLanes; ++l )
+		result[l] = s[0][l] + s[3][l];
+
+	for( std::size_t l = 0; l < kLanes; ++l )
+	{
+		std::uint32_t const t = s[1][l] << 9;
+
+		s[2][l] ^= s[0][l];
+		s[3][l] ^= s[1][l];
+		s[1][l] ^= s[2][l];
+		s[0][l] ^= s[3][l];
+
+		s[2][l] ^= t;
+		s[3][l] = (s[3][l] << 11) | (s[3][l] >> 21);
+	}
+
+	for( std::size_t l = 0; l < kLanes; ++l )
+		aOut[l] = float(result[l] >> 8) * kToUnitFloat_;
+}
+
+void Xoshiro128x8::refill_() noexcept
+{
+	next_( mBuffer );
+	mBufferPos = 0;
+}
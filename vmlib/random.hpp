@@ -0,0 +1,59 @@
+#ifndef RANDOM_HPP_60264741_E2BB_4AA6_A6E9_8B1E7745D134
+#define RANDOM_HPP_60264741_E2BB_4AA6_A6E9_8B1E7745D134
+
+#include <cstddef>
+#include <cstdint>
+
+/** Xoshiro128x8: fast, reproducible random numbers for arrays
+ *
+ * Eight independent xoshiro128+ generators (D. Blackman, S. Vigna,
+ * "Scrambled Linear Pseudorandom Number Generators", 2018) that are advanced
+ * together. Each step produces eight 32-bit values with a handful of integer
+ * adds, shifts and xors per lane; the lane loops are written so that the
+ * compiler maps them onto SIMD registers. xoshiro128+ is meant for
+ * generating floats: only the upper 24 bits of each value are used.
+ *
+ * The generator is seeded explicitly. The same seed always produces the same
+ * sequence of values on all platforms, independently of how the values are
+ * requested (fill_uniform() with any counts, uniform(), or a mix of both).
+ *
+ * Not suitable for cryptographic purposes.
+ */
+class Xoshiro128x8 final
+{
+	public:
+		static constexpr std::size_t kLanes = 8;
+
+	public:
+		explicit Xoshiro128x8( std::uint64_t aSeed ) noexcept;
+
+		void seed( std::uint64_t aSeed ) noexcept;
+
+	public:
+		// Uniform floats in [0, 1)
+		void fill_uniform( float* aOut, std::size_t aCount ) noexcept;
+
+		// Uniform floats in [aMin, aMax)
+		void fill_uniform( float* aOut, std::size_t aCount, float aMin, float aMax ) noexcept;
+
+		// Single uniform float in [0, 1). Taken from an internal block of
+		// kLanes values; prefer fill_uniform() for many values.
+		float uniform() noexcept
+		{
+			if( kLanes == mBufferPos )
+				refill_();
+
+			return mBuffer[mBufferPos++];
+		}
+
+	private:
+		void next_( float* aOut ) noexcept;
+		void refill_() noexcept;
+
+		std::uint32_t mState[4][kLanes];
+
+		float mBuffer[kLanes];
+		std::size_t mBufferPos;
+};
+
+#endif // RANDOM_HPP_60264741_E2BB_4AA6_A6E9_8B1E7745D134
@@ -0,0 +1,520 @@
+#ifndef SIMD_HPP_21348508_492B_4E03_99EA_03EF87D33E3D
+#define SIMD_HPP_21348508_492B_4E03_99EA_03EF87D33E3D
+
+/** Thin SIMD abstraction used by vmlib
+ *
+ * The backend is selected at compile time from the target architecture
+ * flags (e.g., -march=native, /arch:AVX2). Exactly one of the following is
+ * defined to 1, the others to 0:
+ *
+ *   VMLIB_SIMD_AVX  - x86 with AVX; both F32x4 (SSE) and F32x8 (AVX)
+ *   VMLIB_SIMD_SSE  - x86 with SSE2, but no AVX; F32x4 only
+ *   VMLIB_SIMD_NEON - ARM with NEON; F32x4 only
+ *   VMLIB_SIMD_NONE - no SIMD; vmlib uses its scalar code only
+ *
+ * VMLIB_SIMD_FMA is additionally set to 1 when fused multiply-add is
+ * available. Define VMLIB_NO_SIMD before including any vmlib header (or on
+ * the command line) to force the scalar fallback.
+ *
+ * The wrappers are deliberately minimal: only the operations that vmlib
+ * needs are exposed. Code using them is written against F32x4 (and F32x8),
+ * so a new backend only needs to provide the functions below.
+ */
+
+#include <cstddef>
+#include <type_traits>
+
+#if defined(VMLIB_NO_SIMD)
+#	define VMLIB_SIMD_NONE 1
+#elif defined(__AVX__)
+#	define VMLIB_SIMD_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#	define VMLIB_SIMD_SSE 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#	define VMLIB_SIMD_NEON 1
+#else
+#	define VMLIB_SIMD_NONE 1
+#endif
+
+#if !defined(VMLIB_SIMD_AVX)
+#	define VMLIB_SIMD_AVX 0
+#endif
+#if !defined(VMLIB_SIMD_SSE)
+#	define VMLIB_SIMD_SSE 0
+#endif
+#if !defined(VMLIB_SIMD_NEON)
+#	define VMLIB_SIMD_NEON 0
+#endif
+#if !defined(VMLIB_SIMD_NONE)
+#	define VMLIB_SIMD_NONE 0
+#endif
+
+#if !VMLIB_SIMD_NONE && (defined(__FMA__) || defined(__AVX2__) || defined(__aarch64__) || defined(_M_ARM64))
+	// MSVC does not define __FMA__, but /arch:AVX2 implies FMA3.
+#	define VMLIB_SIMD_FMA 1
+#else
+#	define VMLIB_SIMD_FMA 0
+#endif
+
+#if VMLIB_SIMD_AVX
+#	include <immintrin.h>
+#elif VMLIB_SIMD_SSE
+#	include <emmintrin.h>
+#elif VMLIB_SIMD_NEON
+#	include <arm_neon.h>
+#endif
+
+/* VMLIB_IS_CONSTANT_EVALUATED()
+ *
+ * C++17 lacks std::is_constant_evaluated(), but all of GCC (9+), clang (9+)
+ * and MSVC (19.25+) provide the underlying builtin in C++17 mode. This lets
+ * the constexpr operators pick the SIMD code at runtime while keeping the
+ * scalar code for constant evaluation. If the builtin is missing, the
+ * operators simply always use the scalar code.
+ */
+#if defined(__has_builtin)
+#	if __has_builtin(__builtin_is_constant_evaluated)
+#		define VMLIB_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#	endif
+#endif
+#if !defined(VMLIB_IS_CONSTANT_EVALUATED)
+#	if (defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 9) || (defined(_MSC_VER) && _MSC_VER >= 1925)
+#		define VMLIB_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#	endif
+#endif
+
+#if !VMLIB_SIMD_NONE && defined(VMLIB_IS_CONSTANT_EVALUATED)
+#	define VMLIB_SIMD_RUNTIME_DISPATCH 1
+#else
+#	define VMLIB_SIMD_RUNTIME_DISPATCH 0
+#endif
+
+#if !VMLIB_SIMD_NONE
+namespace simd
+{
+	// 4-wide float vector
+	struct F32x4
+	{
+		static constexpr std::size_t kWidth = 4;
+
+#		if VMLIB_SIMD_NEON
+		float32x4_t v;
+#		else
+		__m128 v;
+#		endif
+	};
+
+	// Generic load/splat, for code that is templated on the vector type.
+	// Specialized for each vector type below.
+	template< class tVec > tVec load( float const* );
+	template< class tVec > tVec splat( float );
+
+#	if VMLIB_SIMD_NEON
+	inline F32x4 load4( float const* aPtr ) noexcept { return { vld1q_f32( aPtr ) }; }
+	inline void store4( float* aPtr, F32x4 aX ) noexcept { vst1q_f32( aPtr, aX.v ); }
+	inline F32x4 splat4( float aX ) noexcept { return { vdupq_n_f32( aX ) }; }
+
+	inline F32x4 add( F32x4 aX, F32x4 aY ) noexcept { return { vaddq_f32( aX.v, aY.v ) }; }
+	inline F32x4 sub( F32x4 aX, F32x4 aY ) noexcept { return { vsubq_f32( aX.v, aY.v ) }; }
+	inline F32x4 mul( F32x4 aX, F32x4 aY ) noexcept { return { vmulq_f32( aX.v, aY.v ) }; }
+#		if defined(__aarch64__) || defined(_M_ARM64)
+	inline F32x4 div( F32x4 aX, F32x4 aY ) noexcept { return { vdivq_f32( aX.v, aY.v ) }; }
+#		else
+	inline F32x4 div( F32x4 aX, F32x4 aY ) noexcept
+	{
+		// ARMv7 NEON has no division; two Newton-Raphson steps on the
+		// reciprocal estimate get close to full precision.
+		float32x4_t r = vrecpeq_f32( aY.v );
+		r = vmulq_f32( vrecpsq_f32( aY.v, r ), r );
+		r = vmulq_f32( vrecpsq_f32( aY.v, r ), r );
+		return { vmulq_f32( aX.v, r ) };
+	}
+#		endif
+
+#		if defined(__aarch64__) || defined(_M_ARM64)
+	inline F32x4 sqrt( F32x4 aX ) noexcept { return { vsqrtq_f32( aX.v ) }; }
+#		else
+	inline F32x4 sqrt( F32x4 aX ) noexcept
+	{
+		// x * rsqrt(x), with the reciprocal square root refined by two
+		// Newton-Raphson steps. Zero inputs would produce 0 * inf = NaN and are
+		// therefore masked.
+		float32x4_t r = vrsqrteq_f32( aX.v );
+		r = vmulq_f32( vrsqrtsq_f32( vmulq_f32( aX.v, r ), r ), r );
+		r = vmulq_f32( vrsqrtsq_f32( vmulq_f32( aX.v, r ), r ), r );
+		uint32x4_t const zero = vceqq_f32( aX.v, vdupq_n_f32( 0.f ) );
+		return { vbslq_f32( zero, aX.v, vmulq_f32( aX.v, r ) ) };
+	}
+#		endif
+
+	inline F32x4 min( F32x4 aX, F32x4 aY ) noexcept { return { vminq_f32( aX.v, aY.v ) }; }
+	inline F32x4 max( F32x4 aX, F32x4 aY ) noexcept { return { vmaxq_f32( aX.v, aY.v ) }; }
+	inline F32x4 abs( F32x4 aX ) noexcept { return { vabsq_f32( aX.v ) }; }
+
+	// Magnitude of aMag with the sign of aSign
+	inline F32x4 copysign( F32x4 aMag, F32x4 aSign ) noexcept
+	{
+		return { vbslq_f32( vdupq_n_u32( 0x80000000u ), aSign.v, aMag.v ) };
+	}
+
+	// Round to the nearest integer
+#		if defined(__aarch64__) || defined(_M_ARM64)
+	inline F32x4 round( F32x4 aX ) noexcept { return { vrndnq_f32( aX.v ) }; }
+#		else
+	inline F32x4 round( F32x4 aX ) noexcept
+	{
+		// Valid for |x| < 2^31
+		float32x4_t const h = copysign( F32x4{ vdupq_n_f32( 0.5f ) }, aX ).v;
+		return { vcvtq_f32_s32( vcvtq_s32_f32( vaddq_f32( aX.v, h ) ) ) };
+	}
+#		endif
+
+	// Low-precision estimate of 1/sqrt(x) (about 8 bits)
+	inline F32x4 rsqrt_estimate( F32x4 aX ) noexcept { return { vrsqrteq_f32( aX.v ) }; }
+	constexpr unsigned kRsqrtEstimateBits = 8;
+
+	inline float first( F32x4 aX ) noexcept { return vgetq_lane_f32( aX.v, 0 ); }
+
+	// Bit i of the result is the sign bit of element i
+	inline unsigned sign_mask( F32x4 aX ) noexcept
+	{
+		uint32x4_t const signs = vshrq_n_u32( vreinterpretq_u32_f32( aX.v ), 31 );
+		return vgetq_lane_u32( signs, 0 ) | (vgetq_lane_u32( signs, 1 ) << 1)
+			| (vgetq_lane_u32( signs, 2 ) << 2) | (vgetq_lane_u32( signs, 3 ) << 3);
+	}
+
+	// Split the elements of (aA, aB) = a0 a1 a2 a3 b0 b1 b2 b3 into
+	// aEven = a0 a2 b0 b2 and aOdd = a1 a3 b1 b3
+	inline void unzip( F32x4 aA, F32x4 aB, F32x4& aEven, F32x4& aOdd ) noexcept
+	{
+		float32x4x2_t const r = vuzpq_f32( aA.v, aB.v );
+		aEven.v = r.val[0];
+		aOdd.v = r.val[1];
+	}
+
+	// madd(a,b,c) = a*b + c
+	inline F32x4 madd( F32x4 aX, F32x4 aY, F32x4 aZ ) noexcept
+	{
+#		if VMLIB_SIMD_FMA
+		return { vfmaq_f32( aZ.v, aX.v, aY.v ) };
+#		else
+		return { vmlaq_f32( aZ.v, aX.v, aY.v ) };
+#		endif
+	}
+
+	inline void transpose4( F32x4& aR0, F32x4& aR1, F32x4& aR2, F32x4& aR3 ) noexcept
+	{
+		float32x4x2_t const t01 = vtrnq_f32( aR0.v, aR1.v );
+		float32x4x2_t const t23 = vtrnq_f32( aR2.v, aR3.v );
+		aR0.v = vcombine_f32( vget_low_f32( t01.val[0] ), vget_low_f32( t23.val[0] ) );
+		aR1.v = vcombine_f32( vget_low_f32( t01.val[1] ), vget_low_f32( t23.val[1] ) );
+		aR2.v = vcombine_f32( vget_high_f32( t01.val[0] ), vget_high_f32( t23.val[0] ) );
+		aR3.v = vcombine_f32( vget_high_f32( t01.val[1] ), vget_high_f32( t23.val[1] ) );
+	}
+
+	// Rearrange elements: ret = ( x[tI0], x[tI1], x[tI2], x[tI3] )
+	template< int tI0, int tI1, int tI2, int tI3 >
+	inline F32x4 permute( F32x4 aX ) noexcept
+	{
+		float32x4_t r = vdupq_n_f32( vgetq_lane_f32( aX.v, tI0 ) );
+		r = vsetq_lane_f32( vgetq_lane_f32( aX.v, tI1 ), r, 1 );
+		r = vsetq_lane_f32( vgetq_lane_f32( aX.v, tI2 ), r, 2 );
+		r = vsetq_lane_f32( vgetq_lane_f32( aX.v, tI3 ), r, 3 );
+		return { r };
+	}
+
+	// Load four consecutive Vec3f (x0 y0 z0 x1 y1 z1 ...) as x, y and z.
+	inline void load_xyz( float const* aPtr, F32x4& aX, F32x4& aY, F32x4& aZ ) noexcept
+	{
+		float32x4x3_t const xyz = vld3q_f32( aPtr );
+		aX.v = xyz.val[0];
+		aY.v = xyz.val[1];
+		aZ.v = xyz.val[2];
+	}
+	inline void store_xyz( float* aPtr, F32x4 aX, F32x4 aY, F32x4 aZ ) noexcept
+	{
+		float32x4x3_t const xyz = { { aX.v, aY.v, aZ.v } };
+		vst3q_f32( aPtr, xyz );
+	}
+#	else // SSE and AVX
+	inline F32x4 load4( float const* aPtr ) noexcept { return { _mm_loadu_ps( aPtr ) }; }
+	inline void store4( float* aPtr, F32x4 aX ) noexcept { _mm_storeu_ps( aPtr, aX.v ); }
+	inline F32x4 splat4( float aX ) noexcept { return { _mm_set1_ps( aX ) }; }
+
+	inline F32x4 add( F32x4 aX, F32x4 aY ) noexcept { return { _mm_add_ps( aX.v, aY.v ) }; }
+	inline F32x4 sub( F32x4 aX, F32x4 aY ) noexcept { return { _mm_sub_ps( aX.v, aY.v ) }; }
+	inline F32x4 mul( F32x4 aX, F32x4 aY ) noexcept { return { _mm_mul_ps( aX.v, aY.v ) }; }
+	inline F32x4 div( F32x4 aX, F32x4 aY ) noexcept { return { _mm_div_ps( aX.v, aY.v ) }; }
+	inline F32x4 sqrt( F32x4 aX ) noexcept { return { _mm_sqrt_ps( aX.v ) }; }
+
+	inline F32x4 min( F32x4 aX, F32x4 aY ) noexcept { return { _mm_min_ps( aX.v, aY.v ) }; }
+	inline F32x4 max( F32x4 aX, F32x4 aY ) noexcept { return { _mm_max_ps( aX.v, aY.v ) }; }
+	inline F32x4 abs( F32x4 aX ) noexcept { return { _mm_andnot_ps( _mm_set1_ps( -0.f ), aX.v ) }; }
+
+	// Magnitude of aMag with the sign of aSign
+	inline F32x4 copysign( F32x4 aMag, F32x4 aSign ) noexcept
+	{
+		__m128 const sign = _mm_set1_ps( -0.f );
+		return { _mm_or_ps( _mm_and_ps( sign, aSign.v ), _mm_andnot_ps( sign, aMag.v ) ) };
+	}
+
+	// Round to the nearest integer
+	inline F32x4 round( F32x4 aX ) noexcept
+	{
+#		if VMLIB_SIMD_AVX
+		return { _mm_round_ps( aX.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC ) };
+#		else
+		// SSE2 has no rounding instruction. Valid for |x| < 2^31.
+		return { _mm_cvtepi32_ps( _mm_cvtps_epi32( aX.v ) ) };
+#		endif
+	}
+
+	// Low-precision estimate of 1/sqrt(x) (about 12 bits)
+	inline F32x4 rsqrt_estimate( F32x4 aX ) noexcept { return { _mm_rsqrt_ps( aX.v ) }; }
+	constexpr unsigned kRsqrtEstimateBits = 12;
+
+	inline float first( F32x4 aX ) noexcept { return _mm_cvtss_f32( aX.v ); }
+
+	// Bit i of the result is the sign bit of element i
+	inline unsigned sign_mask( F32x4 aX ) noexcept { return unsigned(_mm_movemask_ps( aX.v )); }
+
+	// Split the elements of (aA, aB) = a0 a1 a2 a3 b0 b1 b2 b3 into
+	// aEven = a0 a2 b0 b2 and aOdd = a1 a3 b1 b3
+	inline void unzip( F32x4 aA, F32x4 aB, F32x4& aEven, F32x4& aOdd ) noexcept
+	{
+		aEven.v = _mm_shuffle_ps( aA.v, aB.v, _MM_SHUFFLE(2,0,2,0) );
+		aOdd.v = _mm_shuffle_ps( aA.v, aB.v, _MM_SHUFFLE(3,1,3,1) );
+	}
+
+	// madd(a,b,c) = a*b + c
+	inline F32x4 madd( F32x4 aX, F32x4 aY, F32x4 aZ ) noexcept
+	{
+#		if VMLIB_SIMD_FMA
+		return { _mm_fmadd_ps( aX.v, aY.v, aZ.v ) };
+#		else
+		return { _mm_add_ps( _mm_mul_ps( aX.v, aY.v ), aZ.v ) };
+#		endif
+	}
+
+	inline void transpose4( F32x4& aR0, F32x4& aR1, F32x4& aR2, F32x4& aR3 ) noexcept
+	{
+		_MM_TRANSPOSE4_PS( aR0.v, aR1.v, aR2.v, aR3.v );
+	}
+
+	// Rearrange elements: ret = ( x[tI0], x[tI1], x[tI2], x[tI3] )
+	template< int tI0, int tI1, int tI2, int tI3 >
+	inline F32x4 permute( F32x4 aX ) noexcept
+	{
+		return { _mm_shuffle_ps( aX.v, aX.v, _MM_SHUFFLE(tI3, tI2, tI1, tI0) ) };
+	}
+
+	namespace detail
+	{
+		// De-/interleave three registers holding four Vec3f:
+		//   a = x0 y0 z0 x1,  b = y1 z1 x2 y2,  c = z2 x3 y3 z3
+		// Only in-lane shuffles are used, so the same sequence works on each
+		// 128-bit lane of an AVX register.
+		template< class tReg, class tShuffle >
+		inline void deinterleave_xyz( tReg aA, tReg aB, tReg aC, tReg& aX, tReg& aY, tReg& aZ, tShuffle&& aShuffle ) noexcept
+		{
+			tReg const x2y2x3y3 = aShuffle( aB, aC, std::integral_constant<int, _MM_SHUFFLE(2,1,3,2)>{} );
+			tReg const y0z0y1z1 = aShuffle( aA, aB, std::integral_constant<int, _MM_SHUFFLE(1,0,2,1)>{} );
+			aX = aShuffle( aA, x2y2x3y3, std::integral_constant<int, _MM_SHUFFLE(2,0,3,0)>{} );
+			aY = aShuffle( y0z0y1z1, x2y2x3y3, std::integral_constant<int, _MM_SHUFFLE(3,1,2,0)>{} );
+			aZ = aShuffle( y0z0y1z1, aC, std::integral_constant<int, _MM_SHUFFLE(3,0,3,1)>{} );
+		}
+
+		template< class tReg, class tShuffle, class tUnpack >
+		inline void interleave_xyz( tReg aX, tReg aY, tReg aZ, tReg& aA, tReg& aB, tReg& aC, tShuffle&& aShuffle, tUnpack&& aUnpack ) noexcept
+		{
+			tReg const x0y0x1y1 = aUnpack( aX, aY, std::false_type{} );
+			tReg const x2y2x3y3 = aUnpack( aX, aY, std::true_type{} );
+			tReg const z0z0x1x1 = aShuffle( aZ, aX, std::integral_constant<int, _MM_SHUFFLE(1,1,0,0)>{} );
+			tReg const y1y1z1z1 = aShuffle( aY, aZ, std::integral_constant<int, _MM_SHUFFLE(1,1,1,1)>{} );
+			tReg const z2z2x3x3 = aShuffle( aZ, aX, std::integral_constant<int, _MM_SHUFFLE(3,3,2,2)>{} );
+			tReg const y3y3z3z3 = aShuffle( aY, aZ, std::integral_constant<int, _MM_SHUFFLE(3,3,3,3)>{} );
+			aA = aShuffle( x0y0x1y1, z0z0x1x1, std::integral_constant<int, _MM_SHUFFLE(2,0,1,0)>{} );
+			aB = aShuffle( y1y1z1z1, x2y2x3y3, std::integral_constant<int, _MM_SHUFFLE(1,0,2,0)>{} );
+			aC = aShuffle( z2z2x3x3, y3y3z3z3, std::integral_constant<int, _MM_SHUFFLE(2,0,2,0)>{} );
+		}
+
+		struct Shuffle128
+		{
+			template< int tImm >
+			__m128 operator() ( __m128 aX, __m128 aY, std::integral_constant<int, tImm> ) const noexcept
+			{
+				return _mm_shuffle_ps( aX, aY, tImm );
+			}
+		};
+		struct Unpack128
+		{
+			__m128 operator() ( __m128 aX, __m128 aY, std::false_type ) const noexcept { return _mm_unpacklo_ps( aX, aY ); }
+			__m128 operator() ( __m128 aX, __m128 aY, std::true_type ) const noexcept { return _mm_unpackhi_ps( aX, aY ); }
+		};
+	}
+
+	// Load four consecutive Vec3f (x0 y0 z0 x1 y1 z1 ...) as x, y and z.
+	inline void load_xyz( float const* aPtr, F32x4& aX, F32x4& aY, F32x4& aZ ) noexcept
+	{
+		detail::deinterleave_xyz( _mm_loadu_ps( aPtr ), _mm_loadu_ps( aPtr+4 ), _mm_loadu_ps( aPtr+8 ), aX.v, aY.v, aZ.v, detail::Shuffle128{} );
+	}
+	inline void store_xyz( float* aPtr, F32x4 aX, F32x4 aY, F32x4 aZ ) noexcept
+	{
+		__m128 a, b, c;
+		detail::interleave_xyz( aX.v, aY.v, aZ.v, a, b, c, detail::Shuffle128{}, detail::Unpack128{} );
+		_mm_storeu_ps( aPtr, a );
+		_mm_storeu_ps( aPtr+4, b );
+		_mm_storeu_ps( aPtr+8, c );
+	}
+#	endif // ~ NEON
+
+	template<> inline F32x4 load<F32x4>( float const* aPtr ) { return load4( aPtr ); }
+	template<> inline F32x4 splat<F32x4>( float aX ) { return splat4( aX ); }
+	inline void store( float* aPtr, F32x4 aX ) noexcept { store4( aPtr, aX ); }
+
+#	if VMLIB_SIMD_AVX
+	// 8-wide float vector. Many AVX operations work on the two 128-bit halves
+	// ("lanes") independently; the functions below note where this is the
+	// case.
+	struct F32x8
+	{
+		static constexpr std::size_t kWidth = 8;
+
+		__m256 v;
+	};
+
+	inline F32x8 load8( float const* aPtr ) noexcept { return { _mm256_loadu_ps( aPtr ) }; }
+	inline void store8( float* aPtr, F32x8 aX ) noexcept { _mm256_storeu_ps( aPtr, aX.v ); }
+	inline F32x8 splat8( float aX ) noexcept { return { _mm256_set1_ps( aX ) }; }
+
+	// Load four floats into both 128-bit lanes
+	inline F32x8 load4x2( float const* aPtr ) noexcept { return { _mm256_broadcast_ps( reinterpret_cast<__m128 const*>(aPtr) ) }; }
+
+	inline F32x8 add( F32x8 aX, F32x8 aY ) noexcept { return { _mm256_add_ps( aX.v, aY.v ) }; }
+	inline F32x8 sub( F32x8 aX, F32x8 aY ) noexcept { return { _mm256_sub_ps( aX.v, aY.v ) }; }
+	inline F32x8 mul( F32x8 aX, F32x8 aY ) noexcept { return { _mm256_mul_ps( aX.v, aY.v ) }; }
+	inline F32x8 div( F32x8 aX, F32x8 aY ) noexcept { return { _mm256_div_ps( aX.v, aY.v ) }; }
+	inline F32x8 sqrt( F32x8 aX ) noexcept { return { _mm256_sqrt_ps( aX.v ) }; }
+
+	inline F32x8 min( F32x8 aX, F32x8 aY ) noexcept { return { _mm256_min_ps( aX.v, aY.v ) }; }
+	inline F32x8 max( F32x8 aX, F32x8 aY ) noexcept { return { _mm256_max_ps( aX.v, aY.v ) }; }
+	inline F32x8 abs( F32x8 aX ) noexcept { return { _mm256_andnot_ps( _mm256_set1_ps( -0.f ), aX.v ) }; }
+
+	inline F32x8 copysign( F32x8 aMag, F32x8 aSign ) noexcept
+	{
+		__m256 const sign = _mm256_set1_ps( -0.f );
+		return { _mm256_or_ps( _mm256_and_ps( sign, aSign.v ), _mm256_andnot_ps( sign, aMag.v ) ) };
+	}
+
+	inline F32x8 round( F32x8 aX ) noexcept
+	{
+		return { _mm256_round_ps( aX.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC ) };
+	}
+
+	inline F32x8 rsqrt_estimate( F32x8 aX ) noexcept { return { _mm256_rsqrt_ps( aX.v ) }; }
+
+	inline unsigned sign_mask( F32x8 aX ) noexcept { return unsigned(_mm256_movemask_ps( aX.v )); }
+
+	// Same as unzip( F32x4, ... ), across the full register: the results are
+	// in order (a0 a2 a4 a6 b0 b2 b4 b6), not per 128-bit lane.
+	inline void unzip( F32x8 aA, F32x8 aB, F32x8& aEven, F32x8& aOdd ) noexcept
+	{
+		__m256 const lo = _mm256_permute2f128_ps( aA.v, aB.v, 0x20 ); // a0..a3 b0..b3
+		__m256 const hi = _mm256_permute2f128_ps( aA.v, aB.v, 0x31 ); // a4..a7 b4..b7
+		__m256 const even = _mm256_shuffle_ps( lo, hi, _MM_SHUFFLE(2,0,2,0) ); // a0 a2 a4 a6 | b0 b2 b4 b6
+		__m256 const odd = _mm256_shuffle_ps( lo, hi, _MM_SHUFFLE(3,1,3,1) );
+		aEven.v = even;
+		aOdd.v = odd;
+	}
+
+	inline F32x8 madd( F32x8 aX, F32x8 aY, F32x8 aZ ) noexcept
+	{
+#		if VMLIB_SIMD_FMA
+		return { _mm256_fmadd_ps( aX.v, aY.v, aZ.v ) };
+#		else
+		return { _mm256_add_ps( _mm256_mul_ps( aX.v, aY.v ), aZ.v ) };
+#		endif
+	}
+
+	// Broadcast element tI of each 128-bit lane to the whole lane
+	template< int tI >
+	inline F32x8 splat_in_lanes( F32x8 aX ) noexcept
+	{
+		static_assert( tI >= 0 && tI < 4 );
+		return { _mm256_permute_ps( aX.v, tI * 0x55 ) };
+	}
+
+	// Transpose the 4x4 blocks formed by the lower and by the upper 128-bit
+	// lanes of the four registers independently.
+	inline void transpose4_in_lanes( F32x8& aR0, F32x8& aR1, F32x8& aR2, F32x8& aR3 ) noexcept
+	{
+		__m256 const t0 = _mm256_unpacklo_ps( aR0.v, aR1.v );
+		__m256 const t1 = _mm256_unpacklo_ps( aR2.v, aR3.v );
+		__m256 const t2 = _mm256_unpackhi_ps( aR0.v, aR1.v );
+		__m256 const t3 = _mm256_unpackhi_ps( aR2.v, aR3.v );
+		aR0.v = _mm256_shuffle_ps( t0, t1, _MM_SHUFFLE(1,0,1,0) );
+		aR1.v = _mm256_shuffle_ps( t0, t1, _MM_SHUFFLE(3,2,3,2) );
+		aR2.v = _mm256_shuffle_ps( t2, t3, _MM_SHUFFLE(1,0,1,0) );
+		aR3.v = _mm256_shuffle_ps( t2, t3, _MM_SHUFFLE(3,2,3,2) );
+	}
+
+	namespace detail
+	{
+		struct Shuffle256
+		{
+			template< int tImm >
+			__m256 operator() ( __m256 aX, __m256 aY, std::integral_constant<int, tImm> ) const noexcept
+			{
+				return _mm256_shuffle_ps( aX, aY, tImm );
+			}
+		};
+		struct Unpack256
+		{
+			__m256 operator() ( __m256 aX, __m256 aY, std::false_type ) const noexcept { return _mm256_unpacklo_ps( aX, aY ); }
+			__m256 operator() ( __m256 aX, __m256 aY, std::true_type ) const noexcept { return _mm256_unpackhi_ps( aX, aY ); }
+		};
+
+		inline __m256 load_lanes( float const* aLo, float const* aHi ) noexcept
+		{
+			return _mm256_insertf128_ps( _mm256_castps128_ps256( _mm_loadu_ps( aLo ) ), _mm_loadu_ps( aHi ), 1 );
+		}
+		inline void store_lanes( float* aLo, float* aHi, __m256 aX ) noexcept
+		{
+			_mm_storeu_ps( aLo, _mm256_castps256_ps128( aX ) );
+			_mm_storeu_ps( aHi, _mm256_extractf128_ps( aX, 1 ) );
+		}
+	}
+
+	// Load eight consecutive Vec3f as x, y and z. Vertices 0-3 are processed
+	// in the lower lane and 4-7 in the upper lane, then the lanes are
+	// combined; the order of elements in the results is therefore 0,1,...,7.
+	inline void load_xyz( float const* aPtr, F32x8& aX, F32x8& aY, F32x8& aZ ) noexcept
+	{
+		__m256 const a = detail::load_lanes( aPtr, aPtr+12 );
+		__m256 const b = detail::load_lanes( aPtr+4, aPtr+16 );
+		__m256 const c = detail::load_lanes( aPtr+8, aPtr+20 );
+		detail::deinterleave_xyz( a, b, c, aX.v, aY.v, aZ.v, detail::Shuffle256{} );
+	}
+	inline void store_xyz( float* aPtr, F32x8 aX, F32x8 aY, F32x8 aZ ) noexcept
+	{
+		__m256 a, b, c;
+		detail::interleave_xyz( aX.v, aY.v, aZ.v, a, b, c, detail::Shuffle256{}, detail::Unpack256{} );
+		detail::store_lanes( aPtr, aPtr+12, a );
+		detail::store_lanes( aPtr+4, aPtr+16, b );
+		detail::store_lanes( aPtr+8, aPtr+20, c );
+	}
+
+	template<> inline F32x8 load<F32x8>( float const* aPtr ) { return load8( aPtr ); }
+	template<> inline F32x8 splat<F32x8>( float aX ) { return splat8( aX ); }
+	inline void store( float* aPtr, F32x8 aX ) noexcept { store8( aPtr, aX ); }
+
+	// Note: for F32x8, transpose4() works on each 128-bit lane separately.
+	inline void transpose4( F32x8& aR0, F32x8& aR1, F32x8& aR2, F32x8& aR3 ) noexcept
+	{
+		transpose4_in_lanes( aR0, aR1, aR2, aR3 );
+	}
+#	endif // ~ AVX
+}
+#endif // ~ !VMLIB_SIMD_NONE
+
+#endif // SIMD_HPP_21348508_492B_4E03_99EA_03EF87D33E3D
@@ -0,0 +1,100 @@
+#ifndef TRANSFORM_HPP_42DE4299_3A48_4591_AAD2_99BC5C3198C0
+#define TRANSFORM_HPP_42DE4299_3A48_4591_AAD2_99BC5C3198C0
+
+#include "vec3.hpp"
+#include "mat33.hpp"
+#include "mat44.hpp"
+#include "quat.hpp"
+
+/** Transform: translation, rotation and uniform scale
+ *
+ * Represents the affine map
+ *
+ *   p ↦ translation + rotation ( scale p )
+ *
+ * i.e., the same as the matrix
+ *
+ *   make_translation( t ) * quat_to_mat44( r ) * make_scaling( s, s, s )
+ *
+ * in eight floats instead of sixteen. The scale is uniform so that composing
+ * two Transforms yields another Transform exactly (with non-uniform scaling,
+ * a rotated scale becomes a shear). Use Mat44f for non-uniform scaling.
+ *
+ * Transforms compose with operator*, like matrices: (parent * child) first
+ * applies child and then parent. This makes it cheap to walk a hierarchy and
+ * only convert to a Mat44f once, when the final model matrix is needed.
+ */
+struct Transform
+{
+	Vec3f translation;
+	Quatf rotation;
+	float scale;
+};
+
+constexpr Transform kIdentityTransform = { { 0.f, 0.f, 0.f }, kIdentityQuatf, 1.f };
+
+inline
+Transform make_transform( Vec3f aTranslation, Quatf const& aRotation = kIdentityQuatf, float aScale = 1.f ) noexcept
+{
+	return Transform{ aTranslation, aRotation, aScale };
+}
+
+// Functions:
+
+inline
+Vec3f transform_point( Transform const& aT, Vec3f aP ) noexcept
+{
+	return aT.translation + rotate( aT.rotation, aT.scale * aP );
+}
+
+// Directions are not affected by the translation.
+inline
+Vec3f transform_vector( Transform const& aT, Vec3f aV ) noexcept
+{
+	return rotate( aT.rotation, aT.scale * aV );
+}
+
+inline
+Transform operator*( Transform const& aParent, Transform const& aChild ) noexcept
+{
+	return Transform{
+		transform_point( aParent, aChild.translation ),
+		aParent.rotation * aChild.rotation,
+		aParent.scale * aChild.scale
+	};
+}
+
+inline
+Transform invert( Transform const& aT ) noexcept
+{
+	float const s = 1.f / aT.scale;
+	Quatf const r = conjugate( aT.rotation );
+	return Transform{ -rotate( r, s * aT.translation ), r, s };
+}
+
+inline
+Mat44f transform_to_mat44( Transform const& aT ) noexcept
+{
+	Mat33f const r = quat_to_mat33( aT.rotation );
+	float const s = aT.scale;
+	return Mat44f{ {
+		s*r(0,0), s*r(0,1), s*r(0,2), aT.translation.x,
+		s*r(1,0), s*r(1,1), s*r(1,2), aT.translation.y,
+		s*r(2,0), s*r(2,1), s*r(2,2), aT.translation.z,
+		0.f,      0.f,      0.f,      1.f
+	} };
+}
+
+// With uniform scaling, the inverse transpose of the upper 3x3 part is the
+// rotation divided by the scale; no general inverse is needed.
+inline
+Mat33f normal_matrix( Transform const& aT ) noexcept
+{
+	Mat33f ret = quat_to_mat33( aT.rotation );
+	float const s = 1.f / aT.scale;
+	for( auto& v : ret.v )
+		v *= s;
+	return ret;
+}
+
+#endif // TRANSFORM_HPP_42DE4299_3A48_4591_AAD2_99BC5C3198C0
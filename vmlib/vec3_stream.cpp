@@ -0,0 +1,430 @@
+#include "vec3_stream.hpp"
+
+#include <new>
+#include <utility>
+#include <algorithm>
+
+#include "simd.hpp"
+
+static_assert( sizeof(Vec3f) == 3*sizeof(float) );
+
+namespace
+{
+	// Capacities are multiples of this, so that each component array starts
+	// at a kAlignment boundary.
+	constexpr std::size_t kBlock_ = Vec3Stream::kAlignment / sizeof(float);
+
+	float* allocate_( std::size_t aCapacity )
+	{
+		if( 0 == aCapacity )
+			return nullptr;
+
+		return static_cast<float*>(::operator new( 3 * aCapacity * sizeof(float), std::align_val_t(Vec3Stream::kAlignment) ));
+	}
+	void deallocate_( float* aPtr ) noexcept
+	{
+		if( aPtr )
+			::operator delete( aPtr, std::align_val_t(Vec3Stream::kAlignment) );
+	}
+
+#	if !VMLIB_SIMD_NONE
+	// As in batch_transform.cpp, each kernel processes full blocks of
+	// tVec::kWidth elements and returns the number of elements processed.
+
+	template< class tVec >
+	std::size_t axpy_simd_( float aA, Vec3StreamConstView aX, Vec3StreamView aY ) noexcept
+	{
+		using namespace simd;
+		constexpr std::size_t kWidth = tVec::kWidth;
+
+		tVec const a = splat<tVec>( aA );
+
+		std::size_t i = 0;
+		for( ; i + kWidth <= aX.size; i += kWidth )
+		{
+			store( aY.x+i, madd( a, load<tVec>( aX.x+i ), load<tVec>( aY.x+i ) ) );
+			store( aY.y+i, madd( a, load<tVec>( aX.y+i ), load<tVec>( aY.y+i ) ) );
+			store( aY.z+i, madd( a, load<tVec>( aX.z+i ), load<tVec>( aY.z+i ) ) );
+		}
+		return i;
+	}
+
+	template< class tVec >
+	std::size_t scale_simd_( Vec3StreamView aX, float aA ) noexcept
+	{
+		using namespace simd;
+		constexpr std::size_t kWidth = tVec::kWidth;
+
+		tVec const a = splat<tVec>( aA );
+
+		std::size_t i = 0;
+		for( ; i + kWidth <= aX.size; i += kWidth )
+		{
+			store( aX.x+i, mul( load<tVec>( aX.x+i ), a ) );
+			store( aX.y+i, mul( load<tVec>( aX.y+i ), a ) );
+			store( aX.z+i, mul( load<tVec>( aX.z+i ), a ) );
+		}
+		return i;
+	}
+
+	template< class tVec > inline
+	tVec dot_( tVec aX0, tVec aY0, tVec aZ0, tVec aX1, tVec aY1, tVec aZ1 ) noexcept
+	{
+		using namespace simd;
+		// Same order of evaluation as the scalar dot()
+		return madd( aZ0, aZ1, madd( aY0, aY1, mul( aX0, aX1 ) ) );
+	}
+
+	template< class tVec >
+	std::size_t normalize_simd_( Vec3StreamView aX ) noexcept
+	{
+		using namespace simd;
+		constexpr std::size_t kWidth = tVec::kWidth;
+
+		std::size_t i = 0;
+		for( ; i + kWidth <= aX.size; i += kWidth )
+		{
+			tVec const x = load<tVec>( aX.x+i );
+			tVec const y = load<tVec>( aX.y+i );
+			tVec const z = load<tVec>( aX.z+i );
+
+			tVec const l = sqrt( dot_( x, y, z, x, y, z ) );
+			store( aX.x+i, div( x, l ) );
+			store( aX.y+i, div( y, l ) );
+			store( aX.z+i, div( z, l ) );
+		}
+		return i;
+	}
+
+	template< class tVec >
+	std::size_t dot_simd_( Vec3StreamConstView aX, Vec3StreamConstView aY, float* aOut ) noexcept
+	{
+		using namespace simd;
+		constexpr std::size_t kWidth = tVec::kWidth;
+
+		std::size_t i = 0;
+		for( ; i + kWidth <= aX.size; i += kWidth )
+		{
+			store( aOut+i, dot_(
+				load<tVec>( aX.x+i ), load<tVec>( aX.y+i ), load<tVec>( aX.z+i ),
+				load<tVec>( aY.x+i ), load<tVec>( aY.y+i ), load<tVec>( aY.z+i )
+			) );
+		}
+		return i;
+	}
+
+	template< class tVec >
+	std::size_t length_simd_( Vec3StreamConstView aX, float* aOut ) noexcept
+	{
+		using namespace simd;
+		constexpr std::size_t kWidth = tVec::kWidth;
+
+		std::size_t i = 0;
+		for( ; i + kWidth <= aX.size; i += kWidth )
+		{
+			tVec const x = load<tVec>( aX.x+i );
+			tVec const y = load<tVec>( aX.y+i );
+			tVec const z = load<tVec>( aX.z+i );
+			store( aOut+i, sqrt( dot_( x, y, z, x, y, z ) ) );
+		}
+		return i;
+	}
+
+	template< class tVec >
+	std::size_t interleave_simd_( Vec3StreamConstView aX, Vec3f* aOut ) noexcept
+	{
+		using namespace simd;
+		constexpr std::size_t kWidth = tVec::kWidth;
+
+		std::size_t i = 0;
+		for( ; i + kWidth <= aX.size; i += kWidth )
+			store_xyz( &aOut[i].x, load<tVec>( aX.x+i ), load<tVec>( aX.y+i ), load<tVec>( aX.z+i ) );
+		return i;
+	}
+
+	template< class tVec >
+	std::size_t deinterleave_simd_( Vec3f const* aIn, Vec3StreamView aOut ) noexcept
+	{
+		using namespace simd;
+		constexpr std::size_t kWidth = tVec::kWidth;
+
+		std::size_t i = 0;
+		for( ; i + kWidth <= aOut.size; i += kWidth )
+		{
+			tVec x, y, z;
+			load_xyz( &aIn[i].x, x, y, z );
+			store( aOut.x+i, x );
+			store( aOut.y+i, y );
+			store( aOut.z+i, z );
+		}
+		return i;
+	}
+#	endif // ~ !VMLIB_SIMD_NONE
+
+	Vec3StreamView advance_( Vec3StreamView aView, std::size_t aCount ) noexcept
+	{
+		return { aView.x+aCount, aView.y+aCount, aView.z+aCount, aView.size-aCount };
+	}
+	Vec3StreamConstView advance_( Vec3StreamConstView aView, std::size_t aCount ) noexcept
+	{
+		return { aView.x+aCount, aView.y+aCount, aView.z+aCount, aView.size-aCount };
+	}
+}
+
+// Vec3Stream
+Vec3Stream::Vec3Stream() noexcept
+	: mData( nullptr )
+	, mSize( 0 )
+	, mCapacity( 0 )
+{}
+
+Vec3Stream::Vec3Stream( std::size_t aCount, Vec3f aValue )
+	: Vec3Stream()
+{
+	resize( aCount, aValue );
+}
+
+Vec3Stream::~Vec3Stream()
+{
+	deallocate_( mData );
+}
+
+Vec3Stream::Vec3Stream( Vec3Stream const& aOther )
+	: Vec3Stream()
+{
+	reallocate_( aOther.mSize );
+	mSize = aOther.mSize;
+	std::copy_n( aOther.x(), mSize, x() );
+	std::copy_n( aOther.y(), mSize, y() );
+	std::copy_n( aOther.z(), mSize, z() );
+}
+Vec3Stream& Vec3Stream::operator= (Vec3Stream const& aOther)
+{
+	if( this != &aOther )
+	{
+		Vec3Stream copy( aOther );
+		*this = std::move(copy);
+	}
+	return *this;
+}
+
+Vec3Stream::Vec3Stream( Vec3Stream&& aOther ) noexcept
+	: mData( std::exchange( aOther.mData, nullptr ) )
+	, mSize( std::exchange( aOther.mSize, 0 ) )
+	, mCapacity( std::exchange( aOther.mCapacity, 0 ) )
+{}
+Vec3Stream& Vec3Stream::operator= (Vec3Stream&& aOther) noexcept
+{
+	std::swap( mData, aOther.mData );
+	std::swap( mSize, aOther.mSize );
+	std::swap( mCapacity, aOther.mCapacity );
+	return *this;
+}
+
+void Vec3Stream::reserve( std::size_t aCapacity )
+{
+	if( aCapacity > mCapacity )
+		reallocate_( aCapacity );
+}
+
+void Vec3Stream::resize( std::size_t aCount, Vec3f aValue )
+{
+	reserve( aCount );
+	if( aCount > mSize )
+	{
+		std::fill( x() + mSize, x() + aCount, aValue.x );
+		std::fill( y() + mSize, y() + aCount, aValue.y );
+		std::fill( z() + mSize, z() + aCount, aValue.z );
+	}
+	mSize = aCount;
+}
+
+void Vec3Stream::push_back( Vec3f aV )
+{
+	if( mSize == mCapacity )
+		reallocate_( std::max( 2*mCapacity, kBlock_ ) );
+
+	++mSize;
+	set( mSize-1, aV );
+}
+
+Vec3StreamView Vec3Stream::view( std::size_t aBegin ) noexcept
+{
+	assert( aBegin <= mSize );
+	return view( aBegin, mSize - aBegin );
+}
+Vec3StreamView Vec3Stream::view( std::size_t aBegin, std::size_t aCount ) noexcept
+{
+	assert( aBegin + aCount <= mSize );
+	return { x() + aBegin, y() + aBegin, z() + aBegin, aCount };
+}
+Vec3StreamConstView Vec3Stream::view( std::size_t aBegin ) const noexcept
+{
+	assert( aBegin <= mSize );
+	return view( aBegin, mSize - aBegin );
+}
+Vec3StreamConstView Vec3Stream::view( std::size_t aBegin, std::size_t aCount ) const noexcept
+{
+	assert( aBegin + aCount <= mSize );
+	return { x() + aBegin, y() + aBegin, z() + aBegin, aCount };
+}
+
+void Vec3Stream::reallocate_( std::size_t aCapacity )
+{
+	std::size_t const capacity = (aCapacity + kBlock_ - 1) / kBlock_ * kBlock_;
+	float* const data = allocate_( capacity );
+
+	if( mSize )
+	{
+		std::copy_n( x(), mSize, data );
+		std::copy_n( y(), mSize, data + capacity );
+		std::copy_n( z(), mSize, data + 2*capacity );
+	}
+
+	deallocate_( mData );
+	mData = data;
+	mCapacity = capacity;
+}
+
+
+// Kernels
+void axpy( float aA, Vec3StreamConstView aX, Vec3StreamView aY ) noexcept
+{
+	assert( aX.size == aY.size );
+
+	std::size_t done = 0;
+#	if VMLIB_SIMD_AVX
+	done += axpy_simd_<simd::F32x8>( aA, advance_( aX, done ), advance_( aY, done ) );
+#	endif
+#	if !VMLIB_SIMD_NONE
+	done += axpy_simd_<simd::F32x4>( aA, advance_( aX, done ), advance_( aY, done ) );
+#	endif
+	detail::axpy_scalar( aA, advance_( aX, done ), advance_( aY, done ) );
+}
+
+void scale( Vec3StreamView aX, float aA ) noexcept
+{
+	std::size_t done = 0;
+#	if VMLIB_SIMD_AVX
+	done += scale_simd_<simd::F32x8>( advance_( aX, done ), aA );
+#	endif
+#	if !VMLIB_SIMD_NONE
+	done += scale_simd_<simd::F32x4>( advance_( aX, done ), aA );
+#	endif
+	detail::scale_scalar( advance_( aX, done ), aA );
+}
+
+void normalize( Vec3StreamView aX ) noexcept
+{
+	std::size_t done = 0;
+#	if VMLIB_SIMD_AVX
+	done += normalize_simd_<simd::F32x8>( advance_( aX, done ) );
+#	endif
+#	if !VMLIB_SIMD_NONE
+	done += normalize_simd_<simd::F32x4>( advance_( aX, done ) );
+#	endif
+	detail::normalize_scalar( advance_( aX, done ) );
+}
+
+void dot( Vec3StreamConstView aX, Vec3StreamConstView aY, float* aOut ) noexcept
+{
+	assert( aX.size == aY.size );
+
+	std::size_t done = 0;
+#	if VMLIB_SIMD_AVX
+	done += dot_simd_<simd::F32x8>( advance_( aX, done ), advance_( aY, done ), aOut+done );
+#	endif
+#	if !VMLIB_SIMD_NONE
+	done += dot_simd_<simd::F32x4>( advance_( aX, done ), advance_( aY, done ), aOut+done );
+#	endif
+	detail::dot_scalar( advance_( aX, done ), advance_( aY, done ), aOut+done );
+}
+
+void length( Vec3StreamConstView aX, float* aOut ) noexcept
+{
+	std::size_t done = 0;
+#	if VMLIB_SIMD_AVX
+	done += length_simd_<simd::F32x8>( advance_( aX, done ), aOut+done );
+#	endif
+#	if !VMLIB_SIMD_NONE
+	done += length_simd_<simd::F32x4>( advance_( aX, done ), aOut+done );
+#	endif
+	detail::length_scalar( advance_( aX, done ), aOut+done );
+}
+
+void interleave( Vec3StreamConstView aX, Vec3f* aOut ) noexcept
+{
+	std::size_t done = 0;
+#	if VMLIB_SIMD_AVX
+	done += interleave_simd_<simd::F32x8>( advance_( aX, done ), aOut+done );
+#	endif
+#	if !VMLIB_SIMD_NONE
+	done += interleave_simd_<simd::F32x4>( advance_( aX, done ), aOut+done );
+#	endif
+	for( std::size_t i = done; i < aX.size; ++i )
+		aOut[i] = Vec3f{ aX.x[i], aX.y[i], aX.z[i] };
+}
+
+void deinterleave( Vec3f const* aIn, Vec3StreamView aOut ) noexcept
+{
+	std::size_t done = 0;
+#	if VMLIB_SIMD_AVX
+	done += deinterleave_simd_<simd::F32x8>( aIn+done, advance_( aOut, done ) );
+#	endif
+#	if !VMLIB_SIMD_NONE
+	done += deinterleave_simd_<simd::F32x4>( aIn+done, advance_( aOut, done ) );
+#	endif
+	for( std::size_t i = done; i < aOut.size; ++i )
+	{
+		aOut.x[i] = aIn[i].x;
+		aOut.y[i] = aIn[i].y;
+		aOut.z[i] = aIn[i].z;
+	}
+}
+
+
+namespace detail
+{
+	void axpy_scalar( float aA, Vec3StreamConstView aX, Vec3StreamView aY ) noexcept
+	{
+		for( std::size_t i = 0; i < aX.size; ++i )
+		{
+			aY.x[i] += aA * aX.x[i];
+			aY.y[i] += aA * aX.y[i];
+			aY.z[i] += aA * aX.z[i];
+		}
+	}
+
+	void scale_scalar( Vec3StreamView aX, float aA ) noexcept
+	{
+		for( std::size_t i = 0; i < aX.size; ++i )
+		{
+			aX.x[i] *= aA;
+			aX.y[i] *= aA;
+			aX.z[i] *= aA;
+		}
+	}
+
+	void normalize_scalar( Vec3StreamView aX ) noexcept
+	{
+		for( std::size_t i = 0; i < aX.size; ++i )
+		{
+			Vec3f const v = normalize( Vec3f{ aX.x[i], aX.y[i], aX.z[i] } );
+			aX.x[i] = v.x;
+			aX.y[i] = v.y;
+			aX.z[i] = v.z;
+		}
+	}
+
+	void dot_scalar( Vec3StreamConstView aX, Vec3StreamConstView aY, float* aOut ) noexcept
+	{
+		for( std::size_t i = 0; i < aX.size; ++i )
+			aOut[i] = dot( Vec3f{ aX.x[i], aX.y[i], aX.z[i] }, Vec3f{ aY.x[i], aY.y[i], aY.z[i] } );
+	}
+
+	void length_scalar( Vec3StreamConstView aX, float* aOut ) noexcept
+	{
+		for( std::size_t i = 0; i < aX.size; ++i )
+			aOut[i] = length( Vec3f{ aX.x[i], aX.y[i], aX.z[i] } );
+	}
+}
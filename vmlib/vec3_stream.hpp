@@ -0,0 +1,155 @@
+#ifndef VEC3_STREAM_HPP_F1B9309F_A315_42B3_A281_3E9CCC84C982
+#define VEC3_STREAM_HPP_F1B9309F_A315_42B3_A281_3E9CCC84C982
+
+#include <cassert>
+#include <cstddef>
+
+#include "vec3.hpp"
+
+/** Vec3Stream: structure-of-arrays storage for Vec3f
+ *
+ * Stores the x, y and z components of N vectors in three separate float
+ * arrays (instead of an array of N Vec3f). Kernels that work on all elements
+ * can then load 4/8 x-components (y-, z-components) with a single SIMD load,
+ * and process 4/8 vectors per instruction without any shuffling.
+ *
+ * All three arrays live in a single allocation:
+ *
+ *   data(): [ x0 x1 ... x(N-1) pad | y0 y1 ... pad | z0 z1 ... pad ]
+ *
+ * Each array starts at a kAlignment-byte boundary, a cache line, so threads
+ * can work on ranges that start at multiples of 16 elements without sharing
+ * cache lines. The distance between the arrays is capacity() floats. The
+ * block can be uploaded to OpenGL as-is (glBufferData( ..., size_bytes(),
+ * data(), ... )) and read with three single-float attributes at offsets
+ * component_offset( 0..2 ). Use interleave() to write the vectors as Vec3f
+ * directly into a mapped buffer instead.
+ *
+ * The kernels below take views, so that they can also operate on a subrange
+ * of a stream (see Vec3Stream::view()).
+ */
+struct Vec3StreamView
+{
+	float* x;
+	float* y;
+	float* z;
+	std::size_t size;
+};
+
+struct Vec3StreamConstView
+{
+	float const* x;
+	float const* y;
+	float const* z;
+	std::size_t size;
+};
+
+class Vec3Stream final
+{
+	public:
+		static constexpr std::size_t kAlignment = 64; // bytes, a cache line
+
+	public:
+		Vec3Stream() noexcept;
+		explicit Vec3Stream( std::size_t aCount, Vec3f aValue = Vec3f{ 0.f, 0.f, 0.f } );
+
+		~Vec3Stream();
+
+		Vec3Stream( Vec3Stream const& );
+		Vec3Stream& operator= (Vec3Stream const&);
+
+		Vec3Stream( Vec3Stream&& ) noexcept;
+		Vec3Stream& operator= (Vec3Stream&&) noexcept;
+
+	public:
+		std::size_t size() const noexcept { return mSize; }
+		std::size_t capacity() const noexcept { return mCapacity; }
+		bool empty() const noexcept { return 0 == mSize; }
+
+		void reserve( std::size_t );
+		void resize( std::size_t, Vec3f aValue = Vec3f{ 0.f, 0.f, 0.f } );
+		void clear() noexcept { mSize = 0; }
+
+		void push_back( Vec3f );
+
+		Vec3f get( std::size_t aI ) const noexcept
+		{
+			assert( aI < mSize );
+			return Vec3f{ mData[aI], mData[mCapacity + aI], mData[2*mCapacity + aI] };
+		}
+		void set( std::size_t aI, Vec3f aV ) noexcept
+		{
+			assert( aI < mSize );
+			mData[aI] = aV.x;
+			mData[mCapacity + aI] = aV.y;
+			mData[2*mCapacity + aI] = aV.z;
+		}
+
+		float* x() noexcept { return mData; }
+		float* y() noexcept { return mData + mCapacity; }
+		float* z() noexcept { return mData + 2*mCapacity; }
+		float const* x() const noexcept { return mData; }
+		float const* y() const noexcept { return mData + mCapacity; }
+		float const* z() const noexcept { return mData + 2*mCapacity; }
+
+		// Raw storage, see above.
+		float const* data() const noexcept { return mData; }
+		std::size_t size_bytes() const noexcept { return 3 * mCapacity * sizeof(float); }
+		std::size_t component_offset( std::size_t aComponent ) const noexcept
+		{
+			assert( aComponent < 3 );
+			return aComponent * mCapacity * sizeof(float);
+		}
+
+		Vec3StreamView view( std::size_t aBegin = 0 ) noexcept;
+		Vec3StreamView view( std::size_t aBegin, std::size_t aCount ) noexcept;
+		Vec3StreamConstView view( std::size_t aBegin = 0 ) const noexcept;
+		Vec3StreamConstView view( std::size_t aBegin, std::size_t aCount ) const noexcept;
+
+		operator Vec3StreamView() noexcept { return view(); }
+		operator Vec3StreamConstView() const noexcept { return view(); }
+
+	private:
+		void reallocate_( std::size_t );
+
+		float* mData;
+		std::size_t mSize;
+		std::size_t mCapacity;
+};
+
+// Kernels. Unless noted, the views must have the same size. Outputs may
+// alias inputs element-by-element (e.g., aY += aA * aY), but must not
+// otherwise overlap.
+
+// aY += aA * aX
+void axpy( float aA, Vec3StreamConstView aX, Vec3StreamView aY ) noexcept;
+
+// aX *= aA
+void scale( Vec3StreamView aX, float aA ) noexcept;
+
+// aX = aX / length(aX). Zero-length vectors yield NaNs, as for normalize().
+void normalize( Vec3StreamView aX ) noexcept;
+
+// aOut[i] = dot( aX[i], aY[i] ); aOut has aX.size elements
+void dot( Vec3StreamConstView aX, Vec3StreamConstView aY, float* aOut ) noexcept;
+
+// aOut[i] = length( aX[i] ); aOut has aX.size elements
+void length( Vec3StreamConstView aX, float* aOut ) noexcept;
+
+// Conversion from/to arrays of Vec3f (e.g., a mapped vertex buffer) with
+// aX.size elements.
+void interleave( Vec3StreamConstView aX, Vec3f* aOut ) noexcept;
+void deinterleave( Vec3f const* aIn, Vec3StreamView aOut ) noexcept;
+
+
+// Scalar reference implementations (one element at a time).
+namespace detail
+{
+	void axpy_scalar( float, Vec3StreamConstView, Vec3StreamView ) noexcept;
+	void scale_scalar( Vec3StreamView, float ) noexcept;
+	void normalize_scalar( Vec3StreamView ) noexcept;
+	void dot_scalar( Vec3StreamConstView, Vec3StreamConstView, float* ) noexcept;
+	void length_scalar( Vec3StreamConstView, float* ) noexcept;
+}
+
+#endif // VEC3_STREAM_HPP_F1B9309F_A315_42B3_A281_3E9CCC84C982